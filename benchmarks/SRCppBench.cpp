@@ -0,0 +1,954 @@
+// SRCppBench: throughput of SRCpp's Convert, PushConverter and PullConverter,
+// each measured against the equivalent hand-written libsamplerate calls on the
+// same data so wrapper overhead shows up as its own counter.
+//
+// The sweep is large; use --benchmark_filter to pick cases, e.g.
+//   SRCppBench --benchmark_filter='Push/Sinc_Fastest/float<-short/ch2/.*'
+#include <SRCpp/SRCpp.hpp>
+#include <SRCpp/SRCppConverterPool.hpp>
+#include <SRCpp/SRCppFile.hpp>
+#include <SRCpp/SRCppParallel.hpp>
+#include <SRCpp/SRCppStreamPool.hpp>
+#include <array>
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <numbers>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr auto kTypes = std::array {
+    SRCpp::Type::Sinc_BestQuality,
+    SRCpp::Type::Sinc_MediumQuality,
+    SRCpp::Type::Sinc_Fastest,
+    SRCpp::Type::ZeroOrderHold,
+    SRCpp::Type::Linear,
+};
+constexpr auto kChannels = std::array { 1, 2, 6, 16 };
+constexpr auto kFactors = std::array { 44100.0 / 48000.0, 48000.0 / 44100.0,
+    16000.0 / 48000.0, 2.0 };
+constexpr auto kBlockFrames = std::array<size_t, 6> { 32, 256, 1024, 4096,
+    16384, 65536 };
+
+auto TypeName(SRCpp::Type type) -> std::string
+{
+    switch (type) {
+    case SRCpp::Type::Sinc_BestQuality:
+        return "Sinc_BestQuality";
+    case SRCpp::Type::Sinc_MediumQuality:
+        return "Sinc_MediumQuality";
+    case SRCpp::Type::Sinc_Fastest:
+        return "Sinc_Fastest";
+    case SRCpp::Type::ZeroOrderHold:
+        return "ZeroOrderHold";
+    case SRCpp::Type::Linear:
+        return "Linear";
+    case SRCpp::Type::Polyphase_BestQuality:
+        return "Polyphase_BestQuality";
+    case SRCpp::Type::Polyphase_MediumQuality:
+        return "Polyphase_MediumQuality";
+    case SRCpp::Type::Polyphase_Fastest:
+        return "Polyphase_Fastest";
+    }
+    return "Unknown";
+}
+
+template <SRCpp::SupportedSampleType T> auto SampleName() -> std::string
+{
+    if constexpr (std::is_same_v<T, short>) {
+        return "short";
+    } else if constexpr (std::is_same_v<T, int>) {
+        return "int";
+    } else {
+        return "float";
+    }
+}
+
+struct Case {
+    SRCpp::Type type;
+    int channels;
+    double factor;
+    size_t frames;
+};
+
+auto OutputFrames(Case const& c) -> size_t
+{
+    return static_cast<size_t>(std::ceil(c.frames * c.factor)) + 16;
+}
+
+// A different tone per channel so no channel is trivially compressible.
+template <SRCpp::SupportedSampleType T> auto MakeInput(Case const& c)
+{
+    std::vector<float> data(c.frames * c.channels);
+    for (size_t i = 0; i < c.frames; ++i) {
+        for (int ch = 0; ch < c.channels; ++ch) {
+            auto hz = 440.0 * (ch + 1);
+            data[i * c.channels + ch] = static_cast<float>(
+                0.5 * std::sin(hz * i * 2 * std::numbers::pi / 48000.0));
+        }
+    }
+    std::vector<T> result(data.size());
+    if constexpr (std::is_same_v<T, short>) {
+        src_float_to_short_array(data.data(), result.data(), data.size());
+    } else if constexpr (std::is_same_v<T, int>) {
+        src_float_to_int_array(data.data(), result.data(), data.size());
+    } else {
+        result = data;
+    }
+    return result;
+}
+
+// The conversions a caller would write by hand around libsamplerate.
+template <SRCpp::SupportedSampleType From>
+void RawToFloat(std::span<const From> in, std::span<float> out)
+{
+    if constexpr (std::is_same_v<From, short>) {
+        src_short_to_float_array(in.data(), out.data(), in.size());
+    } else if constexpr (std::is_same_v<From, int>) {
+        src_int_to_float_array(in.data(), out.data(), in.size());
+    } else {
+        std::copy(in.begin(), in.end(), out.begin());
+    }
+}
+
+template <SRCpp::SupportedSampleType To>
+void RawFromFloat(std::span<const float> in, std::span<To> out)
+{
+    if constexpr (std::is_same_v<To, short>) {
+        src_float_to_short_array(in.data(), out.data(), in.size());
+    } else if constexpr (std::is_same_v<To, int>) {
+        src_float_to_int_array(in.data(), out.data(), in.size());
+    } else {
+        std::copy(in.begin(), in.end(), out.begin());
+    }
+}
+
+using Clock = std::chrono::steady_clock;
+
+// Runs the raw libsamplerate equivalent for the same number of iterations the
+// wrapper ran and publishes the per-frame cost of each plus the overhead.  A
+// raw run that fails calls SkipWithError, which ends the report.
+template <typename Raw>
+void Report(benchmark::State& state, Case const& c, Clock::duration wrapped,
+    Raw&& raw)
+{
+    auto iterations = static_cast<size_t>(state.iterations());
+    auto start = Clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        raw();
+        if (state.error_occurred()) {
+            return;
+        }
+    }
+    auto raw_elapsed = Clock::now() - start;
+
+    auto frames = static_cast<double>(iterations * c.frames);
+    auto wrapped_ns
+        = std::chrono::duration<double, std::nano>(wrapped).count() / frames;
+    auto raw_ns
+        = std::chrono::duration<double, std::nano>(raw_elapsed).count()
+        / frames;
+    state.counters["frames/s"] = benchmark::Counter(
+        frames, benchmark::Counter::kIsRate | benchmark::Counter::kAvgThreads);
+    state.counters["ns/frame"] = wrapped_ns;
+    state.counters["raw_ns/frame"] = raw_ns;
+    state.counters["overhead%"]
+        = raw_ns > 0.0 ? (wrapped_ns / raw_ns - 1.0) * 100.0 : 0.0;
+}
+
+template <SRCpp::SupportedSampleType To, SRCpp::SupportedSampleType From>
+void BenchConvert(benchmark::State& state, Case c)
+{
+    auto input = MakeInput<From>(c);
+    auto output = std::vector<To>(OutputFrames(c) * c.channels);
+
+    auto start = Clock::now();
+    for (auto _ : state) {
+        auto [result, error] = SRCpp::Convert(
+            std::span<const From> { input }, std::span<To> { output }, c.type,
+            c.channels, c.factor);
+        if (!result) {
+            state.SkipWithError(error.c_str());
+            return;
+        }
+        benchmark::DoNotOptimize(result->data());
+    }
+    auto wrapped = Clock::now() - start;
+
+    auto float_in = std::vector<float>(input.size());
+    auto float_out = std::vector<float>(output.size());
+    Report(state, c, wrapped, [&] {
+        RawToFloat<From>(input, float_in);
+        auto data = SRC_DATA {
+            float_in.data(),
+            float_out.data(),
+            static_cast<long>(c.frames),
+            static_cast<long>(float_out.size() / c.channels),
+            0,
+            0,
+            1,
+            c.factor,
+        };
+        src_simple(&data, static_cast<int>(c.type), c.channels);
+        RawFromFloat<To>(
+            std::span { float_out }.first(data.output_frames_gen * c.channels),
+            output);
+        benchmark::DoNotOptimize(output.data());
+    });
+}
+
+template <SRCpp::SupportedSampleType To, SRCpp::SupportedSampleType From>
+void BenchPush(benchmark::State& state, Case c)
+{
+    auto input = MakeInput<From>(c);
+    auto output = std::vector<To>(OutputFrames(c) * c.channels);
+    auto converter = SRCpp::PushConverter(c.type, c.channels, c.factor);
+
+    auto start = Clock::now();
+    for (auto _ : state) {
+        auto [result, error] = converter.convert(
+            std::span<const From> { input }, std::span<To> { output });
+        if (!result) {
+            state.SkipWithError(error.c_str());
+            return;
+        }
+        benchmark::DoNotOptimize(result->data());
+    }
+    auto wrapped = Clock::now() - start;
+
+    auto error = 0;
+    auto* raw_state = src_new(static_cast<int>(c.type), c.channels, &error);
+    auto float_in = std::vector<float>(input.size());
+    auto float_out = std::vector<float>(output.size());
+    Report(state, c, wrapped, [&] {
+        RawToFloat<From>(input, float_in);
+        auto data = SRC_DATA {
+            float_in.data(),
+            float_out.data(),
+            static_cast<long>(c.frames),
+            static_cast<long>(float_out.size() / c.channels),
+            0,
+            0,
+            0,
+            c.factor,
+        };
+        src_process(raw_state, &data);
+        RawFromFloat<To>(
+            std::span { float_out }.first(data.output_frames_gen * c.channels),
+            output);
+        benchmark::DoNotOptimize(output.data());
+    });
+    src_delete(raw_state);
+}
+
+template <SRCpp::SupportedSampleType To, SRCpp::SupportedSampleType From>
+void BenchPull(benchmark::State& state, Case c)
+{
+    auto input = MakeInput<From>(c);
+    auto output = std::vector<To>(
+        static_cast<size_t>(std::ceil(c.frames * c.factor)) * c.channels);
+    // an endless source: the same block over and over again
+    auto converter = SRCpp::PullConverter(
+        [&input]() -> std::span<From> { return input; }, c.type, c.channels,
+        c.factor);
+
+    auto start = Clock::now();
+    for (auto _ : state) {
+        auto [result, error] = converter.convert(std::span<To> { output });
+        if (!result) {
+            state.SkipWithError(error.c_str());
+            return;
+        }
+        benchmark::DoNotOptimize(result->data());
+    }
+    auto wrapped = Clock::now() - start;
+
+    struct RawSource {
+        std::span<const From> input;
+        std::vector<float> scratch;
+        int channels;
+    } source { input, std::vector<float>(input.size()), c.channels };
+    auto error = 0;
+    auto* raw_state = src_callback_new(
+        [](void* cb_data, float** data) -> long {
+            auto* source = static_cast<RawSource*>(cb_data);
+            RawToFloat<From>(source->input, source->scratch);
+            *data = source->scratch.data();
+            return static_cast<long>(source->input.size() / source->channels);
+        },
+        static_cast<int>(c.type), c.channels, &error, &source);
+    auto float_out = std::vector<float>(output.size());
+    Report(state, c, wrapped, [&] {
+        auto frames = src_callback_read(raw_state, c.factor,
+            static_cast<long>(float_out.size() / c.channels),
+            float_out.data());
+        RawFromFloat<To>(
+            std::span { float_out }.first(frames * c.channels), output);
+        benchmark::DoNotOptimize(output.data());
+    });
+    src_delete(raw_state);
+}
+
+// Per-call cost of PushConverter::convert with a standing input backlog.  The
+// backlog is primed with an output-less push, then every call adds a block and
+// offers just enough output room to drain a block, so the backlog stays put.
+// Staging cost should be independent of the backlog size.
+void BenchPushBacklog(benchmark::State& state)
+{
+    auto c = Case { SRCpp::Type::Linear, 2, 44100.0 / 48000.0, 256 };
+    auto backlog_frames = static_cast<size_t>(state.range(0));
+    auto input = MakeInput<float>(c);
+    auto output = std::vector<float>(
+        static_cast<size_t>(std::ceil(c.frames * c.factor)) * c.channels);
+    auto converter = SRCpp::PushConverter(c.type, c.channels, c.factor);
+
+    auto backlog = MakeInput<float>(
+        Case { c.type, c.channels, c.factor, backlog_frames });
+    converter.convert(std::span<const float> { backlog }, std::span<float> {});
+
+    for (auto _ : state) {
+        auto [result, error] = converter.convert(
+            std::span<const float> { input }, std::span<float> { output });
+        if (!result) {
+            state.SkipWithError(error.c_str());
+            return;
+        }
+        benchmark::DoNotOptimize(result->data());
+    }
+    state.counters["frames/s"] = benchmark::Counter(
+        static_cast<double>(state.iterations() * c.frames),
+        benchmark::Counter::kIsRate);
+}
+BENCHMARK(BenchPushBacklog)
+    ->Name("PushBacklog")
+    ->RangeMultiplier(16)
+    ->Range(0, 1 << 20);
+
+// One sample format kernel at a given SIMD level against libsamplerate's
+// scalar src_*_array equivalent.
+template <SRCpp::SupportedSampleType To, SRCpp::SupportedSampleType From>
+void BenchFormat(benchmark::State& state, SRCpp::SimdLevel level, size_t samples)
+{
+    auto c = Case { SRCpp::Type::Linear, 1, 1.0, samples };
+    auto input = MakeInput<From>(c);
+    auto output = std::vector<To>(samples);
+    const auto& kernels = SRCpp::details::FormatKernelsFor(level);
+
+    auto start = Clock::now();
+    for (auto _ : state) {
+        if constexpr (std::is_same_v<To, float>) {
+            if constexpr (std::is_same_v<From, short>) {
+                kernels.short_to_float(input.data(), output.data(), samples);
+            } else {
+                kernels.int_to_float(input.data(), output.data(), samples);
+            }
+        } else if constexpr (std::is_same_v<To, short>) {
+            kernels.float_to_short(input.data(), output.data(), samples);
+        } else {
+            kernels.float_to_int(input.data(), output.data(), samples);
+        }
+        benchmark::DoNotOptimize(output.data());
+    }
+    auto wrapped = Clock::now() - start;
+    Report(state, c, wrapped, [&] {
+        if constexpr (std::is_same_v<To, float>) {
+            RawToFloat<From>(input, output);
+        } else {
+            RawFromFloat<To>(input, output);
+        }
+        benchmark::DoNotOptimize(output.data());
+    });
+}
+
+auto LevelName(SRCpp::SimdLevel level) -> std::string
+{
+    switch (level) {
+    case SRCpp::SimdLevel::Scalar:
+        return "Scalar";
+    case SRCpp::SimdLevel::SSE2:
+        return "SSE2";
+    case SRCpp::SimdLevel::AVX2:
+        return "AVX2";
+    case SRCpp::SimdLevel::AVX512:
+        return "AVX512";
+    }
+    return "unknown";
+}
+
+void RegisterFormats()
+{
+    auto add = [&]<typename To, typename From>() {
+        for (auto level : { SRCpp::SimdLevel::Scalar, SRCpp::SimdLevel::SSE2,
+                 SRCpp::SimdLevel::AVX2, SRCpp::SimdLevel::AVX512 }) {
+            if (level > SRCpp::DetectSimdLevel()) {
+                continue;
+            }
+            for (auto samples : kBlockFrames) {
+                auto name = std::format("Format/{}/{}<-{}/n{}",
+                    LevelName(level), SampleName<To>(), SampleName<From>(),
+                    samples);
+                benchmark::RegisterBenchmark(
+                    name.c_str(), BenchFormat<To, From>, level, samples);
+            }
+        }
+    };
+    add.template operator()<float, short>();
+    add.template operator()<float, int>();
+    add.template operator()<short, float>();
+    add.template operator()<int, float>();
+}
+
+// Planar PushConverter::convert against interleaving by hand, converting,
+// running libsamplerate and de-interleaving by hand.
+template <SRCpp::SupportedSampleType To, SRCpp::SupportedSampleType From>
+void BenchPlanarPush(benchmark::State& state, Case c)
+{
+    auto channels = static_cast<size_t>(c.channels);
+    auto output_frames = OutputFrames(c);
+    auto input = std::vector<std::vector<From>>(
+        channels, MakeInput<From>(Case { c.type, 1, c.factor, c.frames }));
+    auto output
+        = std::vector<std::vector<To>>(channels, std::vector<To>(output_frames));
+    auto input_pointers = std::vector<const From*> {};
+    auto output_pointers = std::vector<To*> {};
+    for (size_t ch = 0; ch < channels; ++ch) {
+        input_pointers.push_back(input[ch].data());
+        output_pointers.push_back(output[ch].data());
+    }
+    auto planar_in = SRCpp::PlanarSpan<const From> { input_pointers, c.frames };
+    auto planar_out = SRCpp::PlanarSpan<To> { output_pointers, output_frames };
+    auto converter = SRCpp::PushConverter(c.type, c.channels, c.factor);
+
+    auto start = Clock::now();
+    for (auto _ : state) {
+        auto [result, error] = converter.convert(planar_in, planar_out);
+        if (!result) {
+            state.SkipWithError(error.c_str());
+            return;
+        }
+        benchmark::DoNotOptimize(result->channel(0).data());
+    }
+    auto wrapped = Clock::now() - start;
+
+    auto error = 0;
+    auto* raw_state = src_new(static_cast<int>(c.type), c.channels, &error);
+    auto interleaved_in = std::vector<From>(c.frames * channels);
+    auto interleaved_out = std::vector<To>(output_frames * channels);
+    auto float_in = std::vector<float>(interleaved_in.size());
+    auto float_out = std::vector<float>(interleaved_out.size());
+    Report(state, c, wrapped, [&] {
+        for (size_t i = 0; i < c.frames; ++i) {
+            for (size_t ch = 0; ch < channels; ++ch) {
+                interleaved_in[i * channels + ch] = input[ch][i];
+            }
+        }
+        RawToFloat<From>(interleaved_in, float_in);
+        auto data = SRC_DATA {
+            float_in.data(),
+            float_out.data(),
+            static_cast<long>(c.frames),
+            static_cast<long>(output_frames),
+            0,
+            0,
+            0,
+            c.factor,
+        };
+        src_process(raw_state, &data);
+        auto generated = static_cast<size_t>(data.output_frames_gen);
+        RawFromFloat<To>(std::span { float_out }.first(generated * channels),
+            interleaved_out);
+        for (size_t i = 0; i < generated; ++i) {
+            for (size_t ch = 0; ch < channels; ++ch) {
+                output[ch][i] = interleaved_out[i * channels + ch];
+            }
+        }
+        benchmark::DoNotOptimize(output.data());
+    });
+    src_delete(raw_state);
+}
+
+void RegisterPlanar()
+{
+    auto add = [&]<typename To, typename From>() {
+        for (auto type : { SRCpp::Type::Sinc_Fastest, SRCpp::Type::Linear }) {
+            for (auto channels : { 2, 6 }) {
+                auto c = Case { type, channels, 44100.0 / 48000.0, 1024 };
+                auto name = std::format("PlanarPush/{}/{}<-{}/ch{}",
+                    TypeName(type), SampleName<To>(), SampleName<From>(),
+                    channels);
+                benchmark::RegisterBenchmark(
+                    name.c_str(), BenchPlanarPush<To, From>, c);
+            }
+        }
+    };
+    add.template operator()<float, float>();
+    add.template operator()<short, short>();
+}
+
+// ParallelPushConverter against a single PushConverter (the raw column here)
+// on wide streams in 256-frame blocks, where per-call synchronisation cost
+// matters most.
+void BenchParallelPush(benchmark::State& state, Case c, size_t threads)
+{
+    auto input = MakeInput<float>(c);
+    auto output = std::vector<float>(OutputFrames(c) * c.channels);
+    auto converter = SRCpp::ParallelPushConverter(
+        c.type, c.channels, c.factor, threads);
+
+    auto start = Clock::now();
+    for (auto _ : state) {
+        auto [result, error] = converter.convert(
+            std::span<const float> { input }, std::span<float> { output });
+        if (!result) {
+            state.SkipWithError(error.c_str());
+            return;
+        }
+        benchmark::DoNotOptimize(result->data());
+    }
+    auto wrapped = Clock::now() - start;
+
+    auto serial = SRCpp::PushConverter(c.type, c.channels, c.factor);
+    Report(state, c, wrapped, [&] {
+        auto [result, error] = serial.convert(
+            std::span<const float> { input }, std::span<float> { output });
+        if (!result) {
+            state.SkipWithError(error.c_str());
+            return;
+        }
+        benchmark::DoNotOptimize(result->data());
+    });
+}
+
+// Convert split across threads against the serial Convert (the raw column
+// here) on a long stereo buffer.
+void BenchParallelConvert(benchmark::State& state, Case c, size_t threads)
+{
+    auto input = MakeInput<float>(c);
+    auto output = std::vector<float>(OutputFrames(c) * c.channels);
+
+    auto start = Clock::now();
+    for (auto _ : state) {
+        auto [result, error] = SRCpp::Convert(std::span<const float> { input },
+            std::span<float> { output }, c.type, c.channels, c.factor, threads);
+        if (!result) {
+            state.SkipWithError(error.c_str());
+            return;
+        }
+        benchmark::DoNotOptimize(result->data());
+    }
+    auto wrapped = Clock::now() - start;
+
+    Report(state, c, wrapped, [&] {
+        auto [result, error] = SRCpp::Convert(std::span<const float> { input },
+            std::span<float> { output }, c.type, c.channels, c.factor);
+        if (!result) {
+            state.SkipWithError(error.c_str());
+            return;
+        }
+        benchmark::DoNotOptimize(result->data());
+    });
+}
+
+void RegisterParallel()
+{
+    for (auto type : { SRCpp::Type::Sinc_BestQuality,
+             SRCpp::Type::Sinc_Fastest, SRCpp::Type::Linear }) {
+        for (size_t threads : { 2, 4 }) {
+            auto c = Case { type, 2, 44100.0 / 48000.0, 1 << 20 };
+            auto name = std::format("ParallelConvert/{}/ch2/threads{}",
+                TypeName(type), threads);
+            benchmark::RegisterBenchmark(
+                name.c_str(), BenchParallelConvert, c, threads)
+                ->UseRealTime();
+        }
+    }
+    for (auto type : { SRCpp::Type::Sinc_BestQuality,
+             SRCpp::Type::Sinc_Fastest, SRCpp::Type::Linear }) {
+        for (auto channels : { 8, 64 }) {
+            for (size_t threads : { 2, 4 }) {
+                auto c = Case { type, channels, 44100.0 / 48000.0, 256 };
+                auto name = std::format("ParallelPush/{}/ch{}/threads{}",
+                    TypeName(type), channels, threads);
+                benchmark::RegisterBenchmark(
+                    name.c_str(), BenchParallelPush, c, threads)
+                    ->UseRealTime();
+            }
+        }
+    }
+}
+
+// One 20ms telephony block pushed to each of many streams on a StreamPool,
+// against the same PushConverters driven one after another on this thread
+// (the raw column here).
+void BenchStreamPool(benchmark::State& state, SRCpp::Type type, size_t streams,
+    size_t threads)
+{
+    auto block_frames = size_t { 160 };
+    auto c = Case { type, 1, 48000.0 / 8000.0, block_frames * streams };
+    auto block = MakeInput<short>(Case { type, 1, c.factor, block_frames });
+
+    auto pool = SRCpp::StreamPool(threads);
+    for (size_t id = 0; id < streams; ++id) {
+        pool.open(id, type, 1, c.factor, [](std::span<const float> output) {
+            benchmark::DoNotOptimize(output.data());
+        });
+    }
+    auto start = Clock::now();
+    for (auto _ : state) {
+        for (size_t id = 0; id < streams; ++id) {
+            pool.push(id, std::span<const short> { block });
+        }
+        pool.wait();
+    }
+    auto wrapped = Clock::now() - start;
+
+    auto serial = std::vector<SRCpp::PushConverter> {};
+    for (size_t id = 0; id < streams; ++id) {
+        serial.emplace_back(type, 1, c.factor);
+    }
+    Report(state, c, wrapped, [&] {
+        for (auto& pusher : serial) {
+            auto [result, error]
+                = pusher.convert<float>(std::span<const short> { block });
+            if (!result) {
+                state.SkipWithError(error.c_str());
+                return;
+            }
+            benchmark::DoNotOptimize(result->data());
+        }
+    });
+}
+
+void RegisterStreamPool()
+{
+    for (auto type : { SRCpp::Type::Sinc_Fastest, SRCpp::Type::Linear }) {
+        for (size_t threads : { 1, 4 }) {
+            auto streams = size_t { 2000 };
+            auto name = std::format("StreamPool/{}/streams{}/threads{}",
+                TypeName(type), streams, threads);
+            benchmark::RegisterBenchmark(
+                name.c_str(), BenchStreamPool, type, streams, threads)
+                ->UseRealTime();
+        }
+    }
+}
+
+// Call setup: a converter leased from a ConverterPool and used for one block,
+// against constructing a new PushConverter each time (the raw column here).
+// The per-frame counters are per setup, since each iteration is one.
+void BenchConverterPool(benchmark::State& state, SRCpp::Type type)
+{
+    auto c = Case { type, 1, 48000.0 / 8000.0, 1 };
+    auto block = MakeInput<short>(Case { type, 1, c.factor, 160 });
+    auto pool = SRCpp::ConverterPool();
+
+    auto start = Clock::now();
+    for (auto _ : state) {
+        auto [lease, error] = pool.acquire(type, 1, c.factor);
+        if (!lease) {
+            state.SkipWithError(SRCpp::StrError(error));
+            return;
+        }
+        auto [result, convert_error] = (*lease)->convert<float>(
+            std::span<const short> { block });
+        if (!result) {
+            state.SkipWithError(convert_error.c_str());
+            return;
+        }
+        benchmark::DoNotOptimize(result->data());
+    }
+    auto wrapped = Clock::now() - start;
+
+    Report(state, c, wrapped, [&] {
+        auto converter = SRCpp::PushConverter(type, 1, c.factor);
+        auto [result, error]
+            = converter.convert<float>(std::span<const short> { block });
+        if (!result) {
+            state.SkipWithError(error.c_str());
+            return;
+        }
+        benchmark::DoNotOptimize(result->data());
+    });
+}
+
+void RegisterConverterPool()
+{
+    for (auto type : { SRCpp::Type::Sinc_BestQuality,
+             SRCpp::Type::Sinc_Fastest, SRCpp::Type::Linear }) {
+        auto name = std::format("ConverterPool/{}", TypeName(type));
+        benchmark::RegisterBenchmark(name.c_str(), BenchConverterPool, type);
+    }
+}
+
+// A Polyphase type pushed in blocks against the Sinc type of the same tier,
+// both through PushConverter on the same stream.  Reports the cost of each
+// per frame and how many times faster the Polyphase type is.
+void BenchPolyphase(benchmark::State& state, Case c, SRCpp::Type sinc)
+{
+    auto input = MakeInput<float>(c);
+    auto output = std::vector<float>(OutputFrames(c) * c.channels);
+    auto converter = SRCpp::PushConverter(c.type, c.channels, c.factor);
+
+    auto start = Clock::now();
+    for (auto _ : state) {
+        auto [result, error] = converter.convert(
+            std::span<const float> { input }, std::span<float> { output });
+        if (!result) {
+            state.SkipWithError(error.c_str());
+            return;
+        }
+        benchmark::DoNotOptimize(result->data());
+    }
+    auto polyphase = Clock::now() - start;
+
+    auto reference = SRCpp::PushConverter(sinc, c.channels, c.factor);
+    auto iterations = static_cast<size_t>(state.iterations());
+    start = Clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        auto [result, error] = reference.convert(
+            std::span<const float> { input }, std::span<float> { output });
+        if (!result) {
+            state.SkipWithError(error.c_str());
+            return;
+        }
+        benchmark::DoNotOptimize(result->data());
+    }
+    auto sinc_elapsed = Clock::now() - start;
+
+    auto frames = static_cast<double>(iterations * c.frames);
+    auto polyphase_ns
+        = std::chrono::duration<double, std::nano>(polyphase).count() / frames;
+    auto sinc_ns
+        = std::chrono::duration<double, std::nano>(sinc_elapsed).count()
+        / frames;
+    state.counters["frames/s"] = benchmark::Counter(
+        frames, benchmark::Counter::kIsRate | benchmark::Counter::kAvgThreads);
+    state.counters["ns/frame"] = polyphase_ns;
+    state.counters["sinc_ns/frame"] = sinc_ns;
+    state.counters["speedup"]
+        = polyphase_ns > 0.0 ? sinc_ns / polyphase_ns : 0.0;
+}
+
+void RegisterPolyphase()
+{
+    constexpr auto tiers = std::array {
+        std::pair { SRCpp::Type::Polyphase_BestQuality,
+            SRCpp::Type::Sinc_BestQuality },
+        std::pair { SRCpp::Type::Polyphase_MediumQuality,
+            SRCpp::Type::Sinc_MediumQuality },
+        std::pair { SRCpp::Type::Polyphase_Fastest,
+            SRCpp::Type::Sinc_Fastest },
+    };
+    for (auto [type, sinc] : tiers) {
+        for (auto factor :
+            { 48000.0 / 44100.0, 16000.0 / 48000.0, 48000.0 / 8000.0 }) {
+            for (auto channels : { 1, 2 }) {
+                auto c = Case { type, channels, factor, 4096 };
+                auto name = std::format("Polyphase/{}/ch{}/r{:.4f}",
+                    TypeName(type), channels, factor);
+                benchmark::RegisterBenchmark(
+                    name.c_str(), BenchPolyphase, c, sinc);
+            }
+        }
+    }
+}
+
+// Power-of-two factors, which the Polyphase types convert with a half-band
+// cascade, against the Sinc type of the same tier.
+void RegisterHalfBand()
+{
+    constexpr auto tiers = std::array {
+        std::pair { SRCpp::Type::Polyphase_BestQuality,
+            SRCpp::Type::Sinc_BestQuality },
+        std::pair { SRCpp::Type::Polyphase_Fastest,
+            SRCpp::Type::Sinc_Fastest },
+    };
+    for (auto [type, sinc] : tiers) {
+        for (auto factor : { 2.0, 4.0, 0.5, 0.25 }) {
+            auto c = Case { type, 2, factor, 4096 };
+            auto name = std::format(
+                "HalfBand/{}/ch2/r{:.4f}", TypeName(type), factor);
+            benchmark::RegisterBenchmark(
+                name.c_str(), BenchPolyphase, c, sinc);
+        }
+    }
+}
+
+// A FixedRatioConverter pushed in blocks against PushConverter with the same
+// Polyphase type (the raw column here).
+template <typename Converter> void BenchFixed(benchmark::State& state)
+{
+    auto c = Case { Converter::type, static_cast<int>(Converter::channels),
+        Converter::factor, 4096 };
+    auto input = MakeInput<float>(c);
+    auto output = std::vector<float>(OutputFrames(c) * c.channels);
+    auto converter = Converter {};
+
+    auto start = Clock::now();
+    for (auto _ : state) {
+        auto [result, error] = converter.convert_noalloc(
+            std::span<const float> { input }, std::span<float> { output });
+        if (error != 0) {
+            state.SkipWithError(SRCpp::StrError(error));
+            return;
+        }
+        benchmark::DoNotOptimize(result.data());
+    }
+    auto wrapped = Clock::now() - start;
+
+    auto reference = SRCpp::PushConverter(c.type, c.channels, c.factor);
+    Report(state, c, wrapped, [&] {
+        auto [result, error] = reference.convert(
+            std::span<const float> { input }, std::span<float> { output });
+        if (!result) {
+            state.SkipWithError(error.c_str());
+            return;
+        }
+        benchmark::DoNotOptimize(result->data());
+    });
+}
+
+void RegisterFixed()
+{
+    auto add = [&]<typename Converter>() {
+        auto name = std::format("Fixed/{}/ch{}/r{:.4f}",
+            TypeName(Converter::type), Converter::channels,
+            Converter::factor);
+        benchmark::RegisterBenchmark(name.c_str(), BenchFixed<Converter>);
+    };
+    add.template operator()<SRCpp::FixedRatioConverter<44100, 48000, 2,
+        SRCpp::Type::Polyphase_MediumQuality>>();
+    add.template operator()<SRCpp::FixedRatioConverter<48000, 16000, 1>>();
+    add.template operator()<SRCpp::FixedRatioConverter<8000, 48000, 1,
+        SRCpp::Type::Polyphase_Fastest>>();
+}
+
+// Streaming a raw 16-bit file through ConvertFile into a WAV file, against
+// reading it whole into a vector and calling Convert (the raw column here).
+void BenchFile(benchmark::State& state, Case c)
+{
+    auto input = MakeInput<short>(c);
+    auto directory = std::filesystem::temp_directory_path();
+    auto source = directory / "SRCppBench_in.raw";
+    auto sink = directory / "SRCppBench_out.wav";
+    {
+        std::ofstream file(source, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(input.data()),
+            static_cast<std::streamsize>(input.size() * sizeof(short)));
+    }
+    auto options = SRCpp::FileOptions {
+        .type = c.type,
+        .factor = c.factor,
+        .raw_input = SRCpp::RawLayout { c.channels, 48000.0,
+            SRCpp::FileFormat::Int16 },
+    };
+
+    auto start = Clock::now();
+    for (auto _ : state) {
+        auto [stats, error] = SRCpp::ConvertFile(source, sink, options);
+        if (!stats) {
+            state.SkipWithError(error.c_str());
+            return;
+        }
+        benchmark::DoNotOptimize(stats->output_frames);
+    }
+    auto wrapped = Clock::now() - start;
+
+    Report(state, c, wrapped, [&] {
+        std::ifstream file(source, std::ios::binary);
+        auto samples = std::vector<short>(input.size());
+        file.read(reinterpret_cast<char*>(samples.data()),
+            static_cast<std::streamsize>(samples.size() * sizeof(short)));
+        auto [result, error] = SRCpp::Convert<short>(
+            std::span<const short> { samples }, c.type, c.channels, c.factor);
+        if (!result) {
+            state.SkipWithError(error.c_str());
+            return;
+        }
+        std::ofstream out(sink, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(result->data()),
+            static_cast<std::streamsize>(result->size() * sizeof(short)));
+    });
+    std::filesystem::remove(source);
+    std::filesystem::remove(sink);
+}
+
+void RegisterFile()
+{
+    for (auto type : { SRCpp::Type::Sinc_Fastest, SRCpp::Type::Linear }) {
+        // ten seconds of stereo
+        auto c = Case { type, 2, 44100.0 / 48000.0, 480000 };
+        auto name = std::format("File/{}/ch{}/r{:.4f}", TypeName(type),
+            c.channels, c.factor);
+        benchmark::RegisterBenchmark(name.c_str(), BenchFile, c);
+    }
+}
+
+// Calls func.template operator()<To, From>() for every supported pair.
+template <typename Func> void ForEachPair(Func&& func)
+{
+    auto for_from = [&]<typename To>() {
+        func.template operator()<To, short>();
+        func.template operator()<To, int>();
+        func.template operator()<To, float>();
+    };
+    for_from.template operator()<short>();
+    for_from.template operator()<int>();
+    for_from.template operator()<float>();
+}
+
+void RegisterAll()
+{
+    ForEachPair([]<typename To, typename From>() {
+        for (auto type : kTypes) {
+            for (auto channels : kChannels) {
+                for (auto factor : kFactors) {
+                    for (auto frames : kBlockFrames) {
+                        auto c = Case { type, channels, factor, frames };
+                        auto suffix = std::format("{}/{}<-{}/ch{}/r{:.4f}/b{}",
+                            TypeName(type), SampleName<To>(),
+                            SampleName<From>(), channels, factor, frames);
+                        benchmark::RegisterBenchmark(
+                            ("Convert/" + suffix).c_str(),
+                            BenchConvert<To, From>, c);
+                        benchmark::RegisterBenchmark(
+                            ("Push/" + suffix).c_str(), BenchPush<To, From>,
+                            c);
+                        benchmark::RegisterBenchmark(
+                            ("Pull/" + suffix).c_str(), BenchPull<To, From>,
+                            c);
+                    }
+                }
+            }
+        }
+    });
+}
+
+}
+
+auto main(int argc, char** argv) -> int
+{
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    RegisterAll();
+    RegisterFormats();
+    RegisterPlanar();
+    RegisterParallel();
+    RegisterStreamPool();
+    RegisterConverterPool();
+    RegisterPolyphase();
+    RegisterFixed();
+    RegisterHalfBand();
+    RegisterFile();
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -23,14 +23,26 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <cmath>
 #include <format>
 #include <functional>
+#include <iterator>
+#include <limits>
+#include <map>
 #include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <numbers>
+#include <numeric>
 #include <optional>
 #include <samplerate.h>
 #include <span>
 #include <string>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -41,6 +53,35 @@ SOFTWARE.
 #define SRCPP_USE_CPP23 0
 #endif
 
+#if SRCPP_USE_CPP23 && __has_include(<generator>)
+#include <generator>
+#include <ranges>
+#endif
+#if defined(__cpp_lib_generator)
+#define SRCPP_USE_GENERATOR 1
+#else
+#define SRCPP_USE_GENERATOR 0
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)                \
+    || defined(_M_IX86)
+#define SRCPP_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#else
+#define SRCPP_X86 0
+#endif
+
+// MSVC allows any instruction set's intrinsics without annotating the
+// function; gcc and clang need to be told which one a kernel is built for.
+#if defined(_MSC_VER) && !defined(__clang__)
+#define SRCPP_TARGET(isa)
+#else
+#define SRCPP_TARGET(isa) __attribute__((target(isa)))
+#endif
+
 /*
 # SRCpp.hpp
 
@@ -89,7 +130,10 @@ enum struct Type : int {
     Sinc_MediumQuality = SRC_SINC_MEDIUM_QUALITY,
     Sinc_Fastest = SRC_SINC_FASTEST,
     ZeroOrderHold = SRC_ZERO_ORDER_HOLD,
-    Linear = SRC_LINEAR
+    Linear = SRC_LINEAR,
+    Polyphase_BestQuality = 16,
+    Polyphase_MediumQuality,
+    Polyphase_Fastest,
 };
 ```
 
@@ -101,6 +145,9 @@ Enumerates the available sample rate conversion algorithms:
 - `Sinc_Fastest`: Fastest sinc interpolation (`SRC_SINC_FASTEST`)
 - `ZeroOrderHold`: Zero-order hold interpolation (`SRC_ZERO_ORDER_HOLD`)
 - `Linear`: Linear interpolation (`SRC_LINEAR`)
+- `Polyphase_BestQuality`, `Polyphase_MediumQuality`, `Polyphase_Fastest`:
+SRCpp's polyphase FIR engine for fixed rational factors, at the quality of the
+matching `Sinc_*` type (see Polyphase types below)
 
 ### `enum struct Type`
 
@@ -110,6 +157,19 @@ enum struct Format : uint8_t { Short, Int, Float };
 
 Enumerates the available unsafe conversions of short, int, and floats.
 
+### `enum struct SimdLevel`
+
+```cpp
+enum struct SimdLevel : uint8_t { Scalar, SSE2, AVX2, AVX512 };
+
+auto DetectSimdLevel() -> SimdLevel;
+```
+
+Instruction sets the sample format conversions are built for.
+`DetectSimdLevel()` reports the best one this CPU supports, which is what every
+conversion between `short`, `int` and `float` uses.  Targets other than x86
+always use `Scalar`.
+
 ---
 
 ## Functions
@@ -136,6 +196,9 @@ auto Convert(std::span<const From> input, std::span<To> output,
     - `factor`: Sample rate conversion factor
 - **Returns:** Pair of optional span of output samples written if no error, and
 error string if error occurred.
+- **Notes:** When `To` or `From` is not `float`, the conversion streams through a
+fixed-size internal block instead of converting the whole buffer up front, so
+the extra memory used does not grow with the input.
 
 ### `Convert` (with allocation)
 
@@ -159,6 +222,33 @@ auto Convert(std::span<const From> input, SRCpp::Type type, int channels,
 - **Returns:** Pair of optional vector of output samples if no error, and error
 string if error occurred.
 
+### `ConvertFormat`
+
+Converts samples between `short`, `int` and `float` without changing the sample
+rate.
+
+```cpp
+template <SupportedSampleType To, SupportedSampleType From>
+auto ConvertFormat(std::span<const From> input, std::span<To> output)
+    -> std::pair<std::optional<std::span<To>>, std::string>;
+
+template <SupportedSampleType To, SupportedSampleType From>
+auto ConvertFormat(std::span<const From> input)
+    -> std::pair<std::optional<std::vector<To>>, std::string>;
+```
+
+- **Template Parameters:**
+    - `To`: The Type to convert to.  Must be supplied when allocating.
+    - `From`: The Type to convert from.  Usually deduced implicitly.
+- **Parameters:**
+    - `input`: Input samples
+    - `output`: Output buffer, at least as large as `input`
+- **Returns:** Pair of optional span (or vector) of output samples if no error,
+and error string if error occurred.
+- **Notes:** Results match libsamplerate's `src_*_array` functions bit for bit,
+including clipping, except that NaN becomes 0.  `short` to `int` and back goes
+through `float`, as the rate conversions do.
+
 ---
 
 ## Classes
@@ -180,6 +270,14 @@ public:
     auto convert(std::span<const From> input)
         -> std::pair<std::optional<std::vector<To>>, std::string>;
 
+    template <SupportedSampleType To>
+    auto convert(std::vector<float>&& input, std::span<To> output)
+        -> std::pair<std::optional<std::span<To>>, std::string>;
+
+    template <SupportedSampleType To>
+    auto convert(std::vector<float>&& input)
+        -> std::pair<std::optional<std::vector<To>>, std::string>;
+
     template <SupportedSampleType To>
     auto flush() -> std::pair<std::optional<std::vector<To>>, std::string>;
 };
@@ -190,7 +288,8 @@ input to be provided in chunks and output to be retrieved as available.
 
 - **Constructor:** `PushConverter(Type type, int channels, double factor)`
     - Constructs a new push converter with the specified algorithm, channel
-count, and conversion factor.
+count, and conversion factor.  Its buffers come from an optional
+`std::pmr::memory_resource` (see Memory resources).
 
 - **Methods:**
     - `convert(input, output)`: Converts a chunk of input samples, writing to
@@ -199,12 +298,27 @@ written and error string.  `To` and `From` are often deduced automatically.
     - `convert(input)`: Converts a chunk of input samples, allocating the output
 buffer. Returns pair of optional vector of output samples and error string. `To`
 must be supplied.
+    - `convert(std::move(input), ...)`: As above, but takes ownership of a
+`std::vector<float>`.  Input libsamplerate could not consume yet stays in that
+vector rather than being copied.
     - `flush()`: Flushes any remaining samples from the converter.
         Returns pair of optional vector of output samples and error string. `To`
 must be supplied.
+    - `reset()`, `reset(factor)`: Discards staged input and converter
+history so the next call starts a new stream, optionally with a new factor.
+Buffer capacity is kept.  Returns `0` or an error code (see `StrError`).
+    - `latency_frames()`, `max_output_frames(n)`,
+`expected_output_frames(n)`: What the stream holds back and how much output to
+make room for.  See [Output size and latency](#output-size-and-latency).
+`PullConverter` has the same methods.
+    - `set_ratio(factor, mode)`, `ratio()`: Changes the factor mid-stream
+without losing filter history.  See [Changing the factor](#changing-the-factor).
+`PullConverter` has the same methods.
 
 - **Notes:** Copy and move constructors/assignment are supported. Copying clones
-the internal state.
+the internal state.  `float` input is handed to libsamplerate without a copy
+whenever nothing is left staged from an earlier call; only the unconsumed tail
+is staged.
 
 ---
 
@@ -247,141 +361,202 @@ string.
 
 ---
 
-## Unsafe
+## Output size and latency
 
-Each form of conversion supports an "unsafe" type.  This is where the caller
-supplies untyped memory location and a `Format` enum of the appropriate "from"
-and "to" type.  This is to allow usage of conversion at run time where the
-underlying type is not known.  The APIs are intentionally labeled as unsafe to
-give caution to the caller that these be used sparingly and with extra scrutiny.
+Each API can say how much output to expect, and how much room to give it, so
+a stream can allocate once up front.
+
+```cpp
+auto ExpectedOutputFrames(size_t input_frames, double factor) noexcept
+    -> size_t;
+auto MaxOutputFrames(size_t input_frames, double factor) noexcept -> size_t;
+auto LatencyFrames(SRCpp::Type type, double factor) -> size_t;
+
+auto PushConverter::max_output_frames(size_t input_frames) const noexcept
+    -> size_t;
+auto PushConverter::expected_output_frames(size_t total_input_frames) const
+    noexcept -> size_t;
+auto PushConverter::latency_frames() const noexcept -> size_t;
+// and the same three on PullConverter
+```
+
+- `ExpectedOutputFrames(n, factor)` is `ceil(n * factor)`, what converting `n`
+frames produces.  For the `Polyphase_*` types it is exact; libsamplerate can
+produce a frame more or less.  `expected_output_frames(n)` is the same for a
+whole stream of `n` frames, flush included, at the converter's factor.
+- `MaxOutputFrames(n, factor)` is the room `Convert` needs, and what its
+allocating overloads allocate: one frame over the expected count.
+- `PushConverter::max_output_frames(n)` is the room the next `convert` of `n`
+frames needs.  It counts input still staged from earlier calls and output the
+filter is holding back, so a buffer that size takes everything the call can
+produce.  `max_output_frames(0)` is the room for the flush.  It never
+allocates, so real-time callers can size each block with it.
+- `PullConverter::max_output_frames(n)` is the output `n` more frames from the
+callback can complete, with what the filter was already holding back.
+- `latency_frames()` is how many output frames a stream holds back until later
+input, or the flush, completes them.  `LatencyFrames(type, factor)` is the same
+for a converter not yet created.  For the libsamplerate types it is worked out
+from the lengths of their filters and can be a frame out; the native engines
+know theirs exactly.
+- Output from every type is aligned with the input: each engine compensates for
+its filter's delay, so output frame `k` is at time `k / factor` in the input
+and there is no leading delay to trim.  `latency_frames()` is how far a stream
+runs behind what has been pushed, for A/V sync, not an offset into its output.
 
 ---
 
-## Details
+## Appending output
 
-- All functions and classes are exception-safe. Errors are reported via return
-values or exceptions (for construction failures).
-- All functions that return `std::pair<std::optional<T>, std::string>` have an
-equivalent `std::expected<T, std::string>` to allow C++23 style error handling.
-- Input and output buffers are assumed to be interleaved per channel.
-- The library attempts to handle deduction of containers to `std::span` and the
-appropriate type when possible.
-- The sample rate conversion factor is defined as `output_sample_rate /
-input_sample_rate`.
-- The implementation includes a workaround for libsamplerate issue #208 for
-linear interpolation.
-- Lifetime of the Callback Input and output buffers are assumed to be
-interleaved per channel.
+`Convert`, `PushConverter` and `PullConverter` can append to storage the caller
+keeps, instead of filling a sized span or returning a new vector.
+
+```cpp
+template <SupportedSampleType To, SupportedSampleType From>
+auto ConvertInto(std::span<const From> input, std::vector<To>& output,
+    SRCpp::Type type, int channels, double factor)
+    -> std::pair<std::optional<std::span<To>>, std::string>;
+template <SupportedSampleType To, SupportedSampleType From,
+    std::output_iterator<const To&> OutputIt>
+auto ConvertInto(std::span<const From> input, OutputIt output,
+    SRCpp::Type type, int channels, double factor)
+    -> std::pair<std::optional<OutputIt>, std::string>;
+
+auto PushConverter::convert_into(input, std::vector<To>& output);
+auto PushConverter::flush_into(std::vector<To>& output);
+auto PushConverter::convert_into<To>(input, OutputIt output);
+auto PushConverter::flush_into<To>(OutputIt output);
+auto PullConverter::convert_into(size_t frames, std::vector<To>& output);
+auto PullConverter::convert_into<To>(size_t frames, OutputIt output);
+```
+
+- The vector forms append after whatever `output` already holds and return the
+span of samples appended.  Samples are written once, as they are converted;
+`output` is never resized and value-initialized first.  It grows
+geometrically, so a stream that clears the same vector between blocks stops
+allocating once it has reached its largest block.
+- The iterator forms write through any output iterator, such as a
+`std::back_inserter`, and return it advanced past the last sample.
+- On error the vector forms leave it as it was; an iterator may already have
+been written through.
+- Output matches `Convert`, `convert` and `flush` for the same input.
+`PullConverter::convert_into(frames, …)` appends up to `frames` frames.
 
 ---
 
-## See Also
+## Memory resources
 
-- [libsamplerate documentation](http://www.mega-nerd.com/SRC/)
-- `std::span`, `std::vector`, `std::expected` (C++23)
-*/
-namespace SRCpp {
+`PushConverter`, `PullConverter` and `ConvertInto` take an optional
+`std::pmr::memory_resource*` for the buffers they allocate, so a converter can
+live in a per-session arena, a `std::pmr::monotonic_buffer_resource` or a
+pool backed by huge pages.
 
-enum struct Type : uint8_t {
-    Sinc_BestQuality = SRC_SINC_BEST_QUALITY,
-    Sinc_MediumQuality = SRC_SINC_MEDIUM_QUALITY,
-    Sinc_Fastest = SRC_SINC_FASTEST,
-    ZeroOrderHold = SRC_ZERO_ORDER_HOLD,
-    Linear = SRC_LINEAR
-};
+```cpp
+PushConverter(SRCpp::Type type, int channels, double factor,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+static auto PushConverter::create(SRCpp::Type type, int channels,
+    double factor, std::pmr::memory_resource* resource
+    = std::pmr::get_default_resource()) noexcept
+    -> std::pair<std::optional<PushConverter>, int>;
+PullConverter(Callback&& callback, SRCpp::Type type, int channels,
+    double factor,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+auto ConvertInto(input, output, SRCpp::Type type, int channels, double factor,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+```
 
-enum struct Format : uint8_t { Short, Int, Float };
+- Staging, scratch and history buffers all come from `resource`, aligned to 64
+bytes.  The resource must outlive the converter.  A copy of a `PushConverter`
+allocates from the same resource, and a move takes the buffers with it.
+- `Convert` takes its blocks from `std::pmr::get_default_resource()`.
+- The vector forms of `convert_into`, `flush_into` and `ConvertInto` take a
+`std::vector` with any allocator, so output can go into a `std::pmr::vector`
+on the same resource.
+- The converter state that libsamplerate allocates, and the filter tables the
+`Polyphase_*` types share between converters, stay on the global heap.
+- A resource is not thread-safe in general, so the threaded converters do not
+take one.
 
-// Concept to restrict types to short, int, or float
-template <typename T>
-concept SupportedSampleType = std::is_same_v<T, short> || std::is_same_v<T, int>
-    || std::is_same_v<T, float>;
+---
 
-template <SupportedSampleType T> constexpr auto SampleTypeToFormat() -> Format
-{
-    if constexpr (std::is_same_v<T, short>) {
-        return Format::Short;
-    } else if constexpr (std::is_same_v<T, int>) {
-        return Format::Int;
-    } else {
-        return Format::Float;
-    }
-}
+## Unsafe
 
-constexpr auto SizeOfFormat(Format format) -> size_t
-{
-    switch (format) {
-    case Format::Short:
-        return sizeof(short);
-    case Format::Int:
-        return sizeof(int);
-    case Format::Float:
-        return sizeof(float);
-    }
-    return sizeof(short);
-}
+Each form of conversion supports an "unsafe" type.  This is where the caller
+supplies untyped memory location and a `Format` enum of the appropriate "from"
+and "to" type.  This is to allow usage of conversion at run time where the
+underlying type is not known.  The APIs are intentionally labeled as unsafe to
+give caution to the caller that these be used sparingly and with extra scrutiny.
 
-#if SRCPP_USE_CPP23
-template <SupportedSampleType To, SupportedSampleType From>
-auto Convert_expected(std::span<const From> input, std::span<To> output,
-    SRCpp::Type type, int channels, double factor)
-    -> std::expected<std::span<To>, std::string>;
-template <SupportedSampleType To, SupportedSampleType From = float>
-auto Convert_expected(std::span<const From> input, SRCpp::Type type,
-    int channels, double factor) -> std::expected<std::vector<To>, std::string>;
+---
 
-auto Convert_unsafe_expected(Format from, const void* input, size_t input_size,
-    Format to, void* output, size_t output_size, SRCpp::Type type, int channels,
-    double factor) -> std::expected<size_t, std::string>;
-auto Convert_unsafe_expected(Format from, const void* input, size_t input_size,
-    Format to, SRCpp::Type type, int channels, double factor)
-    -> std::expected<std::vector<std::byte>, std::string>;
-#endif // SRCPP_USE_CPP23
+## Planar buffers
+
+`Convert`, `PushConverter` and `PullConverter` also take non-interleaved audio:
+one buffer per channel, described by a `PlanarSpan`.
+
+```cpp
+template <typename T> class PlanarSpan {
+public:
+    PlanarSpan(std::span<T* const> channels, size_t frames, size_t offset = 0);
+
+    auto channels() const -> size_t;
+    auto frames() const -> size_t;
+    auto channel(size_t index) const -> std::span<T>;
+    auto first(size_t frames) const -> PlanarSpan;
+    auto subspan(size_t offset, size_t frames = std::dynamic_extent) const
+        -> PlanarSpan;
+};
 
 template <SupportedSampleType To, SupportedSampleType From>
-auto Convert(std::span<const From> input, std::span<To> output,
-    SRCpp::Type type, int channels, double factor)
-    -> std::pair<std::optional<std::span<To>>, std::string>;
+auto Convert(PlanarSpan<const From> input, PlanarSpan<To> output,
+    SRCpp::Type type, double factor)
+    -> std::pair<std::optional<PlanarSpan<To>>, std::string>;
+
 template <SupportedSampleType To, SupportedSampleType From>
-auto Convert(std::span<const From> input, SRCpp::Type type, int channels,
-    double factor) -> std::pair<std::optional<std::vector<To>>, std::string>;
+auto Convert(PlanarSpan<const From> input, SRCpp::Type type, double factor)
+    -> std::pair<std::optional<std::vector<std::vector<To>>>, std::string>;
 
-auto Convert_unsafe(Format from, const void* input, size_t input_size,
-    Format to, void* output, size_t output_size, SRCpp::Type type, int channels,
-    double factor) -> std::pair<std::optional<size_t>, std::string>;
-auto Convert_unsafe(Format from, const void* input, size_t input_size,
-    Format to, SRCpp::Type type, int channels, double factor)
-    -> std::pair<std::optional<std::vector<std::byte>>, std::string>;
+template <SupportedSampleType To, SupportedSampleType From>
+auto PushConverter::convert(PlanarSpan<const From> input,
+    PlanarSpan<To> output)
+    -> std::pair<std::optional<PlanarSpan<To>>, std::string>;
 
-class PushConverter {
-public:
-    PushConverter(SRCpp::Type type, int channels, double factor);
-    ~PushConverter();
-    PushConverter(const PushConverter& other);
-    auto operator=(const PushConverter& other) -> PushConverter&;
-    PushConverter(PushConverter&& other) noexcept;
-    auto operator=(PushConverter&& other) noexcept -> PushConverter&;
+template <SupportedSampleType To>
+auto PushConverter::flush(PlanarSpan<To> output)
+    -> std::pair<std::optional<PlanarSpan<To>>, std::string>;
 
-#if SRCPP_USE_CPP23
-    template <SupportedSampleType To, SupportedSampleType From>
-    auto convert_expected(std::span<const From> input, std::span<To> output)
-        -> std::expected<std::span<To>, std::string>;
+template <SupportedSampleType To>
+auto PullConverter::convert(PlanarSpan<To> output)
+    -> std::pair<std::optional<PlanarSpan<To>>, std::string>;
+```
 
-    template <SupportedSampleType To, SupportedSampleType From>
-    auto convert_expected(std::span<const From> input)
-        -> std::expected<std::vector<To>, std::string>;
+- A `PlanarSpan` only refers to the caller's array of channel pointers, which
+must outlive it.  `first()` and `subspan()` narrow the frames without touching
+that array.
+- Every buffer must have the converter's channel count; otherwise the call
+fails with `ErrorChannelMismatch`.  `Convert` takes the channel count from
+`input`.
+- `PushConverter` also has `convert_noalloc` and `flush_noalloc` overloads for
+`PlanarSpan`, and a `PullConverter` callback may return a `PlanarSpan<T>`
+instead of a `std::span<T>`.
+- Interleaving and `short`/`int`/`float` conversion are done together, a
+cache-sized chunk at a time, as input is staged and as output is written.
+There is no separate pass over the caller's buffers.
 
-    template <SupportedSampleType To>
-    auto flush_expected() -> std::expected<std::vector<To>, std::string>;
+---
 
-    auto convert_unsafe_expected(Format from, const void* input,
-        size_t input_size, Format to, void* output, size_t output_size)
-        -> std::expected<size_t, std::string>;
+## Parallel conversion
 
-    auto convert_unsafe_expected(
-        Format from, const void* input, size_t input_size, Format to)
-        -> std::expected<std::vector<std::byte>, std::string>;
-#endif // SRCPP_USE_CPP23
+`#include <SRCpp/SRCppParallel.hpp>` for `ParallelPushConverter`, which splits
+a wide interleaved stream into channel groups and converts them on a small
+pool of threads.
+
+```cpp
+class ParallelPushConverter {
+public:
+    ParallelPushConverter(
+        SRCpp::Type type, int channels, double factor, size_t threads = 0);
+
+    auto groups() const -> size_t;
 
     template <SupportedSampleType To, SupportedSampleType From>
     auto convert(std::span<const From> input, std::span<To> output)
@@ -393,95 +568,3842 @@ public:
 
     template <SupportedSampleType To>
     auto flush() -> std::pair<std::optional<std::vector<To>>, std::string>;
+};
+```
 
-    auto convert_unsafe(Format from, const void* input, size_t input_size,
-        Format to, void* output, size_t output_size)
-        -> std::pair<std::optional<size_t>, std::string>;
-
-    auto convert_unsafe(
-        Format from, const void* input, size_t input_size, Format to)
-        -> std::pair<std::optional<std::vector<std::byte>>, std::string>;
+- `threads` of 0 uses one per hardware thread.  The channels are divided into
+`min(threads, channels)` groups of near-equal size, each with its own
+`SRC_STATE`; `groups()` reports how many.
+- libsamplerate converts every channel independently, so the output is
+identical to a `PushConverter` given the same calls.
+- The calling thread converts the first group itself.  The other threads spin
+briefly before sleeping, so back-to-back small blocks do not pay for a wake-up
+each call.
+- With a single group every call goes straight to a `PushConverter`.
+- The container and `_expected` forms of `PushConverter` are also provided.
+The library now links `Threads::Threads`.
+
+The same header adds a `Convert` for long buffers that splits the input in
+time and converts the pieces concurrently.
 
-#if SRCPP_USE_CPP23
-    template <typename ToContainer, typename FromContainer,
-        SupportedSampleType To = typename ToContainer::value_type,
-        SupportedSampleType From = typename FromContainer::value_type>
-    auto convert_expected(FromContainer const& input, ToContainer& output)
-    {
-        return convert_expected<To, From>(
-            std::span<const From> { input }, std::span<To> { output });
-    }
+```cpp
+template <SupportedSampleType To, SupportedSampleType From>
+auto Convert(std::span<const From> input, std::span<To> output,
+    SRCpp::Type type, int channels, double factor, size_t threads)
+    -> std::pair<std::optional<std::span<To>>, std::string>;
 
-    template <SupportedSampleType To, typename FromContainer,
-        SupportedSampleType From = typename FromContainer::value_type>
-    auto convert_expected(FromContainer const& input)
-    {
-        return convert_expected<To, From>(std::span<const From> { input });
-    }
-#endif // SRCPP_USE_CPP23
+template <SupportedSampleType To, SupportedSampleType From>
+auto Convert(std::span<const From> input, SRCpp::Type type, int channels,
+    double factor, size_t threads)
+    -> std::pair<std::optional<std::vector<To>>, std::string>;
+```
 
-    template <typename ToContainer, typename FromContainer,
-        SupportedSampleType To = typename ToContainer::value_type,
-        SupportedSampleType From = typename FromContainer::value_type>
-    auto convert(FromContainer const& input, ToContainer& output)
-    {
-        return convert(
-            std::span<const From> { input }, std::span<To> { output });
-    }
+- The input is cut into up to `threads` segments (0 uses one per hardware
+thread).  Each segment is converted with enough input either side to cover the
+filter, and the output from that overlap is dropped.
+- Segments start where `factor` maps input frames onto whole output frames, so
+`factor` must be a ratio of whole numbers such as `44100.0 / 48000.0`.  Other
+factors, and buffers under about 16k frames per segment, are converted on the
+calling thread exactly as `Convert` would.
+- `Linear` and `ZeroOrderHold` output is bit-exact with `Convert` when
+`1 / factor` is exact in binary (2, 0.5, 0.25, ...).  Otherwise each segment
+restarts the filter phase without the rounding the serial conversion has
+accumulated.  Results then agree to within about 1e-5 of full scale, and
+`ZeroOrderHold` may pick the neighbouring input frame at a segment's first
+output.
+- The output is the same length as `Convert`'s, and is cut short the same way
+when `output` is too small.
 
-    template <SupportedSampleType To, typename FromContainer,
-        SupportedSampleType From = typename FromContainer::value_type>
-    auto convert(FromContainer const& input)
-    {
-        return convert<To, From>(std::span<const From> { input });
-    }
+---
 
-private:
-    SRC_STATE* state_ { nullptr };
-    SRCpp::Type type_ { SRC_SINC_BEST_QUALITY };
-    int channels_ { 0 };
-    double factor_ { 1.0 };
-    const float dummy_ {};
-    std::vector<float> reserved_input_;
-    std::vector<float> last_input_;
-    std::vector<float> scratch_output_;
-    size_t input_frames_consumed_ { 0 };
-    size_t output_frames_produced_ { 0 };
+## Stream pool
 
-    auto convert(
-        std::span<const float> input, std::span<float> output, bool end)
-        -> std::pair<
-            std::optional<std::pair<std::span<const float>, std::span<float>>>,
-            std::string>;
-    auto convertWithFixFor208(
-        std::span<const float> input, std::span<float> output, bool end)
-        -> std::pair<
-            std::optional<std::pair<std::span<const float>, std::span<float>>>,
-            std::string>;
-    auto framesToReserve(size_t frames) const -> size_t;
-};
+`#include <SRCpp/SRCppStreamPool.hpp>` for `StreamPool`, which converts many
+independent push streams on a shared set of worker threads.
 
-class PullConverter {
+```cpp
+class StreamPool {
 public:
-    // using callback_t = std::function<std::span<From>()>;
-    template <typename Callback>
-    PullConverter(
-        Callback&& callback, SRCpp::Type type, int channels, double factor);
-    ~PullConverter();
+    using StreamId = uint64_t;
+    using Callback = std::function<void(std::span<const float> output)>;
+
+    explicit StreamPool(size_t threads = 0);
+
+    auto open(StreamId id, SRCpp::Type type, int channels, double factor,
+        Callback callback) -> std::pair<std::optional<StreamId>, std::string>;
 
     template <SupportedSampleType From>
-    PullConverter(std::span<From> (*func)(void*), void* context,
-        SRCpp::Type type, int channels, double factor)
-        : PullConverter(
-            [func, context]() { return func(context); }, type, channels, factor)
-    {
-        static_assert(SupportedSampleType<From>,
-            "Function must return std::span<From> where From is short, int, or "
-            "float");
-    }
+    auto push(StreamId id, std::span<const From> input)
+        -> std::pair<std::optional<size_t>, std::string>;
 
-    PullConverter(PullConverter&& other) noexcept;
-    auto operator=(PullConverter&& other) noexcept -> PullConverter&;
+    auto close(StreamId id) -> std::pair<std::optional<StreamId>, std::string>;
+    void wait();
+
+    auto stream_stats(StreamId id) const -> std::optional<StreamStats>;
+    auto stats() const -> StreamPoolStats;
+};
+```
+
+- `push` may be called from any thread.  It copies the block, converted to
+`float`, onto the stream's queue and returns the queue depth in blocks.
+- Each stream's blocks are converted in the order they were pushed, by one
+worker at a time, and the output goes to the stream's callback on that worker.
+A callback may push to its own or any other stream.
+- Every worker has its own run queue of streams with work waiting.  An idle
+worker steals from the others.  A worker converts at most a few blocks of one
+stream before moving it to the back of its queue, so a busy stream cannot
+starve the rest.
+- `close` flushes the stream after its queued blocks and passes the tail to the
+callback.  The stream is then forgotten and its id may be opened again.
+- `stream_stats` reports a stream's queue depth, the frames in and out, and
+the last error from conversion or from its callback.  `stats` reports totals
+for the pool and the time since it was created.
+- `wait` returns once all work pushed so far is done.  The destructor waits
+too.
+
+---
+
+## Converter pool
+
+`#include <SRCpp/SRCppConverterPool.hpp>` for `ConverterPool`, which recycles
+`PushConverter`s so setting up a stream does not cost a `src_new` and fresh
+buffers each time.
+
+```cpp
+class ConverterPool {
+public:
+    class Lease {
+    public:
+        auto operator*() -> PushConverter&;
+        auto operator->() -> PushConverter*;
+        auto release() && -> PushConverter;
+    };
+
+    explicit ConverterPool(size_t max_idle = 16);
+
+    auto acquire(SRCpp::Type type, int channels, double factor) noexcept
+        -> std::pair<std::optional<Lease>, int>;
+    auto reserve(SRCpp::Type type, int channels, size_t count) noexcept -> int;
+
+    auto idle(SRCpp::Type type, int channels) const -> size_t;
+    auto idle() const -> size_t;
+};
+```
+
+- Idle converters are kept per `(Type, channels)`, at most `max_idle` of each.
+`acquire` takes one and calls `reset(factor)` on it, or creates a new one when
+none is idle.  Errors are returned as codes, as `PushConverter::create` does.
+- A `Lease` returns its converter to the pool when destroyed, with whatever
+buffer capacity it grew.  `release()` keeps the converter instead.  A lease
+must not outlive its pool.
+- `reserve` creates idle converters ahead of a burst of setups.
+- The pool is safe to use from several threads.  Each lease is used by one
+thread at a time.
+- `PullConverter` is not pooled.  Its callback is bound when it is
+constructed, and the callback's type is part of the state it allocates.
+
+---
+
+## Polyphase types
+
+The `Polyphase_*` types convert with SRCpp's own polyphase FIR engine instead of
+libsamplerate.  They are meant for the fixed rational factors most audio uses,
+such as 44100 to 48000 (160 / 147), 48000 to 16000 (1 / 3) or 8000 to 48000
+(6 / 1).  They work everywhere a `Type` is taken: `Convert`, `PushConverter`,
+`PullConverter` and the converters built on them.
+
+- The factor must be `up / down` with `up` at most 1024, to within 1e-12.
+Other factors fail with `ErrorNotRational` (`std::runtime_error` from the
+constructors).
+- Each tier's passband matches the `Sinc_*` type of the same name (97%, 90% and
+80% of the lower Nyquist frequency), with at least 100 dB of stopband
+attenuation.
+- The filter is a Kaiser windowed sinc split into `up` phases.  Each output
+sample is one inner product between a phase and the input, computed with the
+best `SimdLevel` the CPU supports.  Coefficients are designed once per
+`(type, up, down)` and shared.
+- Output is aligned with the input, with no added delay, and the frame count is
+`ceil(input_frames * up / down)`.
+- `PushConverter::reset(factor)` with a new factor designs or looks up
+another filter, which allocates.
+
+---
+
+## Fixed-ratio converter
+
+When the rates and channel count are known at compile time,
+`FixedRatioConverter` converts with a `Polyphase_*` type whose filter is
+designed by `constexpr` code into a read-only table.
+
+```cpp
+template <size_t InRate, size_t OutRate, size_t Channels,
+    SRCpp::Type Quality = SRCpp::Type::Polyphase_BestQuality>
+class FixedRatioConverter {
+public:
+    static constexpr SRCpp::Type type = Quality;
+    static constexpr size_t channels = Channels;
+    static constexpr double factor = double(OutRate) / InRate;
+
+    auto output_frames(size_t input_frames) const noexcept -> size_t;
+    void reset() noexcept;
+
+    template <SupportedSampleType To, SupportedSampleType From>
+    auto convert_noalloc(std::span<const From> input,
+        std::span<To> output) noexcept -> std::pair<std::span<To>, int>;
+    template <SupportedSampleType To>
+    auto flush_noalloc(std::span<To> output) noexcept
+        -> std::pair<std::span<To>, int>;
+
+    template <SupportedSampleType To, SupportedSampleType From>
+    auto convert(std::span<const From> input, std::span<To> output)
+        -> std::pair<std::optional<std::span<To>>, std::string>;
+    template <SupportedSampleType To, SupportedSampleType From>
+    auto convert(std::span<const From> input)
+        -> std::pair<std::optional<std::vector<To>>, std::string>;
+    template <SupportedSampleType To>
+    auto flush() -> std::pair<std::optional<std::vector<To>>, std::string>;
+    // and the container overloads PushConverter has
+};
+```
+
+- Output is identical to `PushConverter` with the same type, channel count and
+factor.
+- Nothing is set up at runtime and nothing is allocated, apart from the vectors
+the allocating overloads return.  The converter's state is its own members, so
+it is trivially copyable.  Its size grows with the filter and the channel
+count.
+- Unsupported rates, channel counts and types fail to compile.
+- Each call converts all of its input.  `output_frames(n)` is exactly what
+converting `n` more frames produces, and `output_frames(0)` is what the flush
+produces.  An output span smaller than that fails with `ErrorOutputTooSmall`.
+- The tables are designed while compiling.  The larger ones, such as
+`Polyphase_BestQuality` from 44100 to 48000, take several seconds each.
+
+---
+
+## Half-band cascade
+
+At factors of 2, 4 and 8 and their inverses, the `Polyphase_*` types convert
+with a cascade of half-band FIR stages instead of a polyphase filter.  Each
+stage doubles or halves the rate, so 48000 to 192000 runs two stages.  This is
+chosen from the factor alone; the `Sinc_*` types always use libsamplerate.
+
+- Every other tap of a half-band filter is zero, and the centre tap needs no
+multiply, so each output costs about half the inner product of a polyphase
+filter of the same quality.  Later interpolation stages, and earlier decimation
+stages, only have to keep the images of the one before them out of the final
+band, so their filters are shorter.
+- The tiers keep the `Polyphase_*` passbands and at least 100 dB of stopband
+attenuation.  The frame count is `ceil(input_frames * factor)`, and output is
+aligned with the input as for the other factors.
+- `latency_frames()` reports the output frames a stream holds back until later
+input or the flush completes them.
+- `reset(factor)` between a power-of-two factor and any other starts a new
+stream on the other engine.
+
+---
+
+## Changing the factor
+
+`PushConverter` and `PullConverter` can change their factor mid-stream for
+varispeed or drift correction, without a new converter, a new stream or a
+discontinuity.
+
+```cpp
+enum class RatioMode { Step, Ramp };
+
+auto PushConverter::set_ratio(double factor, RatioMode mode = RatioMode::Step)
+    noexcept -> int;
+auto PushConverter::ratio() const noexcept -> double;
+
+// set_ratio(factor, mode), then convert
+template <SupportedSampleType To, SupportedSampleType From>
+auto PushConverter::convert(std::span<const From> input, std::span<To> output,
+    double factor, RatioMode mode = RatioMode::Ramp)
+    -> std::pair<std::optional<std::span<To>>, std::string>;
+// and the allocating, convert_noalloc and container forms
+
+auto PullConverter::set_ratio(double factor, RatioMode mode = RatioMode::Step)
+    noexcept -> int;
+template <SupportedSampleType To>
+auto PullConverter::convert(std::span<To> output, double factor,
+    RatioMode mode = RatioMode::Ramp)
+    -> std::pair<std::optional<std::span<To>>, std::string>;
+```
+
+- `Step` converts at the new factor from the next output frame, as
+`src_set_ratio` does.
+- `Ramp` moves linearly from the current factor to the new one across the next
+call's output buffer, as libsamplerate does when `SRC_DATA::src_ratio` changes.
+Passing a factor with every block therefore sweeps smoothly from block to block.
+- The `Polyphase_*` types always step.  A Polyphase filter for a new factor is
+designed, or looked up, on the first change to it, which allocates, unless
+`prepare()` readied it.  A change to or from a power-of-two factor starts a
+new stream, as `reset(factor)` does.
+- Factors libsamplerate does not support fail with `ErrorBadFactor`.  Factors
+the Polyphase types cannot express fail with `ErrorNotRational`.  After an error
+the converter keeps its factor.
+
+---
+
+## Adaptive resampler
+
+`#include <SRCpp/SRCppAdaptive.hpp>` for `AdaptiveResampler`, which bridges two
+independent clocks, such as a capture and a playback device that differ by tens
+of ppm.
+
+```cpp
+struct AdaptiveOptions {
+    size_t target_frames { 2048 };
+    size_t capacity_frames { 8192 };
+    double max_deviation { 1e-3 };
+    double response_frames { 480000.0 };
+};
+
+class AdaptiveResampler {
+public:
+    AdaptiveResampler(SRCpp::Type type, int channels, double factor,
+        AdaptiveOptions options = {});
+
+    template <SupportedSampleType From>
+    auto write(std::span<const From> input) noexcept -> size_t;
+    template <SupportedSampleType To>
+    auto read(std::span<To> output)
+        -> std::pair<std::optional<std::span<To>>, std::string>;
+
+    void report_latency(double frames) noexcept;
+
+    auto ratio() const noexcept -> double;
+    auto level() const noexcept -> size_t;
+    auto underruns() const noexcept -> size_t;
+    auto overruns() const noexcept -> size_t;
+};
+```
+
+- The producer thread calls `write` and the consumer thread calls `read`.  They
+meet in an `SpscRing` (`SRCppRing.hpp`), a wait-free single-producer,
+single-consumer ring.  Neither side locks.  Neither allocates, except `read`
+growing a scratch buffer for non-`float` output.
+- `read` always fills its output.  It is silent until `target_frames` are
+queued, and again after the queue runs dry, which counts as an underrun.  Input
+that does not fit in `capacity_frames` is dropped and counted as an overrun.
+- Before each read, a PI loop compares the queued input with `target_frames`.
+It moves the factor away from the nominal `factor` by at most `max_deviation`,
+ramping to it across the read.  The loop settles in about `response_frames`
+input frames.  A slower loop passes on less of the jitter that block sizes put
+into the fill level.
+- With `report_latency`, the loop follows latencies the caller measures from
+device timestamps instead of the fill level.  These have no block jitter.
+- `ratio()` and `level()` may be read from any thread for monitoring.
+`level()` counts the input the converter has taken in but not used yet.
+- The type must be able to ramp its factor, so the `Polyphase_*` types are
+rejected with `std::runtime_error`.
+
+---
+
+## Threaded converter
+
+`#include <SRCpp/SRCppThreaded.hpp>` for `ThreadedConverter`, which runs a
+converter on a worker thread so that a real-time thread can use an expensive
+type such as `Sinc_BestQuality` for the cost of a copy.
+
+```cpp
+struct ThreadedOptions {
+    size_t block_frames { 256 };
+    size_t input_frames { 8192 };
+    size_t read_ahead_frames { 8192 };
+};
+
+class ThreadedConverter {
+public:
+    ThreadedConverter(SRCpp::Type type, int channels, double factor,
+        ThreadedOptions options = {});
+    template <typename Callback>
+    ThreadedConverter(Callback&& callback, SRCpp::Type type, int channels,
+        double factor, ThreadedOptions options = {});
+
+    template <SupportedSampleType From>
+    auto write(std::span<const From> input) noexcept -> size_t;
+    void finish() noexcept;
+    template <SupportedSampleType To>
+    auto read(std::span<To> output) noexcept -> std::span<To>;
+
+    auto available() const noexcept -> size_t;
+    auto latency_frames() const noexcept -> size_t;
+    auto finished() const noexcept -> bool;
+    auto failed() const noexcept -> bool;
+    auto error() const -> std::string;
+};
+```
+
+- The first form wraps a `PushConverter`.  The caller `write`s input and
+`read`s output, and `finish` ends the stream so the worker flushes.
+- The second form wraps a `PullConverter`.  Its callback runs on the worker
+instead of inside the caller's `read`, and an empty span ends the stream.
+- Input and output pass through two `SpscRing`s, so `write`, `read` and the
+queries never block, lock or allocate.  The caller only wakes the worker with a
+futex notify when it is asleep.
+- `write` returns the frames that fit in `input_frames`.  `read` returns the
+whole frames that were ready, which may be fewer than asked for, or none.
+- The worker converts `block_frames` of input at a time and stops while
+`read_ahead_frames` of output wait to be read.  That is the exact limit, though
+the ring behind it is rounded up to a power of two.
+- `latency_frames()` is in output frames: input still queued, output ready and
+output the worker holds, including the converter's filter delay where it
+reports one.
+- Bad arguments throw `std::runtime_error`, as `PushConverter` does.  A failure
+on the worker stops it and sets `failed()`, and `error()` describes it.
+
+---
+
+## Streaming with `std::generator`
+
+With C++23 and a standard library that has `std::generator`
+(`SRCPP_USE_GENERATOR`), `resample_stream` converts a range of input chunks
+lazily.
+
+```cpp
+template <SupportedSampleType To = float, std::ranges::viewable_range Chunks>
+auto resample_stream(Chunks&& chunks, SRCpp::Type type, int channels,
+    double factor) -> std::generator<std::span<const To>>;
+```
+
+- Each element of `chunks` is a contiguous range of interleaved `short`, `int`
+or `float` samples, such as a `std::span` or a `std::vector`.  Each is only read
+when the output before it has been consumed.
+- Each chunk's output is yielded as soon as it is converted, and the converter's
+flush follows the last chunk.  Memory stays bounded by the largest chunk.
+- The yielded spans refer to one buffer, which the next block overwrites.
+- Bad arguments throw `std::runtime_error` from the call itself.  A conversion
+error throws it from the iteration that meets it.
+
+```cpp
+for (auto block : SRCpp::resample_stream(packets, SRCpp::Type::Sinc_Fastest,
+         2, 48000.0 / 44100.0)) {
+    sink.write(block);
+}
+```
+
+---
+
+## Range adaptor
+
+`#include <SRCpp/SRCppRanges.hpp>` for `views::resample`, which converts a range
+of interleaved samples lazily.
+
+```cpp
+namespace views {
+template <SupportedSampleType To = float>
+auto resample(SRCpp::Type type, int channels, double factor);
+template <SupportedSampleType To = float, std::ranges::viewable_range Range>
+auto resample(Range&& range, SRCpp::Type type, int channels, double factor);
+}
+
+auto preview = samples | SRCpp::views::resample(SRCpp::Type::Sinc_Fastest, 2,
+                             48000.0 / 44100.0)
+    | std::views::take(2 * 48000);
+```
+
+- The input is any range of `short`, `int` or `float` samples.  The result is a
+`resample_view` of `To` samples.
+- The input is pulled through a `PullConverter` in chunks of 256 frames.  The
+output is converted in blocks of 256 frames, and only when the view is
+iterated.  Taking the first seconds of a long asset only reads and converts
+about those seconds.
+- `resample_view` is a move-only input range, so it can be iterated once.  A
+partial frame at the end of the input is dropped.
+- Bad arguments throw `std::runtime_error` when the view is made.  Conversion
+errors throw it from the iteration that meets them.
+
+---
+
+## File conversion
+
+`#include <SRCpp/SRCppFile.hpp>` for `ConvertFile`, which converts files of any
+size with bounded memory.
+
+```cpp
+enum class FileFormat { Int16, Int24, Int32, Float32 };
+
+struct RawLayout {
+    int channels { 2 };
+    double sample_rate { 48000.0 };
+    FileFormat format { FileFormat::Int16 };
+};
+
+struct FileOptions {
+    SRCpp::Type type { SRCpp::Type::Sinc_MediumQuality };
+    double factor { 1.0 };
+    std::optional<double> output_rate {};
+    std::optional<FileFormat> output_format {};
+    std::optional<RawLayout> raw_input {};
+    bool raw_output { false };
+    size_t block_frames { 65536 };
+};
+
+auto ConvertFile(const std::filesystem::path& input,
+    const std::filesystem::path& output, const FileOptions& options = {})
+    -> std::pair<std::optional<FileStats>, std::string>;
+```
+
+- The input is a WAV or RF64 file, or headerless little-endian PCM described by
+`raw_input`.  Samples are 16, 24 or 32-bit integers, or 32-bit floats.
+- `output_rate`, when set, overrides `factor` using the input's sample rate.
+The output keeps the input's sample format unless `output_format` says
+otherwise.
+- The output is a WAV file.  It becomes RF64 once the audio needs more than 4
+GiB, or is headerless PCM with `raw_output`.
+- More than two channels, or integer samples of more than 16 bits, are written
+as `WAVE_FORMAT_EXTENSIBLE` with the usual channel mask up to 7.1.  Mono or
+stereo float has an 18-byte fmt chunk with an empty extension.
+- Both files are memory-mapped.  The audio streams through a `PushConverter`
+`block_frames` at a time, and the pages behind each block are released as it
+goes, so peak memory does not grow with the file.
+- The output is mapped at `MaxOutputFrames` plus the converter's
+`max_output_frames(0)` for the flush, and cut to the frames it did produce, so
+the file is exactly as long as its header says.  The flush is taken a block at
+a time until it runs dry.
+- On an error the output file is removed, rather than left half-written.
+- `FileStats` reports the frames read and written, the channels, the output
+rate and the output format.
+- It needs a system with `mmap`.  Elsewhere it returns an error.
+
+---
+
+## Batch conversion
+
+`#include <SRCpp/SRCppBatch.hpp>` for `ConvertMany`, which converts many files
+across all cores.
+
+```cpp
+struct Job {
+    std::filesystem::path input {};
+    std::filesystem::path output {};
+    FileOptions options {};
+    std::optional<FileStats> stats {};
+    std::string error {};
+};
+
+struct BatchStats {
+    size_t converted { 0 };
+    size_t failed { 0 };
+    size_t input_frames { 0 };
+    size_t output_frames { 0 };
+    double seconds { 0.0 };
+    auto frames_per_second() const -> double;
+};
+
+auto ConvertMany(std::span<Job> jobs, size_t threads = 0) -> BatchStats;
+```
+
+- Each job is a `ConvertFile`, and its output is identical.  `ConvertMany`
+fills in the job's `stats`, or its `error` if it failed.  A failed job does not
+stop the others.
+- `threads` of 0 uses one worker per hardware thread.  The calling thread is one
+of them.
+- Jobs start largest input first.  Workers take the next job as they finish one,
+so the short files at the end fill in around the long ones, and no long file is
+left to run alone at the end.
+- Each worker keeps a `ConverterPool` and its buffers from one file to the next,
+so a batch of short clips does not pay for creating a converter per clip.
+- `frames_per_second()` is the input frames of the whole batch over its
+wall-clock time.
+
+---
+
+## Real-time use
+
+`PushConverter` can be driven from an audio callback thread without touching
+the heap.
+
+```cpp
+static auto PushConverter::create(SRCpp::Type type, int channels, double factor)
+    noexcept -> std::pair<std::optional<PushConverter>, int>;
+
+void PushConverter::prepare(size_t max_input_frames, size_t max_output_frames,
+    std::span<const double> factors = {});
+
+template <SupportedSampleType To, SupportedSampleType From>
+auto PushConverter::convert_noalloc(std::span<const From> input,
+    std::span<To> output) noexcept -> std::pair<std::span<To>, int>;
+
+template <SupportedSampleType To>
+auto PushConverter::flush_noalloc(std::span<To> output) noexcept
+    -> std::pair<std::span<To>, int>;
+
+auto StrError(int error) noexcept -> const char*;
+```
+
+- `create()` constructs a converter without throwing, returning an error code
+on failure.
+- `prepare()` sizes the internal buffers for calls of up to `max_input_frames`
+in and `max_output_frames` out.  It allocates, so call it before going
+real-time.
+- A Polyphase type designs the filters for `factors` in `prepare()`, so the
+per-call factor form of `convert_noalloc()` can switch to them.  Any other
+factor, and a change to or from a power-of-two factor, is refused there with
+`ErrorExceedsPrepared`.  The libsamplerate types change factor without
+allocating.
+- `convert_noalloc()` and `flush_noalloc()` never allocate and never throw.
+They return the output written and `0`, or an error code.  Input that would
+not fit in the prepared staging is refused with `ErrorExceedsPrepared` rather
+than grown into; keep it from backing up by offering at least
+`max_output_frames` of output each call.
+- Output larger than the prepared scratch is filled a scratch at a time, so
+short and int output gets as much as float output.  A flush that fills its
+output leaves the rest of the tail for the next flush; the stream only starts
+over once a flush comes back with room to spare.
+- Error codes are libsamplerate's own (positive) or SRCpp's `ErrorCode` values
+(negative).  `StrError()` describes either without allocating.
+
+---
+
+## Details
+
+- All functions and classes are exception-safe. Errors are reported via return
+values or exceptions (for construction failures).
+- All functions that return `std::pair<std::optional<T>, std::string>` have an
+equivalent `std::expected<T, std::string>` to allow C++23 style error handling.
+- Input and output buffers are assumed to be interleaved per channel, except
+where a `PlanarSpan` is taken.
+- The library attempts to handle deduction of containers to `std::span` and the
+appropriate type when possible.
+- The sample rate conversion factor is defined as `output_sample_rate /
+input_sample_rate`.
+- The implementation includes a workaround for libsamplerate issue #208 for
+linear interpolation.
+- Lifetime of the Callback Input and output buffers are assumed to be
+interleaved per channel.
+
+---
+
+## See Also
+
+- [libsamplerate documentation](http://www.mega-nerd.com/SRC/)
+- `std::span`, `std::vector`, `std::expected` (C++23)
+*/
+namespace SRCpp {
+
+enum struct Type : uint8_t {
+    Sinc_BestQuality = SRC_SINC_BEST_QUALITY,
+    Sinc_MediumQuality = SRC_SINC_MEDIUM_QUALITY,
+    Sinc_Fastest = SRC_SINC_FASTEST,
+    ZeroOrderHold = SRC_ZERO_ORDER_HOLD,
+    Linear = SRC_LINEAR,
+    // SRCpp's own polyphase FIR engine, for fixed rational factors
+    Polyphase_BestQuality = 16,
+    Polyphase_MediumQuality,
+    Polyphase_Fastest,
+};
+
+enum struct Format : uint8_t { Short, Int, Float };
+
+// Concept to restrict types to short, int, or float
+template <typename T>
+concept SupportedSampleType = std::is_same_v<T, short> || std::is_same_v<T, int>
+    || std::is_same_v<T, float>;
+
+template <SupportedSampleType T> constexpr auto SampleTypeToFormat() -> Format
+{
+    if constexpr (std::is_same_v<T, short>) {
+        return Format::Short;
+    } else if constexpr (std::is_same_v<T, int>) {
+        return Format::Int;
+    } else {
+        return Format::Float;
+    }
+}
+
+constexpr auto SizeOfFormat(Format format) -> size_t
+{
+    switch (format) {
+    case Format::Short:
+        return sizeof(short);
+    case Format::Int:
+        return sizeof(int);
+    case Format::Float:
+        return sizeof(float);
+    }
+    return sizeof(short);
+}
+
+// Non-interleaved (planar) samples: one buffer per channel, each holding
+// frames() samples.  Only the channel pointers are referenced, so first()
+// and subspan() never allocate.
+template <typename T> class PlanarSpan {
+public:
+    using element_type = T;
+    using value_type = std::remove_cv_t<T>;
+
+    constexpr PlanarSpan() = default;
+    constexpr PlanarSpan(
+        std::span<T* const> channels, size_t frames, size_t offset = 0)
+        : channels_ { channels }
+        , frames_ { frames }
+        , offset_ { offset }
+    {
+    }
+
+    // PlanarSpan<float> converts to PlanarSpan<const float>.
+    template <typename U>
+        requires std::is_convertible_v<U (*)[], T (*)[]>
+    constexpr PlanarSpan(const PlanarSpan<U>& other)
+        : PlanarSpan(other.channels_, other.frames_, other.offset_)
+    {
+    }
+
+    constexpr auto channels() const -> size_t { return channels_.size(); }
+    constexpr auto frames() const -> size_t { return frames_; }
+    constexpr auto empty() const -> bool { return frames_ == 0; }
+
+    constexpr auto channel(size_t index) const -> std::span<T>
+    {
+        return { channels_[index] + offset_, frames_ };
+    }
+
+    constexpr auto first(size_t frames) const -> PlanarSpan
+    {
+        return { channels_, frames, offset_ };
+    }
+
+    constexpr auto subspan(
+        size_t offset, size_t frames = std::dynamic_extent) const -> PlanarSpan
+    {
+        if (frames == std::dynamic_extent) {
+            frames = frames_ - offset;
+        }
+        return { channels_, frames, offset_ + offset };
+    }
+
+private:
+    template <typename> friend class PlanarSpan;
+
+    std::span<T* const> channels_;
+    size_t frames_ { 0 };
+    size_t offset_ { 0 };
+};
+
+// Error codes reported by the real-time PushConverter calls.  Positive codes
+// come from libsamplerate; SRCpp's own are negative.
+enum ErrorCode : int {
+    ErrorNone = 0,
+    ErrorExceedsPrepared = -1,
+    ErrorOutOfMemory = -2,
+    ErrorChannelMismatch = -3,
+    ErrorBadFactor = -4,
+    ErrorNotRational = -5,
+    ErrorOutputTooSmall = -6,
+};
+
+inline auto StrError(int error) noexcept -> const char*
+{
+    switch (error) {
+    case ErrorExceedsPrepared:
+        return "Input exceeds the staging reserved by prepare().";
+    case ErrorOutOfMemory:
+        return "Out of memory.";
+    case ErrorChannelMismatch:
+        return "Planar buffer channel count does not match the converter.";
+    case ErrorBadFactor:
+        return "Conversion factor is outside what libsamplerate supports.";
+    case ErrorNotRational:
+        return "Polyphase types need a factor of up / down with up at most "
+               "1024.";
+    case ErrorOutputTooSmall:
+        return "Output is too small for the frames the input produces.";
+    default:
+        return src_strerror(error);
+    }
+}
+
+// How a converter moves to a new factor mid-stream.  Step converts at the new
+// factor from the next output frame, as src_set_ratio does.  Ramp moves
+// linearly from the current factor to the new one across the next call's
+// output buffer, as libsamplerate does when SRC_DATA's src_ratio changes.
+// The Polyphase types always step.
+enum class RatioMode { Step, Ramp };
+
+#if SRCPP_USE_CPP23
+template <SupportedSampleType To, SupportedSampleType From>
+auto Convert_expected(std::span<const From> input, std::span<To> output,
+    SRCpp::Type type, int channels, double factor)
+    -> std::expected<std::span<To>, std::string>;
+template <SupportedSampleType To, SupportedSampleType From = float>
+auto Convert_expected(std::span<const From> input, SRCpp::Type type,
+    int channels, double factor) -> std::expected<std::vector<To>, std::string>;
+
+auto Convert_unsafe_expected(Format from, const void* input, size_t input_size,
+    Format to, void* output, size_t output_size, SRCpp::Type type, int channels,
+    double factor) -> std::expected<size_t, std::string>;
+auto Convert_unsafe_expected(Format from, const void* input, size_t input_size,
+    Format to, SRCpp::Type type, int channels, double factor)
+    -> std::expected<std::vector<std::byte>, std::string>;
+
+template <SupportedSampleType To, SupportedSampleType From>
+auto Convert_expected(PlanarSpan<const From> input, PlanarSpan<To> output,
+    SRCpp::Type type, double factor)
+    -> std::expected<PlanarSpan<To>, std::string>;
+#endif // SRCPP_USE_CPP23
+
+template <SupportedSampleType To, SupportedSampleType From>
+auto Convert(std::span<const From> input, std::span<To> output,
+    SRCpp::Type type, int channels, double factor)
+    -> std::pair<std::optional<std::span<To>>, std::string>;
+template <SupportedSampleType To, SupportedSampleType From>
+auto Convert(std::span<const From> input, SRCpp::Type type, int channels,
+    double factor) -> std::pair<std::optional<std::vector<To>>, std::string>;
+
+auto Convert_unsafe(Format from, const void* input, size_t input_size,
+    Format to, void* output, size_t output_size, SRCpp::Type type, int channels,
+    double factor) -> std::pair<std::optional<size_t>, std::string>;
+auto Convert_unsafe(Format from, const void* input, size_t input_size,
+    Format to, SRCpp::Type type, int channels, double factor)
+    -> std::pair<std::optional<std::vector<std::byte>>, std::string>;
+
+// Planar input and output; the channel count comes from input.
+template <SupportedSampleType To, SupportedSampleType From>
+auto Convert(PlanarSpan<const From> input, PlanarSpan<To> output,
+    SRCpp::Type type, double factor)
+    -> std::pair<std::optional<PlanarSpan<To>>, std::string>;
+template <SupportedSampleType To, SupportedSampleType From>
+auto Convert(PlanarSpan<const From> input, SRCpp::Type type, double factor)
+    -> std::pair<std::optional<std::vector<std::vector<To>>>, std::string>;
+
+// Output frames converting input_frames at factor produces,
+// ceil(input_frames * factor), and the room Convert's output needs for them,
+// which allows libsamplerate to round one frame over.
+auto ExpectedOutputFrames(size_t input_frames, double factor) noexcept
+    -> size_t;
+auto MaxOutputFrames(size_t input_frames, double factor) noexcept -> size_t;
+
+// What a PushConverter or PullConverter of type at factor holds back (see
+// PushConverter::latency_frames).  Convert's output is complete and aligned
+// with its input, so it holds nothing back.
+auto LatencyFrames(SRCpp::Type type, double factor) -> size_t;
+
+// Appends the output to output instead of writing into a sized span, so its
+// capacity carries over from call to call and nothing is value-initialized
+// first.  Returns the samples appended; on error output is left as it was.
+// The second form writes through an output iterator and returns it advanced
+// past the last sample.  The conversion's own blocks come from resource.
+template <SupportedSampleType To, SupportedSampleType From, typename Allocator>
+auto ConvertInto(std::span<const From> input,
+    std::vector<To, Allocator>& output, SRCpp::Type type, int channels,
+    double factor,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+    -> std::pair<std::optional<std::span<To>>, std::string>;
+template <SupportedSampleType To, SupportedSampleType From,
+    std::output_iterator<const To&> OutputIt>
+auto ConvertInto(std::span<const From> input, OutputIt output,
+    SRCpp::Type type, int channels, double factor,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+    -> std::pair<std::optional<OutputIt>, std::string>;
+
+// Instruction sets the sample format kernels are built for.
+enum struct SimdLevel : uint8_t { Scalar, SSE2, AVX2, AVX512 };
+
+// The best level this CPU (and OS) supports; what the conversions use.
+auto DetectSimdLevel() -> SimdLevel;
+
+#if SRCPP_USE_CPP23
+template <SupportedSampleType To, SupportedSampleType From>
+auto ConvertFormat_expected(std::span<const From> input, std::span<To> output)
+    -> std::expected<std::span<To>, std::string>;
+template <SupportedSampleType To, SupportedSampleType From>
+auto ConvertFormat_expected(std::span<const From> input)
+    -> std::expected<std::vector<To>, std::string>;
+auto ConvertFormat_unsafe_expected(Format from, const void* input,
+    size_t input_size, Format to, void* output, size_t output_size)
+    -> std::expected<size_t, std::string>;
+auto ConvertFormat_unsafe_expected(
+    Format from, const void* input, size_t input_size, Format to)
+    -> std::expected<std::vector<std::byte>, std::string>;
+#endif // SRCPP_USE_CPP23
+
+template <SupportedSampleType To, SupportedSampleType From>
+auto ConvertFormat(std::span<const From> input, std::span<To> output)
+    -> std::pair<std::optional<std::span<To>>, std::string>;
+template <SupportedSampleType To, SupportedSampleType From>
+auto ConvertFormat(std::span<const From> input)
+    -> std::pair<std::optional<std::vector<To>>, std::string>;
+auto ConvertFormat_unsafe(Format from, const void* input, size_t input_size,
+    Format to, void* output, size_t output_size)
+    -> std::pair<std::optional<size_t>, std::string>;
+auto ConvertFormat_unsafe(
+    Format from, const void* input, size_t input_size, Format to)
+    -> std::pair<std::optional<std::vector<std::byte>>, std::string>;
+
+namespace details {
+    // Sample format kernels.  Each matches libsamplerate's src_*_array
+    // function bit for bit, including clipping, except that NaN always
+    // becomes 0 (libsamplerate leaves that to lrint).  The SIMD versions do
+    // the same arithmetic a vector at a time and finish the tail with the
+    // scalar one; both honour the current rounding mode.
+    inline void ShortToFloatScalar(const short* in, float* out, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = static_cast<float>(in[i] / (1.0 * 0x8000));
+        }
+    }
+
+    inline void IntToFloatScalar(const int* in, float* out, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = static_cast<float>(in[i] / (8.0 * 0x10000000));
+        }
+    }
+
+    inline void FloatToShortScalar(const float* in, short* out, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i) {
+            auto scaled = in[i] * 32768.f;
+            if (scaled >= 32767.f) {
+                out[i] = 32767;
+            } else if (scaled <= -32768.f) {
+                out[i] = -32768;
+            } else if (std::isnan(scaled)) {
+                out[i] = 0;
+            } else {
+                out[i] = static_cast<short>(std::lrint(scaled));
+            }
+        }
+    }
+
+    inline void FloatToIntScalar(const float* in, int* out, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i) {
+            auto scaled = in[i] * (8.0 * 0x10000000);
+            if (scaled >= (1.0 * 0x7FFFFFFF)) {
+                out[i] = 0x7fffffff;
+            } else if (scaled <= (-8.0 * 0x10000000)) {
+                out[i] = -1 - 0x7fffffff;
+            } else if (std::isnan(scaled)) {
+                out[i] = 0;
+            } else {
+                out[i] = static_cast<int>(std::lrint(scaled));
+            }
+        }
+    }
+
+    // Stereo interleaving, used by the planar conversions.
+    inline void Interleave2Scalar(
+        const float* left, const float* right, float* out, size_t frames)
+    {
+        for (size_t i = 0; i < frames; ++i) {
+            out[2 * i] = left[i];
+            out[2 * i + 1] = right[i];
+        }
+    }
+
+    inline void Deinterleave2Scalar(
+        const float* in, float* left, float* right, size_t frames)
+    {
+        for (size_t i = 0; i < frames; ++i) {
+            left[i] = in[2 * i];
+            right[i] = in[2 * i + 1];
+        }
+    }
+
+#if SRCPP_X86
+    // float * 2^31 is exact in float, and no float lies in
+    // [0x7FFFFFFF, 2^31), so comparing against 2^31 in float gives the same
+    // clipping as libsamplerate's comparison in double.
+    inline constexpr float kIntScale = 2147483648.f;
+
+    SRCPP_TARGET("sse2")
+    inline void ShortToFloatSSE2(const short* in, float* out, size_t count)
+    {
+        const auto scale = _mm_set1_ps(1.0f / 0x8000);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            auto lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+            auto hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+            _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+            _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+        }
+        ShortToFloatScalar(in + i, out + i, count - i);
+    }
+
+    SRCPP_TARGET("sse2")
+    inline void IntToFloatSSE2(const int* in, float* out, size_t count)
+    {
+        const auto scale = _mm_set1_ps(1.0f / kIntScale);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(v), scale));
+        }
+        IntToFloatScalar(in + i, out + i, count - i);
+    }
+
+    SRCPP_TARGET("sse2")
+    inline auto FloatToShortLaneSSE2(__m128 v) -> __m128i
+    {
+        auto scaled = _mm_mul_ps(v, _mm_set1_ps(32768.f));
+        scaled = _mm_and_ps(scaled, _mm_cmpord_ps(scaled, scaled));
+        scaled = _mm_min_ps(_mm_max_ps(scaled, _mm_set1_ps(-32768.f)),
+            _mm_set1_ps(32767.f));
+        return _mm_cvtps_epi32(scaled);
+    }
+
+    SRCPP_TARGET("sse2")
+    inline void FloatToShortSSE2(const float* in, short* out, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            auto lo = FloatToShortLaneSSE2(_mm_loadu_ps(in + i));
+            auto hi = FloatToShortLaneSSE2(_mm_loadu_ps(in + i + 4));
+            _mm_storeu_si128(
+                reinterpret_cast<__m128i*>(out + i), _mm_packs_epi32(lo, hi));
+        }
+        FloatToShortScalar(in + i, out + i, count - i);
+    }
+
+    SRCPP_TARGET("sse2")
+    inline void FloatToIntSSE2(const float* in, int* out, size_t count)
+    {
+        const auto scale = _mm_set1_ps(kIntScale);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            auto scaled = _mm_mul_ps(_mm_loadu_ps(in + i), scale);
+            // out of range converts to 0x80000000; flip it for positives.
+            auto converted = _mm_cvtps_epi32(scaled);
+            auto over = _mm_castps_si128(_mm_cmpge_ps(scaled, scale));
+            converted = _mm_xor_si128(converted, over);
+            auto ordered = _mm_castps_si128(_mm_cmpord_ps(scaled, scaled));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i),
+                _mm_and_si128(converted, ordered));
+        }
+        FloatToIntScalar(in + i, out + i, count - i);
+    }
+
+    SRCPP_TARGET("sse2")
+    inline void Interleave2SSE2(
+        const float* left, const float* right, float* out, size_t frames)
+    {
+        size_t i = 0;
+        for (; i + 4 <= frames; i += 4) {
+            auto l = _mm_loadu_ps(left + i);
+            auto r = _mm_loadu_ps(right + i);
+            _mm_storeu_ps(out + 2 * i, _mm_unpacklo_ps(l, r));
+            _mm_storeu_ps(out + 2 * i + 4, _mm_unpackhi_ps(l, r));
+        }
+        Interleave2Scalar(left + i, right + i, out + 2 * i, frames - i);
+    }
+
+    SRCPP_TARGET("sse2")
+    inline void Deinterleave2SSE2(
+        const float* in, float* left, float* right, size_t frames)
+    {
+        size_t i = 0;
+        for (; i + 4 <= frames; i += 4) {
+            auto a = _mm_loadu_ps(in + 2 * i);
+            auto b = _mm_loadu_ps(in + 2 * i + 4);
+            _mm_storeu_ps(left + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+            _mm_storeu_ps(
+                right + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+        }
+        Deinterleave2Scalar(in + 2 * i, left + i, right + i, frames - i);
+    }
+
+    SRCPP_TARGET("avx2")
+    inline void ShortToFloatAVX2(const short* in, float* out, size_t count)
+    {
+        const auto scale = _mm256_set1_ps(1.0f / 0x8000);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            auto v = _mm256_cvtepi16_epi32(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)));
+            _mm256_storeu_ps(
+                out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+        }
+        ShortToFloatScalar(in + i, out + i, count - i);
+    }
+
+    SRCPP_TARGET("avx2")
+    inline void IntToFloatAVX2(const int* in, float* out, size_t count)
+    {
+        const auto scale = _mm256_set1_ps(1.0f / kIntScale);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            auto v = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(in + i));
+            _mm256_storeu_ps(
+                out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+        }
+        IntToFloatScalar(in + i, out + i, count - i);
+    }
+
+    SRCPP_TARGET("avx2")
+    inline auto FloatToShortLaneAVX2(__m256 v) -> __m256i
+    {
+        auto scaled = _mm256_mul_ps(v, _mm256_set1_ps(32768.f));
+        scaled = _mm256_and_ps(
+            scaled, _mm256_cmp_ps(scaled, scaled, _CMP_ORD_Q));
+        scaled = _mm256_min_ps(_mm256_max_ps(scaled, _mm256_set1_ps(-32768.f)),
+            _mm256_set1_ps(32767.f));
+        return _mm256_cvtps_epi32(scaled);
+    }
+
+    SRCPP_TARGET("avx2")
+    inline void FloatToShortAVX2(const float* in, short* out, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            auto lo = FloatToShortLaneAVX2(_mm256_loadu_ps(in + i));
+            auto hi = FloatToShortLaneAVX2(_mm256_loadu_ps(in + i + 8));
+            // packs works per 128-bit lane; put the quarters back in order.
+            auto packed = _mm256_permute4x64_epi64(
+                _mm256_packs_epi32(lo, hi), 0xD8);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), packed);
+        }
+        FloatToShortScalar(in + i, out + i, count - i);
+    }
+
+    SRCPP_TARGET("avx2")
+    inline void FloatToIntAVX2(const float* in, int* out, size_t count)
+    {
+        const auto scale = _mm256_set1_ps(kIntScale);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            auto scaled = _mm256_mul_ps(_mm256_loadu_ps(in + i), scale);
+            auto converted = _mm256_cvtps_epi32(scaled);
+            auto over = _mm256_castps_si256(
+                _mm256_cmp_ps(scaled, scale, _CMP_GE_OQ));
+            converted = _mm256_xor_si256(converted, over);
+            auto ordered = _mm256_castps_si256(
+                _mm256_cmp_ps(scaled, scaled, _CMP_ORD_Q));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i),
+                _mm256_and_si256(converted, ordered));
+        }
+        FloatToIntScalar(in + i, out + i, count - i);
+    }
+
+    SRCPP_TARGET("avx2")
+    inline void Interleave2AVX2(
+        const float* left, const float* right, float* out, size_t frames)
+    {
+        size_t i = 0;
+        for (; i + 8 <= frames; i += 8) {
+            auto l = _mm256_loadu_ps(left + i);
+            auto r = _mm256_loadu_ps(right + i);
+            // unpack works per 128-bit lane; swap the middle halves back.
+            auto lo = _mm256_unpacklo_ps(l, r);
+            auto hi = _mm256_unpackhi_ps(l, r);
+            _mm256_storeu_ps(out + 2 * i, _mm256_permute2f128_ps(lo, hi, 0x20));
+            _mm256_storeu_ps(
+                out + 2 * i + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+        }
+        Interleave2Scalar(left + i, right + i, out + 2 * i, frames - i);
+    }
+
+    SRCPP_TARGET("avx2")
+    inline void Deinterleave2AVX2(
+        const float* in, float* left, float* right, size_t frames)
+    {
+        size_t i = 0;
+        for (; i + 8 <= frames; i += 8) {
+            auto a = _mm256_loadu_ps(in + 2 * i);
+            auto b = _mm256_loadu_ps(in + 2 * i + 8);
+            auto lo = _mm256_permute2f128_ps(a, b, 0x20);
+            auto hi = _mm256_permute2f128_ps(a, b, 0x31);
+            _mm256_storeu_ps(
+                left + i, _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0)));
+            _mm256_storeu_ps(
+                right + i, _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1)));
+        }
+        Deinterleave2Scalar(in + 2 * i, left + i, right + i, frames - i);
+    }
+
+    // gcc before 13 warns about the undefined passthrough operands inside
+    // its own AVX-512 intrinsics.
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ < 13
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+    SRCPP_TARGET("avx512f")
+    inline void ShortToFloatAVX512(const short* in, float* out, size_t count)
+    {
+        const auto scale = _mm512_set1_ps(1.0f / 0x8000);
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            auto v = _mm512_cvtepi16_epi32(
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i)));
+            _mm512_storeu_ps(
+                out + i, _mm512_mul_ps(_mm512_cvtepi32_ps(v), scale));
+        }
+        ShortToFloatScalar(in + i, out + i, count - i);
+    }
+
+    SRCPP_TARGET("avx512f")
+    inline void IntToFloatAVX512(const int* in, float* out, size_t count)
+    {
+        const auto scale = _mm512_set1_ps(1.0f / kIntScale);
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            auto v = _mm512_loadu_si512(in + i);
+            _mm512_storeu_ps(
+                out + i, _mm512_mul_ps(_mm512_cvtepi32_ps(v), scale));
+        }
+        IntToFloatScalar(in + i, out + i, count - i);
+    }
+
+    SRCPP_TARGET("avx512f")
+    inline void FloatToShortAVX512(const float* in, short* out, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            auto scaled
+                = _mm512_mul_ps(_mm512_loadu_ps(in + i), _mm512_set1_ps(32768.f));
+            scaled = _mm512_maskz_mov_ps(
+                _mm512_cmp_ps_mask(scaled, scaled, _CMP_ORD_Q), scaled);
+            scaled = _mm512_min_ps(
+                _mm512_max_ps(scaled, _mm512_set1_ps(-32768.f)),
+                _mm512_set1_ps(32767.f));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i),
+                _mm512_cvtsepi32_epi16(_mm512_cvtps_epi32(scaled)));
+        }
+        FloatToShortScalar(in + i, out + i, count - i);
+    }
+
+    SRCPP_TARGET("avx512f")
+    inline void FloatToIntAVX512(const float* in, int* out, size_t count)
+    {
+        const auto scale = _mm512_set1_ps(kIntScale);
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            auto scaled = _mm512_mul_ps(_mm512_loadu_ps(in + i), scale);
+            auto converted = _mm512_cvtps_epi32(scaled);
+            converted = _mm512_mask_mov_epi32(converted,
+                _mm512_cmp_ps_mask(scaled, scale, _CMP_GE_OQ),
+                _mm512_set1_epi32(0x7fffffff));
+            converted = _mm512_maskz_mov_epi32(
+                _mm512_cmp_ps_mask(scaled, scaled, _CMP_ORD_Q), converted);
+            _mm512_storeu_si512(out + i, converted);
+        }
+        FloatToIntScalar(in + i, out + i, count - i);
+    }
+
+    SRCPP_TARGET("avx512f")
+    inline void Interleave2AVX512(
+        const float* left, const float* right, float* out, size_t frames)
+    {
+        const auto first = _mm512_setr_epi32(
+            0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23);
+        const auto second = _mm512_add_epi32(first, _mm512_set1_epi32(8));
+        size_t i = 0;
+        for (; i + 16 <= frames; i += 16) {
+            auto l = _mm512_loadu_ps(left + i);
+            auto r = _mm512_loadu_ps(right + i);
+            _mm512_storeu_ps(out + 2 * i, _mm512_permutex2var_ps(l, first, r));
+            _mm512_storeu_ps(
+                out + 2 * i + 16, _mm512_permutex2var_ps(l, second, r));
+        }
+        Interleave2Scalar(left + i, right + i, out + 2 * i, frames - i);
+    }
+
+    SRCPP_TARGET("avx512f")
+    inline void Deinterleave2AVX512(
+        const float* in, float* left, float* right, size_t frames)
+    {
+        const auto even = _mm512_setr_epi32(
+            0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+        const auto odd = _mm512_add_epi32(even, _mm512_set1_epi32(1));
+        size_t i = 0;
+        for (; i + 16 <= frames; i += 16) {
+            auto a = _mm512_loadu_ps(in + 2 * i);
+            auto b = _mm512_loadu_ps(in + 2 * i + 16);
+            _mm512_storeu_ps(left + i, _mm512_permutex2var_ps(a, even, b));
+            _mm512_storeu_ps(right + i, _mm512_permutex2var_ps(a, odd, b));
+        }
+        Deinterleave2Scalar(in + 2 * i, left + i, right + i, frames - i);
+    }
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ < 13
+#pragma GCC diagnostic pop
+#endif
+#endif // SRCPP_X86
+
+    struct FormatKernels {
+        void (*short_to_float)(const short*, float*, size_t);
+        void (*int_to_float)(const int*, float*, size_t);
+        void (*float_to_short)(const float*, short*, size_t);
+        void (*float_to_int)(const float*, int*, size_t);
+        void (*interleave2)(const float*, const float*, float*, size_t);
+        void (*deinterleave2)(const float*, float*, float*, size_t);
+    };
+
+    // The kernels for level; levels this build has no kernels for fall back
+    // to the best one below it.
+    inline auto FormatKernelsFor(SimdLevel level) -> const FormatKernels&
+    {
+        static constexpr auto scalar = FormatKernels { ShortToFloatScalar,
+            IntToFloatScalar, FloatToShortScalar, FloatToIntScalar,
+            Interleave2Scalar, Deinterleave2Scalar };
+#if SRCPP_X86
+        static constexpr auto sse2 = FormatKernels { ShortToFloatSSE2,
+            IntToFloatSSE2, FloatToShortSSE2, FloatToIntSSE2,
+            Interleave2SSE2, Deinterleave2SSE2 };
+        static constexpr auto avx2 = FormatKernels { ShortToFloatAVX2,
+            IntToFloatAVX2, FloatToShortAVX2, FloatToIntAVX2,
+            Interleave2AVX2, Deinterleave2AVX2 };
+        static constexpr auto avx512 = FormatKernels { ShortToFloatAVX512,
+            IntToFloatAVX512, FloatToShortAVX512, FloatToIntAVX512,
+            Interleave2AVX512, Deinterleave2AVX512 };
+        switch (level) {
+        case SimdLevel::AVX512:
+            return avx512;
+        case SimdLevel::AVX2:
+            return avx2;
+        case SimdLevel::SSE2:
+            return sse2;
+        case SimdLevel::Scalar:
+            return scalar;
+        }
+#endif // SRCPP_X86
+        (void)level;
+        return scalar;
+    }
+
+    inline auto ActiveFormatKernels() -> const FormatKernels&
+    {
+        static const auto& kernels = FormatKernelsFor(DetectSimdLevel());
+        return kernels;
+    }
+
+    // Converts input.size() samples into output, which must be at least as
+    // large.  Conversions between short and int go through float, as every
+    // other SRCpp path does.
+    template <SupportedSampleType To, SupportedSampleType From>
+    inline void ConvertSamples(std::span<const From> input, To* output)
+    {
+        const auto& kernels = ActiveFormatKernels();
+        if constexpr (std::is_same_v<From, To>) {
+            std::copy(input.begin(), input.end(), output);
+        } else if constexpr (std::is_same_v<To, float>) {
+            if constexpr (std::is_same_v<From, short>) {
+                kernels.short_to_float(input.data(), output, input.size());
+            } else {
+                kernels.int_to_float(input.data(), output, input.size());
+            }
+        } else if constexpr (std::is_same_v<From, float>) {
+            if constexpr (std::is_same_v<To, short>) {
+                kernels.float_to_short(input.data(), output, input.size());
+            } else {
+                kernels.float_to_int(input.data(), output, input.size());
+            }
+        } else {
+            constexpr size_t kChunk = 256;
+            float scratch[kChunk];
+            for (size_t i = 0; i < input.size(); i += kChunk) {
+                auto chunk = input.subspan(i, std::min(kChunk, input.size() - i));
+                ConvertSamples<float, From>(chunk, scratch);
+                ConvertSamples<To, float>(
+                    std::span<const float> { scratch, chunk.size() },
+                    output + i);
+            }
+        }
+    }
+
+    template <typename T> struct IsPlanarSpan : std::false_type { };
+    template <typename T> struct IsPlanarSpan<PlanarSpan<T>> : std::true_type {
+    };
+
+    // Frames per channel the planar conversions stage on the stack at once.
+    inline constexpr size_t kPlanarChunk = 256;
+
+    // Writes input interleaved into output as float.  Each chunk of a channel
+    // is format converted into L1-resident scratch (or read in place when
+    // already float) and then interleaved, so the caller's buffers are only
+    // touched once.
+    template <SupportedSampleType From>
+    inline void InterleaveFrames(PlanarSpan<const From> input, float* output)
+    {
+        const auto& kernels = ActiveFormatKernels();
+        auto channels = input.channels();
+        if (channels == 1) {
+            ConvertSamples<float, From>(input.channel(0), output);
+            return;
+        }
+        float scratch[2][kPlanarChunk];
+        for (size_t frame = 0; frame < input.frames(); frame += kPlanarChunk) {
+            auto count = std::min(kPlanarChunk, input.frames() - frame);
+            auto* out = output + frame * channels;
+            auto source
+                = [&](size_t index, [[maybe_unused]] float* buffer) -> const float* {
+                auto samples = input.channel(index).subspan(frame, count);
+                if constexpr (std::is_same_v<From, float>) {
+                    return samples.data();
+                } else {
+                    ConvertSamples<float, From>(samples, buffer);
+                    return buffer;
+                }
+            };
+            if (channels == 2) {
+                kernels.interleave2(
+                    source(0, scratch[0]), source(1, scratch[1]), out, count);
+                continue;
+            }
+            for (size_t index = 0; index < channels; ++index) {
+                const auto* samples = source(index, scratch[0]);
+                for (size_t i = 0; i < count; ++i) {
+                    out[i * channels + index] = samples[i];
+                }
+            }
+        }
+    }
+
+    // As InterleaveFrames, but writes output.size() samples starting sample
+    // samples into input's interleaved order; neither end need fall on a
+    // frame boundary.
+    template <SupportedSampleType From>
+    inline void InterleaveSamples(
+        PlanarSpan<const From> input, size_t sample, std::span<float> output)
+    {
+        auto channels = input.channels();
+        auto single = [&](size_t done) {
+            auto at = sample + done;
+            ConvertSamples<float, From>(
+                input.channel(at % channels).subspan(at / channels, 1),
+                output.data() + done);
+        };
+        size_t done = 0;
+        for (; done < output.size() && (sample + done) % channels; ++done) {
+            single(done);
+        }
+        auto frames = (output.size() - done) / channels;
+        InterleaveFrames(input.subspan((sample + done) / channels, frames),
+            output.data() + done);
+        for (done += frames * channels; done < output.size(); ++done) {
+            single(done);
+        }
+    }
+
+    // Writes output.frames() interleaved float frames from input into the
+    // planar output, converting to To on the way.
+    template <SupportedSampleType To>
+    inline void DeinterleaveFrames(const float* input, PlanarSpan<To> output)
+    {
+        const auto& kernels = ActiveFormatKernels();
+        auto channels = output.channels();
+        if (channels == 1) {
+            ConvertSamples<To, float>(
+                std::span { input, output.frames() }, output.channel(0).data());
+            return;
+        }
+        float scratch[2][kPlanarChunk];
+        for (size_t frame = 0; frame < output.frames();
+            frame += kPlanarChunk) {
+            auto count = std::min(kPlanarChunk, output.frames() - frame);
+            const auto* in = input + frame * channels;
+            auto target = [&](size_t index, [[maybe_unused]] float* buffer) {
+                if constexpr (std::is_same_v<To, float>) {
+                    return output.channel(index).data() + frame;
+                } else {
+                    return buffer;
+                }
+            };
+            auto store = [&](size_t index, const float* samples) {
+                if constexpr (!std::is_same_v<To, float>) {
+                    ConvertSamples<To, float>(std::span { samples, count },
+                        output.channel(index).data() + frame);
+                }
+            };
+            if (channels == 2) {
+                auto* left = target(0, scratch[0]);
+                auto* right = target(1, scratch[1]);
+                kernels.deinterleave2(in, left, right, count);
+                store(0, left);
+                store(1, right);
+                continue;
+            }
+            for (size_t index = 0; index < channels; ++index) {
+                auto* samples = target(index, scratch[0]);
+                for (size_t i = 0; i < count; ++i) {
+                    samples[i] = in[i * channels + index];
+                }
+                store(index, samples);
+            }
+        }
+    }
+
+    // Frame-level access shared by the interleaved and planar paths.
+    template <typename T>
+    inline auto FrameCount(std::span<T> samples, size_t channels) -> size_t
+    {
+        return samples.size() / channels;
+    }
+
+    template <typename T>
+    inline auto FrameCount(PlanarSpan<T> samples, size_t) -> size_t
+    {
+        return samples.frames();
+    }
+
+    template <typename T>
+    inline auto SampleCount(std::span<T> samples, size_t) -> size_t
+    {
+        return samples.size();
+    }
+
+    template <typename T>
+    inline auto SampleCount(PlanarSpan<T> samples, size_t channels) -> size_t
+    {
+        return samples.frames() * channels;
+    }
+
+    // The frames from frame on, and the first count frames.
+    template <typename T>
+    inline auto FramesFrom(std::span<T> samples, size_t channels, size_t frame)
+        -> std::span<T>
+    {
+        return samples.subspan(frame * channels);
+    }
+
+    template <typename T>
+    inline auto FramesFrom(PlanarSpan<T> samples, size_t, size_t frame)
+        -> PlanarSpan<T>
+    {
+        return samples.subspan(frame);
+    }
+
+    template <typename T>
+    inline auto FirstFrames(std::span<T> samples, size_t channels, size_t count)
+        -> std::span<T>
+    {
+        return samples.first(count * channels);
+    }
+
+    template <typename T>
+    inline auto FirstFrames(PlanarSpan<T> samples, size_t, size_t count)
+        -> PlanarSpan<T>
+    {
+        return samples.first(count);
+    }
+
+    // Stages count input frames from frame on as interleaved float.
+    template <SupportedSampleType From>
+    inline void ReadFrames(std::span<const From> input, size_t channels,
+        size_t frame, size_t count, float* output)
+    {
+        ConvertSamples<float, From>(
+            input.subspan(frame * channels, count * channels), output);
+    }
+
+    template <SupportedSampleType From>
+    inline void ReadFrames(PlanarSpan<const From> input, size_t,
+        size_t frame, size_t count, float* output)
+    {
+        InterleaveFrames(input.subspan(frame, count), output);
+    }
+
+    // Stores interleaved float frames into output from frame on.
+    template <SupportedSampleType To>
+    inline void WriteFrames(std::span<const float> produced,
+        std::span<To> output, size_t channels, size_t frame)
+    {
+        ConvertSamples<To, float>(produced, output.data() + frame * channels);
+    }
+
+    template <SupportedSampleType To>
+    inline void WriteFrames(std::span<const float> produced,
+        PlanarSpan<To> output, size_t channels, size_t frame)
+    {
+        DeinterleaveFrames(
+            produced.data(), output.subspan(frame, produced.size() / channels));
+    }
+
+    // Samples converted from float at a time on their way to an appending
+    // output.
+    inline constexpr size_t kEmitBlockSamples = 1024;
+
+    // Hands produced to append as spans of To, converting through a stack
+    // block, so the destination is only ever written once.
+    template <SupportedSampleType To, typename Append>
+    inline void EmitSamples(std::span<const float> produced, Append& append)
+    {
+        if constexpr (std::is_same_v<To, float>) {
+            append(produced);
+        } else {
+            std::array<To, kEmitBlockSamples> block;
+            for (size_t i = 0; i < produced.size(); i += block.size()) {
+                auto chunk = produced.subspan(
+                    i, std::min(block.size(), produced.size() - i));
+                ConvertSamples<To, float>(chunk, block.data());
+                append(std::span<const To> { block.data(), chunk.size() });
+            }
+        }
+    }
+
+    // Grows output for count more elements, geometrically, so repeated
+    // appends reallocate as rarely as push_back does.
+    template <typename T, typename Allocator>
+    inline void ReserveMore(std::vector<T, Allocator>& output, size_t count)
+    {
+        if (output.capacity() - output.size() < count) {
+            output.reserve(
+                std::max(output.size() + count, 2 * output.capacity()));
+        }
+    }
+
+    template <SupportedSampleType To, typename Allocator>
+    inline auto AppendTo(std::vector<To, Allocator>& output)
+    {
+        return [&output](std::span<const To> samples) {
+            output.insert(output.end(), samples.begin(), samples.end());
+        };
+    }
+
+    template <SupportedSampleType To, typename OutputIt>
+    inline auto AppendThrough(OutputIt& output)
+    {
+        return [&output](std::span<const To> samples) {
+            output = std::copy(samples.begin(), samples.end(), output);
+        };
+    }
+
+    // An output that is appended to rather than written at an offset, for
+    // ConvertInBlocks; room bounds the samples it takes.
+    template <SupportedSampleType To, typename Append> struct SampleSink {
+        Append append;
+        size_t room;
+    };
+
+    template <SupportedSampleType To, typename Append>
+    inline auto SampleCount(const SampleSink<To, Append>& sink, size_t)
+        -> size_t
+    {
+        return sink.room;
+    }
+
+    template <SupportedSampleType To, typename Append>
+    inline void WriteFrames(std::span<const float> produced,
+        SampleSink<To, Append>& sink, size_t, size_t)
+    {
+        EmitSamples<To>(produced, sink.append);
+    }
+
+    // A sink is always written at its end.
+    template <SupportedSampleType To, typename Append>
+    inline auto FramesFrom(SampleSink<To, Append>& sink, size_t, size_t)
+        -> SampleSink<To, Append>&
+    {
+        return sink;
+    }
+
+    template <SupportedSampleType To, typename Append>
+    inline auto FirstFrames(SampleSink<To, Append> sink, size_t, size_t)
+        -> SampleSink<To, Append>
+    {
+        return sink;
+    }
+}
+
+inline auto DetectSimdLevel() -> SimdLevel
+{
+#if SRCPP_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4] {};
+    __cpuid(info, 0);
+    auto max_leaf = info[0];
+    __cpuid(info, 1);
+    auto sse2 = (info[3] & (1 << 26)) != 0;
+    auto os_avx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0;
+    auto xcr0 = os_avx ? _xgetbv(0) : 0;
+    auto avx2 = false;
+    auto avx512 = false;
+    if (max_leaf >= 7) {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0 && (xcr0 & 0x6) == 0x6;
+        avx512 = (info[1] & (1 << 16)) != 0 && (xcr0 & 0xE6) == 0xE6;
+    }
+#else
+    __builtin_cpu_init();
+    auto sse2 = __builtin_cpu_supports("sse2") != 0;
+    auto avx2 = __builtin_cpu_supports("avx2") != 0;
+    auto avx512 = __builtin_cpu_supports("avx512f") != 0;
+#endif
+    if (avx512) {
+        return SimdLevel::AVX512;
+    }
+    if (avx2) {
+        return SimdLevel::AVX2;
+    }
+    if (sse2) {
+        return SimdLevel::SSE2;
+    }
+#endif // SRCPP_X86
+    return SimdLevel::Scalar;
+}
+
+namespace details {
+    // What the buffers converters allocate are aligned to: a cache line, and
+    // the widest vector the format kernels load.
+    inline constexpr size_t kBufferAlignment = 64;
+
+    // Allocates from a std::pmr::memory_resource at kBufferAlignment.  The
+    // resource moves with a buffer, and a copied buffer allocates from the
+    // same resource, so a converter's buffers stay on the resource it was
+    // created with.
+    template <typename T> class AlignedAllocator {
+    public:
+        using value_type = T;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+
+        AlignedAllocator() noexcept = default;
+        AlignedAllocator(std::pmr::memory_resource* resource) noexcept
+            : resource_ { resource }
+        {
+        }
+        template <typename U>
+        AlignedAllocator(const AlignedAllocator<U>& other) noexcept
+            : resource_ { other.resource() }
+        {
+        }
+
+        auto allocate(size_t count) -> T*
+        {
+            if (count > std::numeric_limits<size_t>::max() / sizeof(T)) {
+                throw std::bad_array_new_length();
+            }
+            return static_cast<T*>(
+                resource_->allocate(count * sizeof(T), alignment));
+        }
+
+        void deallocate(T* data, size_t count) noexcept
+        {
+            resource_->deallocate(data, count * sizeof(T), alignment);
+        }
+
+        auto resource() const noexcept -> std::pmr::memory_resource*
+        {
+            return resource_;
+        }
+
+        template <typename U>
+        auto operator==(const AlignedAllocator<U>& other) const noexcept
+            -> bool
+        {
+            return *resource_ == *other.resource();
+        }
+
+    private:
+        static constexpr size_t alignment
+            = std::max(kBufferAlignment, alignof(T));
+
+        std::pmr::memory_resource* resource_ {
+            std::pmr::get_default_resource()
+        };
+    };
+
+    template <typename T>
+    using AlignedBuffer = std::vector<T, AlignedAllocator<T>>;
+
+    // Input staging for PushConverter.  A mirrored ring: every sample is
+    // stored twice, at slot and slot + capacity, so the staged samples are
+    // always readable as one contiguous window no matter where the ring has
+    // wrapped.  Appending costs O(new samples) and consuming only moves the
+    // head; leftover samples are never shifted.
+    //
+    // An empty buffer can also adopt a caller's vector as-is.  Until the next
+    // append the staged samples are read straight out of that vector (a
+    // non-empty adopted_ marks this linear mode); the append moves them into
+    // the ring, which adopting leaves reserved.
+    class StagingBuffer {
+    public:
+        StagingBuffer() = default;
+        explicit StagingBuffer(std::pmr::memory_resource* resource)
+            : storage_ { AlignedAllocator<float> { resource } }
+        {
+        }
+
+        auto size() const -> size_t { return size_; }
+        auto empty() const -> bool { return size_ == 0; }
+        auto capacity() const -> size_t { return capacity_; }
+
+        // Whether count more samples can be appended without reallocating.
+        auto fits(size_t count) const -> bool
+        {
+            return size_ + count <= capacity_;
+        }
+
+        // The staged samples, oldest first.
+        auto window() const -> std::span<const float>
+        {
+            return { (adopted_.empty() ? storage_.data() : adopted_.data())
+                    + head_,
+                size_ };
+        }
+
+        // Appends count samples.  fill(dest, offset) must write dest.size()
+        // samples, starting offset samples into the new data.
+        template <typename Fill> void append(size_t count, Fill&& fill);
+
+        // Drops count samples from the front of the window.
+        void consume(size_t count);
+
+        // Ensures samples can be staged without reallocating.
+        void reserve(size_t samples);
+
+        // Stages storage[offset, end) without copying.  Only valid when
+        // empty.
+        void adopt(std::vector<float>&& storage, size_t offset);
+
+        void clear()
+        {
+            adopted_ = {};
+            head_ = 0;
+            size_ = 0;
+        }
+
+    private:
+        AlignedBuffer<float> storage_;
+        // the caller's vector while one is adopted
+        std::vector<float> adopted_;
+        size_t capacity_ { 0 };
+        size_t head_ { 0 };
+        size_t size_ { 0 };
+    };
+}
+
+namespace details {
+    // The simplest fraction { up, down } within 1e-12 of factor whose
+    // denominator is at most max_down, from the continued fraction of factor.
+    inline auto RationalFactor(double factor, size_t max_down)
+        -> std::optional<std::pair<size_t, size_t>>
+    {
+        auto numerator = std::pair { 1.0, 0.0 };
+        auto denominator = std::pair { 0.0, 1.0 };
+        auto remainder = factor;
+        while (true) {
+            auto term = std::floor(remainder);
+            numerator = { term * numerator.first + numerator.second,
+                numerator.first };
+            denominator = { term * denominator.first + denominator.second,
+                denominator.first };
+            if (denominator.first > static_cast<double>(max_down)) {
+                return std::nullopt;
+            }
+            if (std::abs(numerator.first / denominator.first - factor)
+                <= 1e-12 * factor) {
+                return std::pair { static_cast<size_t>(numerator.first),
+                    static_cast<size_t>(denominator.first) };
+            }
+            remainder = 1.0 / (remainder - term);
+        }
+    }
+
+    inline constexpr auto IsPolyphase(SRCpp::Type type) -> bool
+    {
+        return type == SRCpp::Type::Polyphase_BestQuality
+            || type == SRCpp::Type::Polyphase_MediumQuality
+            || type == SRCpp::Type::Polyphase_Fastest;
+    }
+
+    // Inner products for the polyphase filter: the sum of a[i] * b[i] over
+    // count floats.  Each kernel keeps several partial sums so the adds do
+    // not wait on each other.
+    inline auto DotScalar(const float* a, const float* b, size_t count)
+        -> float
+    {
+        float sum[4] {};
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            sum[0] += a[i] * b[i];
+            sum[1] += a[i + 1] * b[i + 1];
+            sum[2] += a[i + 2] * b[i + 2];
+            sum[3] += a[i + 3] * b[i + 3];
+        }
+        for (; i < count; ++i) {
+            sum[0] += a[i] * b[i];
+        }
+        return (sum[0] + sum[1]) + (sum[2] + sum[3]);
+    }
+
+#if SRCPP_X86
+    SRCPP_TARGET("sse2")
+    inline auto HorizontalSum(__m128 sum) -> float
+    {
+        auto pair = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+        return _mm_cvtss_f32(
+            _mm_add_ss(pair, _mm_shuffle_ps(pair, pair, 0x55)));
+    }
+
+    SRCPP_TARGET("sse2")
+    inline auto DotSSE2(const float* a, const float* b, size_t count) -> float
+    {
+        auto sum0 = _mm_setzero_ps();
+        auto sum1 = _mm_setzero_ps();
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            sum0 = _mm_add_ps(
+                sum0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+            sum1 = _mm_add_ps(sum1,
+                _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+        }
+        return HorizontalSum(_mm_add_ps(sum0, sum1))
+            + DotScalar(a + i, b + i, count - i);
+    }
+
+    // AVX2 machines without FMA exist, and DetectSimdLevel does not check
+    // for it, so this kernel multiplies and adds separately.
+    SRCPP_TARGET("avx2")
+    inline auto DotAVX2(const float* a, const float* b, size_t count) -> float
+    {
+        auto sum0 = _mm256_setzero_ps();
+        auto sum1 = _mm256_setzero_ps();
+        auto sum2 = _mm256_setzero_ps();
+        auto sum3 = _mm256_setzero_ps();
+        size_t i = 0;
+        for (; i + 32 <= count; i += 32) {
+            sum0 = _mm256_add_ps(sum0,
+                _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+            sum1 = _mm256_add_ps(sum1,
+                _mm256_mul_ps(
+                    _mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8)));
+            sum2 = _mm256_add_ps(sum2,
+                _mm256_mul_ps(
+                    _mm256_loadu_ps(a + i + 16), _mm256_loadu_ps(b + i + 16)));
+            sum3 = _mm256_add_ps(sum3,
+                _mm256_mul_ps(
+                    _mm256_loadu_ps(a + i + 24), _mm256_loadu_ps(b + i + 24)));
+        }
+        for (; i + 8 <= count; i += 8) {
+            sum0 = _mm256_add_ps(sum0,
+                _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+        }
+        auto sum
+            = _mm256_add_ps(_mm256_add_ps(sum0, sum1), _mm256_add_ps(sum2, sum3));
+        return HorizontalSum(_mm_add_ps(_mm256_castps256_ps128(sum),
+                   _mm256_extractf128_ps(sum, 1)))
+            + DotScalar(a + i, b + i, count - i);
+    }
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ < 13
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+    SRCPP_TARGET("avx512f")
+    inline auto DotAVX512(const float* a, const float* b, size_t count)
+        -> float
+    {
+        auto sum0 = _mm512_setzero_ps();
+        auto sum1 = _mm512_setzero_ps();
+        auto sum2 = _mm512_setzero_ps();
+        auto sum3 = _mm512_setzero_ps();
+        size_t i = 0;
+        for (; i + 64 <= count; i += 64) {
+            sum0 = _mm512_fmadd_ps(
+                _mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), sum0);
+            sum1 = _mm512_fmadd_ps(
+                _mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16), sum1);
+            sum2 = _mm512_fmadd_ps(
+                _mm512_loadu_ps(a + i + 32), _mm512_loadu_ps(b + i + 32), sum2);
+            sum3 = _mm512_fmadd_ps(
+                _mm512_loadu_ps(a + i + 48), _mm512_loadu_ps(b + i + 48), sum3);
+        }
+        for (; i + 16 <= count; i += 16) {
+            sum0 = _mm512_fmadd_ps(
+                _mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), sum0);
+        }
+        // fold the 128-bit lanes together through memory; gcc 12 warns about
+        // the lane shuffles and _mm512_reduce_add_ps alike
+        float lanes[16];
+        _mm512_storeu_ps(lanes,
+            _mm512_add_ps(_mm512_add_ps(sum0, sum1), _mm512_add_ps(sum2, sum3)));
+        auto sum = _mm_add_ps(
+            _mm_add_ps(_mm_loadu_ps(lanes), _mm_loadu_ps(lanes + 4)),
+            _mm_add_ps(_mm_loadu_ps(lanes + 8), _mm_loadu_ps(lanes + 12)));
+        return HorizontalSum(sum) + DotScalar(a + i, b + i, count - i);
+    }
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ < 13
+#pragma GCC diagnostic pop
+#endif
+#endif // SRCPP_X86
+
+    struct FilterKernels {
+        float (*dot)(const float*, const float*, size_t);
+    };
+
+    // As FormatKernelsFor, for the polyphase filter.
+    inline auto FilterKernelsFor(SimdLevel level) -> const FilterKernels&
+    {
+        static constexpr auto scalar = FilterKernels { DotScalar };
+#if SRCPP_X86
+        static constexpr auto sse2 = FilterKernels { DotSSE2 };
+        static constexpr auto avx2 = FilterKernels { DotAVX2 };
+        static constexpr auto avx512 = FilterKernels { DotAVX512 };
+        switch (level) {
+        case SimdLevel::AVX512:
+            return avx512;
+        case SimdLevel::AVX2:
+            return avx2;
+        case SimdLevel::SSE2:
+            return sse2;
+        case SimdLevel::Scalar:
+            return scalar;
+        }
+#endif // SRCPP_X86
+        (void)level;
+        return scalar;
+    }
+
+    inline auto ActiveFilterKernels() -> const FilterKernels&
+    {
+        static const auto& kernels = FilterKernelsFor(DetectSimdLevel());
+        return kernels;
+    }
+
+    // The largest interpolation factor (numerator of the reduced factor) the
+    // polyphase types accept.  The coefficient bank holds that many phases.
+    inline constexpr size_t kMaxPolyphasePhases = 1024;
+
+    // Stopband attenuation of the polyphase filters, in dB.  libsamplerate
+    // documents 97 dB for all three Sinc types.
+    inline constexpr double kPolyphaseAttenuation = 100.0;
+
+    // Phases are padded to a multiple of this many taps, one AVX-512 vector.
+    inline constexpr size_t kPolyphaseTapAlign = 16;
+
+    // Frames of input the polyphase engine stages per channel beyond the
+    // filter's own history.
+    inline constexpr size_t kPolyphaseChunk = 1024;
+
+    // Passband as a fraction of the lower of the two Nyquist frequencies,
+    // matching the bandwidth libsamplerate documents for the Sinc type of the
+    // same tier.
+    inline constexpr auto PolyphaseBandwidth(SRCpp::Type type) -> double
+    {
+        switch (type) {
+        case SRCpp::Type::Polyphase_BestQuality:
+            return 0.97;
+        case SRCpp::Type::Polyphase_MediumQuality:
+            return 0.90;
+        default:
+            return 0.80;
+        }
+    }
+
+    // std::sqrt, std::sin and std::ceil are not constexpr before C++26, so
+    // the filter design uses these instead.  Runtime designs use them too,
+    // which keeps FixedRatioConverter's tables identical to the banks of the
+    // Polyphase types.
+    inline constexpr auto ConstexprSqrt(double x) -> double
+    {
+        if (x <= 0.0) {
+            return 0.0;
+        }
+        // halving the exponent gives a first guess within a few percent;
+        // after one Newton step every estimate is at or above the root, so
+        // stop once they no longer descend
+        auto guess = std::bit_cast<double>(
+            (std::bit_cast<uint64_t>(x) >> 1) + (uint64_t { 1023 } << 51));
+        auto root = 0.5 * (guess + x / guess);
+        while (true) {
+            auto next = 0.5 * (root + x / root);
+            if (next >= root) {
+                return root;
+            }
+            root = next;
+        }
+    }
+
+    inline constexpr auto ConstexprSin(double x) -> double
+    {
+        constexpr auto pi = std::numbers::pi;
+        // into [-pi / 2, pi / 2], where 12 terms of the series are exact
+        auto turns = x / (2.0 * pi);
+        x -= static_cast<double>(
+                 static_cast<int64_t>(turns + (turns < 0.0 ? -0.5 : 0.5)))
+            * (2.0 * pi);
+        if (x > pi / 2.0) {
+            x = pi - x;
+        } else if (x < -pi / 2.0) {
+            x = -pi - x;
+        }
+        auto square = x * x;
+        auto term = x;
+        auto sum = x;
+        for (auto n = 1.0; n <= 12.0; n += 1.0) {
+            term *= -square / ((2.0 * n) * (2.0 * n + 1.0));
+            sum += term;
+        }
+        return sum;
+    }
+
+    inline constexpr auto ConstexprCeil(double x) -> size_t
+    {
+        auto whole = static_cast<size_t>(x);
+        return static_cast<double>(whole) < x ? whole + 1 : whole;
+    }
+
+    // Zeroth order modified Bessel function of the first kind, for the
+    // Kaiser window: the first 25 terms of its series, nested so each costs
+    // a multiply and an add.  That is exact to double precision for x up to
+    // 12, beyond the window's shape parameter.
+    inline constexpr auto BesselI0(double x) -> double
+    {
+        auto quarter = x * x / 4.0;
+        auto sum = 1.0;
+        for (auto k = 24.0; k >= 1.0; k -= 1.0) {
+            sum = 1.0 + sum * quarter / (k * k);
+        }
+        return sum;
+    }
+
+    // Taps per phase, and the prototype's centre, of the bank for
+    // converting by up / down.
+    struct PolyphaseShape {
+        size_t taps { 0 };
+        size_t delay { 0 };
+    };
+
+    inline constexpr auto PolyphaseShapeFor(
+        SRCpp::Type type, size_t up, size_t down) -> PolyphaseShape
+    {
+        auto bandwidth = PolyphaseBandwidth(type);
+        auto rate = static_cast<double>(std::max(up, down));
+        // Kaiser's estimate for the window's length
+        auto transition = (1.0 - bandwidth) * std::numbers::pi / rate;
+        auto delay = ConstexprCeil(
+            (kPolyphaseAttenuation - 7.95) / (2.285 * transition) / 2.0);
+        auto length = 2 * delay + 1;
+        // whole vectors for the kernels; the extra taps are zero
+        auto taps = ((length + up - 1) / up + kPolyphaseTapAlign - 1)
+            / kPolyphaseTapAlign * kPolyphaseTapAlign;
+        return { taps, delay };
+    }
+
+    // Fills coefficients, taps floats, with one phase of the bank for
+    // converting by up / down.  The prototype is a Kaiser windowed sinc
+    // low-pass at the rate up times the input's, cut off below the lower
+    // Nyquist frequency and centred on tap delay, so the conversion adds no
+    // latency.  Phase p holds taps p, p + up, p + 2 * up and so on, stored
+    // reversed, so an output is the inner product of its phase with the taps
+    // input frames ending at the last one it depends on.  Phases are
+    // designed, and normalised, independently of each other.
+    inline constexpr void DesignPolyphasePhase(SRCpp::Type type, size_t up,
+        size_t down, size_t phase, std::span<float> coefficients)
+    {
+        constexpr auto pi = std::numbers::pi;
+        auto [taps, delay] = PolyphaseShapeFor(type, up, down);
+        auto bandwidth = PolyphaseBandwidth(type);
+        auto rate = static_cast<double>(std::max(up, down));
+        auto beta = 0.1102 * (kPolyphaseAttenuation - 8.7);
+        auto cutoff = (1.0 + bandwidth) / (2.0 * rate);
+        auto window_scale = 1.0 / BesselI0(beta);
+
+        // the sinc's numerator, sin(pi * cutoff * offset), steps from tap to
+        // tap of the phase by rotation
+        auto angle = pi * cutoff
+            * (static_cast<double>(phase) - static_cast<double>(delay));
+        auto step = pi * cutoff * static_cast<double>(up);
+        auto sine = ConstexprSin(angle);
+        auto cosine = ConstexprSin(angle + pi / 2.0);
+        auto step_sine = ConstexprSin(step);
+        auto step_cosine = ConstexprSin(step + pi / 2.0);
+
+        std::fill(coefficients.begin(), coefficients.end(), 0.0f);
+        auto sum = 0.0;
+        for (size_t tap = phase, index = taps; tap <= 2 * delay && index > 0;
+             tap += up) {
+            auto offset = static_cast<double>(tap) - static_cast<double>(delay);
+            auto position = offset / static_cast<double>(delay);
+            auto window
+                = BesselI0(beta * ConstexprSqrt(1.0 - position * position))
+                * window_scale;
+            auto sinc = tap == delay ? cutoff : sine / (pi * offset);
+            auto value = sinc * window;
+            coefficients[--index] = static_cast<float>(value);
+            sum += value;
+            auto rotated = sine * step_cosine + cosine * step_sine;
+            cosine = cosine * step_cosine - sine * step_sine;
+            sine = rotated;
+        }
+        // unity gain at DC, whichever phase an output falls on
+        for (auto& coefficient : coefficients) {
+            coefficient = static_cast<float>(coefficient / sum);
+        }
+    }
+
+    // A bank designed at runtime, shared by every engine converting at its
+    // ratio.
+    struct PolyphaseBank {
+        SRCpp::Type type { SRCpp::Type::Polyphase_BestQuality };
+        size_t up { 1 };
+        size_t down { 1 };
+        size_t taps { 0 };
+        size_t delay { 0 };
+        // down / up as whole input frames and phases, the step between
+        // outputs
+        size_t whole { 0 };
+        size_t fraction { 0 };
+        std::vector<float> coefficients;
+
+        auto phase(size_t index) const -> const float*
+        {
+            return coefficients.data() + index * taps;
+        }
+    };
+
+    inline auto DesignPolyphase(SRCpp::Type type, size_t up, size_t down)
+        -> std::shared_ptr<const PolyphaseBank>
+    {
+        auto bank = std::make_shared<PolyphaseBank>();
+        auto shape = PolyphaseShapeFor(type, up, down);
+        bank->type = type;
+        bank->up = up;
+        bank->down = down;
+        bank->taps = shape.taps;
+        bank->delay = shape.delay;
+        bank->whole = down / up;
+        bank->fraction = down % up;
+        bank->coefficients.resize(bank->taps * up);
+        for (size_t phase = 0; phase < up; ++phase) {
+            DesignPolyphasePhase(type, up, down, phase,
+                std::span { bank->coefficients }.subspan(
+                    phase * bank->taps, bank->taps));
+        }
+        return bank;
+    }
+
+    // The bank for one ratio as a compile-time table, laid out as
+    // PolyphaseBank's.  Each phase is its own constant expression, which
+    // keeps every evaluation well inside the compiler's limits.
+    template <SRCpp::Type Type, size_t Up, size_t Down>
+    struct FixedPolyphaseBank {
+        static constexpr auto shape = PolyphaseShapeFor(Type, Up, Down);
+
+        template <size_t Phase>
+        static constexpr auto phase = [] {
+            std::array<float, shape.taps> coefficients {};
+            DesignPolyphasePhase(Type, Up, Down, Phase, coefficients);
+            return coefficients;
+        }();
+
+        alignas(64) static constexpr auto coefficients =
+            []<size_t... Phases>(std::index_sequence<Phases...>) {
+                std::array<float, Up * shape.taps> table {};
+                (std::copy(phase<Phases>.begin(), phase<Phases>.end(),
+                     table.begin() + Phases * shape.taps),
+                    ...);
+                return table;
+            }(std::make_index_sequence<Up> {});
+    };
+
+    // Filter designs shared by every engine that needs the same one.  An
+    // entry lives while an engine holds it, and the Keep most recently used
+    // are held beyond that, so converters created one after another share
+    // them too.  Entries nothing holds are dropped on the next design.
+    template <typename Key, typename Value, size_t Keep> class DesignCache {
+    public:
+        template <typename Design>
+        auto get(const Key& key, Design&& design)
+            -> std::shared_ptr<const Value>
+        {
+            std::scoped_lock lock { mutex_ };
+            auto found = entries_.find(key);
+            auto value = found != entries_.end() ? found->second.lock()
+                                                 : nullptr;
+            if (!value) {
+                std::erase_if(entries_,
+                    [](const auto& entry) { return entry.second.expired(); });
+                value = design();
+                entries_.insert_or_assign(key, value);
+            }
+            // most recently used last
+            std::erase(recent_, value);
+            recent_.push_back(value);
+            if (recent_.size() > Keep) {
+                recent_.erase(recent_.begin());
+            }
+            return value;
+        }
+
+        auto size() -> size_t
+        {
+            std::scoped_lock lock { mutex_ };
+            return entries_.size();
+        }
+
+    private:
+        std::mutex mutex_;
+        std::map<Key, std::weak_ptr<const Value>> entries_;
+        std::vector<std::shared_ptr<const Value>> recent_;
+    };
+
+    inline auto PolyphaseBanks() -> auto&
+    {
+        static DesignCache<std::tuple<SRCpp::Type, size_t, size_t>,
+            PolyphaseBank, 8>
+            banks;
+        return banks;
+    }
+
+    // Banks are designed once per (type, up, down) and shared by every
+    // engine converting at that ratio.
+    inline auto PolyphaseBankFor(SRCpp::Type type, size_t up, size_t down)
+        -> std::shared_ptr<const PolyphaseBank>
+    {
+        return PolyphaseBanks().get(std::tuple { type, up, down },
+            [&] { return DesignPolyphase(type, up, down); });
+    }
+
+    // The bank for converting by factor, or the error code explaining why
+    // there is none.
+    inline auto PolyphaseBankFor(SRCpp::Type type, double factor) noexcept
+        -> std::pair<std::shared_ptr<const PolyphaseBank>, int>
+    {
+        if (!src_is_valid_ratio(factor)) {
+            return { nullptr, ErrorBadFactor };
+        }
+        auto ratio = RationalFactor(factor, kMaxPolyphasePhases);
+        if (!ratio.has_value() || ratio->first > kMaxPolyphasePhases) {
+            return { nullptr, ErrorNotRational };
+        }
+        try {
+            return { PolyphaseBankFor(type, ratio->first, ratio->second),
+                ErrorNone };
+        } catch (const std::bad_alloc&) {
+            return { nullptr, ErrorOutOfMemory };
+        }
+    }
+
+    // A polyphase FIR converter for one fixed rational factor, driven through
+    // SRC_DATA the way libsamplerate's converters are.  Input is staged
+    // planar, one run of history per channel, so every output sample is a
+    // single contiguous inner product.  Staging is sized up front, so process
+    // never allocates unless the factor changes.
+    class Polyphase {
+    public:
+        Polyphase(std::shared_ptr<const PolyphaseBank> bank, size_t channels,
+            double factor);
+
+        auto type() const -> SRCpp::Type { return bank_->type; }
+        auto factor() const -> double { return factor_; }
+        // Output frames held back for input still to come.
+        auto latency() const -> size_t
+        {
+            return (bank_->delay + bank_->down - 1) / bank_->down;
+        }
+
+        auto process(SRC_DATA& data) noexcept -> int;
+        void reset() noexcept;
+
+        // Switches to another bank mid-stream, carrying on from the same
+        // point in the input.  Without may_allocate, returns
+        // ErrorExceedsPrepared instead of growing the staging.
+        auto retune(std::shared_ptr<const PolyphaseBank> bank, double factor,
+            bool may_allocate = true) -> int;
+        // Reserves the staging retune needs to switch between banks
+        // without allocating.
+        void reserve(std::span<const PolyphaseBank* const> banks);
+
+    private:
+        std::shared_ptr<const PolyphaseBank> bank_;
+        size_t channels_ { 0 };
+        // the factor asked for, which bank_ matches to within 1e-12
+        double factor_ { 1.0 };
+        // frames per channel the staging holds; channel c starts at
+        // c * capacity_
+        size_t capacity_ { 0 };
+        std::vector<float> history_;
+        // what retune lays the kept history out in before swapping it in
+        std::vector<float> spare_;
+        // input frame held in slot 0 (negative frames are the silence before
+        // the stream) and how many frames are held
+        int64_t base_ { 0 };
+        size_t length_ { 0 };
+        // the next output frame, the last input frame it needs and its
+        // phase, and the input frames in the stream once end_of_input has
+        // been seen
+        uint64_t next_ { 0 };
+        int64_t newest_ { 0 };
+        size_t phase_ { 0 };
+        uint64_t end_ { 0 };
+        bool ending_ { false };
+
+        static auto capacityFor(const PolyphaseBank& bank) -> size_t
+        {
+            return bank.taps - 1
+                + std::max(kPolyphaseChunk, bank.taps + bank.down / bank.up);
+        }
+
+        void seek(uint64_t frame)
+        {
+            auto position = frame * bank_->down + bank_->delay;
+            next_ = frame;
+            newest_ = static_cast<int64_t>(position / bank_->up);
+            phase_ = position % bank_->up;
+        }
+
+        // Moves on to the next output without dividing.
+        void advance()
+        {
+            ++next_;
+            newest_ += static_cast<int64_t>(bank_->whole);
+            phase_ += bank_->fraction;
+            if (phase_ >= bank_->up) {
+                phase_ -= bank_->up;
+                ++newest_;
+            }
+        }
+
+        auto finished() const -> bool
+        {
+            return ending_ && next_ * bank_->down >= end_ * bank_->up;
+        }
+
+        void discardHistory();
+    };
+
+    inline Polyphase::Polyphase(std::shared_ptr<const PolyphaseBank> bank,
+        size_t channels, double factor)
+        : bank_ { std::move(bank) }
+        , channels_ { channels }
+        , factor_ { factor }
+        , capacity_ { capacityFor(*bank_) }
+        , history_(capacity_ * channels_)
+    {
+        reset();
+    }
+
+    inline void Polyphase::reset() noexcept
+    {
+        // the stream starts with a filter's worth of silence
+        std::fill(history_.begin(), history_.end(), 0.0f);
+        base_ = 1 - static_cast<int64_t>(bank_->taps);
+        length_ = bank_->taps - 1;
+        seek(0);
+        end_ = 0;
+        ending_ = false;
+    }
+
+    inline void Polyphase::discardHistory()
+    {
+        auto oldest = newest_ - static_cast<int64_t>(bank_->taps) + 1;
+        if (oldest <= base_) {
+            return;
+        }
+        auto drop = std::min(static_cast<size_t>(oldest - base_), length_);
+        if (drop == 0) {
+            return;
+        }
+        for (size_t channel = 0; channel < channels_; ++channel) {
+            auto* run = history_.data() + channel * capacity_;
+            std::copy(run + drop, run + length_, run);
+        }
+        base_ += static_cast<int64_t>(drop);
+        length_ -= drop;
+    }
+
+    inline auto Polyphase::process(SRC_DATA& data) noexcept -> int
+    {
+        const auto& kernels = ActiveFilterKernels();
+        const auto& bank = *bank_;
+        auto input_frames = static_cast<size_t>(data.input_frames);
+        auto output_frames = static_cast<size_t>(data.output_frames);
+        size_t used = 0;
+        size_t generated = 0;
+        while (true) {
+            // everything the staged input allows
+            while (generated < output_frames && !finished()) {
+                if (newest_ >= base_ + static_cast<int64_t>(length_)) {
+                    break;
+                }
+                auto first = static_cast<size_t>(
+                    newest_ - base_ - static_cast<int64_t>(bank.taps) + 1);
+                auto* coefficients = bank.phase(phase_);
+                auto* out = data.data_out + generated * channels_;
+                for (size_t channel = 0; channel < channels_; ++channel) {
+                    out[channel] = kernels.dot(coefficients,
+                        history_.data() + channel * capacity_ + first,
+                        bank.taps);
+                }
+                advance();
+                ++generated;
+            }
+            if (generated == output_frames || finished()) {
+                break;
+            }
+
+            discardHistory();
+            // input the next output does not reach back to is skipped
+            auto start = base_ + static_cast<int64_t>(length_);
+            auto oldest = newest_ - static_cast<int64_t>(bank.taps) + 1;
+            if (length_ == 0 && oldest > start) {
+                auto skip = std::min(
+                    static_cast<size_t>(oldest - start), input_frames - used);
+                used += skip;
+                base_ += static_cast<int64_t>(skip);
+            }
+            // staging stops at the bank's own capacity, so history a retune
+            // carried over drains rather than growing what the next keeps
+            auto room = std::min(capacity_, capacityFor(bank)) - length_;
+            if (used < input_frames) {
+                auto count = std::min(room, input_frames - used);
+                const auto* in = data.data_in + used * channels_;
+                for (size_t channel = 0; channel < channels_; ++channel) {
+                    auto* run = history_.data() + channel * capacity_ + length_;
+                    for (size_t frame = 0; frame < count; ++frame) {
+                        run[frame] = in[frame * channels_ + channel];
+                    }
+                }
+                used += count;
+                length_ += count;
+                continue;
+            }
+            if (!data.end_of_input) {
+                break;
+            }
+            // past the end of the stream the filter reads silence
+            if (!ending_) {
+                ending_ = true;
+                end_ = static_cast<uint64_t>(
+                    base_ + static_cast<int64_t>(length_));
+            }
+            for (size_t channel = 0; channel < channels_; ++channel) {
+                auto* run = history_.data() + channel * capacity_ + length_;
+                std::fill(run, run + room, 0.0f);
+            }
+            length_ += room;
+        }
+        data.input_frames_used = static_cast<long>(used);
+        data.output_frames_gen = static_cast<long>(generated);
+        return ErrorNone;
+    }
+
+    inline auto Polyphase::retune(std::shared_ptr<const PolyphaseBank> bank,
+        double factor, bool may_allocate) -> int
+    {
+        // the next output keeps its place in time
+        auto time = static_cast<double>(next_)
+            * static_cast<double>(bank_->down)
+            / static_cast<double>(bank_->up);
+        auto next = static_cast<uint64_t>(std::ceil(time
+            * static_cast<double>(bank->up) / static_cast<double>(bank->down)));
+        auto position = next * bank->down + bank->delay;
+        auto oldest = static_cast<int64_t>(position / bank->up)
+            - static_cast<int64_t>(bank->taps) + 1;
+
+        // keep the history the new filter reaches back to, padding with
+        // silence where it reaches further than the old one kept
+        auto end = base_ + static_cast<int64_t>(length_);
+        auto keep_from = std::clamp(oldest, base_, end);
+        auto lead = static_cast<size_t>(std::max<int64_t>(base_ - oldest, 0));
+        auto kept = static_cast<size_t>(end - keep_from);
+        auto capacity = std::max(capacityFor(*bank), lead + kept + 1);
+        if (!may_allocate && spare_.capacity() < capacity * channels_) {
+            return ErrorExceedsPrepared;
+        }
+        spare_.assign(capacity * channels_, 0.0f);
+        for (size_t channel = 0; channel < channels_; ++channel) {
+            auto* run = history_.data() + channel * capacity_
+                + static_cast<size_t>(keep_from - base_);
+            std::copy(run, run + kept,
+                spare_.data() + channel * capacity + lead);
+        }
+        std::swap(history_, spare_);
+        capacity_ = capacity;
+        base_ = keep_from - static_cast<int64_t>(lead);
+        length_ = lead + kept;
+        bank_ = std::move(bank);
+        factor_ = factor;
+        seek(next);
+        return ErrorNone;
+    }
+
+    inline void Polyphase::reserve(std::span<const PolyphaseBank* const> banks)
+    {
+        // retune keeps at most what one bank stages plus what the filters
+        // reach back past it, so both buffers it swaps between get that
+        auto taps = bank_->taps;
+        auto capacity = capacity_;
+        for (const auto* bank : banks) {
+            taps = std::max(taps, bank->taps);
+            capacity = std::max(capacity, capacityFor(*bank));
+        }
+        capacity += 2 * taps + 2;
+        history_.reserve(capacity * channels_);
+        spare_.reserve(capacity * channels_);
+    }
+
+    // The exponent of factor when it is a power of two from 1 / 256 to 256
+    // other than 1, or 0.  The Polyphase types convert those factors with a
+    // cascade of half-band stages.
+    inline auto PowerOfTwoExponent(double factor) -> int
+    {
+        for (int exponent = 1; exponent <= 8; ++exponent) {
+            auto scale = static_cast<double>(1 << exponent);
+            if (factor == scale) {
+                return exponent;
+            }
+            if (factor == 1.0 / scale) {
+                return -exponent;
+            }
+        }
+        return 0;
+    }
+
+    // A half-band low-pass for one stage of a cascade.  Cut off at half the
+    // lower rate's Nyquist frequency, it is zero at every even offset from
+    // its centre but the centre itself, so only the 2 * half taps at odd
+    // offsets -(2 * half - 1) to 2 * half - 1 are stored.  They are scaled to
+    // sum to 1, the gain interpolation needs; the centre is then exactly 1.
+    struct HalfBandFilter {
+        SRCpp::Type type { SRCpp::Type::Polyphase_BestQuality };
+        // passband as a fraction of the lower rate's Nyquist frequency
+        double bandwidth { 0.0 };
+        size_t half { 0 };
+        std::vector<float> taps;
+    };
+
+    inline auto DesignHalfBand(SRCpp::Type type, double bandwidth)
+        -> std::shared_ptr<const HalfBandFilter>
+    {
+        constexpr auto pi = std::numbers::pi;
+        // the band between the passband and its mirror about the cut-off is
+        // the transition; what aliases into it stays above the passband
+        auto transition = (1.0 - bandwidth) * pi;
+        auto length
+            = (kPolyphaseAttenuation - 7.95) / (2.285 * transition) + 2.0;
+        // 2 * half taps in whole AVX2 vectors
+        auto half = (ConstexprCeil(length / 4.0) + 3) / 4 * 4;
+        auto beta = 0.1102 * (kPolyphaseAttenuation - 8.7);
+        auto window_scale = 1.0 / BesselI0(beta);
+        auto edge = static_cast<double>(2 * half - 1);
+
+        auto filter = std::make_shared<HalfBandFilter>();
+        filter->type = type;
+        filter->bandwidth = bandwidth;
+        filter->half = half;
+        filter->taps.resize(2 * half);
+        auto sum = 0.0;
+        std::vector<double> values(half);
+        for (size_t index = 0; index < half; ++index) {
+            auto offset = static_cast<double>(2 * index + 1);
+            auto position = offset / edge;
+            auto window
+                = BesselI0(beta * ConstexprSqrt(1.0 - position * position))
+                * window_scale;
+            values[index]
+                = std::sin(pi * offset / 2.0) / (pi * offset) * window;
+            sum += 2.0 * values[index];
+        }
+        // taps[half - 1 - i] and taps[half + i] are offsets -(2i + 1) and
+        // 2i + 1
+        for (size_t index = 0; index < half; ++index) {
+            auto tap = static_cast<float>(values[index] / sum);
+            filter->taps[half - 1 - index] = tap;
+            filter->taps[half + index] = tap;
+        }
+        return filter;
+    }
+
+    inline auto HalfBandFilters() -> auto&
+    {
+        static DesignCache<std::pair<SRCpp::Type, double>, HalfBandFilter, 8>
+            filters;
+        return filters;
+    }
+
+    // Filters are designed once per (type, bandwidth) and shared.
+    inline auto HalfBandFor(SRCpp::Type type, double bandwidth)
+        -> std::shared_ptr<const HalfBandFilter>
+    {
+        return HalfBandFilters().get(std::pair { type, bandwidth },
+            [&] { return DesignHalfBand(type, bandwidth); });
+    }
+
+    // One stage of a half-band cascade, interpolating or decimating by 2.
+    // Like the Polyphase engine, output is aligned with the input: output 2n
+    // of an interpolator is input n, and output n of a decimator is centred
+    // on input 2n.  History is planar, channel c from c * capacity_, and for
+    // a decimator is split into even and odd input frames, so every inner
+    // product reads contiguous samples.
+    class HalfBandStage {
+    public:
+        HalfBandStage(std::shared_ptr<const HalfBandFilter> filter,
+            bool interpolate, size_t channels);
+
+        // Appends frames of planar input, channel c at input + c * stride,
+        // and writes the outputs they complete to output, channel c at
+        // output + c * output_stride.  Returns the output frames written.
+        auto push(const float* input, size_t stride, size_t frames,
+            float* output, size_t output_stride) noexcept -> size_t;
+        // Ends the stream, writing the outputs still waiting for input.
+        auto finish(float* output, size_t output_stride) noexcept -> size_t;
+        void reset() noexcept;
+
+        // Output frames the stage holds back, twice over for an
+        // interpolator's pairs.
+        auto held() const -> size_t
+        {
+            return interpolate_ ? 2 * filter_->half : filter_->half;
+        }
+
+    private:
+        std::shared_ptr<const HalfBandFilter> filter_;
+        bool interpolate_ { true };
+        size_t channels_ { 0 };
+        // slots per channel; a decimator has as many again for odd frames
+        size_t capacity_ { 0 };
+        std::vector<float> history_;
+        // the slot 0 holds (an input frame for an interpolator, an even /
+        // odd pair for a decimator; negative ones are silence), how many
+        // input frames have arrived, and how many outputs were written
+        int64_t base_ { 0 };
+        uint64_t received_ { 0 };
+        uint64_t next_ { 0 };
+        // input frames in the stream once finish has been called
+        uint64_t end_ { 0 };
+        bool ending_ { false };
+
+        static constexpr size_t kChunk = 256;
+
+        auto slots() const -> size_t
+        {
+            auto held = interpolate_ ? received_ : (received_ + 1) / 2;
+            return static_cast<size_t>(static_cast<int64_t>(held) - base_);
+        }
+        void append(const float* input, size_t stride, size_t frames);
+        auto drain(float* output, size_t output_stride) -> size_t;
+        void discardHistory();
+    };
+
+    inline HalfBandStage::HalfBandStage(
+        std::shared_ptr<const HalfBandFilter> filter, bool interpolate,
+        size_t channels)
+        : filter_ { std::move(filter) }
+        , interpolate_ { interpolate }
+        , channels_ { channels }
+        , capacity_ { 2 * filter_->half + kChunk }
+        , history_(capacity_ * channels_ * (interpolate ? 1 : 2))
+    {
+        reset();
+    }
+
+    inline void HalfBandStage::reset() noexcept
+    {
+        // the stream starts with silence as far back as the filter reaches
+        std::fill(history_.begin(), history_.end(), 0.0f);
+        auto half = static_cast<int64_t>(filter_->half);
+        base_ = interpolate_ ? 1 - half : -half;
+        received_ = 0;
+        next_ = 0;
+        end_ = 0;
+        ending_ = false;
+    }
+
+    inline void HalfBandStage::append(
+        const float* input, size_t stride, size_t frames)
+    {
+        for (size_t channel = 0; channel < channels_; ++channel) {
+            const auto* in = input ? input + channel * stride : nullptr;
+            auto* run = history_.data() + channel * capacity_;
+            for (size_t frame = 0; frame < frames; ++frame) {
+                auto value = in ? in[frame] : 0.0f;
+                auto index = received_ + frame;
+                if (interpolate_) {
+                    run[static_cast<int64_t>(index) - base_] = value;
+                    continue;
+                }
+                // even frames in the first half of the channel's history,
+                // odd frames in the second
+                auto slot = static_cast<int64_t>(index / 2) - base_;
+                auto odd = index % 2 ? capacity_ * channels_ : 0;
+                run[odd + static_cast<size_t>(slot)] = value;
+            }
+        }
+        received_ += frames;
+    }
+
+    inline auto HalfBandStage::drain(float* output, size_t output_stride)
+        -> size_t
+    {
+        const auto& kernels = ActiveFilterKernels();
+        const auto* taps = filter_->taps.data();
+        auto half = filter_->half;
+        size_t produced = 0;
+        if (interpolate_) {
+            // pair n is input n and the point between inputs n and n + 1
+            auto last = ending_ ? end_ : std::numeric_limits<uint64_t>::max();
+            while (next_ < last && next_ + half < received_) {
+                auto slot = static_cast<size_t>(
+                    static_cast<int64_t>(next_) - base_);
+                for (size_t channel = 0; channel < channels_; ++channel) {
+                    const auto* run = history_.data() + channel * capacity_;
+                    auto* out = output + channel * output_stride + produced;
+                    out[0] = run[slot];
+                    out[1] = kernels.dot(taps, run + slot + 1 - half, 2 * half);
+                }
+                ++next_;
+                produced += 2;
+            }
+            return produced;
+        }
+        // output n needs the odd frames up to 2 * (n + half) - 1
+        auto last = ending_ ? (end_ + 1) / 2
+                            : std::numeric_limits<uint64_t>::max();
+        while (next_ < last && 2 * (next_ + half) - 1 < received_) {
+            auto slot
+                = static_cast<size_t>(static_cast<int64_t>(next_) - base_);
+            for (size_t channel = 0; channel < channels_; ++channel) {
+                const auto* even = history_.data() + channel * capacity_;
+                const auto* odd = even + capacity_ * channels_;
+                output[channel * output_stride + produced] = 0.5f
+                    * (even[slot] + kernels.dot(taps, odd + slot - half,
+                                        2 * half));
+            }
+            ++next_;
+            ++produced;
+        }
+        return produced;
+    }
+
+    inline void HalfBandStage::discardHistory()
+    {
+        // the next output reaches back half slots
+        auto oldest = static_cast<int64_t>(next_)
+            - static_cast<int64_t>(filter_->half) + (interpolate_ ? 1 : 0);
+        if (oldest <= base_) {
+            return;
+        }
+        auto drop = static_cast<size_t>(oldest - base_);
+        auto kept = slots() > drop ? slots() - drop : 0;
+        auto runs = channels_ * (interpolate_ ? 1 : 2);
+        for (size_t run = 0; run < runs; ++run) {
+            auto* slot = history_.data() + run * capacity_;
+            std::copy(slot + drop, slot + drop + kept, slot);
+        }
+        base_ = oldest;
+    }
+
+    inline auto HalfBandStage::push(const float* input, size_t stride,
+        size_t frames, float* output, size_t output_stride) noexcept
+        -> size_t
+    {
+        size_t produced = 0;
+        size_t used = 0;
+        while (true) {
+            produced += drain(output + produced, output_stride);
+            if (used == frames) {
+                return produced;
+            }
+            discardHistory();
+            // room left, in input frames; a decimator's last pair may be
+            // waiting for its odd frame
+            auto room = interpolate_
+                ? capacity_ - slots()
+                : 2 * (capacity_ - slots()) + received_ % 2;
+            auto count = std::min(room, frames - used);
+            append(input ? input + used : nullptr, stride, count);
+            used += count;
+        }
+    }
+
+    inline auto HalfBandStage::finish(
+        float* output, size_t output_stride) noexcept -> size_t
+    {
+        // past the end of the stream the filter reads silence
+        ending_ = true;
+        end_ = received_;
+        return push(nullptr, 0, 2 * filter_->half + 1, output, output_stride);
+    }
+
+    // SRCpp's engine for the Polyphase types at power-of-two factors: one
+    // half-band stage per octave, driven through SRC_DATA as Polyphase is.
+    // Interpolating, the sharpest stage runs first at the lowest rate and
+    // later stages only remove its images, so they get by with short
+    // filters; decimating, the order is reversed.  Input is converted a
+    // chunk at a time into planar buffers sized up front, and output that
+    // does not fit is kept for the next call.
+    class HalfBandCascade {
+    public:
+        HalfBandCascade(SRCpp::Type type, size_t channels, double factor);
+
+        auto type() const -> SRCpp::Type { return type_; }
+        auto factor() const -> double { return factor_; }
+        // Output frames held back for input still to come.
+        auto latency() const -> size_t { return latency_; }
+
+        auto process(SRC_DATA& data) noexcept -> int;
+        void reset() noexcept;
+
+    private:
+        SRCpp::Type type_ { SRCpp::Type::Polyphase_BestQuality };
+        size_t channels_ { 0 };
+        double factor_ { 1.0 };
+        bool interpolate_ { true };
+        size_t latency_ { 0 };
+        std::vector<HalfBandStage> stages_;
+        // planar buffers: the input to each stage, and the last stage's
+        // output, each channel strides_[i] floats apart
+        std::vector<std::vector<float>> buffers_;
+        std::vector<size_t> strides_;
+        // output frames in the last buffer not yet handed out
+        size_t pending_ { 0 };
+        size_t pending_offset_ { 0 };
+        bool finished_ { false };
+
+        static constexpr size_t kChunk = 256;
+
+        // Runs frames already in the first buffer (or the stream's end, when
+        // frames is 0) through the stages into the last buffer.
+        void run(size_t frames, bool finish);
+    };
+
+    inline HalfBandCascade::HalfBandCascade(
+        SRCpp::Type type, size_t channels, double factor)
+        : type_ { type }
+        , channels_ { channels }
+        , factor_ { factor }
+    {
+        auto exponent = PowerOfTwoExponent(factor);
+        interpolate_ = exponent > 0;
+        auto count = static_cast<size_t>(std::abs(exponent));
+        // stage i of an interpolator works i octaves above the input, where
+        // the signal fills less of the band; a decimator's stages are the
+        // same filters in reverse
+        auto bandwidth = PolyphaseBandwidth(type);
+        auto latency = 0.0;
+        for (size_t stage = 0; stage < count; ++stage) {
+            auto octave = interpolate_ ? stage : count - 1 - stage;
+            auto filter = HalfBandFor(type, bandwidth / (1 << octave));
+            stages_.emplace_back(filter, interpolate_, channels);
+            // what the stage holds back, at the rate of the final output
+            auto rate = interpolate_
+                ? static_cast<double>(1 << (count - 1 - stage))
+                : 1.0 / static_cast<double>(1 << (count - stage));
+            latency += interpolate_
+                ? static_cast<double>(stages_.back().held()) * rate
+                : static_cast<double>(2 * filter->half - 1) * rate;
+        }
+        latency_ = static_cast<size_t>(std::ceil(latency));
+
+        // Each buffer holds what its stage receives for one chunk, or at the
+        // end of the stream what every earlier stage still held.
+        auto frames = static_cast<double>(kChunk);
+        auto tail = 0.0;
+        for (size_t stage = 0; stage <= count; ++stage) {
+            auto stride = static_cast<size_t>(std::max(frames, tail)) + 2;
+            strides_.push_back(stride);
+            buffers_.emplace_back(stride * channels);
+            if (stage < count) {
+                auto scale = interpolate_ ? 2.0 : 0.5;
+                frames = std::ceil(frames * scale) + 1;
+                tail = std::ceil(tail * scale) + 1
+                    + static_cast<double>(stages_[stage].held()) + 1;
+            }
+        }
+    }
+
+    inline void HalfBandCascade::reset() noexcept
+    {
+        for (auto& stage : stages_) {
+            stage.reset();
+        }
+        pending_ = 0;
+        pending_offset_ = 0;
+        finished_ = false;
+    }
+
+    inline void HalfBandCascade::run(size_t frames, bool finish)
+    {
+        for (size_t stage = 0; stage < stages_.size(); ++stage) {
+            auto* input = buffers_[stage].data();
+            auto* output = buffers_[stage + 1].data();
+            auto produced = stages_[stage].push(input, strides_[stage],
+                frames, output, strides_[stage + 1]);
+            if (finish) {
+                produced += stages_[stage].finish(
+                    output + produced, strides_[stage + 1]);
+            }
+            frames = produced;
+        }
+        pending_ = frames;
+        pending_offset_ = 0;
+    }
+
+    inline auto HalfBandCascade::process(SRC_DATA& data) noexcept -> int
+    {
+        auto input_frames = static_cast<size_t>(data.input_frames);
+        auto output_frames = static_cast<size_t>(data.output_frames);
+        const auto& last = buffers_.back();
+        auto last_stride = strides_.back();
+        size_t used = 0;
+        size_t generated = 0;
+        while (true) {
+            // hand out what the last chunk produced
+            auto count = std::min(pending_, output_frames - generated);
+            for (size_t channel = 0; channel < channels_; ++channel) {
+                const auto* in
+                    = last.data() + channel * last_stride + pending_offset_;
+                auto* out = data.data_out + generated * channels_ + channel;
+                for (size_t frame = 0; frame < count; ++frame) {
+                    out[frame * channels_] = in[frame];
+                }
+            }
+            pending_ -= count;
+            pending_offset_ += count;
+            generated += count;
+            if (pending_ > 0) {
+                break;
+            }
+            if (used < input_frames) {
+                auto chunk = std::min(kChunk, input_frames - used);
+                auto& first = buffers_.front();
+                const auto* in = data.data_in + used * channels_;
+                for (size_t channel = 0; channel < channels_; ++channel) {
+                    auto* run = first.data() + channel * strides_.front();
+                    for (size_t frame = 0; frame < chunk; ++frame) {
+                        run[frame] = in[frame * channels_ + channel];
+                    }
+                }
+                run(chunk, false);
+                used += chunk;
+                continue;
+            }
+            if (!data.end_of_input || finished_) {
+                break;
+            }
+            finished_ = true;
+            run(0, true);
+        }
+        data.input_frames_used = static_cast<long>(used);
+        data.output_frames_gen = static_cast<long>(generated);
+        return ErrorNone;
+    }
+
+    // What PushConverter, PullConverter and the one-shot Convert drive: a
+    // libsamplerate SRC_STATE for the Sinc, ZeroOrderHold and Linear types,
+    // or for the Polyphase types a HalfBandCascade at power-of-two factors
+    // and a Polyphase otherwise.  All are fed through SRC_DATA and report
+    // libsamplerate or SRCpp error codes.  An engine created with
+    // a callback reads its input from it, as src_callback_new does.
+    class Engine {
+    public:
+        using Callback = long (*)(void*, float**);
+
+        Engine() = default;
+        ~Engine();
+        Engine(Engine&& other) noexcept;
+        auto operator=(Engine&& other) noexcept -> Engine&;
+
+        static auto create(SRCpp::Type type, int channels, double factor,
+            Callback callback = nullptr, void* user_data = nullptr) noexcept
+            -> std::pair<Engine, int>;
+        auto clone() const noexcept -> std::pair<Engine, int>;
+
+        auto process(SRC_DATA& data) noexcept -> int;
+        auto reset() noexcept -> int;
+        // Also checks, and for the Polyphase types designs for, factor.
+        auto reset(double factor) noexcept -> int;
+        // Moves the stream on to factor without starting a new one.  A Step
+        // applies now; a Ramp starts with the next process call, which
+        // passes the new factor in SRC_DATA.  Without may_allocate, a
+        // Polyphase engine only switches to a factor prepare() has readied
+        // and returns ErrorExceedsPrepared for any other.
+        auto set_ratio(double factor, RatioMode mode,
+            bool may_allocate = true) noexcept -> int;
+        // Readies a Polyphase engine to switch to each of factors without
+        // allocating or locking.  Factors it has no filter for, and those
+        // a half-band cascade converts, are left to the allocating path.
+        void prepare(std::span<const double> factors);
+        // Whether a Ramp actually ramps, rather than stepping.
+        auto ramps() const noexcept -> bool { return state_ != nullptr; }
+        // Whether a Ramp waits for the next process or read call, which
+        // ramps across all the output it is given.
+        auto ramp_pending() const noexcept -> bool { return ramp_pending_; }
+
+        // Output frames a stream holds back until later input arrives.  For
+        // the libsamplerate types this is worked out from their filters and
+        // can be a frame out.
+        auto latency() const noexcept -> size_t;
+
+        // Up to frames output frames, reading input from the callback.
+        // Returns the frames produced, or -1 with the cause in error().
+        auto read(double factor, long frames, float* output) noexcept -> long;
+        auto error() const noexcept -> int;
+
+    private:
+        SRC_STATE* state_ { nullptr };
+        std::unique_ptr<Polyphase> polyphase_;
+        std::unique_ptr<HalfBandCascade> halfband_;
+        SRCpp::Type type_ { SRCpp::Type::Sinc_BestQuality };
+        int channels_ { 0 };
+        // the factor a libsamplerate stream is at or ramping to; its state
+        // starts there, so the first call can ramp away from it
+        double ratio_ { 1.0 };
+        bool ramp_pending_ { false };
+        Callback callback_ { nullptr };
+        void* user_data_ { nullptr };
+        // the banks prepare() readied, by the factor each converts at
+        std::vector<std::pair<double, std::shared_ptr<const PolyphaseBank>>>
+            prepared_;
+        // input the callback handed over that has not been consumed yet
+        const float* saved_ { nullptr };
+        long saved_frames_ { 0 };
+        int error_ { ErrorNone };
+
+        auto native() const -> bool { return polyphase_ || halfband_; }
+        auto nativeFactor() const -> double
+        {
+            return polyphase_ ? polyphase_->factor() : halfband_->factor();
+        }
+        // Switches a native engine to factor.
+        auto retune(double factor) noexcept -> int;
+    };
+
+    inline Engine::~Engine() { src_delete(state_); }
+
+    inline Engine::Engine(Engine&& other) noexcept
+        : state_ { std::exchange(other.state_, nullptr) }
+        , polyphase_ { std::move(other.polyphase_) }
+        , halfband_ { std::move(other.halfband_) }
+        , type_ { other.type_ }
+        , channels_ { other.channels_ }
+        , ratio_ { other.ratio_ }
+        , ramp_pending_ { other.ramp_pending_ }
+        , callback_ { other.callback_ }
+        , user_data_ { other.user_data_ }
+        , prepared_ { std::move(other.prepared_) }
+        , saved_ { other.saved_ }
+        , saved_frames_ { other.saved_frames_ }
+        , error_ { other.error_ }
+    {
+    }
+
+    inline auto Engine::operator=(Engine&& other) noexcept -> Engine&
+    {
+        if (this != &other) {
+            src_delete(state_);
+            state_ = std::exchange(other.state_, nullptr);
+            polyphase_ = std::move(other.polyphase_);
+            halfband_ = std::move(other.halfband_);
+            type_ = other.type_;
+            channels_ = other.channels_;
+            ratio_ = other.ratio_;
+            ramp_pending_ = other.ramp_pending_;
+            callback_ = other.callback_;
+            user_data_ = other.user_data_;
+            prepared_ = std::move(other.prepared_);
+            saved_ = other.saved_;
+            saved_frames_ = other.saved_frames_;
+            error_ = other.error_;
+        }
+        return *this;
+    }
+
+    inline auto Engine::create(SRCpp::Type type, int channels, double factor,
+        Callback callback, void* user_data) noexcept -> std::pair<Engine, int>
+    {
+        auto engine = Engine {};
+        engine.type_ = type;
+        engine.channels_ = channels;
+        engine.ratio_ = factor;
+        engine.callback_ = callback;
+        engine.user_data_ = user_data;
+        if (!IsPolyphase(type)) {
+            auto error = 0;
+            engine.state_ = callback
+                ? src_callback_new(callback, static_cast<int>(type), channels,
+                      &error, user_data)
+                : src_new(static_cast<int>(type), channels, &error);
+            if (engine.state_ && src_is_valid_ratio(factor)) {
+                src_set_ratio(engine.state_, factor);
+            }
+            return { std::move(engine), error };
+        }
+        if (channels < 1) {
+            // the same error src_new reports
+            auto error = 0;
+            src_delete(src_new(SRC_LINEAR, channels, &error));
+            return { std::move(engine), error };
+        }
+        try {
+            if (PowerOfTwoExponent(factor) != 0) {
+                engine.halfband_ = std::make_unique<HalfBandCascade>(
+                    type, static_cast<size_t>(channels), factor);
+                return { std::move(engine), ErrorNone };
+            }
+            auto [bank, error] = PolyphaseBankFor(type, factor);
+            if (error != ErrorNone) {
+                return { std::move(engine), error };
+            }
+            engine.polyphase_ = std::make_unique<Polyphase>(
+                std::move(bank), static_cast<size_t>(channels), factor);
+        } catch (const std::bad_alloc&) {
+            return { std::move(engine), ErrorOutOfMemory };
+        }
+        return { std::move(engine), ErrorNone };
+    }
+
+    inline auto Engine::clone() const noexcept -> std::pair<Engine, int>
+    {
+        auto engine = Engine {};
+        engine.type_ = type_;
+        engine.channels_ = channels_;
+        engine.ratio_ = ratio_;
+        engine.ramp_pending_ = ramp_pending_;
+        if (native()) {
+            try {
+                if (polyphase_) {
+                    engine.polyphase_
+                        = std::make_unique<Polyphase>(*polyphase_);
+                    engine.prepared_ = prepared_;
+                } else {
+                    engine.halfband_
+                        = std::make_unique<HalfBandCascade>(*halfband_);
+                }
+            } catch (const std::bad_alloc&) {
+                return { std::move(engine), ErrorOutOfMemory };
+            }
+            return { std::move(engine), ErrorNone };
+        }
+        auto error = 0;
+        engine.state_ = src_clone(state_, &error);
+        return { std::move(engine), error };
+    }
+
+    inline auto Engine::retune(double factor) noexcept -> int
+    {
+        // from one Polyphase bank to another the stream carries on; a switch
+        // to or from a half-band cascade starts a new one
+        if (polyphase_ && PowerOfTwoExponent(factor) == 0) {
+            try {
+                auto [bank, error] = PolyphaseBankFor(type_, factor);
+                if (error != ErrorNone) {
+                    return error;
+                }
+                return polyphase_->retune(std::move(bank), factor);
+            } catch (const std::bad_alloc&) {
+                return ErrorOutOfMemory;
+            }
+        }
+        auto [engine, error]
+            = create(type_, channels_, factor, callback_, user_data_);
+        if (error != ErrorNone) {
+            return error;
+        }
+        polyphase_ = std::move(engine.polyphase_);
+        halfband_ = std::move(engine.halfband_);
+        return ErrorNone;
+    }
+
+    inline auto Engine::process(SRC_DATA& data) noexcept -> int
+    {
+        if (!native()) {
+            ratio_ = data.src_ratio;
+            ramp_pending_ = false;
+            return src_process(state_, &data);
+        }
+        if (data.src_ratio != nativeFactor()) {
+            if (auto error = retune(data.src_ratio); error != ErrorNone) {
+                return error;
+            }
+        }
+        return polyphase_ ? polyphase_->process(data)
+                          : halfband_->process(data);
+    }
+
+    inline auto Engine::reset() noexcept -> int
+    {
+        saved_ = nullptr;
+        saved_frames_ = 0;
+        error_ = ErrorNone;
+        ramp_pending_ = false;
+        if (polyphase_) {
+            polyphase_->reset();
+        } else if (halfband_) {
+            halfband_->reset();
+        } else if (auto error = src_reset(state_); error != 0) {
+            return error;
+        } else if (src_is_valid_ratio(ratio_)) {
+            return src_set_ratio(state_, ratio_);
+        }
+        return ErrorNone;
+    }
+
+    inline auto Engine::reset(double factor) noexcept -> int
+    {
+        if (native() && factor != nativeFactor()) {
+            if (auto error = retune(factor); error != ErrorNone) {
+                return error;
+            }
+        } else if (!src_is_valid_ratio(factor)) {
+            return ErrorBadFactor;
+        }
+        ratio_ = factor;
+        return reset();
+    }
+
+    inline auto Engine::set_ratio(
+        double factor, RatioMode mode, bool may_allocate) noexcept -> int
+    {
+        if (native()) {
+            if (factor == nativeFactor()) {
+                return ErrorNone;
+            }
+            if (may_allocate) {
+                return retune(factor);
+            }
+            if (!src_is_valid_ratio(factor)) {
+                return ErrorBadFactor;
+            }
+            // only banks prepare() readied, and the staging it reserved
+            if (polyphase_) {
+                for (const auto& [prepared, bank] : prepared_) {
+                    if (prepared == factor) {
+                        return polyphase_->retune(bank, factor, false);
+                    }
+                }
+            }
+            return ErrorExceedsPrepared;
+        }
+        if (!src_is_valid_ratio(factor)) {
+            return ErrorBadFactor;
+        }
+        ratio_ = factor;
+        ramp_pending_ = mode == RatioMode::Ramp;
+        return mode == RatioMode::Step ? src_set_ratio(state_, factor)
+                                       : ErrorNone;
+    }
+
+    inline void Engine::prepare(std::span<const double> factors)
+    {
+        if (!polyphase_) {
+            return;
+        }
+        // the bank in use stays readied too, so switching away and back
+        // never drops the last reference to it
+        auto ready = [this](double factor,
+                         std::shared_ptr<const PolyphaseBank> bank) {
+            for (const auto& [prepared, kept] : prepared_) {
+                if (prepared == factor) {
+                    return;
+                }
+            }
+            prepared_.emplace_back(factor, std::move(bank));
+        };
+        auto [current, current_error]
+            = PolyphaseBankFor(type_, polyphase_->factor());
+        if (current_error == ErrorOutOfMemory) {
+            throw std::bad_alloc {};
+        }
+        if (current) {
+            ready(polyphase_->factor(), std::move(current));
+        }
+        for (auto factor : factors) {
+            if (PowerOfTwoExponent(factor) != 0) {
+                continue;
+            }
+            auto [bank, error] = PolyphaseBankFor(type_, factor);
+            if (error == ErrorOutOfMemory) {
+                throw std::bad_alloc {};
+            }
+            if (bank) {
+                ready(factor, std::move(bank));
+            }
+        }
+        auto banks = std::vector<const PolyphaseBank*> {};
+        for (const auto& [prepared, bank] : prepared_) {
+            banks.push_back(bank.get());
+        }
+        polyphase_->reserve(banks);
+    }
+
+    // Output frames a libsamplerate stream of type holds back at factor.
+    // Each output waits for the input its filter reaches forward to: for
+    // the Sinc types half_length / increment input frames, more when
+    // decimating, and for the others the next input frame.  libsamplerate
+    // does not report this, so it is worked out from the sizes of its
+    // filters and can be a frame out.
+    inline auto LibsamplerateLatency(SRCpp::Type type, double factor) noexcept
+        -> size_t
+    {
+        if (!src_is_valid_ratio(factor)) {
+            return 0;
+        }
+        auto [half_length, increment] = [&]() -> std::pair<double, double> {
+            switch (type) {
+            case SRCpp::Type::Sinc_BestQuality:
+                return { 340239.0, 2381.0 };
+            case SRCpp::Type::Sinc_MediumQuality:
+                return { 22438.0, 491.0 };
+            case SRCpp::Type::Sinc_Fastest:
+                return { 2464.0, 128.0 };
+            default:
+                return { 0.0, 1.0 };
+            }
+        }();
+        auto reach = half_length / (increment * std::min(factor, 1.0));
+        auto frames = std::round(reach) + 1.0;
+        return static_cast<size_t>(std::ceil(frames * factor));
+    }
+
+    inline auto Engine::latency() const noexcept -> size_t
+    {
+        if (polyphase_) {
+            return polyphase_->latency();
+        }
+        if (halfband_) {
+            return halfband_->latency();
+        }
+        return LibsamplerateLatency(type_, ratio_);
+    }
+
+    inline auto Engine::read(double factor, long frames, float* output) noexcept
+        -> long
+    {
+        if (!native()) {
+            ratio_ = factor;
+            ramp_pending_ = false;
+            return src_callback_read(state_, factor, frames, output);
+        }
+        // src_callback_read's loop, over the native engine's process
+        auto data = SRC_DATA {};
+        data.src_ratio = factor;
+        data.data_in = saved_;
+        data.input_frames = saved_frames_;
+        long produced = 0;
+        while (produced < frames) {
+            if (data.input_frames == 0) {
+                float* input = nullptr;
+                data.input_frames = callback_(user_data_, &input);
+                data.data_in = input;
+                if (data.input_frames == 0) {
+                    data.end_of_input = 1;
+                }
+            }
+            data.data_out = output + produced * channels_;
+            data.output_frames = frames - produced;
+            if (auto result = process(data); result != ErrorNone) {
+                error_ = result;
+                return -1;
+            }
+            data.data_in += data.input_frames_used * channels_;
+            data.input_frames -= data.input_frames_used;
+            produced += data.output_frames_gen;
+            if (data.end_of_input && data.output_frames_gen == 0) {
+                break;
+            }
+        }
+        saved_ = data.data_in;
+        saved_frames_ = data.input_frames;
+        return produced;
+    }
+
+    inline auto Engine::error() const noexcept -> int
+    {
+        return native() ? error_ : src_error(state_);
+    }
+}
+
+class PushConverter {
+public:
+    // Buffers come from resource, 64-byte aligned.  It must outlive the
+    // converter and any copy of it.
+    PushConverter(SRCpp::Type type, int channels, double factor,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    ~PushConverter();
+    PushConverter(const PushConverter& other);
+    auto operator=(const PushConverter& other) -> PushConverter&;
+    PushConverter(PushConverter&& other) noexcept;
+    auto operator=(PushConverter&& other) noexcept -> PushConverter&;
+
+    // For real-time threads: create() reports errors instead of throwing,
+    // and once prepare() has sized the internal buffers the *_noalloc calls
+    // never allocate.  Those return 0 or an error code (see StrError).
+    static auto create(SRCpp::Type type, int channels, double factor,
+        std::pmr::memory_resource* resource
+        = std::pmr::get_default_resource()) noexcept
+        -> std::pair<std::optional<PushConverter>, int>;
+
+    // factors are those a per-call factor may switch to; a Polyphase type
+    // designs their filters now, so convert_noalloc can reach them.
+    void prepare(size_t max_input_frames, size_t max_output_frames,
+        std::span<const double> factors = {});
+
+    // Drops staged input and converter history so the next call starts a new
+    // stream, keeping buffer capacity.  The second form also changes the
+    // factor.  Returns 0 or an error code.
+    auto reset() noexcept -> int;
+    auto reset(double factor) noexcept -> int;
+
+    // Output frames the converter holds back until later input, or flush,
+    // completes them.  Output is aligned with the input, so this is how far
+    // it runs behind, not a delay at its start.
+    auto latency_frames() const noexcept -> size_t
+    {
+        return engine_.latency();
+    }
+
+    // Room for everything a convert of input_frames more frames can produce,
+    // including input staged and output held back from earlier calls.  With
+    // 0, room for the flush.
+    auto max_output_frames(size_t input_frames) const noexcept -> size_t;
+
+    // Output frames a stream of total_input_frames produces, flush included,
+    // at the current factor.
+    auto expected_output_frames(size_t total_input_frames) const noexcept
+        -> size_t;
+
+    // Changes the factor mid-stream, keeping the filter history, for
+    // varispeed or drift correction.  Only a Polyphase type meeting a
+    // factor it has no filter for yet allocates; convert_noalloc with a
+    // factor refuses those instead.  Returns 0 or an error code.
+    auto set_ratio(double factor, RatioMode mode = RatioMode::Step) noexcept
+        -> int;
+    auto ratio() const noexcept -> double { return factor_; }
+
+    template <SupportedSampleType To, SupportedSampleType From>
+    auto convert_noalloc(std::span<const From> input,
+        std::span<To> output) noexcept -> std::pair<std::span<To>, int>;
+
+    // set_ratio(factor, mode) and then convert, so each block can carry its
+    // own factor.
+    template <SupportedSampleType To, SupportedSampleType From>
+    auto convert_noalloc(std::span<const From> input, std::span<To> output,
+        double factor, RatioMode mode = RatioMode::Ramp) noexcept
+        -> std::pair<std::span<To>, int>;
+
+    template <SupportedSampleType To>
+    auto flush_noalloc(std::span<To> output) noexcept
+        -> std::pair<std::span<To>, int>;
+
+    template <SupportedSampleType To, SupportedSampleType From>
+    auto convert_noalloc(PlanarSpan<const From> input,
+        PlanarSpan<To> output) noexcept -> std::pair<PlanarSpan<To>, int>;
+
+    template <SupportedSampleType To>
+    auto flush_noalloc(PlanarSpan<To> output) noexcept
+        -> std::pair<PlanarSpan<To>, int>;
+
+#if SRCPP_USE_CPP23
+    template <SupportedSampleType To, SupportedSampleType From>
+    auto convert_expected(std::span<const From> input, std::span<To> output)
+        -> std::expected<std::span<To>, std::string>;
+
+    template <SupportedSampleType To, SupportedSampleType From>
+    auto convert_expected(PlanarSpan<const From> input, PlanarSpan<To> output)
+        -> std::expected<PlanarSpan<To>, std::string>;
+
+    template <SupportedSampleType To, SupportedSampleType From>
+    auto convert_expected(std::span<const From> input)
+        -> std::expected<std::vector<To>, std::string>;
+
+    template <SupportedSampleType To>
+    auto flush_expected() -> std::expected<std::vector<To>, std::string>;
+
+    auto convert_unsafe_expected(Format from, const void* input,
+        size_t input_size, Format to, void* output, size_t output_size)
+        -> std::expected<size_t, std::string>;
+
+    auto convert_unsafe_expected(
+        Format from, const void* input, size_t input_size, Format to)
+        -> std::expected<std::vector<std::byte>, std::string>;
+#endif // SRCPP_USE_CPP23
+
+    template <SupportedSampleType To, SupportedSampleType From>
+    auto convert(std::span<const From> input, std::span<To> output)
+        -> std::pair<std::optional<std::span<To>>, std::string>;
+
+    template <SupportedSampleType To, SupportedSampleType From>
+    auto convert(std::span<const From> input)
+        -> std::pair<std::optional<std::vector<To>>, std::string>;
+
+    // As convert_noalloc with a factor.
+    template <SupportedSampleType To, SupportedSampleType From>
+    auto convert(std::span<const From> input, std::span<To> output,
+        double factor, RatioMode mode = RatioMode::Ramp)
+        -> std::pair<std::optional<std::span<To>>, std::string>;
+
+    template <SupportedSampleType To, SupportedSampleType From>
+    auto convert(std::span<const From> input, double factor,
+        RatioMode mode = RatioMode::Ramp)
+        -> std::pair<std::optional<std::vector<To>>, std::string>;
+
+    // Takes ownership of input.  Whatever libsamplerate leaves unconsumed
+    // stays staged in the caller's buffer instead of being copied.
+    template <SupportedSampleType To>
+    auto convert(std::vector<float>&& input, std::span<To> output)
+        -> std::pair<std::optional<std::span<To>>, std::string>;
+
+    template <SupportedSampleType To>
+    auto convert(std::vector<float>&& input)
+        -> std::pair<std::optional<std::vector<To>>, std::string>;
+
+    template <SupportedSampleType To>
+    auto flush() -> std::pair<std::optional<std::vector<To>>, std::string>;
+
+    // Append the output to output instead of writing into a sized span, so
+    // its capacity carries over from call to call and nothing is
+    // value-initialized first.  Return the samples appended.
+    template <SupportedSampleType To, SupportedSampleType From,
+        typename Allocator>
+    auto convert_into(
+        std::span<const From> input, std::vector<To, Allocator>& output)
+        -> std::pair<std::optional<std::span<To>>, std::string>;
+
+    template <SupportedSampleType To, typename Allocator>
+    auto flush_into(std::vector<To, Allocator>& output)
+        -> std::pair<std::optional<std::span<To>>, std::string>;
+
+    // Through an output iterator, returned advanced past the last sample.
+    template <SupportedSampleType To, SupportedSampleType From,
+        std::output_iterator<const To&> OutputIt>
+    auto convert_into(std::span<const From> input, OutputIt output)
+        -> std::pair<std::optional<OutputIt>, std::string>;
+
+    template <SupportedSampleType To, std::output_iterator<const To&> OutputIt>
+    auto flush_into(OutputIt output)
+        -> std::pair<std::optional<OutputIt>, std::string>;
+
+    // Planar input and output, with the converter's channel count.
+    // Interleaving and format conversion happen as the input is staged and
+    // as the output is written, with no separate pass.
+    template <SupportedSampleType To, SupportedSampleType From>
+    auto convert(PlanarSpan<const From> input, PlanarSpan<To> output)
+        -> std::pair<std::optional<PlanarSpan<To>>, std::string>;
+
+    template <SupportedSampleType To>
+    auto flush(PlanarSpan<To> output)
+        -> std::pair<std::optional<PlanarSpan<To>>, std::string>;
+
+    auto convert_unsafe(Format from, const void* input, size_t input_size,
+        Format to, void* output, size_t output_size)
+        -> std::pair<std::optional<size_t>, std::string>;
+
+    auto convert_unsafe(
+        Format from, const void* input, size_t input_size, Format to)
+        -> std::pair<std::optional<std::vector<std::byte>>, std::string>;
+
+#if SRCPP_USE_CPP23
+    template <typename ToContainer, typename FromContainer,
+        SupportedSampleType To = typename ToContainer::value_type,
+        SupportedSampleType From = typename FromContainer::value_type>
+    auto convert_expected(FromContainer const& input, ToContainer& output)
+    {
+        return convert_expected<To, From>(
+            std::span<const From> { input }, std::span<To> { output });
+    }
+
+    template <SupportedSampleType To, typename FromContainer,
+        SupportedSampleType From = typename FromContainer::value_type>
+    auto convert_expected(FromContainer const& input)
+    {
+        return convert_expected<To, From>(std::span<const From> { input });
+    }
+#endif // SRCPP_USE_CPP23
+
+    template <typename ToContainer, typename FromContainer,
+        SupportedSampleType To = typename ToContainer::value_type,
+        SupportedSampleType From = typename FromContainer::value_type>
+    auto convert(FromContainer const& input, ToContainer& output)
+    {
+        return convert(
+            std::span<const From> { input }, std::span<To> { output });
+    }
+
+    template <SupportedSampleType To, typename FromContainer,
+        SupportedSampleType From = typename FromContainer::value_type>
+    auto convert(FromContainer const& input)
+    {
+        return convert<To, From>(std::span<const From> { input });
+    }
+
+    template <typename ToContainer, typename FromContainer,
+        SupportedSampleType To = typename ToContainer::value_type,
+        SupportedSampleType From = typename FromContainer::value_type>
+    auto convert(FromContainer const& input, ToContainer& output,
+        double factor, RatioMode mode = RatioMode::Ramp)
+    {
+        return convert(std::span<const From> { input },
+            std::span<To> { output }, factor, mode);
+    }
+
+    template <SupportedSampleType To, typename FromContainer,
+        SupportedSampleType From = typename FromContainer::value_type>
+    auto convert(FromContainer const& input, double factor,
+        RatioMode mode = RatioMode::Ramp)
+    {
+        return convert<To, From>(
+            std::span<const From> { input }, factor, mode);
+    }
+
+    template <typename ToContainer,
+        SupportedSampleType To = typename ToContainer::value_type>
+    auto convert(std::vector<float>&& input, ToContainer& output)
+    {
+        return convert(std::move(input), std::span<To> { output });
+    }
+
+    template <typename FromContainer, SupportedSampleType To,
+        typename Allocator,
+        SupportedSampleType From = typename FromContainer::value_type>
+    auto convert_into(
+        FromContainer const& input, std::vector<To, Allocator>& output)
+    {
+        return convert_into(std::span<const From> { input }, output);
+    }
+
+    template <SupportedSampleType To, typename FromContainer,
+        std::output_iterator<const To&> OutputIt,
+        SupportedSampleType From = typename FromContainer::value_type>
+    auto convert_into(FromContainer const& input, OutputIt output)
+    {
+        return convert_into<To>(std::span<const From> { input }, output);
+    }
+
+    template <typename ToContainer, typename FromContainer,
+        SupportedSampleType To = typename ToContainer::value_type,
+        SupportedSampleType From = typename FromContainer::value_type>
+    auto convert_noalloc(FromContainer const& input, ToContainer& output) noexcept
+    {
+        return convert_noalloc(
+            std::span<const From> { input }, std::span<To> { output });
+    }
+
+    template <typename ToContainer,
+        SupportedSampleType To = typename ToContainer::value_type>
+    auto flush_noalloc(ToContainer& output) noexcept
+    {
+        return flush_noalloc(std::span<To> { output });
+    }
+
+    template <SupportedSampleType To, SupportedSampleType From>
+    auto convert(PlanarSpan<From> input, PlanarSpan<To> output)
+    {
+        return convert(PlanarSpan<const From> { input }, output);
+    }
+
+    template <SupportedSampleType To, SupportedSampleType From>
+    auto convert_noalloc(PlanarSpan<From> input, PlanarSpan<To> output) noexcept
+    {
+        return convert_noalloc(PlanarSpan<const From> { input }, output);
+    }
+
+private:
+    details::Engine engine_;
+    SRCpp::Type type_ { SRC_SINC_BEST_QUALITY };
+    int channels_ { 0 };
+    double factor_ { 1.0 };
+    const float dummy_ {};
+    details::StagingBuffer reserved_input_;
+    details::AlignedBuffer<float> last_input_;
+    details::AlignedBuffer<float> scratch_output_;
+    // output the consumed input should produce, at the largest factor each
+    // call may have run at
+    double expected_frames_ { 0.0 };
+    size_t output_frames_produced_ { 0 };
+    // the largest factor a pending ramp passes through
+    double peak_factor_ { 1.0 };
+
+    PushConverter(details::Engine engine, SRCpp::Type type, int channels,
+        double factor, std::pmr::memory_resource* resource);
+
+    // What a pass through libsamplerate left unconsumed and produced.
+    struct Processed {
+        std::span<const float> unused;
+        std::span<float> produced;
+    };
+
+    auto process(
+        std::span<const float> input, std::span<float> output, bool end)
+        -> std::pair<Processed, int>;
+    auto convertWithFixFor208(
+        std::span<const float> input, std::span<float> output, bool end)
+        -> std::pair<Processed, int>;
+
+    auto setRatio(double factor, RatioMode mode, bool may_allocate) noexcept
+        -> int;
+    // Shared by convert and convert_noalloc; returns 0 or an error code.
+    // Input and Output are interleaved spans or PlanarSpans.
+    template <typename Output, typename Input>
+    auto convertWith(Input input, Output output, bool may_allocate)
+        -> std::pair<Output, int>;
+    template <SupportedSampleType From>
+    void stageInput(std::span<const From> input);
+    template <SupportedSampleType From>
+    void stageInput(PlanarSpan<const From> input);
+    template <SupportedSampleType To>
+    auto outputScratch(std::span<To> output, bool may_allocate)
+        -> std::span<float>;
+    template <SupportedSampleType To>
+    auto outputScratch(PlanarSpan<To> output, bool may_allocate)
+        -> std::span<float>;
+    template <SupportedSampleType To>
+    auto finishOutput(std::span<float> produced, std::span<To> output)
+        -> std::span<To>;
+    template <SupportedSampleType To>
+    auto finishOutput(std::span<float> produced, PlanarSpan<To> output)
+        -> PlanarSpan<To>;
+    // convert_into's sinks take output a cache-sized block of scratch at a
+    // time, so it is written once, straight onto their end.
+    template <SupportedSampleType To, typename Append>
+    auto outputScratch(details::SampleSink<To, Append>& output, bool)
+        -> std::span<float>;
+    template <SupportedSampleType To, typename Append>
+    void finishOutput(
+        std::span<float> produced, details::SampleSink<To, Append>& output);
+};
+
+class PullConverter {
+public:
+    // using callback_t = std::function<std::span<From>()>;
+    // Buffers come from resource, as PushConverter's do.
+    template <typename Callback>
+    PullConverter(Callback&& callback, SRCpp::Type type, int channels,
+        double factor,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    ~PullConverter();
+
+    template <SupportedSampleType From>
+    PullConverter(std::span<From> (*func)(void*), void* context,
+        SRCpp::Type type, int channels, double factor,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : PullConverter([func, context]() { return func(context); }, type,
+              channels, factor, resource)
+    {
+        static_assert(SupportedSampleType<From>,
+            "Function must return std::span<From> where From is short, int, or "
+            "float");
+    }
+
+    template <SupportedSampleType From>
+    PullConverter(PlanarSpan<From> (*func)(void*), void* context,
+        SRCpp::Type type, int channels, double factor,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : PullConverter([func, context]() { return func(context); }, type,
+              channels, factor, resource)
+    {
+    }
+
+    PullConverter(PullConverter&& other) noexcept;
+    auto operator=(PullConverter&& other) noexcept -> PullConverter&;
+
+    // As PushConverter::latency_frames.
+    auto latency_frames() const noexcept -> size_t
+    {
+        return engine_.latency();
+    }
+
+    // Room for everything a convert can produce once the callback has
+    // supplied input_frames more frames, including output held back from
+    // earlier input.
+    auto max_output_frames(size_t input_frames) const noexcept -> size_t;
+
+    // As PushConverter::expected_output_frames.
+    auto expected_output_frames(size_t total_input_frames) const noexcept
+        -> size_t;
+
+    // As PushConverter::set_ratio.  A Ramp runs across the next convert's
+    // output.
+    auto set_ratio(double factor, RatioMode mode = RatioMode::Step) noexcept
+        -> int;
+    auto ratio() const noexcept -> double { return factor_; }
 
 #if SRCPP_USE_CPP23
     template <SupportedSampleType To>
@@ -490,72 +4412,252 @@ public:
 
     auto convert_unsafe_expected(Format to, void* output, size_t output_size)
         -> std::expected<size_t, std::string>;
+
+    template <SupportedSampleType To>
+    auto convert_expected(PlanarSpan<To> output)
+        -> std::expected<PlanarSpan<To>, std::string>;
 #endif // SRCPP_USE_CPP23
 
     template <SupportedSampleType To>
     auto convert(std::span<To> output)
         -> std::pair<std::optional<std::span<To>>, std::string>;
 
+    // set_ratio(factor, mode) and then convert(output).
+    template <SupportedSampleType To>
+    auto convert(std::span<To> output, double factor,
+        RatioMode mode = RatioMode::Ramp)
+        -> std::pair<std::optional<std::span<To>>, std::string>;
+
+    // Planar output, with the converter's channel count.
+    template <SupportedSampleType To>
+    auto convert(PlanarSpan<To> output)
+        -> std::pair<std::optional<PlanarSpan<To>>, std::string>;
+
     auto convert_unsafe(Format to, void* output, size_t output_size)
         -> std::pair<std::optional<size_t>, std::string>;
 
-#if SRCPP_USE_CPP23
-    template <typename ToContainer,
-        SupportedSampleType To = typename ToContainer::value_type>
-    auto convert_expected(ToContainer& output)
+    // Append up to frames frames of output to output, or through an output
+    // iterator, as PushConverter::convert_into.
+    template <SupportedSampleType To, typename Allocator>
+    auto convert_into(size_t frames, std::vector<To, Allocator>& output)
+        -> std::pair<std::optional<std::span<To>>, std::string>;
+
+    template <SupportedSampleType To, std::output_iterator<const To&> OutputIt>
+    auto convert_into(size_t frames, OutputIt output)
+        -> std::pair<std::optional<OutputIt>, std::string>;
+
+#if SRCPP_USE_CPP23
+    template <typename ToContainer,
+        SupportedSampleType To = typename ToContainer::value_type>
+    auto convert_expected(ToContainer& output)
+    {
+        return convert_expected<To>(std::span<To> { output });
+    }
+#endif // SRCPP_USE_CPP23
+
+    template <typename ToContainer,
+        SupportedSampleType To = typename ToContainer::value_type>
+    auto convert(ToContainer& output)
+    {
+        return convert(std::span<To> { output });
+    }
+
+    template <typename ToContainer,
+        SupportedSampleType To = typename ToContainer::value_type>
+    auto convert(
+        ToContainer& output, double factor, RatioMode mode = RatioMode::Ramp)
+    {
+        return convert(std::span<To> { output }, factor, mode);
+    }
+
+private:
+    struct CallbackHandle {
+        virtual ~CallbackHandle() = default;
+        virtual auto handle_callback(float** data) -> long = 0;
+    };
+    template <typename Callback> struct CallbackHandleImpl : CallbackHandle {
+        CallbackHandleImpl(Callback&& callback, int channels, SRCpp::Type type,
+            std::pmr::memory_resource* resource)
+            : callback_(std::forward<Callback>(callback))
+            , channels_(channels)
+            , type_(type)
+            , scratch_input_(resource)
+            , last_input_(channels_, resource)
+        {
+            static_assert(
+                std::is_invocable_r_v<std::span<typename std::invoke_result_t<
+                                          Callback>::value_type>,
+                    Callback>
+                    || details::IsPlanarSpan<
+                        std::invoke_result_t<Callback>>::value,
+                "Callback must be callable with no arguments and return "
+                "std::span or SRCpp::PlanarSpan of SupportedSampleType");
+            static_assert(
+                SupportedSampleType<
+                    typename std::invoke_result_t<Callback>::value_type>,
+                "Callback must return std::span<T> or SRCpp::PlanarSpan<T> "
+                "where T is short, int, or float");
+        }
+        auto handle_callback(float** data) -> long;
+
+    private:
+        Callback callback_;
+        float dummy_ {};
+        int channels_ { 0 };
+        SRCpp::Type type_;
+        details::AlignedBuffer<float> scratch_input_;
+        details::AlignedBuffer<float> last_input_;
+    };
+    std::unique_ptr<CallbackHandle> callback_;
+    details::AlignedBuffer<float> scratch_output_;
+    details::Engine engine_;
+    double factor_ { 1.0 };
+    int channels_ { 0 };
+
+    // Reads up to frames frames onto the end of sink a cache-sized block
+    // at a time, as PushConverter's convert_into does; returns 0 or an
+    // error code.
+    template <SupportedSampleType To, typename Append>
+    auto readInto(size_t frames, details::SampleSink<To, Append>& sink)
+        -> int;
+};
+
+// A converter whose rates, channel count and Polyphase type are fixed at
+// compile time.  Its filter is designed by constexpr code into a read-only
+// table and its state lives in the object, so it costs nothing to create
+// and never allocates.  Each call converts all of its input, so output must
+// have room for output_frames() frames.
+template <size_t InRate, size_t OutRate, size_t Channels,
+    SRCpp::Type Quality = SRCpp::Type::Polyphase_BestQuality>
+class FixedRatioConverter {
+    static_assert(InRate > 0 && OutRate > 0 && Channels > 0,
+        "Rates and channel count must be positive");
+    static_assert(details::IsPolyphase(Quality),
+        "FixedRatioConverter needs one of the Polyphase types");
+    static_assert(OutRate <= 256 * InRate && InRate <= 256 * OutRate,
+        "Conversion factor is outside what libsamplerate supports");
+
+    static constexpr size_t kUp = OutRate / std::gcd(InRate, OutRate);
+    static constexpr size_t kDown = InRate / std::gcd(InRate, OutRate);
+    static_assert(kUp <= details::kMaxPolyphasePhases,
+        "Polyphase types need a factor of up / down with up at most 1024");
+
+public:
+    static constexpr SRCpp::Type type = Quality;
+    static constexpr size_t channels = Channels;
+    static constexpr double factor
+        = static_cast<double>(OutRate) / static_cast<double>(InRate);
+
+    FixedRatioConverter() noexcept { reset(); }
+
+    // Frames the next convert of input_frames frames produces, or the next
+    // flush when input_frames is 0.
+    auto output_frames(size_t input_frames) const noexcept -> size_t;
+
+    void reset() noexcept;
+
+    template <SupportedSampleType To, SupportedSampleType From>
+    auto convert_noalloc(std::span<const From> input,
+        std::span<To> output) noexcept -> std::pair<std::span<To>, int>;
+
+    template <SupportedSampleType To>
+    auto flush_noalloc(std::span<To> output) noexcept
+        -> std::pair<std::span<To>, int>;
+
+    template <SupportedSampleType To, SupportedSampleType From>
+    auto convert(std::span<const From> input, std::span<To> output)
+        -> std::pair<std::optional<std::span<To>>, std::string>;
+
+    template <SupportedSampleType To, SupportedSampleType From>
+    auto convert(std::span<const From> input)
+        -> std::pair<std::optional<std::vector<To>>, std::string>;
+
+    template <SupportedSampleType To>
+    auto flush() -> std::pair<std::optional<std::vector<To>>, std::string>;
+
+    template <typename ToContainer, typename FromContainer,
+        SupportedSampleType To = typename ToContainer::value_type,
+        SupportedSampleType From = typename FromContainer::value_type>
+    auto convert(FromContainer const& input, ToContainer& output)
+    {
+        return convert(
+            std::span<const From> { input }, std::span<To> { output });
+    }
+
+    template <SupportedSampleType To, typename FromContainer,
+        SupportedSampleType From = typename FromContainer::value_type>
+    auto convert(FromContainer const& input)
+    {
+        return convert<To, From>(std::span<const From> { input });
+    }
+
+    template <typename ToContainer, typename FromContainer,
+        SupportedSampleType To = typename ToContainer::value_type,
+        SupportedSampleType From = typename FromContainer::value_type>
+    auto convert_noalloc(FromContainer const& input, ToContainer& output) noexcept
     {
-        return convert_expected<To>(std::span<To> { output });
+        return convert_noalloc(
+            std::span<const From> { input }, std::span<To> { output });
     }
-#endif // SRCPP_USE_CPP23
 
     template <typename ToContainer,
         SupportedSampleType To = typename ToContainer::value_type>
-    auto convert(ToContainer& output)
+    auto flush_noalloc(ToContainer& output) noexcept
     {
-        return convert(std::span<To> { output });
+        return flush_noalloc(std::span<To> { output });
     }
 
 private:
-    struct CallbackHandle {
-        virtual ~CallbackHandle() = default;
-        virtual auto handle_callback(float** data) -> long = 0;
-    };
-    template <typename Callback> struct CallbackHandleImpl : CallbackHandle {
-        CallbackHandleImpl(Callback&& callback, int channels, SRCpp::Type type)
-            : callback_(std::forward<Callback>(callback))
-            , channels_(channels)
-            , type_(type)
-            , last_input_(channels_)
-        {
-            static_assert(
-                std::is_invocable_r_v<std::span<typename std::invoke_result_t<
-                                          Callback>::value_type>,
-                    Callback>,
-                "Callback must be callable with no arguments and return "
-                "std::span of SupportedSampleType");
-            static_assert(
-                SupportedSampleType<
-                    typename std::invoke_result_t<Callback>::value_type>,
-                "Callback must return std::span<T> where T is short, int, or "
-                "float");
-        }
-        auto handle_callback(float** data) -> long;
+    using Bank = details::FixedPolyphaseBank<Quality, kUp, kDown>;
+    static constexpr size_t kTaps = Bank::shape.taps;
+    static constexpr size_t kDelay = Bank::shape.delay;
+    // frames per channel the staging holds beyond the filter's history, and
+    // frames converted to or from float at a time
+    static constexpr size_t kCapacity
+        = kTaps - 1 + std::max<size_t>(256, kTaps + kDown / kUp);
+    static constexpr size_t kBlock = 64;
+
+    // planar history, channel c from c * kCapacity, as in the Polyphase
+    // engine
+    std::array<float, Channels * kCapacity> history_ {};
+    int64_t base_ { 0 };
+    size_t length_ { 0 };
+    uint64_t next_ { 0 };
+    int64_t newest_ { 0 };
+    size_t phase_ { 0 };
 
-    private:
-        Callback callback_;
-        float dummy_ {};
-        int channels_ { 0 };
-        SRCpp::Type type_;
-        std::vector<float> scratch_input_;
-        std::vector<float> last_input_;
-    };
-    std::unique_ptr<CallbackHandle> callback_;
-    std::vector<float> scratch_output_;
-    SRC_STATE* state_ { nullptr };
-    double factor_ { 1.0 };
-    int channels_ { 0 };
+    template <SupportedSampleType To, SupportedSampleType From>
+    auto process(std::span<const From> input, std::span<To> output) noexcept
+        -> std::pair<std::span<To>, int>;
+    auto drain(float* output, uint64_t stop) noexcept -> size_t;
+    template <SupportedSampleType To>
+    auto emit(To* output, uint64_t stop) noexcept -> size_t;
+    template <SupportedSampleType From>
+    void append(const From* input, size_t frames) noexcept;
+    void discardHistory() noexcept;
 };
 
+#if SRCPP_USE_GENERATOR
+namespace details {
+    // A range whose elements are contiguous ranges of samples.
+    template <typename Chunks>
+    concept SampleChunkRange = std::ranges::input_range<Chunks>
+        && std::ranges::contiguous_range<std::ranges::range_reference_t<Chunks>>
+        && SupportedSampleType<std::remove_cv_t<std::ranges::range_value_t<
+            std::ranges::range_reference_t<Chunks>>>>;
+}
+
+// Converts chunks of interleaved input lazily through a PushConverter,
+// yielding each chunk's output as it is converted and the flush after the
+// last chunk.  Each yielded span refers to a buffer the next block reuses.
+// Bad arguments throw std::runtime_error from the call; a conversion error
+// throws it from the iteration that meets it.
+template <SupportedSampleType To = float, std::ranges::viewable_range Chunks>
+    requires details::SampleChunkRange<Chunks>
+auto resample_stream(Chunks&& chunks, SRCpp::Type type, int channels,
+    double factor) -> std::generator<std::span<const To>>;
+#endif // SRCPP_USE_GENERATOR
+
 // Implementation details
 #if SRCPP_USE_CPP23
 template <SupportedSampleType To, SupportedSampleType From>
@@ -576,7 +4678,7 @@ inline auto Convert_expected(std::span<const From> input, SRCpp::Type type,
 {
     auto [result, error] = Convert<To, From>(input, type, channels, factor);
     if (result.has_value()) {
-        return *result;
+        return std::move(*result);
     }
     return std::unexpected(error);
 }
@@ -600,6 +4702,18 @@ inline auto Convert_unsafe_expected(Format from, const void* input,
 {
     auto [result, error]
         = Convert_unsafe(from, input, input_size, to, type, channels, factor);
+    if (result.has_value()) {
+        return std::move(*result);
+    }
+    return std::unexpected(error);
+}
+
+template <SupportedSampleType To, SupportedSampleType From>
+inline auto Convert_expected(PlanarSpan<const From> input,
+    PlanarSpan<To> output, SRCpp::Type type, double factor)
+    -> std::expected<PlanarSpan<To>, std::string>
+{
+    auto [result, error] = Convert<To, From>(input, output, type, factor);
     if (result.has_value()) {
         return *result;
     }
@@ -608,62 +4722,158 @@ inline auto Convert_unsafe_expected(Format from, const void* input,
 
 #endif // SRCPP_USE_CPP23
 
+namespace details {
+    // Samples staged per block by the one-shot Convert when the input or
+    // output needs a format conversion; small enough to stay in cache.
+    inline constexpr size_t kConvertBlockSamples = 8192;
+
+    // One-shot conversion that streams through a fixed-size float block
+    // instead of converting the whole input (and output) up front.  A single
+    // Engine sees the same sample stream src_simple would, so the output
+    // matches it.  Input and Output are interleaved spans or PlanarSpans;
+    // returns the frames written.  The first discard_frames frames of output
+    // are thrown away rather than written.  The blocks come from resource.
+    template <typename Output, typename Input>
+    inline auto ConvertInBlocks(Input input, Output output, SRCpp::Type type,
+        int channels, double factor, size_t discard_frames = 0,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        -> std::pair<std::optional<size_t>, std::string>
+    {
+        // only interleaved float output can be handed to libsamplerate as is
+        constexpr auto in_place = std::is_same_v<Output, std::span<float>>;
+
+        auto [engine, error] = Engine::create(type, channels, factor);
+        if (error != 0) {
+            return { std::nullopt, StrError(error) };
+        }
+
+        auto frame = static_cast<size_t>(channels);
+        auto block_frames = std::max<size_t>(kConvertBlockSamples / frame, 1);
+        // The first frame holds the frame before the staged input, so the
+        // linear converter always has real history to read.
+        // https://github.com/libsndfile/libsamplerate/issues/208
+        AlignedBuffer<float> staging((block_frames + 1) * frame, resource);
+        // room for roughly one block's worth of output, so upsampling does
+        // not leave most of the staged input waiting on the next pass.
+        AlignedBuffer<float> scratch(resource);
+        if (!in_place || discard_frames > 0) {
+            auto growth = std::clamp(std::ceil(factor), 1.0, 16.0);
+            scratch.resize(block_frames * static_cast<size_t>(growth) * frame);
+        }
+
+        auto input_frames = FrameCount(input, frame);
+        auto output_samples = SampleCount(output, frame);
+        auto fed = size_t { 0 };
+        auto staged = size_t { 0 };
+        auto written = size_t { 0 };
+        auto discarded = size_t { 0 };
+        while (true) {
+            // top up the staging block, converting to float on the way in
+            auto count = std::min(block_frames - staged, input_frames - fed);
+            ReadFrames(input, frame, fed, count,
+                staging.data() + (staged + 1) * frame);
+            fed += count;
+            staged += count;
+
+            auto discarding = discarded < discard_frames;
+            auto out = [&]() -> std::span<float> {
+                if (discarding) {
+                    return std::span { scratch }.first(std::min(
+                        (discard_frames - discarded) * frame, scratch.size()));
+                }
+                auto remaining = output_samples - written;
+                if constexpr (in_place) {
+                    return output.subspan(written, remaining);
+                } else {
+                    return std::span { scratch }.first(
+                        std::min(remaining, scratch.size()));
+                }
+            }();
+            if (out.size() < frame) {
+                break;
+            }
+            auto src_data = SRC_DATA {
+                staging.data() + frame,
+                out.data(),
+                static_cast<long>(staged),
+                static_cast<long>(out.size() / frame),
+                0,
+                0,
+                fed == input_frames,
+                factor,
+            };
+            if (auto result = engine.process(src_data); result != 0) {
+                return { std::nullopt, StrError(result) };
+            }
+            auto used = static_cast<size_t>(src_data.input_frames_used);
+            auto generated
+                = static_cast<size_t>(src_data.output_frames_gen) * frame;
+
+            // convert from float to output format
+            if (discarding) {
+                discarded += generated / frame;
+            } else {
+                if constexpr (!in_place) {
+                    WriteFrames(
+                        out.first(generated), output, frame, written / frame);
+                }
+                written += generated;
+            }
+
+            // keep the last consumed frame as history, shift the rest down
+            if (used) {
+                std::copy(staging.begin() + used * frame,
+                    staging.begin() + (staged + 1) * frame, staging.begin());
+                staged -= used;
+            }
+            // src_simple stops once a call with end_of_input set returns
+            // with room to spare, even if the converter left input behind.
+            if (src_data.end_of_input && generated < out.size()) {
+                break;
+            }
+            if (used == 0 && generated == 0) {
+                break;
+            }
+        }
+        return { written / frame, {} };
+    }
+}
+
 template <SupportedSampleType To, SupportedSampleType From>
 inline auto Convert(std::span<const From> input, std::span<To> output,
     SRCpp::Type type, int channels, double factor)
     -> std::pair<std::optional<std::span<To>>, std::string>
 {
-    // convert input format to Float
-    if constexpr (std::is_same_v<From, short>) {
-        std::vector<float> converted_input(input.size());
-        src_short_to_float_array(
-            input.data(), converted_input.data(), input.size());
-        return Convert(converted_input, output, type, channels, factor);
-    } else if constexpr (std::is_same_v<From, int>) {
-        std::vector<float> converted_input(input.size());
-        src_int_to_float_array(
-            input.data(), converted_input.data(), input.size());
-        return Convert(converted_input, output, type, channels, factor);
-    } else {
-        std::vector<float> data;
-        float* outputData = nullptr;
-        auto outputSize = output.size();
-        if constexpr (!std::is_same_v<To, float>) {
-            data.resize(outputSize);
-            outputData = data.data();
-        } else {
-            outputData = output.data();
-        }
-        auto src_data = SRC_DATA {
-            input.data(),
-            outputData,
-            static_cast<long>(input.size() / channels),
-            static_cast<long>(outputSize / channels),
-            0,
-            0,
-            1,
-            factor,
-        };
-        if (auto result
-            = src_simple(&src_data, static_cast<int>(type), channels);
-            result != 0) {
-            return { std::nullopt, src_strerror(result) };
-        }
-
-        // convert from float to output format
-        if constexpr (std::is_same_v<To, short>) {
-            src_float_to_short_array(outputData, output.data(),
-                src_data.output_frames_gen * channels);
-        }
-        if constexpr (std::is_same_v<To, int>) {
-            src_float_to_int_array(outputData, output.data(),
-                src_data.output_frames_gen * channels);
+    if constexpr (std::is_same_v<From, float> && std::is_same_v<To, float>) {
+        // src_simple only knows libsamplerate's own types
+        if (!details::IsPolyphase(type)) {
+            auto src_data = SRC_DATA {
+                input.data(),
+                output.data(),
+                static_cast<long>(input.size() / channels),
+                static_cast<long>(output.size() / channels),
+                0,
+                0,
+                1,
+                factor,
+            };
+            if (auto result
+                = src_simple(&src_data, static_cast<int>(type), channels);
+                result != 0) {
+                return { std::nullopt, src_strerror(result) };
+            }
+            return { std::span { output.data(),
+                         static_cast<size_t>(
+                             src_data.output_frames_gen * channels) },
+                {} };
         }
-        return { std::span { output.data(),
-                     static_cast<size_t>(
-                         src_data.output_frames_gen * channels) },
-            {} };
     }
+    auto [frames, error]
+        = details::ConvertInBlocks(input, output, type, channels, factor);
+    if (!frames.has_value()) {
+        return { std::nullopt, error };
+    }
+    return { output.first(*frames * channels), {} };
 }
 
 template <SupportedSampleType To, SupportedSampleType From>
@@ -671,13 +4881,120 @@ inline auto Convert(std::span<const From> input, SRCpp::Type type, int channels,
     double factor) -> std::pair<std::optional<std::vector<To>>, std::string>
 {
     std::vector<To> output(
-        (std::ceil((input.size() / channels) * factor) + 1) * channels);
+        MaxOutputFrames(input.size() / channels, factor) * channels);
     auto [result, error]
         = Convert<To, From>(input, output, type, channels, factor);
     if (!result.has_value()) {
         return { std::nullopt, error };
     }
     output.resize(result->size());
+    return { std::move(output), {} };
+}
+
+template <SupportedSampleType To, SupportedSampleType From>
+inline auto Convert(PlanarSpan<const From> input, PlanarSpan<To> output,
+    SRCpp::Type type, double factor)
+    -> std::pair<std::optional<PlanarSpan<To>>, std::string>
+{
+    if (output.channels() != input.channels()) {
+        return { std::nullopt, StrError(ErrorChannelMismatch) };
+    }
+    auto [frames, error] = details::ConvertInBlocks(input, output, type,
+        static_cast<int>(input.channels()), factor);
+    if (!frames.has_value()) {
+        return { std::nullopt, error };
+    }
+    return { output.first(*frames), {} };
+}
+
+template <SupportedSampleType To, SupportedSampleType From>
+inline auto Convert(PlanarSpan<const From> input, SRCpp::Type type,
+    double factor)
+    -> std::pair<std::optional<std::vector<std::vector<To>>>, std::string>
+{
+    auto frames = MaxOutputFrames(input.frames(), factor);
+    std::vector<std::vector<To>> output(
+        input.channels(), std::vector<To>(frames));
+    std::vector<To*> pointers;
+    for (auto& channel : output) {
+        pointers.push_back(channel.data());
+    }
+    auto [result, error] = Convert<To, From>(
+        input, PlanarSpan<To> { pointers, frames }, type, factor);
+    if (!result.has_value()) {
+        return { std::nullopt, error };
+    }
+    for (auto& channel : output) {
+        channel.resize(result->frames());
+    }
+    return { std::move(output), {} };
+}
+
+inline auto ExpectedOutputFrames(size_t input_frames, double factor) noexcept
+    -> size_t
+{
+    return static_cast<size_t>(
+        std::ceil(static_cast<double>(input_frames) * factor));
+}
+
+inline auto MaxOutputFrames(size_t input_frames, double factor) noexcept
+    -> size_t
+{
+    return ExpectedOutputFrames(input_frames, factor) + 1;
+}
+
+inline auto LatencyFrames(SRCpp::Type type, double factor) -> size_t
+{
+    if (!details::IsPolyphase(type)) {
+        return details::LibsamplerateLatency(type, factor);
+    }
+    // the native engines work theirs out as they are set up
+    auto [engine, error] = details::Engine::create(type, 1, factor);
+    return error == ErrorNone ? engine.latency() : 0;
+}
+
+template <SupportedSampleType To, SupportedSampleType From, typename Allocator>
+inline auto ConvertInto(std::span<const From> input,
+    std::vector<To, Allocator>& output, SRCpp::Type type, int channels,
+    double factor, std::pmr::memory_resource* resource)
+    -> std::pair<std::optional<std::span<To>>, std::string>
+{
+    auto frame = static_cast<size_t>(std::max(channels, 1));
+    auto room = MaxOutputFrames(input.size() / frame, factor) * frame;
+    auto start = output.size();
+    details::ReserveMore(output, room);
+    auto sink = details::SampleSink<To, decltype(details::AppendTo(output))> {
+        details::AppendTo(output), room
+    };
+    auto [frames, error]
+        = details::ConvertInBlocks(
+            input, sink, type, channels, factor, 0, resource);
+    if (!frames.has_value()) {
+        output.resize(start);
+        return { std::nullopt, error };
+    }
+    return { std::span { output }.subspan(start), {} };
+}
+
+template <SupportedSampleType To, SupportedSampleType From,
+    std::output_iterator<const To&> OutputIt>
+inline auto ConvertInto(std::span<const From> input, OutputIt output,
+    SRCpp::Type type, int channels, double factor,
+    std::pmr::memory_resource* resource)
+    -> std::pair<std::optional<OutputIt>, std::string>
+{
+    auto frame = static_cast<size_t>(std::max(channels, 1));
+    auto sink
+        = details::SampleSink<To, decltype(details::AppendThrough<To>(output))> {
+              details::AppendThrough<To>(output),
+              MaxOutputFrames(input.size() / frame, factor) * frame
+          };
+    auto [frames, error]
+        = details::ConvertInBlocks(
+            input, sink, type, channels, factor, 0, resource);
+    if (!frames.has_value()) {
+        return { std::nullopt, error };
+    }
     return { output, {} };
 }
 
@@ -781,77 +5098,302 @@ namespace details {
         if (!result.has_value()) {
             return { std::nullopt, error };
         }
-        output.resize(*result);
-        return { std::move(output), {} };
+        output.resize(*result);
+        return { std::move(output), {} };
+    }
+
+    template <SupportedSampleType To>
+    auto convert_unsafe_helper(PullConverter& pull, void* output,
+        size_t output_size) -> std::pair<std::optional<size_t>, std::string>
+    {
+        auto [size, error] = pull.convert(std::span<To> {
+            static_cast<To*>(output), output_size / sizeof(To) });
+        if (!size) {
+            return { std::nullopt, error };
+        }
+        return { size->size_bytes(), {} };
+    }
+}
+
+inline auto Convert_unsafe(Format from, const void* input, size_t input_size,
+    Format to, void* output, size_t output_size, SRCpp::Type type, int channels,
+    double factor) -> std::pair<std::optional<size_t>, std::string>
+{
+    switch (from) {
+    case Format::Short:
+        return details::Convert_unsafe_helper<short>(
+            input, input_size, to, output, output_size, type, channels, factor);
+    case Format::Int:
+        return details::Convert_unsafe_helper<int>(
+            input, input_size, to, output, output_size, type, channels, factor);
+    case Format::Float:
+        return details::Convert_unsafe_helper<float>(
+            input, input_size, to, output, output_size, type, channels, factor);
+    }
+    return { std::nullopt, "Invalid format combination" };
+}
+
+inline auto Convert_unsafe(Format from, const void* input, size_t input_size,
+    Format to, SRCpp::Type type, int channels, double factor)
+    -> std::pair<std::optional<std::vector<std::byte>>, std::string>
+{
+    // a bad channel count is reported by the conversion
+    auto frame = static_cast<size_t>(std::max(channels, 1));
+    size_t output_elements
+        = MaxOutputFrames(input_size / SizeOfFormat(from) / frame, factor)
+        * frame;
+    switch (to) {
+    case Format::Short:
+        return details::Convert_unsafe_helper<short>(from, input, input_size,
+            to, output_elements, type, channels, factor);
+    case Format::Int:
+        return details::Convert_unsafe_helper<int>(from, input, input_size, to,
+            output_elements, type, channels, factor);
+    case Format::Float:
+        return details::Convert_unsafe_helper<float>(from, input, input_size,
+            to, output_elements, type, channels, factor);
+    }
+    return { std::nullopt, "Invalid format combination" };
+}
+
+template <SupportedSampleType To, SupportedSampleType From>
+inline auto ConvertFormat(std::span<const From> input, std::span<To> output)
+    -> std::pair<std::optional<std::span<To>>, std::string>
+{
+    if (output.size() < input.size()) {
+        return { std::nullopt, "Output buffer is smaller than input" };
+    }
+    details::ConvertSamples<To, From>(input, output.data());
+    return { output.first(input.size()), {} };
+}
+
+template <SupportedSampleType To, SupportedSampleType From>
+inline auto ConvertFormat(std::span<const From> input)
+    -> std::pair<std::optional<std::vector<To>>, std::string>
+{
+    std::vector<To> output(input.size());
+    details::ConvertSamples<To, From>(input, output.data());
+    return { std::move(output), {} };
+}
+
+namespace details {
+    template <SupportedSampleType To, SupportedSampleType From>
+    inline auto ConvertFormat_unsafe_helper(std::span<const From> input_span,
+        void* output, size_t output_size)
+        -> std::pair<std::optional<size_t>, std::string>
+    {
+        auto output_span
+            = std::span<To>(static_cast<To*>(output), output_size / sizeof(To));
+        auto [result, error] = ConvertFormat<To, From>(input_span, output_span);
+        if (!result.has_value()) {
+            return { std::nullopt, error };
+        }
+        return { result->size_bytes(), {} };
+    }
+
+    template <SupportedSampleType From>
+    inline auto ConvertFormat_unsafe_helper(const void* input,
+        size_t input_size, Format to, void* output, size_t output_size)
+        -> std::pair<std::optional<size_t>, std::string>
+    {
+        auto input_span = std::span<const From>(
+            static_cast<const From*>(input), input_size / sizeof(From));
+        switch (to) {
+        case Format::Short:
+            return ConvertFormat_unsafe_helper<short>(
+                input_span, output, output_size);
+        case Format::Int:
+            return ConvertFormat_unsafe_helper<int>(
+                input_span, output, output_size);
+        case Format::Float:
+            return ConvertFormat_unsafe_helper<float>(
+                input_span, output, output_size);
+        }
+        return { std::nullopt, "Invalid format combination" };
+    }
+}
+
+inline auto ConvertFormat_unsafe(Format from, const void* input,
+    size_t input_size, Format to, void* output, size_t output_size)
+    -> std::pair<std::optional<size_t>, std::string>
+{
+    switch (from) {
+    case Format::Short:
+        return details::ConvertFormat_unsafe_helper<short>(
+            input, input_size, to, output, output_size);
+    case Format::Int:
+        return details::ConvertFormat_unsafe_helper<int>(
+            input, input_size, to, output, output_size);
+    case Format::Float:
+        return details::ConvertFormat_unsafe_helper<float>(
+            input, input_size, to, output, output_size);
+    }
+    return { std::nullopt, "Invalid format combination" };
+}
+
+inline auto ConvertFormat_unsafe(
+    Format from, const void* input, size_t input_size, Format to)
+    -> std::pair<std::optional<std::vector<std::byte>>, std::string>
+{
+    std::vector<std::byte> output(
+        input_size / SizeOfFormat(from) * SizeOfFormat(to));
+    auto [result, error] = ConvertFormat_unsafe(
+        from, input, input_size, to, output.data(), output.size());
+    if (!result.has_value()) {
+        return { std::nullopt, error };
+    }
+    output.resize(*result);
+    return { std::move(output), {} };
+}
+
+#if SRCPP_USE_CPP23
+template <SupportedSampleType To, SupportedSampleType From>
+inline auto ConvertFormat_expected(std::span<const From> input,
+    std::span<To> output) -> std::expected<std::span<To>, std::string>
+{
+    auto [result, error] = ConvertFormat<To, From>(input, output);
+    if (result.has_value()) {
+        return *result;
+    }
+    return std::unexpected(error);
+}
+
+template <SupportedSampleType To, SupportedSampleType From>
+inline auto ConvertFormat_expected(std::span<const From> input)
+    -> std::expected<std::vector<To>, std::string>
+{
+    auto [result, error] = ConvertFormat<To, From>(input);
+    if (result.has_value()) {
+        return std::move(*result);
+    }
+    return std::unexpected(error);
+}
+
+inline auto ConvertFormat_unsafe_expected(Format from, const void* input,
+    size_t input_size, Format to, void* output, size_t output_size)
+    -> std::expected<size_t, std::string>
+{
+    auto [result, error]
+        = ConvertFormat_unsafe(from, input, input_size, to, output, output_size);
+    if (result.has_value()) {
+        return *result;
+    }
+    return std::unexpected(error);
+}
+
+inline auto ConvertFormat_unsafe_expected(
+    Format from, const void* input, size_t input_size, Format to)
+    -> std::expected<std::vector<std::byte>, std::string>
+{
+    auto [result, error] = ConvertFormat_unsafe(from, input, input_size, to);
+    if (result.has_value()) {
+        return std::move(*result);
+    }
+    return std::unexpected(error);
+}
+#endif // SRCPP_USE_CPP23
+
+inline void details::StagingBuffer::consume(size_t count)
+{
+    size_ -= count;
+    if (!adopted_.empty()) {
+        // adopted storage is only kept around while it holds samples.
+        head_ = size_ ? head_ + count : 0;
+        if (size_ == 0) {
+            adopted_ = {};
+        }
+        return;
     }
+    head_ = size_ ? (head_ + count) % capacity_ : 0;
+}
 
-    template <SupportedSampleType To>
-    auto convert_unsafe_helper(PullConverter& pull, void* output,
-        size_t output_size) -> std::pair<std::optional<size_t>, std::string>
-    {
-        auto [size, error] = pull.convert(std::span<To> {
-            static_cast<To*>(output), output_size / sizeof(To) });
-        if (!size) {
-            return { std::nullopt, error };
+inline void details::StagingBuffer::reserve(size_t samples)
+{
+    if (samples <= capacity_) {
+        if (!adopted_.empty()) {
+            // the ring already has room for what was adopted
+            auto staged = window();
+            std::copy(staged.begin(), staged.end(), storage_.begin());
+            std::copy(
+                staged.begin(), staged.end(), storage_.begin() + capacity_);
+            adopted_ = {};
+            head_ = 0;
         }
-        return { size->size_bytes(), {} };
+        return;
     }
+    auto capacity = std::max<size_t>(std::bit_ceil(samples), 256);
+    AlignedBuffer<float> storage(capacity * 2, storage_.get_allocator());
+    auto staged = window();
+    std::copy(staged.begin(), staged.end(), storage.begin());
+    std::copy(staged.begin(), staged.end(), storage.begin() + capacity);
+    storage_ = std::move(storage);
+    adopted_ = {};
+    capacity_ = capacity;
+    head_ = 0;
 }
 
-inline auto Convert_unsafe(Format from, const void* input, size_t input_size,
-    Format to, void* output, size_t output_size, SRCpp::Type type, int channels,
-    double factor) -> std::pair<std::optional<size_t>, std::string>
+inline void details::StagingBuffer::adopt(
+    std::vector<float>&& storage, size_t offset)
 {
-    switch (from) {
-    case Format::Short:
-        return details::Convert_unsafe_helper<short>(
-            input, input_size, to, output, output_size, type, channels, factor);
-    case Format::Int:
-        return details::Convert_unsafe_helper<int>(
-            input, input_size, to, output, output_size, type, channels, factor);
-    case Format::Float:
-        return details::Convert_unsafe_helper<float>(
-            input, input_size, to, output, output_size, type, channels, factor);
+    if (offset == storage.size()) {
+        return;
     }
-    return { std::nullopt, "Invalid format combination" };
+    adopted_ = std::move(storage);
+    head_ = offset;
+    size_ = adopted_.size() - offset;
 }
 
-inline auto Convert_unsafe(Format from, const void* input, size_t input_size,
-    Format to, SRCpp::Type type, int channels, double factor)
-    -> std::pair<std::optional<std::vector<std::byte>>, std::string>
+template <typename Fill>
+inline void details::StagingBuffer::append(size_t count, Fill&& fill)
 {
-    size_t output_elements = static_cast<size_t>(std::ceil(
-                                 (input_size / SizeOfFormat(from)) * factor))
-        + 1;
-    switch (to) {
-    case Format::Short:
-        return details::Convert_unsafe_helper<short>(from, input, input_size,
-            to, output_elements, type, channels, factor);
-    case Format::Int:
-        return details::Convert_unsafe_helper<int>(from, input, input_size, to,
-            output_elements, type, channels, factor);
-    case Format::Float:
-        return details::Convert_unsafe_helper<float>(from, input, input_size,
-            to, output_elements, type, channels, factor);
+    if (size_ + count > capacity_) {
+        reserve(std::max(size_ + count, capacity_ * 2));
+    } else if (!adopted_.empty()) {
+        reserve(size_);
     }
-    return { std::nullopt, "Invalid format combination" };
+    auto done = size_t { 0 };
+    while (done < count) {
+        auto slot = (head_ + size_ + done) % capacity_;
+        auto length = std::min(count - done, capacity_ - slot);
+        auto* primary = storage_.data() + slot;
+        fill(std::span<float> { primary, length }, done);
+        std::copy(primary, primary + length, primary + capacity_);
+        done += length;
+    }
+    size_ += count;
 }
 
-inline PushConverter::PushConverter(
-    SRCpp::Type type, int channels, double factor)
+inline PushConverter::PushConverter(SRCpp::Type type, int channels,
+    double factor, std::pmr::memory_resource* resource)
     : type_ { type }
     , channels_ { channels }
     , factor_ { factor }
-    , last_input_(channels)
+    , reserved_input_ { resource }
+    , last_input_(channels * 2, resource)
+    , scratch_output_(resource)
+    , peak_factor_ { factor }
 {
-    auto error = 0;
-    state_ = src_new(static_cast<int>(type), channels, &error);
+    auto [engine, error] = details::Engine::create(type, channels, factor);
     if (error != 0) {
-        throw std::runtime_error(src_strerror(error));
+        throw std::runtime_error(StrError(error));
     }
+    engine_ = std::move(engine);
+}
+
+inline PushConverter::PushConverter(details::Engine engine, SRCpp::Type type,
+    int channels, double factor, std::pmr::memory_resource* resource)
+    : engine_ { std::move(engine) }
+    , type_ { type }
+    , channels_ { channels }
+    , factor_ { factor }
+    , reserved_input_ { resource }
+    , last_input_(channels * 2, resource)
+    , scratch_output_(resource)
+    , peak_factor_ { factor }
+{
 }
 
-inline PushConverter::~PushConverter() { src_delete(state_); }
+inline PushConverter::~PushConverter() = default;
 
 inline PushConverter::PushConverter(const PushConverter& other)
     : type_(other.type_)
@@ -860,67 +5402,67 @@ inline PushConverter::PushConverter(const PushConverter& other)
     , reserved_input_(other.reserved_input_)
     , last_input_(other.last_input_)
     , scratch_output_(other.scratch_output_)
-    , input_frames_consumed_(other.input_frames_consumed_)
+    , expected_frames_(other.expected_frames_)
     , output_frames_produced_(other.output_frames_produced_)
+    , peak_factor_(other.peak_factor_)
 {
-    auto error = 0;
-    state_ = src_clone(other.state_, &error);
+    auto [engine, error] = other.engine_.clone();
     if (error != 0) {
-        throw std::runtime_error(src_strerror(error));
+        throw std::runtime_error(StrError(error));
     }
+    engine_ = std::move(engine);
 }
 
 inline auto PushConverter::operator=(const PushConverter& other)
     -> PushConverter&
 {
     if (this != &other) {
-        src_delete(state_);
-        auto error = 0;
-        state_ = src_clone(other.state_, &error);
+        auto [engine, error] = other.engine_.clone();
         if (error != 0) {
-            throw std::runtime_error(src_strerror(error));
+            throw std::runtime_error(StrError(error));
         }
+        engine_ = std::move(engine);
         type_ = other.type_;
         channels_ = other.channels_;
         factor_ = other.factor_;
         reserved_input_ = other.reserved_input_;
         last_input_ = other.last_input_;
         scratch_output_ = other.scratch_output_;
-        input_frames_consumed_ = other.input_frames_consumed_;
+        expected_frames_ = other.expected_frames_;
         output_frames_produced_ = other.output_frames_produced_;
+        peak_factor_ = other.peak_factor_;
     }
     return *this;
 }
 
 inline PushConverter::PushConverter(PushConverter&& other) noexcept
-    : state_(other.state_)
+    : engine_(std::move(other.engine_))
     , type_(other.type_)
     , channels_(other.channels_)
     , factor_(other.factor_)
     , reserved_input_(std::move(other.reserved_input_))
     , last_input_(std::move(other.last_input_))
     , scratch_output_(std::move(other.scratch_output_))
-    , input_frames_consumed_(other.input_frames_consumed_)
+    , expected_frames_(other.expected_frames_)
     , output_frames_produced_(other.output_frames_produced_)
+    , peak_factor_(other.peak_factor_)
 {
-    other.state_ = nullptr;
 }
 
 inline auto PushConverter::operator=(PushConverter&& other) noexcept
     -> PushConverter&
 {
     if (this != &other) {
-        src_delete(state_);
-        state_ = other.state_;
+        engine_ = std::move(other.engine_);
         type_ = other.type_;
         channels_ = other.channels_;
         factor_ = other.factor_;
         reserved_input_ = std::move(other.reserved_input_);
         last_input_ = std::move(other.last_input_);
         scratch_output_ = std::move(other.scratch_output_);
-        input_frames_consumed_ = other.input_frames_consumed_;
+        expected_frames_ = other.expected_frames_;
         output_frames_produced_ = other.output_frames_produced_;
-        other.state_ = nullptr;
+        peak_factor_ = other.peak_factor_;
     }
     return *this;
 }
@@ -934,118 +5476,516 @@ inline auto PushConverter::convert_expected(std::span<const From> input,
     if (result.has_value()) {
         return *result;
     }
-    return std::unexpected(error);
+    return std::unexpected(error);
+}
+
+template <SupportedSampleType To, SupportedSampleType From>
+inline auto PushConverter::convert_expected(PlanarSpan<const From> input,
+    PlanarSpan<To> output) -> std::expected<PlanarSpan<To>, std::string>
+{
+    auto [result, error] = convert<To, From>(input, output);
+    if (result.has_value()) {
+        return *result;
+    }
+    return std::unexpected(error);
+}
+
+template <SupportedSampleType To, SupportedSampleType From>
+inline auto PushConverter::convert_expected(std::span<const From> input)
+    -> std::expected<std::vector<To>, std::string>
+{
+    auto [result, error] = convert<To, From>(input);
+    if (result.has_value()) {
+        return std::move(*result);
+    }
+    return std::unexpected(error);
+}
+
+template <SupportedSampleType To>
+inline auto PushConverter::flush_expected()
+    -> std::expected<std::vector<To>, std::string>
+{
+    return convert_expected<To, float>(std::span<const float> {});
+}
+
+inline auto PushConverter::convert_unsafe_expected(Format from,
+    const void* input, size_t input_size, Format to, void* output,
+    size_t output_size) -> std::expected<size_t, std::string>
+{
+    auto [result, error]
+        = convert_unsafe(from, input, input_size, to, output, output_size);
+    if (result.has_value()) {
+        return *result;
+    }
+    return std::unexpected(error);
+}
+
+inline auto PushConverter::convert_unsafe_expected(
+    Format from, const void* input, size_t input_size, Format to)
+    -> std::expected<std::vector<std::byte>, std::string>
+{
+    auto [result, error] = convert_unsafe(from, input, input_size, to);
+    if (result.has_value()) {
+        return std::move(*result);
+    }
+    return std::unexpected(error);
+}
+#endif // SRCPP_USE_CPP23
+
+template <SupportedSampleType From>
+inline void PushConverter::stageInput(std::span<const From> input)
+{
+    // convert from input format to float
+    reserved_input_.append(
+        input.size(), [&input](std::span<float> dest, size_t offset) {
+            details::ConvertSamples<float, From>(
+                input.subspan(offset, dest.size()), dest.data());
+        });
+}
+
+template <SupportedSampleType From>
+inline void PushConverter::stageInput(PlanarSpan<const From> input)
+{
+    // interleave and convert to float straight into staging
+    reserved_input_.append(input.frames() * channels_,
+        [&input](std::span<float> dest, size_t offset) {
+            details::InterleaveSamples(input, offset, dest);
+        });
+}
+
+template <SupportedSampleType To>
+inline auto PushConverter::outputScratch(
+    std::span<To> output, bool may_allocate) -> std::span<float>
+{
+    if constexpr (std::is_same_v<To, float>) {
+        return output;
+    } else {
+        // without allocating, only convert what the prepared scratch holds.
+        auto samples = may_allocate
+            ? output.size()
+            : std::min(output.size(), scratch_output_.capacity());
+        scratch_output_.resize(samples);
+        return scratch_output_;
+    }
+}
+
+template <SupportedSampleType To>
+inline auto PushConverter::outputScratch(
+    PlanarSpan<To> output, bool may_allocate) -> std::span<float>
+{
+    // planar output always goes through interleaved scratch
+    auto samples = output.frames() * channels_;
+    if (!may_allocate) {
+        samples = std::min(samples, scratch_output_.capacity());
+    }
+    scratch_output_.resize(samples);
+    return scratch_output_;
+}
+
+template <SupportedSampleType To>
+inline auto PushConverter::finishOutput(
+    std::span<float> produced, std::span<To> output) -> std::span<To>
+{
+    // convert from float to output format
+    if constexpr (!std::is_same_v<To, float>) {
+        details::ConvertSamples<To, float>(produced, output.data());
+        return output.first(produced.size());
+    } else {
+        return produced;
+    }
+}
+
+template <SupportedSampleType To>
+inline auto PushConverter::finishOutput(
+    std::span<float> produced, PlanarSpan<To> output) -> PlanarSpan<To>
+{
+    // de-interleave and convert from float to output format
+    auto frames = output.first(produced.size() / channels_);
+    details::DeinterleaveFrames(produced.data(), frames);
+    return frames;
+}
+
+namespace details {
+    inline auto Overlaps(std::span<const float> a, std::span<const float> b)
+        -> bool
+    {
+        auto less = std::less<const float*> {};
+        return less(a.data(), b.data() + b.size())
+            && less(b.data(), a.data() + a.size());
+    }
+}
+
+template <typename Output, typename Input>
+inline auto PushConverter::convertWith(
+    Input input, Output output, bool may_allocate) -> std::pair<Output, int>
+{
+    auto channels = static_cast<size_t>(channels_);
+    if constexpr (details::IsPlanarSpan<Input>::value) {
+        if (input.channels() != channels) {
+            return { details::FirstFrames(output, channels, 0),
+                ErrorChannelMismatch };
+        }
+    }
+    if constexpr (details::IsPlanarSpan<Output>::value) {
+        if (output.channels() != channels) {
+            return { details::FirstFrames(output, channels, 0),
+                ErrorChannelMismatch };
+        }
+    }
+    // whatever libsamplerate leaves unconsumed must fit in staging.
+    if (!may_allocate
+        && !reserved_input_.fits(details::SampleCount(input, channels))) {
+        return { details::FirstFrames(output, channels, 0),
+            ErrorExceedsPrepared };
+    }
+    auto output_span = outputScratch(output, may_allocate);
+    auto end = input.empty();
+    auto room = details::SampleCount(output, channels);
+    auto written = size_t { 0 };
+    auto filled = false;
+    // Converts into the next stretch of output, through scratch unless it
+    // is output itself, and notes whether the pass used all its room.
+    auto pass = [&](std::span<const float> samples)
+        -> std::pair<Processed, int> {
+        auto chunk = std::min(output_span.size(), room - written);
+        chunk -= chunk % channels;
+        auto [processed, error]
+            = convertWithFixFor208(samples, output_span.first(chunk), end);
+        if (error != 0) {
+            return { {}, error };
+        }
+        finishOutput(processed.produced,
+            details::FramesFrom(output, channels, written / channels));
+        written += processed.produced.size();
+        filled = chunk > 0 && processed.produced.size() == chunk;
+        return { processed, 0 };
+    };
+    auto direct = false;
+    if constexpr (std::is_same_v<Input, std::span<const float>>) {
+        // Nothing staged: hand the caller's samples straight to libsamplerate
+        // and only stage what it leaves behind.  In-place callers still go
+        // through staging, as libsamplerate rejects overlapping buffers.
+        if (reserved_input_.empty()
+            && !details::Overlaps(input, output_span)) {
+            auto [processed, error] = pass(input);
+            if (error != 0) {
+                return { details::FirstFrames(output, channels, 0), error };
+            }
+            stageInput(processed.unused);
+            direct = true;
+        }
+    }
+    if (!direct) {
+        stageInput(input);
+        auto [processed, error] = pass(reserved_input_.window());
+        if (error != 0) {
+            return { details::FirstFrames(output, channels, 0), error };
+        }
+        reserved_input_.consume(
+            reserved_input_.size() - processed.unused.size());
+    }
+    // Without allocating, scratch can hold less than output has room for.
+    // While it comes back full there may be more waiting, from staged input
+    // or, at the end, the filter's tail, so refill it until output is full.
+    while (filled && written + channels <= room) {
+        auto [processed, error] = pass(reserved_input_.window());
+        if (error != 0) {
+            return { details::FirstFrames(output, channels, 0), error };
+        }
+        reserved_input_.consume(
+            reserved_input_.size() - processed.unused.size());
+    }
+    return { details::FirstFrames(output, channels, written / channels), 0 };
+}
+
+template <SupportedSampleType To, SupportedSampleType From>
+inline auto PushConverter::convert(
+    std::span<const From> input, std::span<To> output)
+    -> std::pair<std::optional<std::span<To>>, std::string>
+{
+    auto [result, error] = convertWith(input, output, true);
+    if (error != 0) {
+        return { std::nullopt, StrError(error) };
+    }
+    return { result, {} };
+}
+
+template <SupportedSampleType To, SupportedSampleType From>
+inline auto PushConverter::convert(std::span<const From> input)
+    -> std::pair<std::optional<std::vector<To>>, std::string>
+{
+    auto amount = max_output_frames(input.size() / channels_);
+    std::vector<To> output(amount * channels_);
+    auto [result, error] = convert(input, output);
+    if (!result.has_value()) {
+        return { std::nullopt, error };
+    }
+    output.resize(result->size());
+    return { std::move(output), {} };
+}
+
+template <SupportedSampleType To, SupportedSampleType From>
+inline auto PushConverter::convert(std::span<const From> input,
+    std::span<To> output, double factor, RatioMode mode)
+    -> std::pair<std::optional<std::span<To>>, std::string>
+{
+    if (auto result = set_ratio(factor, mode); result != 0) {
+        return { std::nullopt, StrError(result) };
+    }
+    return convert(input, output);
+}
+
+template <SupportedSampleType To, SupportedSampleType From>
+inline auto PushConverter::convert(std::span<const From> input,
+    double factor, RatioMode mode)
+    -> std::pair<std::optional<std::vector<To>>, std::string>
+{
+    if (auto result = set_ratio(factor, mode); result != 0) {
+        return { std::nullopt, StrError(result) };
+    }
+    return convert<To, From>(input);
+}
+
+template <SupportedSampleType To>
+inline auto PushConverter::convert(
+    std::vector<float>&& input, std::span<To> output)
+    -> std::pair<std::optional<std::span<To>>, std::string>
+{
+    auto output_span = outputScratch(output, true);
+    if (!reserved_input_.empty()
+        || details::Overlaps(input, output_span)) {
+        return convert(std::span<const float> { input }, output);
+    }
+    auto [processed, error]
+        = convertWithFixFor208(input, output_span, input.empty());
+    if (error != 0) {
+        return { std::nullopt, StrError(error) };
+    }
+    if (!processed.unused.empty()) {
+        auto offset = input.size() - processed.unused.size();
+        reserved_input_.adopt(std::move(input), offset);
+    }
+    return { finishOutput(processed.produced, output), {} };
+}
+
+template <SupportedSampleType To>
+inline auto PushConverter::convert(std::vector<float>&& input)
+    -> std::pair<std::optional<std::vector<To>>, std::string>
+{
+    auto amount = max_output_frames(input.size() / channels_);
+    std::vector<To> output(amount * channels_);
+    auto [result, error] = convert(std::move(input), std::span<To> { output });
+    if (!result.has_value()) {
+        return { std::nullopt, error };
+    }
+    output.resize(result->size());
+    return { std::move(output), {} };
+}
+
+template <SupportedSampleType To>
+inline auto PushConverter::flush()
+    -> std::pair<std::optional<std::vector<To>>, std::string>
+{
+    return convert<To, float>(std::span<const float> {});
+}
+
+template <SupportedSampleType To, typename Append>
+inline auto PushConverter::outputScratch(
+    details::SampleSink<To, Append>& output, bool) -> std::span<float>
+{
+    // a pending ramp spans the whole call, as it would for a span
+    auto frames = std::max<size_t>(
+        details::kConvertBlockSamples / static_cast<size_t>(channels_), 1);
+    scratch_output_.resize(engine_.ramp_pending()
+            ? output.room
+            : std::min(output.room, frames * static_cast<size_t>(channels_)));
+    return scratch_output_;
+}
+
+template <SupportedSampleType To, typename Append>
+inline void PushConverter::finishOutput(
+    std::span<float> produced, details::SampleSink<To, Append>& output)
+{
+    details::EmitSamples<To>(produced, output.append);
+}
+
+template <SupportedSampleType To, SupportedSampleType From, typename Allocator>
+inline auto PushConverter::convert_into(
+    std::span<const From> input, std::vector<To, Allocator>& output)
+    -> std::pair<std::optional<std::span<To>>, std::string>
+{
+    auto room = max_output_frames(input.size() / channels_) * channels_;
+    auto start = output.size();
+    details::ReserveMore(output, room);
+    auto sink = details::SampleSink<To, decltype(details::AppendTo(output))> {
+        details::AppendTo(output), room
+    };
+    if (auto [result, error] = convertWith(input, sink, true); error != 0) {
+        output.resize(start);
+        return { std::nullopt, StrError(error) };
+    }
+    return { std::span { output }.subspan(start), {} };
+}
+
+template <SupportedSampleType To, typename Allocator>
+inline auto PushConverter::flush_into(std::vector<To, Allocator>& output)
+    -> std::pair<std::optional<std::span<To>>, std::string>
+{
+    return convert_into(std::span<const float> {}, output);
+}
+
+template <SupportedSampleType To, SupportedSampleType From,
+    std::output_iterator<const To&> OutputIt>
+inline auto PushConverter::convert_into(
+    std::span<const From> input, OutputIt output)
+    -> std::pair<std::optional<OutputIt>, std::string>
+{
+    auto sink
+        = details::SampleSink<To, decltype(details::AppendThrough<To>(output))> {
+              details::AppendThrough<To>(output),
+              max_output_frames(input.size() / channels_) * channels_
+          };
+    if (auto [result, error] = convertWith(input, sink, true); error != 0) {
+        return { std::nullopt, StrError(error) };
+    }
+    return { output, {} };
+}
+
+template <SupportedSampleType To, std::output_iterator<const To&> OutputIt>
+inline auto PushConverter::flush_into(OutputIt output)
+    -> std::pair<std::optional<OutputIt>, std::string>
+{
+    return convert_into<To>(std::span<const float> {}, output);
+}
+
+inline auto PushConverter::create(SRCpp::Type type, int channels,
+    double factor, std::pmr::memory_resource* resource) noexcept
+    -> std::pair<std::optional<PushConverter>, int>
+{
+    auto [engine, error] = details::Engine::create(type, channels, factor);
+    if (error != 0) {
+        return { std::nullopt, error };
+    }
+    try {
+        return { PushConverter(
+                     std::move(engine), type, channels, factor, resource),
+            ErrorNone };
+    } catch (const std::bad_alloc&) {
+        return { std::nullopt, ErrorOutOfMemory };
+    }
+}
+
+inline void PushConverter::prepare(size_t max_input_frames,
+    size_t max_output_frames, std::span<const double> factors)
+{
+    // room for what one call may leave unconsumed plus the next call's input
+    reserved_input_.reserve(2 * max_input_frames * channels_);
+    scratch_output_.reserve(max_output_frames * channels_);
+    engine_.prepare(factors);
+}
+
+inline auto PushConverter::reset() noexcept -> int
+{
+    if (auto result = engine_.reset(); result != 0) {
+        return result;
+    }
+    reserved_input_.clear();
+    std::fill(last_input_.begin(), last_input_.end(), 0.0f);
+    expected_frames_ = 0.0;
+    output_frames_produced_ = 0;
+    peak_factor_ = factor_;
+    return ErrorNone;
 }
 
-template <SupportedSampleType To, SupportedSampleType From>
-inline auto PushConverter::convert_expected(std::span<const From> input)
-    -> std::expected<std::vector<To>, std::string>
+inline auto PushConverter::reset(double factor) noexcept -> int
 {
-    auto [result, error] = convert<To, From>(input);
-    if (result.has_value()) {
-        return *result;
+    if (auto result = engine_.reset(factor); result != 0) {
+        return result;
     }
-    return std::unexpected(error);
+    factor_ = factor;
+    return reset();
 }
 
-template <SupportedSampleType To>
-inline auto PushConverter::flush_expected()
-    -> std::expected<std::vector<To>, std::string>
+inline auto PushConverter::set_ratio(double factor, RatioMode mode) noexcept
+    -> int
 {
-    return convert_expected<To, float>(std::vector<float> {});
+    return setRatio(factor, mode, true);
 }
 
-inline auto PushConverter::convert_unsafe_expected(Format from,
-    const void* input, size_t input_size, Format to, void* output,
-    size_t output_size) -> std::expected<size_t, std::string>
+inline auto PushConverter::setRatio(
+    double factor, RatioMode mode, bool may_allocate) noexcept -> int
 {
-    auto [result, error]
-        = convert_unsafe(from, input, input_size, to, output, output_size);
-    if (result.has_value()) {
-        return *result;
+    if (auto result = engine_.set_ratio(factor, mode, may_allocate);
+        result != 0) {
+        return result;
     }
-    return std::unexpected(error);
+    peak_factor_ = mode == RatioMode::Ramp && engine_.ramps()
+        ? std::max(peak_factor_, factor)
+        : factor;
+    factor_ = factor;
+    return ErrorNone;
 }
 
-inline auto PushConverter::convert_unsafe_expected(
-    Format from, const void* input, size_t input_size, Format to)
-    -> std::expected<std::vector<std::byte>, std::string>
+template <SupportedSampleType To, SupportedSampleType From>
+inline auto PushConverter::convert_noalloc(std::span<const From> input,
+    std::span<To> output) noexcept -> std::pair<std::span<To>, int>
 {
-    auto [result, error] = convert_unsafe(from, input, input_size, to);
-    if (result.has_value()) {
-        return *result;
+    return convertWith(input, output, false);
+}
+
+template <SupportedSampleType To, SupportedSampleType From>
+inline auto PushConverter::convert_noalloc(std::span<const From> input,
+    std::span<To> output, double factor, RatioMode mode) noexcept
+    -> std::pair<std::span<To>, int>
+{
+    if (auto result = setRatio(factor, mode, false); result != 0) {
+        return { {}, result };
     }
-    return std::unexpected(error);
+    return convertWith(input, output, false);
+}
+
+template <SupportedSampleType To>
+inline auto PushConverter::flush_noalloc(std::span<To> output) noexcept
+    -> std::pair<std::span<To>, int>
+{
+    return convertWith(std::span<const float> {}, output, false);
 }
-#endif // SRCPP_USE_CPP23
 
 template <SupportedSampleType To, SupportedSampleType From>
 inline auto PushConverter::convert(
-    std::span<const From> input, std::span<To> output)
-    -> std::pair<std::optional<std::span<To>>, std::string>
+    PlanarSpan<const From> input, PlanarSpan<To> output)
+    -> std::pair<std::optional<PlanarSpan<To>>, std::string>
 {
-    // convert from input format to float
-    auto offsetToPlace = reserved_input_.size();
-    reserved_input_.resize(reserved_input_.size() + input.size());
-    auto* whereToPlaceData = reserved_input_.data() + offsetToPlace;
-    if constexpr (std::is_same_v<From, short>) {
-        src_short_to_float_array(input.data(), whereToPlaceData, input.size());
-    } else if constexpr (std::is_same_v<From, int>) {
-        src_int_to_float_array(input.data(), whereToPlaceData, input.size());
-    } else {
-        std::copy(input.begin(), input.end(), whereToPlaceData);
-    }
-    // where to put things?
-    auto output_span = [&]() -> std::span<float> {
-        if constexpr (std::is_same_v<To, float>) {
-            return output;
-        } else {
-            scratch_output_.resize(output.size());
-            return scratch_output_;
-        }
-    }();
-    auto [result, error]
-        = convertWithFixFor208(reserved_input_, output_span, input.empty());
-    if (!result.has_value()) {
-        return { std::nullopt, error };
+    auto [result, error] = convertWith(input, output, true);
+    if (error != 0) {
+        return { std::nullopt, StrError(error) };
     }
-    auto& [input_data, output_data] = result.value();
-    std::copy(input_data.begin(), input_data.end(), reserved_input_.begin());
-    reserved_input_.resize(input_data.size());
+    return { result, {} };
+}
 
-    // convert from float to output format
-    if constexpr (std::is_same_v<To, short>) {
-        src_float_to_short_array(
-            output_data.data(), output.data(), output_data.size());
-        return { output.first(output_data.size()), {} };
-    } else if constexpr (std::is_same_v<To, int>) {
-        src_float_to_int_array(
-            output_data.data(), output.data(), output_data.size());
-        return { output.first(output_data.size()), {} };
-    } else {
-        return { output_data, {} };
+template <SupportedSampleType To>
+inline auto PushConverter::flush(PlanarSpan<To> output)
+    -> std::pair<std::optional<PlanarSpan<To>>, std::string>
+{
+    auto [result, error] = convertWith(std::span<const float> {}, output, true);
+    if (error != 0) {
+        return { std::nullopt, StrError(error) };
     }
+    return { result, {} };
 }
 
 template <SupportedSampleType To, SupportedSampleType From>
-inline auto PushConverter::convert(std::span<const From> input)
-    -> std::pair<std::optional<std::vector<To>>, std::string>
+inline auto PushConverter::convert_noalloc(PlanarSpan<const From> input,
+    PlanarSpan<To> output) noexcept -> std::pair<PlanarSpan<To>, int>
 {
-    auto amount = framesToReserve(input.size());
-    std::vector<To> output(amount * channels_);
-    auto [result, error] = convert(input, output);
-    if (!result.has_value()) {
-        return { std::nullopt, error };
-    }
-    output.resize(result->size());
-    return { output, {} };
+    return convertWith(input, output, false);
 }
 
 template <SupportedSampleType To>
-inline auto PushConverter::flush()
-    -> std::pair<std::optional<std::vector<To>>, std::string>
+inline auto PushConverter::flush_noalloc(PlanarSpan<To> output) noexcept
+    -> std::pair<PlanarSpan<To>, int>
 {
-    return convert<To, float>(std::vector<float> {});
+    return convertWith(std::span<const float> {}, output, false);
 }
 
 inline auto PushConverter::convert_unsafe(Format from, const void* input,
@@ -1071,7 +6011,8 @@ inline auto PushConverter::convert_unsafe(
     -> std::pair<std::optional<std::vector<std::byte>>, std::string>
 {
     size_t output_samples
-        = framesToReserve(input_size / SizeOfFormat(from)) * channels_;
+        = max_output_frames(input_size / SizeOfFormat(from) / channels_)
+        * channels_;
     switch (to) {
     case Format::Short:
         return details::convert_unsafe_helper<short>(
@@ -1086,11 +6027,9 @@ inline auto PushConverter::convert_unsafe(
     return { std::nullopt, "Invalid format combination" };
 }
 
-inline auto PushConverter::convert(
+inline auto PushConverter::process(
     std::span<const float> input, std::span<float> output, bool end)
-    -> std::pair<
-        std::optional<std::pair<std::span<const float>, std::span<float>>>,
-        std::string>
+    -> std::pair<Processed, int>
 {
     auto* input_ptr = input.empty() ? &dummy_ : input.data();
     auto* output_ptr = output.data();
@@ -1106,108 +6045,122 @@ inline auto PushConverter::convert(
         end,
         factor_,
     };
-    if (auto result = src_process(state_, &src_data); result != 0) {
-        return { std::nullopt, src_strerror(result) };
+    if (auto result = engine_.process(src_data); result != 0) {
+        return { {}, result };
     }
-    if (end) {
-        if (auto result = src_reset(state_); result != 0) {
-            return { std::nullopt, src_strerror(result) };
+    // A flush that fills output may have more of the tail to come, so the
+    // stream only starts over once one comes back short.
+    if (end && src_data.output_frames_gen < src_data.output_frames) {
+        if (auto result = engine_.reset(); result != 0) {
+            return { {}, result };
         }
     }
-    input_frames_consumed_ += src_data.input_frames_used;
+    expected_frames_
+        += static_cast<double>(src_data.input_frames_used) * peak_factor_;
     output_frames_produced_ += src_data.output_frames_gen;
+    // libsamplerate ramps across the whole output buffer, so a call that
+    // fills it ends one output frame's step short of the new factor
+    if (!engine_.ramps()) {
+        peak_factor_ = factor_;
+    } else if (src_data.output_frames_gen == src_data.output_frames) {
+        peak_factor_ = factor_
+            + (peak_factor_ - factor_)
+                / static_cast<double>(std::max(src_data.output_frames, 1L));
+    }
 
-    return { std::pair { input.subspan(src_data.input_frames_used * channels_),
+    return { { input.subspan(src_data.input_frames_used * channels_),
                  output.subspan(0, src_data.output_frames_gen * channels_) },
-        {} };
+        0 };
 }
 
 inline auto PushConverter::convertWithFixFor208(
     std::span<const float> input, std::span<float> output, bool end)
-    -> std::pair<
-        std::optional<std::pair<std::span<const float>, std::span<float>>>,
-        std::string>
+    -> std::pair<Processed, int>
 {
     // https://github.com/libsndfile/libsamplerate/issues/208
     // When there is 1 frame of data, the linear SRC assumes it can read
     // the previous values and reads off the begin of the array.
     // Temporary fix until that is resolved.
     if (type_ != SRCpp::Type::Linear) {
-        return convert(input, output, end);
+        return process(input, output, end);
     }
 
-    auto [result, error] = [&] {
+    // last_input_ holds the last consumed frame followed by room for the
+    // lone frame, so the workaround never has to allocate.
+    auto [processed, error] = [&] {
         if (input.size() == static_cast<size_t>(channels_)) {
-            last_input_.insert(last_input_.end(), input.begin(), input.end());
-            return convert(
-                { last_input_.data() + channels_, input.size() }, output, end);
+            auto lone = std::span { last_input_ }.subspan(channels_);
+            std::copy(input.begin(), input.end(), lone.begin());
+            return process(lone, output, end);
         }
-        return convert(input, output, end);
+        return process(input, output, end);
     }();
-    if (!result.has_value()) {
-        return { std::nullopt, error };
+    if (error != 0) {
+        return { {}, error };
     }
 
-    auto& [input_unused, output_created] = result.value();
-    auto input_data_used = input.size() - input_unused.size();
+    auto input_data_used = input.size() - processed.unused.size();
 
     // if we are linear, save the last input for next time
     if (input_data_used) {
-        last_input_.assign(input.data() + input_data_used - channels_,
-            input.data() + input_data_used);
-    } else {
-        last_input_.clear();
+        std::copy(input.begin() + (input_data_used - channels_),
+            input.begin() + input_data_used, last_input_.begin());
     }
 
-    return { std::pair { input.subspan(input_data_used), output_created }, {} };
+    return { { input.subspan(input_data_used), processed.produced }, 0 };
 }
 
-inline auto PushConverter::framesToReserve(size_t frames) const -> size_t
+inline auto PushConverter::max_output_frames(
+    size_t input_frames) const noexcept -> size_t
 {
-    auto expected_frames_produced = static_cast<size_t>(
-        std::ceil(static_cast<double>(input_frames_consumed_) * factor_));
-    return [&]() -> size_t {
-        if (frames) {
-            return static_cast<size_t>(
-                std::ceil((frames / channels_) * factor_));
-        }
-        if (expected_frames_produced >= output_frames_produced_) {
-            return expected_frames_produced - output_frames_produced_;
-        }
-        return 0;
-    }() + 1;
+    // everything consumed so far, staged and new is owed output at the
+    // largest factor it may run at; what is owed and not yet produced is
+    // what the filter holds back.  libsamplerate can round one frame over.
+    auto staged_frames = reserved_input_.size() / channels_;
+    auto owed = static_cast<size_t>(std::ceil(expected_frames_
+        + static_cast<double>(staged_frames + input_frames) * peak_factor_));
+    return (owed > output_frames_produced_ ? owed - output_frames_produced_
+                                           : 0)
+        + 1;
+}
+
+inline auto PushConverter::expected_output_frames(
+    size_t total_input_frames) const noexcept -> size_t
+{
+    return ExpectedOutputFrames(total_input_frames, factor_);
 }
 
 template <typename Callback>
-inline PullConverter::PullConverter(
-    Callback&& callback, SRCpp::Type type, int channels, double factor)
+inline PullConverter::PullConverter(Callback&& callback, SRCpp::Type type,
+    int channels, double factor, std::pmr::memory_resource* resource)
     : callback_ { std::make_unique<CallbackHandleImpl<Callback>>(
-        std::forward<Callback>(callback), channels, type) }
+        std::forward<Callback>(callback), channels, type, resource) }
+    , scratch_output_(resource)
     , factor_ { factor }
     , channels_ { channels }
 {
-    auto error = 0;
-    state_ = src_callback_new(
+    auto [engine, error] = details::Engine::create(
+        type, channels, factor,
         [](void* cb_data, float** data) -> long {
             auto* self = static_cast<CallbackHandle*>(cb_data);
             return self->handle_callback(data);
         },
-        static_cast<int>(type), channels, &error, callback_.get());
+        callback_.get());
     if (error != 0) {
-        throw std::runtime_error(src_strerror(error));
+        throw std::runtime_error(StrError(error));
     }
+    engine_ = std::move(engine);
 }
 
-inline PullConverter::~PullConverter() { src_delete(state_); }
+inline PullConverter::~PullConverter() = default;
 
 inline PullConverter::PullConverter(PullConverter&& other) noexcept
     : callback_(std::move(other.callback_))
     , scratch_output_(std::move(other.scratch_output_))
-    , state_(other.state_)
+    , engine_(std::move(other.engine_))
     , factor_(other.factor_)
     , channels_(other.channels_)
 {
-    other.state_ = nullptr;
 }
 
 inline auto PullConverter::operator=(PullConverter&& other) noexcept
@@ -1217,7 +6170,7 @@ inline auto PullConverter::operator=(PullConverter&& other) noexcept
         using std::swap;
         swap(callback_, other.callback_);
         swap(scratch_output_, other.scratch_output_);
-        swap(state_, other.state_);
+        swap(engine_, other.engine_);
         swap(factor_, other.factor_);
         swap(channels_, other.channels_);
     }
@@ -1245,6 +6198,17 @@ inline auto PullConverter::convert_unsafe_expected(Format to, void* output,
     }
     return std::unexpected(error);
 }
+
+template <SupportedSampleType To>
+inline auto PullConverter::convert_expected(PlanarSpan<To> output)
+    -> std::expected<PlanarSpan<To>, std::string>
+{
+    auto [result, error] = convert(output);
+    if (result.has_value()) {
+        return *result;
+    }
+    return std::unexpected(error);
+}
 #endif // SRCPP_USE_CPP23
 
 template <SupportedSampleType To>
@@ -1260,21 +6224,137 @@ inline auto PullConverter::convert(std::span<To> output)
             return scratch_output_;
         }
     }();
-    auto size = src_callback_read(
-        state_, factor_, output_data.size() / channels_, output_data.data());
+    auto size = engine_.read(
+        factor_, output_data.size() / channels_, output_data.data());
     if (size < 0) {
-        return { std::nullopt, src_strerror(src_error(state_)) };
+        return { std::nullopt, StrError(engine_.error()) };
     }
     auto samples = size * channels_;
     // convert from float to output format
-    if constexpr (std::is_same_v<To, short>) {
-        src_float_to_short_array(output_data.data(), output.data(), samples);
-    } else if constexpr (std::is_same_v<To, int>) {
-        src_float_to_int_array(output_data.data(), output.data(), samples);
+    if constexpr (!std::is_same_v<To, float>) {
+        details::ConvertSamples<To, float>(
+            output_data.first(samples), output.data());
     }
     return { output.first(samples), {} };
 }
 
+template <SupportedSampleType To, typename Append>
+inline auto PullConverter::readInto(
+    size_t frames, details::SampleSink<To, Append>& sink) -> int
+{
+    auto channels = static_cast<size_t>(channels_);
+    // a pending ramp spans the whole call, as it would for a span
+    auto block = engine_.ramp_pending()
+        ? frames
+        : std::min(
+              std::max<size_t>(details::kConvertBlockSamples / channels, 1),
+              frames);
+    scratch_output_.resize(block * channels);
+    for (size_t done = 0; done < frames;) {
+        auto count = std::min(block, frames - done);
+        auto size = engine_.read(
+            factor_, static_cast<long>(count), scratch_output_.data());
+        if (size < 0) {
+            return engine_.error();
+        }
+        auto read = static_cast<size_t>(size);
+        details::WriteFrames(
+            std::span { scratch_output_ }.first(read * channels), sink,
+            channels, done);
+        done += read;
+        // a short read means the stream has ended
+        if (read < count) {
+            break;
+        }
+    }
+    return ErrorNone;
+}
+
+template <SupportedSampleType To, typename Allocator>
+inline auto PullConverter::convert_into(
+    size_t frames, std::vector<To, Allocator>& output)
+    -> std::pair<std::optional<std::span<To>>, std::string>
+{
+    auto room = frames * static_cast<size_t>(channels_);
+    auto start = output.size();
+    details::ReserveMore(output, room);
+    auto sink = details::SampleSink<To, decltype(details::AppendTo(output))> {
+        details::AppendTo(output), room
+    };
+    if (auto error = readInto(frames, sink); error != 0) {
+        output.resize(start);
+        return { std::nullopt, StrError(error) };
+    }
+    return { std::span { output }.subspan(start), {} };
+}
+
+template <SupportedSampleType To, std::output_iterator<const To&> OutputIt>
+inline auto PullConverter::convert_into(size_t frames, OutputIt output)
+    -> std::pair<std::optional<OutputIt>, std::string>
+{
+    auto sink
+        = details::SampleSink<To, decltype(details::AppendThrough<To>(output))> {
+              details::AppendThrough<To>(output),
+              frames * static_cast<size_t>(channels_)
+          };
+    if (auto error = readInto(frames, sink); error != 0) {
+        return { std::nullopt, StrError(error) };
+    }
+    return { output, {} };
+}
+
+inline auto PullConverter::max_output_frames(
+    size_t input_frames) const noexcept -> size_t
+{
+    return MaxOutputFrames(input_frames, factor_) + latency_frames();
+}
+
+inline auto PullConverter::expected_output_frames(
+    size_t total_input_frames) const noexcept -> size_t
+{
+    return ExpectedOutputFrames(total_input_frames, factor_);
+}
+
+inline auto PullConverter::set_ratio(double factor, RatioMode mode) noexcept
+    -> int
+{
+    if (auto result = engine_.set_ratio(factor, mode); result != 0) {
+        return result;
+    }
+    factor_ = factor;
+    return ErrorNone;
+}
+
+template <SupportedSampleType To>
+inline auto PullConverter::convert(
+    std::span<To> output, double factor, RatioMode mode)
+    -> std::pair<std::optional<std::span<To>>, std::string>
+{
+    if (auto result = set_ratio(factor, mode); result != 0) {
+        return { std::nullopt, StrError(result) };
+    }
+    return convert(output);
+}
+
+template <SupportedSampleType To>
+inline auto PullConverter::convert(PlanarSpan<To> output)
+    -> std::pair<std::optional<PlanarSpan<To>>, std::string>
+{
+    if (output.channels() != static_cast<size_t>(channels_)) {
+        return { std::nullopt, StrError(ErrorChannelMismatch) };
+    }
+    scratch_output_.resize(output.frames() * channels_);
+    auto size
+        = engine_.read(factor_, output.frames(), scratch_output_.data());
+    if (size < 0) {
+        return { std::nullopt, StrError(engine_.error()) };
+    }
+    // de-interleave and convert from float to output format
+    auto frames = output.first(size);
+    details::DeinterleaveFrames(scratch_output_.data(), frames);
+    return { frames, {} };
+}
+
 inline auto PullConverter::convert_unsafe(Format to, void* output,
     size_t output_size) -> std::pair<std::optional<size_t>, std::string>
 {
@@ -1295,15 +6375,24 @@ template <typename Callback>
 inline auto PullConverter::CallbackHandleImpl<Callback>::handle_callback(
     float** data) -> long
 {
-    using From = std::remove_cvref_t<
-        typename std::invoke_result_t<Callback>::value_type>;
+    using Result = std::invoke_result_t<Callback>;
+    using From = std::remove_cvref_t<typename Result::value_type>;
     static_assert(SupportedSampleType<From>,
-        "Callback must return std::span<T> where T is short, int, or "
-        "float");
+        "Callback must return std::span<T> or SRCpp::PlanarSpan<T> where T is "
+        "short, int, or float");
+    constexpr auto planar = details::IsPlanarSpan<Result>::value;
     if (data == nullptr) {
         return 0;
     }
     auto newData = callback_();
+    // A planar callback with the wrong channel count cannot be read, so it
+    // ends the input.
+    if constexpr (planar) {
+        if (newData.channels() != static_cast<size_t>(channels_)) {
+            *data = &dummy_;
+            return 0;
+        }
+    }
     // SRC is pendantic that input and output buffers don't overlap, even if
     // the input size is 0, such as an end iterator.  If a client has input
     // and output buffers that are adjacent, this would cause an error.  So
@@ -1312,17 +6401,18 @@ inline auto PullConverter::CallbackHandleImpl<Callback>::handle_callback(
         *data = &dummy_;
         return 0;
     }
-    // convert from input format to float
+    auto samples = details::SampleCount(newData, channels_);
+    // convert from input format (and layout) to interleaved float
     auto* inputData = [&]() {
-        if constexpr (std::is_same_v<From, short>) {
-            scratch_input_.resize(newData.size());
-            src_short_to_float_array(
-                newData.data(), scratch_input_.data(), newData.size());
+        if constexpr (planar) {
+            scratch_input_.resize(samples);
+            details::InterleaveFrames(
+                PlanarSpan<const From> { newData }, scratch_input_.data());
             return scratch_input_.data();
-        } else if constexpr (std::is_same_v<From, int>) {
-            scratch_input_.resize(newData.size());
-            src_int_to_float_array(
-                newData.data(), scratch_input_.data(), newData.size());
+        } else if constexpr (!std::is_same_v<From, float>) {
+            scratch_input_.resize(samples);
+            details::ConvertSamples<float, From>(
+                newData, scratch_input_.data());
             return scratch_input_.data();
         } else {
             return newData.data();
@@ -1336,7 +6426,7 @@ inline auto PullConverter::CallbackHandleImpl<Callback>::handle_callback(
         if (type_ != SRCpp::Type::Linear) {
             return inputData;
         }
-        if (newData.size() == static_cast<size_t>(channels_)) {
+        if (samples == static_cast<size_t>(channels_)) {
             last_input_.erase(
                 last_input_.begin(), last_input_.end() - channels_);
             last_input_.insert(
@@ -1344,11 +6434,238 @@ inline auto PullConverter::CallbackHandleImpl<Callback>::handle_callback(
             return last_input_.data() + channels_;
         }
         last_input_.assign(
-            inputData + newData.size() - channels_, inputData + newData.size());
+            inputData + samples - channels_, inputData + samples);
         return inputData;
     }();
     *data = fixedInputData;
-    return newData.size() / channels_;
+    return samples / channels_;
+}
+
+template <size_t In, size_t Out, size_t Channels, SRCpp::Type Q>
+inline auto FixedRatioConverter<In, Out, Channels, Q>::output_frames(
+    size_t input_frames) const noexcept -> size_t
+{
+    // outputs whose last input frame will have arrived, or, for a flush,
+    // those that fall before the end of the stream
+    auto end = static_cast<uint64_t>(base_ + static_cast<int64_t>(length_))
+        + input_frames;
+    auto reach = end * kUp;
+    auto stop = [&]() -> uint64_t {
+        if (input_frames == 0) {
+            return (reach + kDown - 1) / kDown;
+        }
+        return reach > kDelay ? (reach - kDelay + kDown - 1) / kDown : 0;
+    }();
+    return stop > next_ ? static_cast<size_t>(stop - next_) : 0;
+}
+
+template <size_t In, size_t Out, size_t Channels, SRCpp::Type Q>
+inline void FixedRatioConverter<In, Out, Channels, Q>::reset() noexcept
+{
+    // the stream starts with a filter's worth of silence
+    history_.fill(0.0f);
+    base_ = 1 - static_cast<int64_t>(kTaps);
+    length_ = kTaps - 1;
+    next_ = 0;
+    newest_ = static_cast<int64_t>(kDelay / kUp);
+    phase_ = kDelay % kUp;
+}
+
+template <size_t In, size_t Out, size_t Channels, SRCpp::Type Q>
+inline auto FixedRatioConverter<In, Out, Channels, Q>::drain(
+    float* output, uint64_t stop) noexcept -> size_t
+{
+    const auto& kernels = details::ActiveFilterKernels();
+    size_t produced = 0;
+    while (next_ < stop && newest_ < base_ + static_cast<int64_t>(length_)) {
+        auto first = static_cast<size_t>(
+            newest_ - base_ - static_cast<int64_t>(kTaps) + 1);
+        const auto* coefficients = Bank::coefficients.data() + phase_ * kTaps;
+        for (size_t channel = 0; channel < Channels; ++channel) {
+            output[channel] = kernels.dot(coefficients,
+                history_.data() + channel * kCapacity + first, kTaps);
+        }
+        output += Channels;
+        ++produced;
+        // on to the next output, without dividing
+        ++next_;
+        newest_ += static_cast<int64_t>(kDown / kUp);
+        phase_ += kDown % kUp;
+        if (phase_ >= kUp) {
+            phase_ -= kUp;
+            ++newest_;
+        }
+    }
+    return produced;
+}
+
+template <size_t In, size_t Out, size_t Channels, SRCpp::Type Q>
+template <SupportedSampleType To>
+inline auto FixedRatioConverter<In, Out, Channels, Q>::emit(
+    To* output, uint64_t stop) noexcept -> size_t
+{
+    if constexpr (std::is_same_v<To, float>) {
+        return drain(output, stop);
+    } else {
+        std::array<float, kBlock * Channels> block;
+        size_t produced = 0;
+        while (true) {
+            auto count = drain(block.data(), std::min(stop, next_ + kBlock));
+            if (count == 0) {
+                break;
+            }
+            details::ConvertSamples<To, float>(
+                std::span<const float> { block.data(), count * Channels },
+                output + produced * Channels);
+            produced += count;
+        }
+        return produced;
+    }
+}
+
+template <size_t In, size_t Out, size_t Channels, SRCpp::Type Q>
+template <SupportedSampleType From>
+inline void FixedRatioConverter<In, Out, Channels, Q>::append(
+    const From* input, size_t frames) noexcept
+{
+    if constexpr (std::is_same_v<From, float>) {
+        for (size_t channel = 0; channel < Channels; ++channel) {
+            auto* run = history_.data() + channel * kCapacity + length_;
+            for (size_t frame = 0; frame < frames; ++frame) {
+                run[frame] = input[frame * Channels + channel];
+            }
+        }
+        length_ += frames;
+    } else {
+        std::array<float, kBlock * Channels> block;
+        for (size_t done = 0; done < frames; done += kBlock) {
+            auto count = std::min(kBlock, frames - done);
+            details::ConvertSamples<float, From>(
+                std::span<const From> { input + done * Channels,
+                    count * Channels },
+                block.data());
+            append(block.data(), count);
+        }
+    }
+}
+
+template <size_t In, size_t Out, size_t Channels, SRCpp::Type Q>
+inline void FixedRatioConverter<In, Out, Channels, Q>::discardHistory() noexcept
+{
+    auto oldest = newest_ - static_cast<int64_t>(kTaps) + 1;
+    if (oldest <= base_) {
+        return;
+    }
+    auto drop = std::min(static_cast<size_t>(oldest - base_), length_);
+    for (size_t channel = 0; channel < Channels; ++channel) {
+        auto* run = history_.data() + channel * kCapacity;
+        std::copy(run + drop, run + length_, run);
+    }
+    base_ += static_cast<int64_t>(drop);
+    length_ -= drop;
+}
+
+template <size_t In, size_t Out, size_t Channels, SRCpp::Type Q>
+template <SupportedSampleType To, SupportedSampleType From>
+inline auto FixedRatioConverter<In, Out, Channels, Q>::process(
+    std::span<const From> input, std::span<To> output) noexcept
+    -> std::pair<std::span<To>, int>
+{
+    auto frames = input.size() / Channels;
+    auto count = output_frames(frames);
+    if (output.size() < count * Channels) {
+        return { {}, ErrorOutputTooSmall };
+    }
+    auto stop = next_ + count;
+    size_t used = 0;
+    size_t generated = 0;
+    while (true) {
+        generated += emit(output.data() + generated * Channels, stop);
+        if (used == frames && (next_ == stop || frames != 0)) {
+            break;
+        }
+        discardHistory();
+        auto room = kCapacity - length_;
+        if (used == frames) {
+            // flushing: past the end of the stream the filter reads silence
+            for (size_t channel = 0; channel < Channels; ++channel) {
+                auto* run = history_.data() + channel * kCapacity + length_;
+                std::fill(run, run + room, 0.0f);
+            }
+            length_ += room;
+            continue;
+        }
+        // input the next output does not reach back to is skipped
+        auto start = base_ + static_cast<int64_t>(length_);
+        auto oldest = newest_ - static_cast<int64_t>(kTaps) + 1;
+        if (length_ == 0 && oldest > start) {
+            auto skip
+                = std::min(static_cast<size_t>(oldest - start), frames - used);
+            used += skip;
+            base_ += static_cast<int64_t>(skip);
+            continue;
+        }
+        auto chunk = std::min(room, frames - used);
+        append(input.data() + used * Channels, chunk);
+        used += chunk;
+    }
+    if (frames == 0) {
+        reset();
+    }
+    return { output.first(generated * Channels), ErrorNone };
+}
+
+template <size_t In, size_t Out, size_t Channels, SRCpp::Type Q>
+template <SupportedSampleType To, SupportedSampleType From>
+inline auto FixedRatioConverter<In, Out, Channels, Q>::convert_noalloc(
+    std::span<const From> input, std::span<To> output) noexcept
+    -> std::pair<std::span<To>, int>
+{
+    return process(input, output);
+}
+
+template <size_t In, size_t Out, size_t Channels, SRCpp::Type Q>
+template <SupportedSampleType To>
+inline auto FixedRatioConverter<In, Out, Channels, Q>::flush_noalloc(
+    std::span<To> output) noexcept -> std::pair<std::span<To>, int>
+{
+    return process(std::span<const float> {}, output);
+}
+
+template <size_t In, size_t Out, size_t Channels, SRCpp::Type Q>
+template <SupportedSampleType To, SupportedSampleType From>
+inline auto FixedRatioConverter<In, Out, Channels, Q>::convert(
+    std::span<const From> input, std::span<To> output)
+    -> std::pair<std::optional<std::span<To>>, std::string>
+{
+    auto [result, error] = process(input, output);
+    if (error != 0) {
+        return { std::nullopt, StrError(error) };
+    }
+    return { result, {} };
+}
+
+template <size_t In, size_t Out, size_t Channels, SRCpp::Type Q>
+template <SupportedSampleType To, SupportedSampleType From>
+inline auto FixedRatioConverter<In, Out, Channels, Q>::convert(
+    std::span<const From> input)
+    -> std::pair<std::optional<std::vector<To>>, std::string>
+{
+    std::vector<To> output(output_frames(input.size() / Channels) * Channels);
+    auto [result, error] = process(input, std::span<To> { output });
+    if (error != 0) {
+        return { std::nullopt, StrError(error) };
+    }
+    output.resize(result.size());
+    return { std::move(output), {} };
+}
+
+template <size_t In, size_t Out, size_t Channels, SRCpp::Type Q>
+template <SupportedSampleType To>
+inline auto FixedRatioConverter<In, Out, Channels, Q>::flush()
+    -> std::pair<std::optional<std::vector<To>>, std::string>
+{
+    return convert<To, float>(std::span<const float> {});
 }
 
 // deduction helpers
@@ -1395,6 +6712,109 @@ auto Convert(FromContainer const& input, SRCpp::Type type, int channels,
         std::span<const From> { input }, type, channels, factor);
 }
 
+template <SupportedSampleType To, SupportedSampleType From>
+auto Convert(PlanarSpan<From> input, PlanarSpan<To> output, SRCpp::Type type,
+    double factor)
+{
+    return Convert<To, From>(
+        PlanarSpan<const From> { input }, output, type, factor);
+}
+
+template <SupportedSampleType To, SupportedSampleType From>
+auto Convert(PlanarSpan<From> input, SRCpp::Type type, double factor)
+{
+    return Convert<To, From>(PlanarSpan<const From> { input }, type, factor);
+}
+
+#if SRCPP_USE_CPP23
+template <typename FromContainer, typename ToContainer,
+    SupportedSampleType From = typename FromContainer::value_type,
+    SupportedSampleType To = typename ToContainer::value_type>
+auto ConvertFormat_expected(FromContainer const& input, ToContainer& output)
+    -> std::expected<std::span<To>, std::string>
+{
+    return ConvertFormat_expected<To, From>(
+        std::span<const From> { input }, std::span<To> { output });
+}
+
+template <SupportedSampleType To, typename FromContainer,
+    SupportedSampleType From = typename FromContainer::value_type>
+auto ConvertFormat_expected(FromContainer const& input)
+    -> std::expected<std::vector<To>, std::string>
+{
+    return ConvertFormat_expected<To, From>(std::span<const From> { input });
+}
+#endif // SRCPP_USE_CPP23
+
+template <typename FromContainer, typename ToContainer,
+    SupportedSampleType From = typename FromContainer::value_type,
+    SupportedSampleType To = typename ToContainer::value_type>
+auto ConvertFormat(FromContainer const& input, ToContainer& output)
+    -> std::pair<std::optional<std::span<To>>, std::string>
+{
+    return ConvertFormat<To, From>(
+        std::span<const From> { input }, std::span<To> { output });
+}
+
+template <SupportedSampleType To, typename FromContainer,
+    SupportedSampleType From = typename FromContainer::value_type>
+auto ConvertFormat(FromContainer const& input)
+    -> std::pair<std::optional<std::vector<To>>, std::string>
+{
+    return ConvertFormat<To, From>(std::span<const From> { input });
+}
+
+#if SRCPP_USE_GENERATOR
+namespace details {
+    template <SupportedSampleType To, typename Chunks>
+    auto ResampleStream(PushConverter converter, size_t channels,
+        Chunks chunks) -> std::generator<std::span<const To>>
+    {
+        using From = std::remove_cv_t<std::ranges::range_value_t<
+            std::ranges::range_reference_t<Chunks>>>;
+        // grows to the largest chunk's output and is reused from then on
+        std::vector<To> output;
+        for (auto&& chunk : chunks) {
+            auto input = std::span<const From> { std::ranges::data(chunk),
+                std::ranges::size(chunk) };
+            auto needed
+                = converter.max_output_frames(input.size() / channels)
+                * channels;
+            if (output.size() < needed) {
+                output.resize(needed);
+            }
+            auto [result, error]
+                = converter.convert(input, std::span<To> { output });
+            if (!result) {
+                throw std::runtime_error(error);
+            }
+            if (!result->empty()) {
+                co_yield *result;
+            }
+        }
+        auto [flushed, error] = converter.template flush<To>();
+        if (!flushed) {
+            throw std::runtime_error(error);
+        }
+        if (!flushed->empty()) {
+            co_yield *flushed;
+        }
+    }
+}
+
+template <SupportedSampleType To, std::ranges::viewable_range Chunks>
+    requires details::SampleChunkRange<Chunks>
+inline auto resample_stream(Chunks&& chunks, SRCpp::Type type, int channels,
+    double factor) -> std::generator<std::span<const To>>
+{
+    // the converter is built here, not in the coroutine, so that bad
+    // arguments throw from this call
+    return details::ResampleStream<To>(PushConverter { type, channels, factor },
+        static_cast<size_t>(channels),
+        std::views::all(std::forward<Chunks>(chunks)));
+}
+#endif // SRCPP_USE_GENERATOR
+
 namespace details {
     static_assert(SupportedSampleType<int>);
     static_assert(!SupportedSampleType<double>);
@@ -0,0 +1,268 @@
+#pragma once
+/*
+MIT License
+
+Copyright (c) 2025 Richard Powell
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <SRCpp/SRCpp.hpp>
+#include <SRCpp/SRCppRing.hpp>
+#include <atomic>
+
+// AdaptiveResampler: bridges two independent clocks, such as a capture and a
+// playback device.  The producer queues input in a wait-free ring; the
+// consumer reads converted output, and a control loop nudges the factor so
+// the queue holds a target latency however far the clocks drift apart.
+namespace SRCpp {
+
+// Tuning for AdaptiveResampler.  Frame counts are input frames.
+struct AdaptiveOptions {
+    // What the loop keeps queued between producer and consumer, which is the
+    // latency the resampler adds.
+    size_t target_frames { 2048 };
+    // The ring's size.  Input that does not fit is dropped.
+    size_t capacity_frames { 8192 };
+    // The largest correction to the nominal factor, as a fraction: 1e-3 is
+    // 1000 ppm.
+    double max_deviation { 1e-3 };
+    // About how long the loop takes to settle after the drift changes.  A
+    // slower loop passes less of the fill level's jitter on to the factor.
+    double response_frames { 480000.0 };
+};
+
+class AdaptiveResampler {
+public:
+    // factor is the nominal output rate / input rate.  type must be one that
+    // can ramp its factor, so not a Polyphase type.  Throws
+    // std::runtime_error on bad arguments, as PushConverter does.
+    AdaptiveResampler(SRCpp::Type type, int channels, double factor,
+        AdaptiveOptions options = {});
+    AdaptiveResampler(const AdaptiveResampler&) = delete;
+    auto operator=(const AdaptiveResampler&) -> AdaptiveResampler& = delete;
+
+    // Producer thread.  Queues whole frames of input, converted to float,
+    // and returns how many fit.  The rest are dropped and counted.
+    template <SupportedSampleType From>
+    auto write(std::span<const From> input) noexcept -> size_t;
+
+    // Consumer thread.  Always fills output.  Until target_frames are queued,
+    // and again after the queue runs dry, the output is silence.  Only
+    // non-float output allocates, for a scratch buffer.
+    template <SupportedSampleType To>
+    auto read(std::span<To> output)
+        -> std::pair<std::optional<std::span<To>>, std::string>;
+
+    // Timestamp feedback, from any thread: the latency between the clocks
+    // as the caller measured it, in input frames.  Once reported, the loop
+    // follows the latest report instead of the queue's fill level.
+    void report_latency(double frames) noexcept;
+
+    // For monitoring, from any thread.  level() is the input frames queued,
+    // counting those the converter has taken in but not used yet.
+    auto ratio() const noexcept -> double
+    {
+        return ratio_.load(std::memory_order_relaxed);
+    }
+    auto level() const noexcept -> size_t;
+    auto underruns() const noexcept -> size_t
+    {
+        return underruns_.load(std::memory_order_relaxed);
+    }
+    auto overruns() const noexcept -> size_t
+    {
+        return overruns_.load(std::memory_order_relaxed);
+    }
+
+    template <typename FromContainer,
+        SupportedSampleType From = typename FromContainer::value_type>
+    auto write(FromContainer const& input) noexcept
+    {
+        return write(std::span<const From> { input });
+    }
+
+    template <typename ToContainer,
+        SupportedSampleType To = typename ToContainer::value_type>
+    auto read(ToContainer& output)
+    {
+        return read(std::span<To> { output });
+    }
+
+private:
+    // input frames handed to the converter per callback
+    static constexpr size_t kChunk = 256;
+
+    auto pull() noexcept -> std::span<float>;
+    void steer(size_t frames) noexcept;
+
+    size_t channels_;
+    double factor_;
+    AdaptiveOptions options_;
+    // PI gains for a critically damped loop settling in response_frames
+    double proportional_;
+    double integral_gain_;
+    SpscRing<float> ring_;
+    std::vector<float> chunk_;
+    PullConverter converter_;
+
+    // consumer state
+    bool primed_ { false };
+    bool starved_ { false };
+    size_t pulled_ { 0 };
+    double smoothed_ { 0.0 };
+    double integral_ { 0.0 };
+
+    // Input the converter holds, estimated as what it pulled less what the
+    // output it produced used up.
+    std::atomic<double> held_ { 0.0 };
+    std::atomic<double> ratio_;
+    std::atomic<double> reported_ { -1.0 };
+    std::atomic<size_t> underruns_ { 0 };
+    std::atomic<size_t> overruns_ { 0 };
+};
+
+// Implementation details
+inline AdaptiveResampler::AdaptiveResampler(
+    SRCpp::Type type, int channels, double factor, AdaptiveOptions options)
+    : channels_ { static_cast<size_t>(std::max(channels, 0)) }
+    , factor_ { factor }
+    , options_ { options }
+    , proportional_ { 2.0 / options.response_frames }
+    , integral_gain_ { 1.0
+          / (options.response_frames * options.response_frames) }
+    , ring_ { std::max(options.capacity_frames, options.target_frames)
+          * channels_ }
+    , chunk_(kChunk * channels_)
+    , converter_ { [this] { return pull(); }, type, channels, factor }
+    , ratio_ { factor }
+{
+    if (details::IsPolyphase(type)) {
+        throw std::runtime_error(
+            "AdaptiveResampler needs a type that can ramp its factor; the "
+            "Polyphase types cannot.");
+    }
+}
+
+inline auto AdaptiveResampler::level() const noexcept -> size_t
+{
+    if (channels_ == 0) {
+        return 0;
+    }
+    auto held = held_.load(std::memory_order_relaxed);
+    return ring_.size() / channels_ + static_cast<size_t>(held + 0.5);
+}
+
+inline void AdaptiveResampler::report_latency(double frames) noexcept
+{
+    reported_.store(std::max(frames, 0.0), std::memory_order_relaxed);
+}
+
+template <SupportedSampleType From>
+inline auto AdaptiveResampler::write(std::span<const From> input) noexcept
+    -> size_t
+{
+    auto frames = input.size() / channels_;
+    auto [first, second] = ring_.write_regions();
+    auto fit = std::min(frames, (first.size() + second.size()) / channels_);
+    auto samples = fit * channels_;
+    auto head = std::min(samples, first.size());
+    details::ConvertSamples<float, From>(input.first(head), first.data());
+    details::ConvertSamples<float, From>(
+        input.subspan(head, samples - head), second.data());
+    ring_.commit_write(samples);
+    if (fit < frames) {
+        overruns_.fetch_add(frames - fit, std::memory_order_relaxed);
+    }
+    return fit;
+}
+
+inline auto AdaptiveResampler::pull() noexcept -> std::span<float>
+{
+    // the converter asks for input as it needs it; running dry hands it
+    // silence rather than ending the stream
+    auto samples = ring_.read(std::span { chunk_ });
+    samples -= samples % channels_;
+    pulled_ += samples / channels_;
+    if (samples == 0) {
+        starved_ = true;
+        std::fill(chunk_.begin(), chunk_.end(), 0.0f);
+        return chunk_;
+    }
+    return std::span { chunk_ }.first(samples);
+}
+
+inline void AdaptiveResampler::steer(size_t frames) noexcept
+{
+    auto reported = reported_.load(std::memory_order_relaxed);
+    auto measured
+        = reported >= 0.0 ? reported : static_cast<double>(level());
+    // the fill level saws up and down with the block sizes on both sides, so
+    // the loop follows its average
+    auto elapsed = static_cast<double>(frames) / factor_;
+    auto smoothing = options_.response_frames / 4.0;
+    smoothed_ += (measured - smoothed_) * elapsed / (elapsed + smoothing);
+
+    auto error = smoothed_ - static_cast<double>(options_.target_frames);
+    auto limit = options_.max_deviation;
+    integral_ = std::clamp(integral_ + error * elapsed,
+        -limit / integral_gain_, limit / integral_gain_);
+    auto correction = std::clamp(
+        proportional_ * error + integral_gain_ * integral_, -limit, limit);
+    // more queued than wanted means the producer is ahead, so consume input
+    // faster with a smaller factor
+    ratio_.store(factor_ * (1.0 - correction), std::memory_order_relaxed);
+}
+
+template <SupportedSampleType To>
+inline auto AdaptiveResampler::read(std::span<To> output)
+    -> std::pair<std::optional<std::span<To>>, std::string>
+{
+    auto frames = output.size() / channels_;
+    if (!primed_) {
+        if (level() < options_.target_frames) {
+            std::fill(output.begin(), output.end(), To {});
+            return { output, {} };
+        }
+        primed_ = true;
+        smoothed_ = static_cast<double>(level());
+    }
+    auto previous = ratio();
+    steer(frames);
+    pulled_ = 0;
+    auto [result, error] = converter_.convert(
+        output.first(frames * channels_), ratio(), RatioMode::Ramp);
+    if (!result) {
+        return { std::nullopt, error };
+    }
+    // the ramp moves the factor linearly across the output
+    auto used = static_cast<double>(frames) * 0.5
+        * (1.0 / previous + 1.0 / ratio());
+    auto held = held_.load(std::memory_order_relaxed);
+    held_.store(std::clamp(held + static_cast<double>(pulled_) - used, 0.0,
+                    static_cast<double>(2 * kChunk)),
+        std::memory_order_relaxed);
+    if (starved_) {
+        starved_ = false;
+        primed_ = false;
+        underruns_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return { output, {} };
+}
+}
@@ -0,0 +1,159 @@
+#pragma once
+/*
+MIT License
+
+Copyright (c) 2025 Richard Powell
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <SRCpp/SRCppConverterPool.hpp>
+#include <SRCpp/SRCppFile.hpp>
+#include <SRCpp/SRCppParallel.hpp>
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+
+// ConvertMany: converts a batch of files across all cores.  The largest
+// files start first, so one long file picked up last does not hold up the
+// whole batch, and each worker keeps its converters and buffers from one
+// file to the next instead of setting them up per file.
+namespace SRCpp {
+
+// One file of a batch.  ConvertMany fills in stats, or error if the file
+// could not be converted.
+struct Job {
+    std::filesystem::path input {};
+    std::filesystem::path output {};
+    FileOptions options {};
+    std::optional<FileStats> stats {};
+    std::string error {};
+};
+
+// The batch as a whole.
+struct BatchStats {
+    size_t converted { 0 };
+    size_t failed { 0 };
+    size_t input_frames { 0 };
+    size_t output_frames { 0 };
+    double seconds { 0.0 };
+
+    // input frames converted per second of wall-clock time
+    auto frames_per_second() const -> double
+    {
+        return seconds > 0.0 ? static_cast<double>(input_frames) / seconds
+                             : 0.0;
+    }
+};
+
+// Converts every job, on threads workers (0 uses one per hardware thread),
+// and returns once all are done.  A job that fails does not stop the others.
+auto ConvertMany(std::span<Job> jobs, size_t threads = 0) -> BatchStats;
+
+// Implementation details
+namespace details {
+    // Job indices, largest input first.  Files that cannot be sized sort
+    // last; converting them reports why.
+    inline auto ScheduleJobs(std::span<const Job> jobs) -> std::vector<size_t>
+    {
+        auto sizes = std::vector<uintmax_t>(jobs.size());
+        for (size_t index = 0; index < jobs.size(); ++index) {
+            auto error = std::error_code {};
+            auto size = std::filesystem::file_size(jobs[index].input, error);
+            sizes[index] = error ? 0 : size;
+        }
+        auto order = std::vector<size_t>(jobs.size());
+        std::iota(order.begin(), order.end(), size_t { 0 });
+        std::stable_sort(order.begin(), order.end(),
+            [&](size_t a, size_t b) { return sizes[a] > sizes[b]; });
+        return order;
+    }
+
+    // Converts one job with a converter from pool.
+    inline void RunJob(
+        Job& job, ConverterPool& pool, FileWorkspace& workspace)
+    {
+        auto [source, source_error] = OpenAudio(job.input, job.options);
+        if (!source) {
+            job.error = source_error;
+            return;
+        }
+        auto [converter, converter_error] = pool.acquire(job.options.type,
+            source->layout.channels, FileFactor(job.options, source->layout));
+        if (!converter) {
+            job.error = StrError(converter_error);
+            return;
+        }
+        std::tie(job.stats, job.error) = ConvertAudio(
+            *source, job.output, job.options, **converter, workspace);
+    }
+}
+
+inline auto ConvertMany(std::span<Job> jobs, size_t threads) -> BatchStats
+{
+    auto start = std::chrono::steady_clock::now();
+    for (auto& job : jobs) {
+        job.stats.reset();
+        job.error.clear();
+    }
+    auto order = details::ScheduleJobs(jobs);
+    if (threads == 0) {
+        threads = std::max(std::thread::hardware_concurrency(), 1U);
+    }
+    threads = std::clamp<size_t>(threads, 1, std::max<size_t>(jobs.size(), 1));
+
+    // workers take the next job in order as they finish one, so the small
+    // files at the end fill in around the large ones
+    auto next = std::atomic<size_t> { 0 };
+    auto task = [&](size_t) {
+        // one converter of each kind is enough for a worker
+        auto pool = ConverterPool { 1 };
+        auto workspace = details::FileWorkspace {};
+        for (auto index = next.fetch_add(1, std::memory_order_relaxed);
+            index < order.size();
+            index = next.fetch_add(1, std::memory_order_relaxed)) {
+            auto& job = jobs[order[index]];
+            // an exception cannot cross back from a worker thread
+            try {
+                details::RunJob(job, pool, workspace);
+            } catch (const std::exception& e) {
+                job.stats.reset();
+                job.error = e.what();
+            }
+        }
+    };
+    auto pool = details::WorkerPool(threads);
+    pool.run(task);
+
+    auto stats = BatchStats {};
+    for (const auto& job : jobs) {
+        if (!job.stats) {
+            ++stats.failed;
+            continue;
+        }
+        ++stats.converted;
+        stats.input_frames += job.stats->input_frames;
+        stats.output_frames += job.stats->output_frames;
+    }
+    stats.seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start)
+                        .count();
+    return stats;
+}
+}
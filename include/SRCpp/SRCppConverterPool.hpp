@@ -0,0 +1,215 @@
+#pragma once
+/*
+MIT License
+
+Copyright (c) 2025 Richard Powell
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <SRCpp/SRCpp.hpp>
+#include <map>
+#include <mutex>
+
+// ConverterPool: recycles PushConverters so that setting up a stream does not
+// pay for src_new and fresh staging buffers each time.  Converters are kept
+// per (Type, channels), handed out reset, and come back when their lease ends.
+namespace SRCpp {
+
+class ConverterPool {
+public:
+    // A converter on loan from the pool; returned to it on destruction.  A
+    // lease must not outlive its pool.  Once moved from or released it holds
+    // nothing and returns nothing.
+    class Lease {
+    public:
+        Lease(Lease&& other) noexcept;
+        auto operator=(Lease&& other) noexcept -> Lease&;
+        ~Lease();
+
+        auto operator*() -> PushConverter& { return converter_; }
+        auto operator->() -> PushConverter* { return &converter_; }
+
+        // Keeps the converter instead of returning it.
+        auto release() && -> PushConverter;
+
+    private:
+        friend class ConverterPool;
+        Lease(ConverterPool* pool, SRCpp::Type type, int channels,
+            PushConverter converter);
+
+        ConverterPool* pool_ { nullptr };
+        SRCpp::Type type_ { SRCpp::Type::Sinc_BestQuality };
+        int channels_ { 0 };
+        PushConverter converter_;
+    };
+
+    // Keeps at most max_idle converters of each (Type, channels).
+    explicit ConverterPool(size_t max_idle = 16);
+    ConverterPool(const ConverterPool&) = delete;
+    auto operator=(const ConverterPool&) -> ConverterPool& = delete;
+
+    // A reset converter, reused if one is idle.  Like PushConverter::create,
+    // reports errors as codes (see StrError) instead of throwing.
+    auto acquire(SRCpp::Type type, int channels, double factor) noexcept
+        -> std::pair<std::optional<Lease>, int>;
+
+    // Creates count idle converters ahead of time.
+    auto reserve(SRCpp::Type type, int channels, size_t count) noexcept -> int;
+
+    // Idle converters of the given kind, or of every kind.
+    auto idle(SRCpp::Type type, int channels) const -> size_t;
+    auto idle() const -> size_t;
+
+private:
+    using Key = std::pair<SRCpp::Type, int>;
+
+    void giveBack(Key key, PushConverter&& converter) noexcept;
+
+    size_t max_idle_;
+    mutable std::mutex mutex_;
+    std::map<Key, std::vector<PushConverter>> idle_;
+};
+
+// Implementation details
+inline ConverterPool::Lease::Lease(ConverterPool* pool, SRCpp::Type type,
+    int channels, PushConverter converter)
+    : pool_ { pool }
+    , type_ { type }
+    , channels_ { channels }
+    , converter_ { std::move(converter) }
+{
+}
+
+inline ConverterPool::Lease::Lease(Lease&& other) noexcept
+    : pool_ { std::exchange(other.pool_, nullptr) }
+    , type_ { other.type_ }
+    , channels_ { other.channels_ }
+    , converter_ { std::move(other.converter_) }
+{
+}
+
+inline auto ConverterPool::Lease::operator=(Lease&& other) noexcept -> Lease&
+{
+    if (this != &other) {
+        if (pool_) {
+            pool_->giveBack({ type_, channels_ }, std::move(converter_));
+        }
+        pool_ = std::exchange(other.pool_, nullptr);
+        type_ = other.type_;
+        channels_ = other.channels_;
+        converter_ = std::move(other.converter_);
+    }
+    return *this;
+}
+
+inline ConverterPool::Lease::~Lease()
+{
+    if (pool_) {
+        pool_->giveBack({ type_, channels_ }, std::move(converter_));
+    }
+}
+
+inline auto ConverterPool::Lease::release() && -> PushConverter
+{
+    pool_ = nullptr;
+    return std::move(converter_);
+}
+
+inline ConverterPool::ConverterPool(size_t max_idle)
+    : max_idle_ { max_idle }
+{
+}
+
+inline auto ConverterPool::acquire(
+    SRCpp::Type type, int channels, double factor) noexcept
+    -> std::pair<std::optional<Lease>, int>
+{
+    auto converter = [&]() -> std::optional<PushConverter> {
+        auto lock = std::unique_lock { mutex_ };
+        auto found = idle_.find({ type, channels });
+        if (found == idle_.end() || found->second.empty()) {
+            return std::nullopt;
+        }
+        auto converter = std::move(found->second.back());
+        found->second.pop_back();
+        return converter;
+    }();
+    if (converter.has_value()) {
+        // reset outside the lock; a converter that will not reset is dropped
+        if (auto error = converter->reset(factor); error == ErrorNone) {
+            return { Lease(this, type, channels, std::move(*converter)),
+                ErrorNone };
+        } else if (error == ErrorBadFactor) {
+            giveBack({ type, channels }, std::move(*converter));
+            return { std::nullopt, error };
+        }
+    }
+    auto [created, error] = PushConverter::create(type, channels, factor);
+    if (!created.has_value()) {
+        return { std::nullopt, error };
+    }
+    return { Lease(this, type, channels, std::move(*created)), ErrorNone };
+}
+
+inline auto ConverterPool::reserve(
+    SRCpp::Type type, int channels, size_t count) noexcept -> int
+{
+    for (size_t made = 0; made < count; ++made) {
+        auto [created, error] = PushConverter::create(type, channels, 1.0);
+        if (!created.has_value()) {
+            return error;
+        }
+        giveBack({ type, channels }, std::move(*created));
+    }
+    return ErrorNone;
+}
+
+inline auto ConverterPool::idle(SRCpp::Type type, int channels) const -> size_t
+{
+    auto lock = std::unique_lock { mutex_ };
+    auto found = idle_.find({ type, channels });
+    return found == idle_.end() ? 0 : found->second.size();
+}
+
+inline auto ConverterPool::idle() const -> size_t
+{
+    auto lock = std::unique_lock { mutex_ };
+    auto total = size_t { 0 };
+    for (const auto& [key, converters] : idle_) {
+        total += converters.size();
+    }
+    return total;
+}
+
+inline void ConverterPool::giveBack(
+    Key key, PushConverter&& converter) noexcept
+{
+    auto lock = std::unique_lock { mutex_ };
+    // dropping it is the only option if the pool cannot grow
+    try {
+        auto& converters = idle_[key];
+        if (converters.size() < max_idle_) {
+            converters.push_back(std::move(converter));
+        }
+    } catch (const std::bad_alloc&) {
+    }
+}
+
+} // namespace SRCpp
@@ -0,0 +1,781 @@
+#pragma once
+/*
+MIT License
+
+Copyright (c) 2025 Richard Powell
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <SRCpp/SRCpp.hpp>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+
+#if __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SRCPP_HAS_MMAP 1
+#else
+#define SRCPP_HAS_MMAP 0
+#endif
+
+// ConvertFile: converts raw PCM or WAV/RF64 files of any size.  Both files
+// are memory-mapped and the audio streams through a PushConverter in large
+// blocks, with the pages behind each block released as it goes, so memory
+// use stays bounded however long the file is.
+namespace SRCpp {
+
+// Sample encodings in files, all little-endian.
+enum class FileFormat {
+    Int16,
+    Int24,
+    Int32,
+    Float32,
+};
+
+// How headerless PCM input is laid out.
+struct RawLayout {
+    int channels { 2 };
+    double sample_rate { 48000.0 };
+    FileFormat format { FileFormat::Int16 };
+};
+
+struct FileOptions {
+    SRCpp::Type type { SRCpp::Type::Sinc_MediumQuality };
+    // output rate / input rate, unless output_rate is set
+    double factor { 1.0 };
+    std::optional<double> output_rate {};
+    // the input's format if not set
+    std::optional<FileFormat> output_format {};
+    // Reads the input as headerless PCM laid out like this, rather than as
+    // WAV or RF64.
+    std::optional<RawLayout> raw_input {};
+    // Writes headerless PCM, rather than WAV, or RF64 once the audio needs
+    // more than 4 GiB.
+    bool raw_output { false };
+    // input frames converted at a time
+    size_t block_frames { 65536 };
+};
+
+// What ConvertFile wrote.
+struct FileStats {
+    size_t input_frames { 0 };
+    size_t output_frames { 0 };
+    int channels { 0 };
+    double output_rate { 0.0 };
+    FileFormat output_format { FileFormat::Int16 };
+};
+
+// Returns what was written, or std::nullopt and an error.  The output file is
+// created or replaced, and removed again if the conversion fails.  Needs a
+// system with mmap.
+auto ConvertFile(const std::filesystem::path& input,
+    const std::filesystem::path& output, const FileOptions& options = {})
+    -> std::pair<std::optional<FileStats>, std::string>;
+
+// Implementation details
+namespace details {
+    inline auto BytesPerSample(FileFormat format) -> size_t
+    {
+        switch (format) {
+        case FileFormat::Int16:
+            return 2;
+        case FileFormat::Int24:
+            return 3;
+        case FileFormat::Int32:
+        case FileFormat::Float32:
+            return 4;
+        }
+        return 0;
+    }
+
+    // A file mapped into memory, shared with the file so that writes land in
+    // it.  Move-only.
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        MappedFile(MappedFile&& other) noexcept
+            : fd_ { std::exchange(other.fd_, -1) }
+            , data_ { std::exchange(other.data_, nullptr) }
+            , size_ { std::exchange(other.size_, 0) }
+            , released_ { std::exchange(other.released_, 0) }
+        {
+        }
+        auto operator=(MappedFile&& other) noexcept -> MappedFile&
+        {
+            std::swap(fd_, other.fd_);
+            std::swap(data_, other.data_);
+            std::swap(size_, other.size_);
+            std::swap(released_, other.released_);
+            return *this;
+        }
+        ~MappedFile() { close(); }
+
+        static auto open(const std::filesystem::path& path)
+            -> std::pair<std::optional<MappedFile>, std::string>;
+        static auto create(const std::filesystem::path& path, size_t size)
+            -> std::pair<std::optional<MappedFile>, std::string>;
+
+        auto bytes() const noexcept -> std::span<std::byte>
+        {
+            return { data_, size_ };
+        }
+
+        // Drops the whole pages before end that are still mapped in.
+        // Written pages are already in the file's page cache, so nothing is
+        // lost; they are only no longer counted against this process.
+        void release(size_t end) noexcept;
+
+        // Unmaps the file and cuts it to size.
+        auto truncate(size_t size) -> std::string;
+
+    private:
+        void close() noexcept;
+
+        int fd_ { -1 };
+        std::byte* data_ { nullptr };
+        size_t size_ { 0 };
+        size_t released_ { 0 };
+    };
+
+#if SRCPP_HAS_MMAP
+    inline auto MappedFile::open(const std::filesystem::path& path)
+        -> std::pair<std::optional<MappedFile>, std::string>
+    {
+        auto file = MappedFile {};
+        file.fd_ = ::open(path.c_str(), O_RDONLY);
+        if (file.fd_ < 0) {
+            return { std::nullopt,
+                std::format("Could not open {}: {}", path.string(),
+                    std::strerror(errno)) };
+        }
+        struct stat info { };
+        if (::fstat(file.fd_, &info) != 0) {
+            return { std::nullopt,
+                std::format("Could not stat {}: {}", path.string(),
+                    std::strerror(errno)) };
+        }
+        file.size_ = static_cast<size_t>(info.st_size);
+        if (file.size_ != 0) {
+            auto* data = ::mmap(
+                nullptr, file.size_, PROT_READ, MAP_SHARED, file.fd_, 0);
+            if (data == MAP_FAILED) {
+                return { std::nullopt,
+                    std::format("Could not map {}: {}", path.string(),
+                        std::strerror(errno)) };
+            }
+            file.data_ = static_cast<std::byte*>(data);
+            ::madvise(data, file.size_, MADV_SEQUENTIAL);
+        }
+        return { std::move(file), std::string {} };
+    }
+
+    inline auto MappedFile::create(
+        const std::filesystem::path& path, size_t size)
+        -> std::pair<std::optional<MappedFile>, std::string>
+    {
+        auto file = MappedFile {};
+        file.fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+        if (file.fd_ < 0) {
+            return { std::nullopt,
+                std::format("Could not create {}: {}", path.string(),
+                    std::strerror(errno)) };
+        }
+        // the file made here is not left behind if it cannot be set up
+        auto fail = [&](std::string_view what, int error)
+            -> std::pair<std::optional<MappedFile>, std::string> {
+            ::unlink(path.c_str());
+            return { std::nullopt,
+                std::format("Could not {} {}: {}", what, path.string(),
+                    std::strerror(error)) };
+        };
+        if (::ftruncate(file.fd_, static_cast<off_t>(size)) != 0) {
+            return fail("size", errno);
+        }
+#if defined(__linux__)
+        // reserve the blocks now, so a full disk fails here rather than as a
+        // SIGBUS on a write through the mapping
+        if (size != 0) {
+            if (auto error = ::posix_fallocate(
+                    file.fd_, 0, static_cast<off_t>(size));
+                error != 0) {
+                return fail("allocate", error);
+            }
+        }
+#endif
+        file.size_ = size;
+        if (size != 0) {
+            auto* data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                MAP_SHARED, file.fd_, 0);
+            if (data == MAP_FAILED) {
+                return fail("map", errno);
+            }
+            file.data_ = static_cast<std::byte*>(data);
+        }
+        return { std::move(file), std::string {} };
+    }
+
+    inline void MappedFile::release(size_t end) noexcept
+    {
+        auto page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        auto last = std::min(end, size_) / page * page;
+        if (data_ == nullptr || last <= released_) {
+            return;
+        }
+        ::msync(data_ + released_, last - released_, MS_ASYNC);
+        ::madvise(data_ + released_, last - released_, MADV_DONTNEED);
+        released_ = last;
+    }
+
+    inline auto MappedFile::truncate(size_t size) -> std::string
+    {
+        if (data_ != nullptr) {
+            ::munmap(data_, size_);
+            data_ = nullptr;
+        }
+        size_ = 0;
+        if (::ftruncate(fd_, static_cast<off_t>(size)) != 0) {
+            return std::format("Could not size output: {}",
+                std::strerror(errno));
+        }
+        return {};
+    }
+
+    inline void MappedFile::close() noexcept
+    {
+        if (data_ != nullptr) {
+            ::munmap(data_, size_);
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+        data_ = nullptr;
+        fd_ = -1;
+    }
+#else
+    inline auto MappedFile::open(const std::filesystem::path&)
+        -> std::pair<std::optional<MappedFile>, std::string>
+    {
+        return { std::nullopt, "ConvertFile needs a system with mmap." };
+    }
+
+    inline auto MappedFile::create(const std::filesystem::path&, size_t)
+        -> std::pair<std::optional<MappedFile>, std::string>
+    {
+        return { std::nullopt, "ConvertFile needs a system with mmap." };
+    }
+
+    inline void MappedFile::release(size_t) noexcept { }
+    inline auto MappedFile::truncate(size_t) -> std::string { return {}; }
+    inline void MappedFile::close() noexcept { }
+#endif // SRCPP_HAS_MMAP
+
+    // Little-endian fields, read and written a byte at a time so that
+    // neither alignment nor the host's byte order matters.
+    inline auto ReadLE(std::span<const std::byte> bytes, size_t offset,
+        size_t size) -> uint64_t
+    {
+        uint64_t value = 0;
+        for (size_t i = 0; i < size; ++i) {
+            value |= std::to_integer<uint64_t>(bytes[offset + i]) << (8 * i);
+        }
+        return value;
+    }
+
+    inline void WriteLE(
+        std::span<std::byte> bytes, size_t offset, size_t size, uint64_t value)
+    {
+        for (size_t i = 0; i < size; ++i) {
+            bytes[offset + i] = static_cast<std::byte>(value >> (8 * i));
+        }
+    }
+
+    inline auto FourCC(std::span<const std::byte> bytes, size_t offset)
+        -> std::string_view
+    {
+        return { reinterpret_cast<const char*>(bytes.data() + offset), 4 };
+    }
+
+    // Where the audio is in a file and how it is encoded.
+    struct AudioLayout {
+        size_t offset;
+        size_t frames;
+        int channels;
+        double sample_rate;
+        FileFormat format;
+    };
+
+    // Finds the fmt and data chunks of a WAV or RF64 file.
+    inline auto ParseWav(std::span<const std::byte> bytes)
+        -> std::pair<std::optional<AudioLayout>, std::string>
+    {
+        if (bytes.size() < 12
+            || (FourCC(bytes, 0) != "RIFF" && FourCC(bytes, 0) != "RF64")
+            || FourCC(bytes, 8) != "WAVE") {
+            return { std::nullopt, "Input is not a WAV or RF64 file." };
+        }
+        std::optional<uint64_t> ds64_data_size;
+        std::optional<AudioLayout> layout;
+        uint64_t format_tag = 0;
+        uint64_t bits = 0;
+        size_t offset = 12;
+        while (offset + 8 <= bytes.size()) {
+            auto id = FourCC(bytes, offset);
+            uint64_t size = ReadLE(bytes, offset + 4, 4);
+            auto body = offset + 8;
+            if (id == "ds64" && size >= 16 && body + 16 <= bytes.size()) {
+                ds64_data_size = ReadLE(bytes, body + 8, 8);
+            } else if (id == "fmt " && size >= 16
+                && body + 16 <= bytes.size()) {
+                format_tag = ReadLE(bytes, body, 2);
+                if (format_tag == 0xFFFE && size >= 26
+                    && body + 26 <= bytes.size()) {
+                    // WAVE_FORMAT_EXTENSIBLE: the sub-format GUID starts with
+                    // the real tag
+                    format_tag = ReadLE(bytes, body + 24, 2);
+                }
+                bits = ReadLE(bytes, body + 14, 2);
+                layout = AudioLayout {
+                    0,
+                    0,
+                    static_cast<int>(ReadLE(bytes, body + 2, 2)),
+                    static_cast<double>(ReadLE(bytes, body + 4, 4)),
+                    FileFormat::Int16,
+                };
+            } else if (id == "data") {
+                if (!layout) {
+                    return { std::nullopt,
+                        "WAV data comes before its format." };
+                }
+                if (size == 0xFFFFFFFF && ds64_data_size) {
+                    size = *ds64_data_size;
+                }
+                if (format_tag == 1 && bits == 16) {
+                    layout->format = FileFormat::Int16;
+                } else if (format_tag == 1 && bits == 24) {
+                    layout->format = FileFormat::Int24;
+                } else if (format_tag == 1 && bits == 32) {
+                    layout->format = FileFormat::Int32;
+                } else if (format_tag == 3 && bits == 32) {
+                    layout->format = FileFormat::Float32;
+                } else {
+                    return { std::nullopt,
+                        std::format("Unsupported WAV encoding: format {} with "
+                                    "{} bits.",
+                            format_tag, bits) };
+                }
+                if (layout->channels <= 0) {
+                    return { std::nullopt, "WAV has no channels." };
+                }
+                // a file cut short keeps what it has
+                size = std::min<uint64_t>(size, bytes.size() - body);
+                layout->offset = body;
+                layout->frames = static_cast<size_t>(size)
+                    / (BytesPerSample(layout->format)
+                        * static_cast<size_t>(layout->channels));
+                return { layout, {} };
+            }
+            // chunks are padded to an even size
+            offset = body + static_cast<size_t>(size) + (size & 1);
+        }
+        return { std::nullopt, "WAV has no data chunk." };
+    }
+
+    // WAVE_FORMAT_EXTENSIBLE, which readers expect for more than two
+    // channels or integer samples of more than 16 bits.
+    inline auto WavExtensible(int channels, FileFormat format) -> bool
+    {
+        return channels > 2
+            || (format != FileFormat::Float32 && BytesPerSample(format) > 2);
+    }
+
+    // The fmt chunk's size: plain PCM, IEEE float with an empty extension,
+    // or the extensible form.
+    inline auto WavFormatSize(int channels, FileFormat format) -> size_t
+    {
+        if (WavExtensible(channels, format)) {
+            return 40;
+        }
+        return format == FileFormat::Float32 ? 18 : 16;
+    }
+
+    // The header ConvertFile writes: RIFF, a 28-byte JUNK chunk that becomes
+    // ds64 when the file needs RF64, fmt, and the data chunk's header.
+    inline auto WavHeaderSize(int channels, FileFormat format) -> size_t
+    {
+        return 64 + WavFormatSize(channels, format);
+    }
+
+    // The usual speakers for a channel count, or none past 7.1.
+    inline auto WavChannelMask(int channels) -> uint64_t
+    {
+        static constexpr uint64_t kMasks[]
+            = { 0x4, 0x3, 0x7, 0x33, 0x37, 0x3F, 0x13F, 0x63F };
+        return channels >= 1 && channels <= 8 ? kMasks[channels - 1] : 0;
+    }
+
+    inline void WriteWavHeader(std::span<std::byte> bytes, int channels,
+        double sample_rate, FileFormat format, size_t frames)
+    {
+        auto sample_bytes = BytesPerSample(format);
+        auto block_align = sample_bytes * static_cast<size_t>(channels);
+        auto data_size = static_cast<uint64_t>(frames) * block_align;
+        auto format_size = WavFormatSize(channels, format);
+        auto header_size = WavHeaderSize(channels, format);
+        auto riff_size = data_size + header_size - 8;
+        auto rf64 = riff_size > 0xFFFFFFFF;
+        auto tag = format == FileFormat::Float32 ? 3 : 1;
+        auto fourcc = [&](size_t offset, std::string_view id) {
+            std::memcpy(bytes.data() + offset, id.data(), 4);
+        };
+        fourcc(0, rf64 ? "RF64" : "RIFF");
+        WriteLE(bytes, 4, 4, rf64 ? 0xFFFFFFFF : riff_size);
+        fourcc(8, "WAVE");
+        fourcc(12, rf64 ? "ds64" : "JUNK");
+        WriteLE(bytes, 16, 4, 28);
+        WriteLE(bytes, 20, 8, rf64 ? riff_size : 0);
+        WriteLE(bytes, 28, 8, rf64 ? data_size : 0);
+        WriteLE(bytes, 36, 8, rf64 ? frames : 0);
+        WriteLE(bytes, 44, 4, 0);
+        fourcc(48, "fmt ");
+        WriteLE(bytes, 52, 4, format_size);
+        auto extensible = WavExtensible(channels, format);
+        WriteLE(bytes, 56, 2, extensible ? 0xFFFE : tag);
+        WriteLE(bytes, 58, 2, static_cast<uint64_t>(channels));
+        auto rate = static_cast<uint64_t>(std::lround(sample_rate));
+        WriteLE(bytes, 60, 4, rate);
+        WriteLE(bytes, 64, 4, rate * block_align);
+        WriteLE(bytes, 68, 2, block_align);
+        WriteLE(bytes, 70, 2, sample_bytes * 8);
+        if (format_size > 16) {
+            WriteLE(bytes, 72, 2, format_size - 18);
+        }
+        if (extensible) {
+            WriteLE(bytes, 74, 2, sample_bytes * 8);
+            WriteLE(bytes, 76, 4, WavChannelMask(channels));
+            // the sub-format GUID, KSDATAFORMAT_SUBTYPE_PCM or _IEEE_FLOAT
+            static constexpr uint8_t kGuidTail[] = { 0x00, 0x00, 0x00, 0x00,
+                0x10, 0x00, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71 };
+            WriteLE(bytes, 80, 2, tag);
+            for (size_t i = 0; i < std::size(kGuidTail); ++i) {
+                bytes[82 + i] = static_cast<std::byte>(kGuidTail[i]);
+            }
+        }
+        fourcc(56 + format_size, "data");
+        WriteLE(bytes, 60 + format_size, 4, rf64 ? 0xFFFFFFFF : data_size);
+    }
+
+    // Integer samples on their way between a file and float.
+    struct SampleScratch {
+        std::vector<short> shorts;
+        std::vector<int> ints;
+    };
+
+    // Decodes file samples to float, through the same kernels the rest of
+    // the library uses.  scratch holds at least output.size() samples.
+    inline void DecodeSamples(std::span<const std::byte> bytes,
+        FileFormat format, std::span<float> output, SampleScratch& scratch)
+    {
+        auto count = output.size();
+        switch (format) {
+        case FileFormat::Int16: {
+            auto shorts = std::span { scratch.shorts }.first(count);
+            for (size_t i = 0; i < count; ++i) {
+                shorts[i] = static_cast<short>(ReadLE(bytes, 2 * i, 2));
+            }
+            ConvertSamples<float, short>(shorts, output.data());
+            return;
+        }
+        case FileFormat::Int24:
+            for (size_t i = 0; i < count; ++i) {
+                // to the top of an int, which the int kernel scales by 2^31
+                scratch.ints[i] = static_cast<int>(
+                    static_cast<uint32_t>(ReadLE(bytes, 3 * i, 3)) << 8);
+            }
+            break;
+        case FileFormat::Int32:
+            for (size_t i = 0; i < count; ++i) {
+                scratch.ints[i] = static_cast<int>(
+                    static_cast<uint32_t>(ReadLE(bytes, 4 * i, 4)));
+            }
+            break;
+        case FileFormat::Float32:
+            for (size_t i = 0; i < count; ++i) {
+                output[i] = std::bit_cast<float>(
+                    static_cast<uint32_t>(ReadLE(bytes, 4 * i, 4)));
+            }
+            return;
+        }
+        ConvertSamples<float, int>(
+            std::span<const int> { scratch.ints }.first(count), output.data());
+    }
+
+    inline void EncodeSamples(std::span<const float> input, FileFormat format,
+        std::span<std::byte> bytes, SampleScratch& scratch)
+    {
+        auto count = input.size();
+        auto& ints = scratch.ints;
+        switch (format) {
+        case FileFormat::Int16:
+            ConvertSamples<short, float>(input, scratch.shorts.data());
+            for (size_t i = 0; i < count; ++i) {
+                WriteLE(bytes, 2 * i, 2,
+                    static_cast<uint16_t>(scratch.shorts[i]));
+            }
+            return;
+        case FileFormat::Int24:
+            ConvertSamples<int, float>(input, ints.data());
+            for (size_t i = 0; i < count; ++i) {
+                // round to 24 bits, keeping full scale in range
+                auto rounded = std::min<int64_t>(
+                    (static_cast<int64_t>(ints[i]) + 128) >> 8, 0x7FFFFF);
+                WriteLE(bytes, 3 * i, 3, static_cast<uint64_t>(rounded));
+            }
+            return;
+        case FileFormat::Int32:
+            ConvertSamples<int, float>(input, ints.data());
+            for (size_t i = 0; i < count; ++i) {
+                WriteLE(bytes, 4 * i, 4, static_cast<uint32_t>(ints[i]));
+            }
+            return;
+        case FileFormat::Float32:
+            for (size_t i = 0; i < count; ++i) {
+                WriteLE(bytes, 4 * i, 4, std::bit_cast<uint32_t>(input[i]));
+            }
+            return;
+        }
+    }
+}
+
+namespace details {
+    // An input file, mapped, and where its audio is.
+    struct AudioSource {
+        MappedFile file;
+        AudioLayout layout;
+    };
+
+    inline auto OpenAudio(const std::filesystem::path& path,
+        const FileOptions& options)
+        -> std::pair<std::optional<AudioSource>, std::string>
+    {
+        auto [file, file_error] = MappedFile::open(path);
+        if (!file) {
+            return { std::nullopt, file_error };
+        }
+        auto bytes = file->bytes();
+        auto [layout, layout_error]
+            = [&]() -> std::pair<std::optional<AudioLayout>, std::string> {
+            if (!options.raw_input) {
+                return ParseWav(bytes);
+            }
+            auto raw = *options.raw_input;
+            if (raw.channels <= 0) {
+                return { std::nullopt,
+                    "Raw input needs at least one channel." };
+            }
+            return { AudioLayout { 0,
+                         bytes.size()
+                             / (BytesPerSample(raw.format)
+                                 * static_cast<size_t>(raw.channels)),
+                         raw.channels, raw.sample_rate, raw.format },
+                {} };
+        }();
+        if (!layout) {
+            return { std::nullopt, layout_error };
+        }
+        return { AudioSource { std::move(*file), *layout }, std::string {} };
+    }
+
+    inline auto FileFactor(const FileOptions& options,
+        const AudioLayout& layout) -> double
+    {
+        return options.output_rate ? *options.output_rate / layout.sample_rate
+                                   : options.factor;
+    }
+
+    // The buffers a conversion works in, kept between files by callers that
+    // convert many.
+    struct FileWorkspace {
+        std::vector<float> decoded;
+        std::vector<float> converted;
+        SampleScratch scratch;
+    };
+
+    // What ConvertAudio works out before it creates the output.
+    struct AudioPlan {
+        size_t channels;
+        double factor;
+        double output_rate;
+        FileFormat format;
+        size_t header;
+        size_t max_frames;
+    };
+
+    // Streams source through converter into sink, after the plan.header
+    // bytes left for the header.  Returns the frames written.
+    inline auto StreamAudio(AudioSource& source, MappedFile& sink,
+        const AudioPlan& plan, const FileOptions& options,
+        PushConverter& converter, FileWorkspace& workspace)
+        -> std::pair<std::optional<size_t>, std::string>
+    {
+        auto const& layout = source.layout;
+        auto source_bytes = source.file.bytes();
+        auto sink_bytes = sink.bytes();
+        auto channels = plan.channels;
+        auto in_frame_bytes = BytesPerSample(layout.format) * channels;
+        auto out_frame_bytes = BytesPerSample(plan.format) * channels;
+
+        auto block = std::max<size_t>(options.block_frames, 1);
+        auto out_block = MaxOutputFrames(block, plan.factor);
+        converter.prepare(block, out_block);
+        auto& decoded = workspace.decoded;
+        auto& converted = workspace.converted;
+        auto& scratch = workspace.scratch;
+        auto most = std::max(block, out_block) * channels;
+        decoded.resize(std::max(decoded.size(), block * channels));
+        converted.resize(std::max(converted.size(), out_block * channels));
+        scratch.shorts.resize(std::max(scratch.shorts.size(), most));
+        scratch.ints.resize(std::max(scratch.ints.size(), most));
+
+        size_t written = 0;
+        auto emit = [&](std::span<const float> samples) {
+            auto frames = samples.size() / channels;
+            EncodeSamples(samples, plan.format,
+                sink_bytes.subspan(plan.header + written * out_frame_bytes,
+                    frames * out_frame_bytes),
+                scratch);
+            written += frames;
+            // hand finished pages back to the page cache as we go
+            sink.release(plan.header + written * out_frame_bytes);
+        };
+        for (size_t frame = 0; frame < layout.frames; frame += block) {
+            auto frames = std::min(block, layout.frames - frame);
+            auto samples = std::span { decoded }.first(frames * channels);
+            DecodeSamples(
+                source_bytes.subspan(layout.offset + frame * in_frame_bytes,
+                    frames * in_frame_bytes),
+                layout.format, samples, scratch);
+            source.file.release(
+                layout.offset + (frame + frames) * in_frame_bytes);
+            auto room = std::min(out_block, plan.max_frames - written);
+            auto [result, error] = converter.convert_noalloc(
+                std::span<const float> { samples },
+                std::span { converted }.first(room * channels));
+            if (error != 0) {
+                return { std::nullopt, StrError(error) };
+            }
+            emit(result);
+        }
+        // the flush comes out a block at a time, until one comes back short
+        while (true) {
+            auto room = std::min(out_block, plan.max_frames - written);
+            auto [flushed, error] = converter.flush_noalloc(
+                std::span { converted }.first(room * channels));
+            if (error != 0) {
+                return { std::nullopt, StrError(error) };
+            }
+            emit(flushed);
+            if (flushed.size() < room * channels) {
+                return { written, {} };
+            }
+            if (written == plan.max_frames) {
+                // rather than cut off a tail that outgrew the output
+                auto [over, over_error] = converter.flush_noalloc(
+                    std::span { converted }.first(channels));
+                if (over_error != 0 || !over.empty()) {
+                    return { std::nullopt,
+                        "Output is longer than the room allowed for it." };
+                }
+                return { written, {} };
+            }
+        }
+    }
+
+    // Converts source into output with converter, which must have been set
+    // up for source's channels and FileFactor.  On an error no output file
+    // is left behind.
+    inline auto ConvertAudio(AudioSource& source,
+        const std::filesystem::path& output, const FileOptions& options,
+        PushConverter& converter, FileWorkspace& workspace)
+        -> std::pair<std::optional<FileStats>, std::string>
+    {
+        auto const& layout = source.layout;
+        auto factor = FileFactor(options, layout);
+        if (!src_is_valid_ratio(factor)) {
+            return { std::nullopt, StrError(ErrorBadFactor) };
+        }
+        auto format = options.output_format.value_or(layout.format);
+        // The output is mapped at the most the converter can produce, the
+        // flush's tail included, and cut to what it did produce at the end.
+        auto plan = AudioPlan {
+            static_cast<size_t>(layout.channels),
+            factor,
+            options.output_rate.value_or(layout.sample_rate * factor),
+            format,
+            options.raw_output ? 0 : WavHeaderSize(layout.channels, format),
+            MaxOutputFrames(layout.frames, factor)
+                + converter.max_output_frames(0),
+        };
+        auto frame_bytes = BytesPerSample(format) * plan.channels;
+        auto [sink, sink_error] = MappedFile::create(
+            output, plan.header + plan.max_frames * frame_bytes);
+        if (!sink) {
+            return { std::nullopt, sink_error };
+        }
+        auto [written, error] = StreamAudio(
+            source, *sink, plan, options, converter, workspace);
+        if (written) {
+            if (plan.header != 0) {
+                WriteWavHeader(sink->bytes(), layout.channels,
+                    plan.output_rate, format, *written);
+            }
+            error = sink->truncate(plan.header + *written * frame_bytes);
+        }
+        if (!written || !error.empty()) {
+            sink.reset();
+            auto ignored = std::error_code {};
+            std::filesystem::remove(output, ignored);
+            return { std::nullopt, error };
+        }
+        return { FileStats { layout.frames, *written, layout.channels,
+                     plan.output_rate, format },
+            {} };
+    }
+}
+
+inline auto ConvertFile(const std::filesystem::path& input,
+    const std::filesystem::path& output, const FileOptions& options)
+    -> std::pair<std::optional<FileStats>, std::string>
+{
+    auto [source, source_error] = details::OpenAudio(input, options);
+    if (!source) {
+        return { std::nullopt, source_error };
+    }
+    auto [converter, converter_error] = PushConverter::create(options.type,
+        source->layout.channels, details::FileFactor(options, source->layout));
+    if (!converter) {
+        return { std::nullopt, StrError(converter_error) };
+    }
+    auto workspace = details::FileWorkspace {};
+    return details::ConvertAudio(
+        *source, output, options, *converter, workspace);
+}
+}
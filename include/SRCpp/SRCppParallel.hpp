@@ -0,0 +1,710 @@
+#pragma once
+/*
+MIT License
+
+Copyright (c) 2025 Richard Powell
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <SRCpp/SRCpp.hpp>
+#include <atomic>
+#include <thread>
+
+// ParallelPushConverter: a PushConverter for wide interleaved streams that
+// splits the channels into groups, each with its own SRC_STATE, and converts
+// the groups on a small worker pool.  libsamplerate converts every channel
+// independently, so the output is identical to a single PushConverter's.
+//
+// Convert(..., threads): the one-shot Convert for long buffers, split in time
+// into segments that are converted concurrently and stitched back together.
+namespace SRCpp {
+
+namespace details {
+    // How many times a waiting thread polls before going to sleep.  Blocks
+    // arrive back to back in steady state, so a waiter usually sees the
+    // change while still spinning and never pays for a wake-up.
+    inline constexpr int kSpinIterations = 2048;
+
+    inline void CpuRelax()
+    {
+#if SRCPP_X86
+        _mm_pause();
+#endif
+    }
+
+    // Spins for a while, then sleeps, until value differs from old.
+    template <typename T>
+    inline auto AwaitChange(const std::atomic<T>& value, T old) -> T
+    {
+        for (int spin = 0; spin < kSpinIterations; ++spin) {
+            if (auto current = value.load(std::memory_order_acquire);
+                current != old) {
+                return current;
+            }
+            CpuRelax();
+        }
+        value.wait(old, std::memory_order_acquire);
+        return value.load(std::memory_order_acquire);
+    }
+
+    // A fixed set of workers that all run the same task once per run().  The
+    // calling thread is worker 0, so a pool of n workers owns n - 1 threads.
+    // Every worker gets its own index, so no work is handed out through
+    // shared counters, and a run costs one release and one wait.
+    class WorkerPool {
+    public:
+        explicit WorkerPool(size_t workers);
+        ~WorkerPool();
+        WorkerPool(const WorkerPool&) = delete;
+        auto operator=(const WorkerPool&) -> WorkerPool& = delete;
+
+        auto workers() const -> size_t { return threads_.size() + 1; }
+
+        // Calls task(worker) for every worker index and returns once all of
+        // them have returned.  task must not throw.
+        template <typename Task> void run(Task& task);
+
+    private:
+        void loop(size_t worker);
+
+        std::vector<std::thread> threads_;
+        void (*invoke_)(void*, size_t) { nullptr };
+        void* context_ { nullptr };
+        bool stop_ { false };
+        std::atomic<uint32_t> generation_ { 0 };
+        std::atomic<size_t> remaining_ { 0 };
+    };
+
+    // The channels [first, first + channels) of the caller's stream.
+    struct ChannelGroup {
+        PushConverter push;
+        size_t first { 0 };
+        size_t channels { 0 };
+        std::vector<float> input;
+        std::vector<float> output;
+        std::span<const float> produced;
+        std::string error;
+    };
+
+    // Copies one group's channels out of every interleaved frame of input,
+    // converting to float.
+    template <SupportedSampleType From>
+    inline void GatherChannels(std::span<const From> input, size_t channels,
+        size_t first, size_t count, float* output)
+    {
+        auto frames = input.size() / channels;
+        for (size_t frame = 0; frame < frames; ++frame) {
+            ConvertSamples<float, From>(
+                input.subspan(frame * channels + first, count),
+                output + frame * count);
+        }
+    }
+
+    // The reverse of GatherChannels: writes a group's interleaved float
+    // frames into its channels of output.
+    template <SupportedSampleType To>
+    inline void ScatterChannels(std::span<const float> input, size_t count,
+        To* output, size_t channels, size_t first)
+    {
+        auto frames = input.size() / count;
+        for (size_t frame = 0; frame < frames; ++frame) {
+            ConvertSamples<To, float>(input.subspan(frame * count, count),
+                output + frame * channels + first);
+        }
+    }
+
+    // Segments shorter than this are not worth a thread of their own.
+    inline constexpr size_t kMinSegmentFrames = 16384;
+
+    // The longest stride SegmentStride will consider.
+    inline constexpr size_t kMaxSegmentStride = size_t { 1 } << 20;
+
+    // The shortest run of input frames that factor turns into a whole number
+    // of output frames, as { input, output }.  Segments start on multiples of
+    // it, so the first output of every segment falls exactly on an output of
+    // the serial conversion.  Found from the continued fraction of factor.
+    inline auto SegmentStride(double factor)
+        -> std::optional<std::pair<size_t, size_t>>
+    {
+        auto ratio = RationalFactor(factor, kMaxSegmentStride);
+        if (!ratio.has_value()) {
+            return std::nullopt;
+        }
+        return std::pair { ratio->second, ratio->first };
+    }
+
+    // Input frames on either side of an output that can affect it, with a
+    // little to spare.  The sinc and polyphase filters widen by 1 / factor
+    // when downsampling.
+    inline auto FilterReach(SRCpp::Type type, double factor) -> size_t
+    {
+        auto reach = [type] {
+            switch (type) {
+            case SRCpp::Type::Sinc_BestQuality:
+                return 160.0;
+            case SRCpp::Type::Sinc_MediumQuality:
+                return 64.0;
+            case SRCpp::Type::Sinc_Fastest:
+                return 32.0;
+            case SRCpp::Type::Polyphase_BestQuality:
+                return 214.0;
+            case SRCpp::Type::Polyphase_MediumQuality:
+                return 65.0;
+            case SRCpp::Type::Polyphase_Fastest:
+                return 33.0;
+            default:
+                return 0.0;
+            }
+        }();
+        return static_cast<size_t>(std::ceil(reach / std::min(factor, 1.0)))
+            + 4;
+    }
+
+    // One slice of a parallel Convert.  Input [first, last) is converted
+    // after preroll frames of history, and the first discard output frames,
+    // which that history produces, are dropped.
+    struct Segment {
+        size_t first { 0 };
+        size_t last { 0 };
+        size_t preroll { 0 };
+        size_t postroll { 0 };
+        size_t discard { 0 };
+        size_t output_first { 0 };
+        size_t output_last { 0 };
+        size_t produced { 0 };
+        std::string error;
+    };
+
+    // Splits input_frames into at most threads segments, or returns none if
+    // the conversion should not be split.
+    inline auto PlanSegments(size_t input_frames, size_t output_frames,
+        SRCpp::Type type, double factor, size_t threads) -> std::vector<Segment>
+    {
+        auto stride = SegmentStride(factor);
+        if (!stride.has_value()) {
+            return {};
+        }
+        auto [stride_input, stride_output] = *stride;
+        auto reach = FilterReach(type, factor);
+        // whole strides of history, so the discarded output is whole frames
+        auto preroll = (reach + stride_input - 1) / stride_input * stride_input;
+        auto shortest = std::max(kMinSegmentFrames, 8 * (preroll + reach));
+        auto strides = input_frames / stride_input;
+        auto count = std::min(
+            { threads, input_frames / shortest, strides ? strides : 1 });
+        if (count < 2) {
+            return {};
+        }
+
+        auto segments = std::vector<Segment>(count);
+        auto per_segment = strides / count;
+        for (size_t index = 0; index < count; ++index) {
+            auto& segment = segments[index];
+            auto is_last = index + 1 == count;
+            segment.first = index * per_segment * stride_input;
+            segment.last
+                = is_last ? input_frames : segment.first + per_segment * stride_input;
+            segment.preroll = index ? preroll : 0;
+            segment.postroll = is_last ? 0 : reach;
+            segment.discard = segment.preroll / stride_input * stride_output;
+            segment.output_first = std::min(
+                index * per_segment * stride_output, output_frames);
+            segment.output_last = is_last
+                ? output_frames
+                : std::min((index + 1) * per_segment * stride_output,
+                      output_frames);
+        }
+        return segments;
+    }
+}
+
+class ParallelPushConverter {
+public:
+    // threads of 0 uses one per hardware thread.  The stream is split into
+    // min(threads, channels) groups of near-equal size.
+    ParallelPushConverter(
+        SRCpp::Type type, int channels, double factor, size_t threads = 0);
+
+    auto groups() const -> size_t { return groups_.size(); }
+
+#if SRCPP_USE_CPP23
+    template <SupportedSampleType To, SupportedSampleType From>
+    auto convert_expected(std::span<const From> input, std::span<To> output)
+        -> std::expected<std::span<To>, std::string>;
+
+    template <SupportedSampleType To, SupportedSampleType From>
+    auto convert_expected(std::span<const From> input)
+        -> std::expected<std::vector<To>, std::string>;
+
+    template <SupportedSampleType To>
+    auto flush_expected() -> std::expected<std::vector<To>, std::string>;
+#endif // SRCPP_USE_CPP23
+
+    template <SupportedSampleType To, SupportedSampleType From>
+    auto convert(std::span<const From> input, std::span<To> output)
+        -> std::pair<std::optional<std::span<To>>, std::string>;
+
+    template <SupportedSampleType To, SupportedSampleType From>
+    auto convert(std::span<const From> input)
+        -> std::pair<std::optional<std::vector<To>>, std::string>;
+
+    template <SupportedSampleType To>
+    auto flush() -> std::pair<std::optional<std::vector<To>>, std::string>;
+
+#if SRCPP_USE_CPP23
+    template <typename ToContainer, typename FromContainer,
+        SupportedSampleType To = typename ToContainer::value_type,
+        SupportedSampleType From = typename FromContainer::value_type>
+    auto convert_expected(FromContainer const& input, ToContainer& output)
+    {
+        return convert_expected<To, From>(
+            std::span<const From> { input }, std::span<To> { output });
+    }
+
+    template <SupportedSampleType To, typename FromContainer,
+        SupportedSampleType From = typename FromContainer::value_type>
+    auto convert_expected(FromContainer const& input)
+    {
+        return convert_expected<To, From>(std::span<const From> { input });
+    }
+#endif // SRCPP_USE_CPP23
+
+    template <typename ToContainer, typename FromContainer,
+        SupportedSampleType To = typename ToContainer::value_type,
+        SupportedSampleType From = typename FromContainer::value_type>
+    auto convert(FromContainer const& input, ToContainer& output)
+    {
+        return convert(
+            std::span<const From> { input }, std::span<To> { output });
+    }
+
+    template <SupportedSampleType To, typename FromContainer,
+        SupportedSampleType From = typename FromContainer::value_type>
+    auto convert(FromContainer const& input)
+    {
+        return convert<To, From>(std::span<const From> { input });
+    }
+
+private:
+    size_t channels_ { 0 };
+    std::vector<details::ChannelGroup> groups_;
+    std::unique_ptr<details::WorkerPool> pool_;
+
+    // Runs func(group) for every group across the pool.  An exception from
+    // func becomes that group's error.
+    template <typename Func> void forEachGroup(Func&& func);
+
+    // Converts every group with convert(group), which returns what
+    // PushConverter does for float output, and writes the groups back into
+    // one interleaved vector.
+    template <SupportedSampleType To, typename Convert>
+    auto convertAllocating(Convert&& convert)
+        -> std::pair<std::optional<std::vector<To>>, std::string>;
+
+    // Every group must have produced the same number of frames.
+    auto producedFrames() const -> std::pair<std::optional<size_t>, std::string>;
+};
+
+// Convert split into up to threads segments that are converted concurrently.
+// threads of 0 uses one per hardware thread.  Buffers too short to be worth
+// splitting, and factors that are not a ratio of whole numbers, are
+// converted on the calling thread.
+#if SRCPP_USE_CPP23
+template <SupportedSampleType To, SupportedSampleType From>
+auto Convert_expected(std::span<const From> input, std::span<To> output,
+    SRCpp::Type type, int channels, double factor, size_t threads)
+    -> std::expected<std::span<To>, std::string>;
+
+template <SupportedSampleType To, SupportedSampleType From>
+auto Convert_expected(std::span<const From> input, SRCpp::Type type,
+    int channels, double factor, size_t threads)
+    -> std::expected<std::vector<To>, std::string>;
+#endif // SRCPP_USE_CPP23
+
+template <SupportedSampleType To, SupportedSampleType From>
+auto Convert(std::span<const From> input, std::span<To> output,
+    SRCpp::Type type, int channels, double factor, size_t threads)
+    -> std::pair<std::optional<std::span<To>>, std::string>;
+
+template <SupportedSampleType To, SupportedSampleType From>
+auto Convert(std::span<const From> input, SRCpp::Type type, int channels,
+    double factor, size_t threads)
+    -> std::pair<std::optional<std::vector<To>>, std::string>;
+
+// Implementation details
+inline details::WorkerPool::WorkerPool(size_t workers)
+{
+    for (size_t worker = 1; worker < workers; ++worker) {
+        threads_.emplace_back([this, worker] { loop(worker); });
+    }
+}
+
+inline details::WorkerPool::~WorkerPool()
+{
+    stop_ = true;
+    generation_.fetch_add(1, std::memory_order_release);
+    generation_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+template <typename Task> inline void details::WorkerPool::run(Task& task)
+{
+    invoke_ = [](void* context, size_t worker) {
+        (*static_cast<Task*>(context))(worker);
+    };
+    context_ = &task;
+    remaining_.store(threads_.size(), std::memory_order_relaxed);
+    generation_.fetch_add(1, std::memory_order_release);
+    generation_.notify_all();
+    task(0);
+    for (auto left = remaining_.load(std::memory_order_acquire); left != 0;
+        left = AwaitChange(remaining_, left)) { }
+}
+
+inline void details::WorkerPool::loop(size_t worker)
+{
+    // generation_ only moves once construction is over, so start from 0
+    // rather than whatever this thread happens to load when it starts.
+    auto seen = uint32_t { 0 };
+    while (true) {
+        seen = AwaitChange(generation_, seen);
+        if (stop_) {
+            return;
+        }
+        invoke_(context_, worker);
+        if (remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            remaining_.notify_one();
+        }
+    }
+}
+
+inline ParallelPushConverter::ParallelPushConverter(
+    SRCpp::Type type, int channels, double factor, size_t threads)
+    : channels_ { static_cast<size_t>(std::max(channels, 0)) }
+{
+    if (threads == 0) {
+        threads = std::max(std::thread::hardware_concurrency(), 1U);
+    }
+    auto groups = std::clamp<size_t>(threads, 1, std::max<size_t>(channels_, 1));
+    for (size_t group = 0; group < groups; ++group) {
+        auto first = group * channels_ / groups;
+        auto count = (group + 1) * channels_ / groups - first;
+        groups_.push_back(details::ChannelGroup {
+            PushConverter(type, static_cast<int>(count), factor), first, count,
+            {}, {}, {}, {} });
+    }
+    pool_ = std::make_unique<details::WorkerPool>(groups);
+}
+
+template <typename Func>
+inline void ParallelPushConverter::forEachGroup(Func&& func)
+{
+    auto task = [this, &func](size_t worker) {
+        for (auto group = worker; group < groups_.size();
+            group += pool_->workers()) {
+            // an exception cannot cross back from a worker thread
+            try {
+                func(groups_[group]);
+            } catch (const std::exception& e) {
+                groups_[group].error = e.what();
+            }
+        }
+    };
+    pool_->run(task);
+}
+
+inline auto ParallelPushConverter::producedFrames() const
+    -> std::pair<std::optional<size_t>, std::string>
+{
+    auto frames = groups_.front().produced.size() / groups_.front().channels;
+    for (const auto& group : groups_) {
+        if (!group.error.empty()) {
+            return { std::nullopt, group.error };
+        }
+        if (group.produced.size() != frames * group.channels) {
+            return { std::nullopt, "Channel groups fell out of step" };
+        }
+    }
+    return { frames, {} };
+}
+
+template <SupportedSampleType To, SupportedSampleType From>
+inline auto ParallelPushConverter::convert(
+    std::span<const From> input, std::span<To> output)
+    -> std::pair<std::optional<std::span<To>>, std::string>
+{
+    // one group is just a PushConverter; skip the copies.
+    if (groups_.size() == 1) {
+        return groups_.front().push.convert(input, output);
+    }
+    auto output_frames = output.size() / channels_;
+    forEachGroup([&](details::ChannelGroup& group) {
+        group.input.resize(input.size() / channels_ * group.channels);
+        details::GatherChannels(
+            input, channels_, group.first, group.channels, group.input.data());
+        group.output.resize(output_frames * group.channels);
+        auto [result, error] = group.push.convert(
+            std::span<const float> { group.input },
+            std::span<float> { group.output });
+        group.error = error;
+        group.produced = result.value_or(std::span<float> {});
+        details::ScatterChannels(group.produced, group.channels,
+            output.data(), channels_, group.first);
+    });
+    auto [frames, error] = producedFrames();
+    if (!frames.has_value()) {
+        return { std::nullopt, error };
+    }
+    return { output.first(*frames * channels_), {} };
+}
+
+template <SupportedSampleType To, typename Convert>
+inline auto ParallelPushConverter::convertAllocating(Convert&& convert)
+    -> std::pair<std::optional<std::vector<To>>, std::string>
+{
+    forEachGroup([&](details::ChannelGroup& group) {
+        auto [result, error] = convert(group);
+        group.error = error;
+        group.output = std::move(result).value_or(std::vector<float> {});
+        group.produced = group.output;
+    });
+    auto [frames, error] = producedFrames();
+    if (!frames.has_value()) {
+        return { std::nullopt, error };
+    }
+    std::vector<To> output(*frames * channels_);
+    forEachGroup([&](details::ChannelGroup& group) {
+        details::ScatterChannels(group.produced, group.channels,
+            output.data(), channels_, group.first);
+    });
+    return { std::move(output), {} };
+}
+
+template <SupportedSampleType To, SupportedSampleType From>
+inline auto ParallelPushConverter::convert(std::span<const From> input)
+    -> std::pair<std::optional<std::vector<To>>, std::string>
+{
+    if (groups_.size() == 1) {
+        return groups_.front().push.convert<To>(input);
+    }
+    return convertAllocating<To>([&](details::ChannelGroup& group) {
+        group.input.resize(input.size() / channels_ * group.channels);
+        details::GatherChannels(
+            input, channels_, group.first, group.channels, group.input.data());
+        return group.push.convert<float>(
+            std::span<const float> { group.input });
+    });
+}
+
+template <SupportedSampleType To>
+inline auto ParallelPushConverter::flush()
+    -> std::pair<std::optional<std::vector<To>>, std::string>
+{
+    if (groups_.size() == 1) {
+        return groups_.front().push.flush<To>();
+    }
+    return convertAllocating<To>([](details::ChannelGroup& group) {
+        return group.push.flush<float>();
+    });
+}
+
+template <SupportedSampleType To, SupportedSampleType From>
+inline auto Convert(std::span<const From> input, std::span<To> output,
+    SRCpp::Type type, int channels, double factor, size_t threads)
+    -> std::pair<std::optional<std::span<To>>, std::string>
+{
+    if (channels < 1) {
+        return Convert<To, From>(input, output, type, channels, factor);
+    }
+    if (threads == 0) {
+        threads = std::max(std::thread::hardware_concurrency(), 1U);
+    }
+    auto frame = static_cast<size_t>(channels);
+    auto segments = details::PlanSegments(input.size() / frame,
+        output.size() / frame, type, factor, threads);
+    if (segments.empty()) {
+        return Convert<To, From>(input, output, type, channels, factor);
+    }
+
+    // Each segment starts preroll frames early, so its converter has the
+    // same history the serial one would, and runs postroll frames on, so
+    // its last kept outputs see the same input ahead.  Both are filtered
+    // out of what is kept.
+    auto task = [&](size_t worker) {
+        auto& segment = segments[worker];
+        auto first = segment.first - segment.preroll;
+        auto last = std::min(segment.last + segment.postroll,
+            input.size() / frame);
+        // an exception cannot cross back from a worker thread
+        try {
+            auto [frames, error] = details::ConvertInBlocks(
+                input.subspan(first * frame, (last - first) * frame),
+                output.subspan(segment.output_first * frame,
+                    (segment.output_last - segment.output_first) * frame),
+                type, channels, factor, segment.discard);
+            segment.error = error;
+            segment.produced = frames.value_or(0);
+        } catch (const std::exception& e) {
+            segment.error = e.what();
+        }
+    };
+    auto pool = details::WorkerPool(segments.size());
+    pool.run(task);
+
+    for (const auto& segment : segments) {
+        if (!segment.error.empty()) {
+            return { std::nullopt, segment.error };
+        }
+        if (&segment != &segments.back()
+            && segment.output_first + segment.produced
+                != segment.output_last) {
+            return { std::nullopt, "Parallel segments did not line up" };
+        }
+    }
+    const auto& last = segments.back();
+    return { output.first((last.output_first + last.produced) * frame), {} };
+}
+
+template <SupportedSampleType To, SupportedSampleType From>
+inline auto Convert(std::span<const From> input, SRCpp::Type type, int channels,
+    double factor, size_t threads)
+    -> std::pair<std::optional<std::vector<To>>, std::string>
+{
+    std::vector<To> output(
+        MaxOutputFrames(input.size() / channels, factor) * channels);
+    auto [result, error]
+        = Convert<To, From>(input, output, type, channels, factor, threads);
+    if (!result.has_value()) {
+        return { std::nullopt, error };
+    }
+    output.resize(result->size());
+    return { std::move(output), {} };
+}
+
+#if SRCPP_USE_CPP23
+template <SupportedSampleType To, SupportedSampleType From>
+inline auto Convert_expected(std::span<const From> input, std::span<To> output,
+    SRCpp::Type type, int channels, double factor, size_t threads)
+    -> std::expected<std::span<To>, std::string>
+{
+    auto [result, error]
+        = Convert<To, From>(input, output, type, channels, factor, threads);
+    if (result.has_value()) {
+        return *result;
+    }
+    return std::unexpected(error);
+}
+
+template <SupportedSampleType To, SupportedSampleType From>
+inline auto Convert_expected(std::span<const From> input, SRCpp::Type type,
+    int channels, double factor, size_t threads)
+    -> std::expected<std::vector<To>, std::string>
+{
+    auto [result, error]
+        = Convert<To, From>(input, type, channels, factor, threads);
+    if (result.has_value()) {
+        return std::move(*result);
+    }
+    return std::unexpected(error);
+}
+
+template <SupportedSampleType To, SupportedSampleType From>
+inline auto ParallelPushConverter::convert_expected(
+    std::span<const From> input, std::span<To> output)
+    -> std::expected<std::span<To>, std::string>
+{
+    auto [result, error] = convert<To, From>(input, output);
+    if (result.has_value()) {
+        return *result;
+    }
+    return std::unexpected(error);
+}
+
+template <SupportedSampleType To, SupportedSampleType From>
+inline auto ParallelPushConverter::convert_expected(
+    std::span<const From> input) -> std::expected<std::vector<To>, std::string>
+{
+    auto [result, error] = convert<To, From>(input);
+    if (result.has_value()) {
+        return std::move(*result);
+    }
+    return std::unexpected(error);
+}
+
+template <SupportedSampleType To>
+inline auto ParallelPushConverter::flush_expected()
+    -> std::expected<std::vector<To>, std::string>
+{
+    auto [result, error] = flush<To>();
+    if (result.has_value()) {
+        return std::move(*result);
+    }
+    return std::unexpected(error);
+}
+#endif // SRCPP_USE_CPP23
+
+// deduction helpers
+#if SRCPP_USE_CPP23
+template <typename ToContainer, typename FromContainer,
+    SupportedSampleType To = typename ToContainer::value_type,
+    SupportedSampleType From = typename FromContainer::value_type>
+auto Convert_expected(FromContainer const& input, ToContainer& output,
+    SRCpp::Type type, int channels, double factor, size_t threads)
+    -> std::expected<std::span<To>, std::string>
+{
+    return Convert_expected<To, From>(std::span<const From> { input },
+        std::span<To> { output }, type, channels, factor, threads);
+}
+
+template <SupportedSampleType To, typename FromContainer,
+    SupportedSampleType From = typename FromContainer::value_type>
+auto Convert_expected(FromContainer const& input, SRCpp::Type type,
+    int channels, double factor, size_t threads)
+    -> std::expected<std::vector<To>, std::string>
+{
+    return Convert_expected<To, From>(
+        std::span<const From> { input }, type, channels, factor, threads);
+}
+#endif // SRCPP_USE_CPP23
+
+template <typename FromContainer, typename ToContainer,
+    SupportedSampleType From = typename FromContainer::value_type,
+    SupportedSampleType To = typename ToContainer::value_type>
+auto Convert(FromContainer const& input, ToContainer& output, SRCpp::Type type,
+    int channels, double factor, size_t threads)
+    -> std::pair<std::optional<std::span<To>>, std::string>
+{
+    return Convert<To, From>(std::span<const From> { input },
+        std::span<To> { output }, type, channels, factor, threads);
+}
+
+template <SupportedSampleType To, typename FromContainer,
+    SupportedSampleType From = typename FromContainer::value_type>
+auto Convert(FromContainer const& input, SRCpp::Type type, int channels,
+    double factor, size_t threads)
+    -> std::pair<std::optional<std::vector<To>>, std::string>
+{
+    return Convert<To, From>(
+        std::span<const From> { input }, type, channels, factor, threads);
+}
+
+} // namespace SRCpp
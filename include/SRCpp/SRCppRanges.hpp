@@ -0,0 +1,221 @@
+#pragma once
+/*
+MIT License
+
+Copyright (c) 2025 Richard Powell
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <SRCpp/SRCpp.hpp>
+#include <iterator>
+#include <ranges>
+
+// views::resample: a range adaptor that converts a range of interleaved
+// samples lazily.  Input is pulled through a PullConverter a chunk at a time
+// and output is converted a block at a time, only as the view is iterated,
+// so `samples | views::resample(...) | std::views::take(n)` does about n
+// samples' worth of work however long samples is.
+namespace SRCpp {
+
+template <std::ranges::input_range V, SupportedSampleType To = float>
+    requires std::ranges::view<V>
+    && SupportedSampleType<std::ranges::range_value_t<V>>
+class resample_view : public std::ranges::view_interface<resample_view<V, To>> {
+public:
+    // Throws std::runtime_error on bad arguments, as PullConverter does.
+    resample_view(V base, SRCpp::Type type, int channels, double factor);
+
+    // An input range: begin() may be called once, and the view is
+    // move-only.  A partial frame at the end of base is dropped.
+    auto begin();
+    auto end() const noexcept { return std::default_sentinel; }
+
+    auto base() const& -> V
+        requires std::copy_constructible<V>
+    {
+        return base_;
+    }
+    auto base() && -> V { return std::move(base_); }
+
+private:
+    using From = std::ranges::range_value_t<V>;
+
+    // input frames per callback, and output frames per block
+    static constexpr size_t kChunk = 256;
+    static constexpr size_t kBlock = 256;
+
+    // Lives on the heap so the converter's callback can keep pointing at it
+    // as the view moves.
+    struct State {
+        State(SRCpp::Type type, int channels, double factor);
+
+        auto pull() -> std::span<From>;
+        void fill();
+
+        PullConverter converter;
+        size_t channels;
+        std::optional<std::ranges::iterator_t<V>> current;
+        std::optional<std::ranges::sentinel_t<V>> last;
+        std::vector<From> input;
+        std::vector<To> output;
+        size_t position { 0 };
+        size_t size { 0 };
+    };
+
+    class iterator {
+    public:
+        using value_type = To;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+        explicit iterator(State* state)
+            : state_ { state }
+        {
+        }
+
+        auto operator*() const -> To
+        {
+            return state_->output[state_->position];
+        }
+        auto operator++() -> iterator&
+        {
+            if (++state_->position == state_->size) {
+                state_->fill();
+            }
+            return *this;
+        }
+        void operator++(int) { ++*this; }
+
+        friend auto operator==(const iterator& it, std::default_sentinel_t)
+            -> bool
+        {
+            return it.state_->position == it.state_->size;
+        }
+
+    private:
+        State* state_ { nullptr };
+    };
+
+    V base_;
+    std::unique_ptr<State> state_;
+};
+
+template <typename Range>
+resample_view(Range&&, SRCpp::Type, int, double)
+    -> resample_view<std::views::all_t<Range>>;
+
+namespace details {
+    template <SupportedSampleType To> struct ResampleClosure {
+        SRCpp::Type type;
+        int channels;
+        double factor;
+
+        template <std::ranges::viewable_range Range>
+        friend auto operator|(Range&& range, const ResampleClosure& closure)
+        {
+            return resample_view<std::views::all_t<Range>, To> {
+                std::views::all(std::forward<Range>(range)), closure.type,
+                closure.channels, closure.factor
+            };
+        }
+    };
+}
+
+namespace views {
+    // `samples | views::resample(type, channels, factor)`, or with the
+    // range first.  To is the output sample type.
+    template <SupportedSampleType To = float>
+    inline auto resample(SRCpp::Type type, int channels, double factor)
+        -> details::ResampleClosure<To>
+    {
+        return { type, channels, factor };
+    }
+
+    template <SupportedSampleType To = float,
+        std::ranges::viewable_range Range>
+    inline auto resample(
+        Range&& range, SRCpp::Type type, int channels, double factor)
+    {
+        return std::forward<Range>(range)
+            | resample<To>(type, channels, factor);
+    }
+}
+
+// Implementation details
+template <std::ranges::input_range V, SupportedSampleType To>
+    requires std::ranges::view<V>
+    && SupportedSampleType<std::ranges::range_value_t<V>>
+inline resample_view<V, To>::State::State(
+    SRCpp::Type type, int channels, double factor)
+    : converter { [this] { return pull(); }, type, channels, factor }
+    , channels { static_cast<size_t>(channels) }
+    , input(kChunk * this->channels)
+    , output(kBlock * this->channels)
+{
+}
+
+template <std::ranges::input_range V, SupportedSampleType To>
+    requires std::ranges::view<V>
+    && SupportedSampleType<std::ranges::range_value_t<V>>
+inline resample_view<V, To>::resample_view(
+    V base, SRCpp::Type type, int channels, double factor)
+    : base_ { std::move(base) }
+    , state_ { std::make_unique<State>(type, channels, factor) }
+{
+}
+
+template <std::ranges::input_range V, SupportedSampleType To>
+    requires std::ranges::view<V>
+    && SupportedSampleType<std::ranges::range_value_t<V>>
+inline auto resample_view<V, To>::begin()
+{
+    state_->current.emplace(std::ranges::begin(base_));
+    state_->last.emplace(std::ranges::end(base_));
+    state_->fill();
+    return iterator { state_.get() };
+}
+
+template <std::ranges::input_range V, SupportedSampleType To>
+    requires std::ranges::view<V>
+    && SupportedSampleType<std::ranges::range_value_t<V>>
+inline auto resample_view<V, To>::State::pull() -> std::span<From>
+{
+    // copy out up to a chunk of whole frames; an empty chunk ends the stream
+    size_t samples = 0;
+    while (samples < input.size() && *current != *last) {
+        input[samples++] = **current;
+        ++*current;
+    }
+    samples -= samples % channels;
+    return std::span { input }.first(samples);
+}
+
+template <std::ranges::input_range V, SupportedSampleType To>
+    requires std::ranges::view<V>
+    && SupportedSampleType<std::ranges::range_value_t<V>>
+inline void resample_view<V, To>::State::fill()
+{
+    auto [result, error] = converter.convert(std::span { output });
+    if (!result) {
+        throw std::runtime_error(error);
+    }
+    position = 0;
+    size = result->size();
+}
+}
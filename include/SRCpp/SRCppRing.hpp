@@ -0,0 +1,168 @@
+#pragma once
+/*
+MIT License
+
+Copyright (c) 2025 Richard Powell
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <span>
+#include <vector>
+
+// SpscRing: a wait-free ring for one producer thread and one consumer thread.
+// Neither side blocks, takes a lock or allocates once the ring is built, so
+// either may be a real-time thread.
+namespace SRCpp {
+
+template <typename T> class SpscRing {
+public:
+    // Holds at least capacity elements; the storage is rounded up to a power
+    // of two.
+    explicit SpscRing(size_t capacity);
+    SpscRing(const SpscRing&) = delete;
+    auto operator=(const SpscRing&) -> SpscRing& = delete;
+
+    auto capacity() const noexcept -> size_t { return storage_.size(); }
+
+    // Elements ready to read and room to write.  Exact from the side that
+    // owns the other end, and a lower bound from anywhere else.
+    auto size() const noexcept -> size_t;
+    auto space() const noexcept -> size_t { return capacity() - size(); }
+
+    // Producer side.  Copies as much of data as fits and returns the count.
+    auto write(std::span<const T> data) noexcept -> size_t;
+    // The free space as up to two regions, to fill in place before
+    // commit_write publishes the first count elements of them.
+    auto write_regions() noexcept -> std::array<std::span<T>, 2>;
+    void commit_write(size_t count) noexcept;
+
+    // Consumer side.  Copies up to data.size() elements out and returns the
+    // count.
+    auto read(std::span<T> data) noexcept -> size_t;
+    // The readable elements as up to two regions; commit_read releases the
+    // first count of them.
+    auto read_regions() noexcept -> std::array<std::span<const T>, 2>;
+    void commit_read(size_t count) noexcept;
+
+private:
+    std::vector<T> storage_;
+    size_t mask_;
+    // Both indices count every element ever passed and wrap with mask_.
+    // write and read cache the other side's index and only reload it when
+    // the cached value says there is too little room or data.
+    alignas(64) std::atomic<size_t> head_ { 0 };
+    size_t cached_tail_ { 0 };
+    alignas(64) std::atomic<size_t> tail_ { 0 };
+    size_t cached_head_ { 0 };
+
+    auto regions(size_t from, size_t count) noexcept
+        -> std::array<std::span<T>, 2>;
+};
+
+// Implementation details
+template <typename T>
+inline SpscRing<T>::SpscRing(size_t capacity)
+    : storage_(std::bit_ceil(std::max<size_t>(capacity, 1)))
+    , mask_ { storage_.size() - 1 }
+{
+}
+
+template <typename T> inline auto SpscRing<T>::size() const noexcept -> size_t
+{
+    auto tail = tail_.load(std::memory_order_acquire);
+    return head_.load(std::memory_order_acquire) - tail;
+}
+
+template <typename T>
+inline auto SpscRing<T>::regions(size_t from, size_t count) noexcept
+    -> std::array<std::span<T>, 2>
+{
+    auto start = from & mask_;
+    auto first = std::min(count, capacity() - start);
+    return { std::span { storage_ }.subspan(start, first),
+        std::span { storage_ }.first(count - first) };
+}
+
+template <typename T>
+inline auto SpscRing<T>::write_regions() noexcept -> std::array<std::span<T>, 2>
+{
+    auto head = head_.load(std::memory_order_relaxed);
+    cached_tail_ = tail_.load(std::memory_order_acquire);
+    return regions(head, capacity() - (head - cached_tail_));
+}
+
+template <typename T>
+inline void SpscRing<T>::commit_write(size_t count) noexcept
+{
+    head_.store(head_.load(std::memory_order_relaxed) + count,
+        std::memory_order_release);
+}
+
+template <typename T>
+inline auto SpscRing<T>::write(std::span<const T> data) noexcept -> size_t
+{
+    auto head = head_.load(std::memory_order_relaxed);
+    if (capacity() - (head - cached_tail_) < data.size()) {
+        cached_tail_ = tail_.load(std::memory_order_acquire);
+    }
+    auto count = std::min(data.size(), capacity() - (head - cached_tail_));
+    auto [first, second] = regions(head, count);
+    std::copy_n(data.begin(), first.size(), first.begin());
+    std::copy_n(data.begin() + first.size(), second.size(), second.begin());
+    head_.store(head + count, std::memory_order_release);
+    return count;
+}
+
+template <typename T>
+inline auto SpscRing<T>::read_regions() noexcept
+    -> std::array<std::span<const T>, 2>
+{
+    auto tail = tail_.load(std::memory_order_relaxed);
+    cached_head_ = head_.load(std::memory_order_acquire);
+    auto [first, second] = regions(tail, cached_head_ - tail);
+    return { first, second };
+}
+
+template <typename T>
+inline void SpscRing<T>::commit_read(size_t count) noexcept
+{
+    tail_.store(tail_.load(std::memory_order_relaxed) + count,
+        std::memory_order_release);
+}
+
+template <typename T>
+inline auto SpscRing<T>::read(std::span<T> data) noexcept -> size_t
+{
+    auto tail = tail_.load(std::memory_order_relaxed);
+    if (cached_head_ - tail < data.size()) {
+        cached_head_ = head_.load(std::memory_order_acquire);
+    }
+    auto count = std::min(data.size(), cached_head_ - tail);
+    auto [first, second] = regions(tail, count);
+    std::copy(first.begin(), first.end(), data.begin());
+    std::copy(second.begin(), second.end(), data.begin() + first.size());
+    tail_.store(tail + count, std::memory_order_release);
+    return count;
+}
+}
@@ -0,0 +1,446 @@
+#pragma once
+/*
+MIT License
+
+Copyright (c) 2025 Richard Powell
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <SRCpp/SRCppParallel.hpp>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+// StreamPool: many independent push streams, each with its own
+// PushConverter, converted on a shared work-stealing pool.  Blocks can be
+// pushed from any thread; each stream's blocks are converted in order, one at
+// a time, and its output is handed to that stream's callback.
+namespace SRCpp {
+
+// Per-stream counters, as reported by StreamPool::stream_stats.
+struct StreamStats {
+    size_t queued_blocks { 0 };
+    size_t queued_frames { 0 };
+    uint64_t input_frames { 0 };
+    uint64_t output_frames { 0 };
+    std::string error;
+};
+
+// Pool-wide counters, as reported by StreamPool::stats.  elapsed is the time
+// since the pool was created, so input_frames / elapsed is the throughput.
+struct StreamPoolStats {
+    size_t streams { 0 };
+    size_t queued_blocks { 0 };
+    uint64_t blocks { 0 };
+    uint64_t input_frames { 0 };
+    uint64_t output_frames { 0 };
+    std::chrono::steady_clock::duration elapsed {};
+};
+
+namespace details {
+    // Blocks a worker converts from one stream before giving others a turn.
+    inline constexpr size_t kBlocksPerTurn = 4;
+
+    struct PoolStream {
+        uint64_t id { 0 };
+        int channels { 0 };
+        PushConverter push;
+        std::function<void(std::span<const float>)> callback;
+        // converted output, reused from block to block by whichever worker
+        // has the stream scheduled
+        std::vector<float> output;
+
+        // Everything below is guarded by mutex.  A stream is in at most one
+        // worker queue, and only while scheduled is set, so only one worker
+        // ever converts it at a time.
+        std::mutex mutex;
+        std::deque<std::vector<float>> queue;
+        std::vector<std::vector<float>> spare;
+        size_t queued_frames { 0 };
+        bool scheduled { false };
+        bool closing { false };
+        StreamStats stats;
+    };
+
+    // One worker's run queue.  The owner takes from the front, thieves from
+    // the back.
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<std::shared_ptr<PoolStream>> streams;
+    };
+}
+
+class StreamPool {
+public:
+    using StreamId = uint64_t;
+    // Called on a worker thread with each block of converted, interleaved
+    // float output.  Never called for one stream from two threads at once.
+    using Callback = std::function<void(std::span<const float> output)>;
+
+    // threads of 0 uses one per hardware thread.
+    explicit StreamPool(size_t threads = 0);
+    // Finishes all queued work, including flushes of closed streams.
+    ~StreamPool();
+    StreamPool(const StreamPool&) = delete;
+    auto operator=(const StreamPool&) -> StreamPool& = delete;
+
+    auto threads() const -> size_t { return workers_.size(); }
+
+    auto open(StreamId id, SRCpp::Type type, int channels, double factor,
+        Callback callback) -> std::pair<std::optional<StreamId>, std::string>;
+
+    // Queues a copy of input, converted to float, behind the stream's earlier
+    // blocks.  Returns the stream's queue depth in blocks.
+    template <SupportedSampleType From>
+    auto push(StreamId id, std::span<const From> input)
+        -> std::pair<std::optional<size_t>, std::string>;
+
+    template <typename FromContainer,
+        SupportedSampleType From = typename FromContainer::value_type>
+    auto push(StreamId id, FromContainer const& input)
+    {
+        return push<From>(id, std::span<const From> { input });
+    }
+
+    // Flushes the stream once its queued blocks are converted, delivers the
+    // tail to its callback and forgets it.  No more blocks may be pushed.
+    auto close(StreamId id) -> std::pair<std::optional<StreamId>, std::string>;
+
+    // Blocks until every block pushed so far has been converted and
+    // delivered.
+    void wait();
+
+    auto stream_stats(StreamId id) const -> std::optional<StreamStats>;
+    auto stats() const -> StreamPoolStats;
+
+private:
+    using Stream = details::PoolStream;
+
+    auto find(StreamId id) const -> std::shared_ptr<Stream>;
+    void schedule(std::shared_ptr<Stream> stream);
+    auto take(size_t worker) -> std::shared_ptr<Stream>;
+    void loop(size_t worker);
+    // Converts up to kBlocksPerTurn blocks; returns whether more are waiting.
+    auto process(Stream& stream) -> bool;
+    void finished();
+
+    mutable std::shared_mutex streams_mutex_;
+    std::unordered_map<StreamId, std::shared_ptr<Stream>> streams_;
+
+    std::vector<details::WorkQueue> queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> next_queue_ { 0 };
+    // streams sitting in a run queue; idle workers sleep on it
+    std::atomic<size_t> ready_ { 0 };
+    // blocks and closes not yet finished; wait() sleeps on it
+    std::atomic<size_t> outstanding_ { 0 };
+    std::atomic<bool> stop_ { false };
+
+    std::atomic<size_t> queued_blocks_ { 0 };
+    std::atomic<uint64_t> blocks_ { 0 };
+    std::atomic<uint64_t> input_frames_ { 0 };
+    std::atomic<uint64_t> output_frames_ { 0 };
+    std::chrono::steady_clock::time_point start_ {
+        std::chrono::steady_clock::now()
+    };
+};
+
+// Implementation details
+inline StreamPool::StreamPool(size_t threads)
+    : queues_(threads ? threads
+                      : std::max(std::thread::hardware_concurrency(), 1U))
+{
+    for (size_t worker = 0; worker < queues_.size(); ++worker) {
+        workers_.emplace_back([this, worker] { loop(worker); });
+    }
+}
+
+inline StreamPool::~StreamPool()
+{
+    wait();
+    stop_ = true;
+    ready_.fetch_add(1, std::memory_order_release);
+    ready_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+inline auto StreamPool::open(StreamId id, SRCpp::Type type, int channels,
+    double factor, Callback callback)
+    -> std::pair<std::optional<StreamId>, std::string>
+{
+    auto [push, error] = PushConverter::create(type, channels, factor);
+    if (!push.has_value()) {
+        return { std::nullopt, StrError(error) };
+    }
+    auto stream = std::make_shared<Stream>(
+        id, channels, std::move(*push), std::move(callback));
+    auto lock = std::unique_lock { streams_mutex_ };
+    if (!streams_.emplace(id, std::move(stream)).second) {
+        return { std::nullopt, "Stream is already open" };
+    }
+    return { id, {} };
+}
+
+template <SupportedSampleType From>
+inline auto StreamPool::push(StreamId id, std::span<const From> input)
+    -> std::pair<std::optional<size_t>, std::string>
+{
+    auto stream = find(id);
+    if (!stream) {
+        return { std::nullopt, "Stream is not open" };
+    }
+    auto frames = input.size() / stream->channels;
+
+    auto lock = std::unique_lock { stream->mutex };
+    if (stream->closing) {
+        return { std::nullopt, "Stream is closing" };
+    }
+    // reuse a converted block's buffer where there is one
+    auto block = std::vector<float> {};
+    if (!stream->spare.empty()) {
+        block = std::move(stream->spare.back());
+        stream->spare.pop_back();
+    }
+    block.resize(input.size());
+    details::ConvertSamples<float, From>(input, block.data());
+    stream->queue.push_back(std::move(block));
+    stream->queued_frames += frames;
+    auto depth = stream->queue.size();
+    outstanding_.fetch_add(1, std::memory_order_relaxed);
+    queued_blocks_.fetch_add(1, std::memory_order_relaxed);
+    if (!std::exchange(stream->scheduled, true)) {
+        lock.unlock();
+        schedule(std::move(stream));
+    }
+    return { depth, {} };
+}
+
+inline auto StreamPool::close(StreamId id)
+    -> std::pair<std::optional<StreamId>, std::string>
+{
+    auto stream = find(id);
+    if (!stream) {
+        return { std::nullopt, "Stream is not open" };
+    }
+    auto lock = std::unique_lock { stream->mutex };
+    if (std::exchange(stream->closing, true)) {
+        return { std::nullopt, "Stream is closing" };
+    }
+    outstanding_.fetch_add(1, std::memory_order_relaxed);
+    if (!std::exchange(stream->scheduled, true)) {
+        lock.unlock();
+        schedule(std::move(stream));
+    }
+    return { id, {} };
+}
+
+inline void StreamPool::wait()
+{
+    for (auto left = outstanding_.load(std::memory_order_acquire); left != 0;
+        left = details::AwaitChange(outstanding_, left)) { }
+}
+
+inline auto StreamPool::stream_stats(StreamId id) const
+    -> std::optional<StreamStats>
+{
+    auto stream = find(id);
+    if (!stream) {
+        return std::nullopt;
+    }
+    auto lock = std::unique_lock { stream->mutex };
+    auto stats = stream->stats;
+    stats.queued_blocks = stream->queue.size();
+    stats.queued_frames = stream->queued_frames;
+    return stats;
+}
+
+inline auto StreamPool::stats() const -> StreamPoolStats
+{
+    auto streams = [this] {
+        auto lock = std::shared_lock { streams_mutex_ };
+        return streams_.size();
+    }();
+    return { streams, queued_blocks_.load(), blocks_.load(),
+        input_frames_.load(), output_frames_.load(),
+        std::chrono::steady_clock::now() - start_ };
+}
+
+inline auto StreamPool::find(StreamId id) const -> std::shared_ptr<Stream>
+{
+    auto lock = std::shared_lock { streams_mutex_ };
+    auto found = streams_.find(id);
+    return found == streams_.end() ? nullptr : found->second;
+}
+
+inline void StreamPool::schedule(std::shared_ptr<Stream> stream)
+{
+    // spread new work round-robin; idle workers steal the rest
+    auto& queue = queues_[next_queue_.fetch_add(1, std::memory_order_relaxed)
+        % queues_.size()];
+    ready_.fetch_add(1, std::memory_order_release);
+    {
+        auto lock = std::unique_lock { queue.mutex };
+        queue.streams.push_back(std::move(stream));
+    }
+    ready_.notify_one();
+}
+
+inline auto StreamPool::take(size_t worker) -> std::shared_ptr<Stream>
+{
+    for (size_t offset = 0; offset < queues_.size(); ++offset) {
+        auto& queue = queues_[(worker + offset) % queues_.size()];
+        auto lock = std::unique_lock { queue.mutex };
+        if (queue.streams.empty()) {
+            continue;
+        }
+        auto stream = std::shared_ptr<Stream> {};
+        if (offset == 0) {
+            stream = std::move(queue.streams.front());
+            queue.streams.pop_front();
+        } else {
+            stream = std::move(queue.streams.back());
+            queue.streams.pop_back();
+        }
+        ready_.fetch_sub(1, std::memory_order_relaxed);
+        return stream;
+    }
+    return nullptr;
+}
+
+inline void StreamPool::loop(size_t worker)
+{
+    while (true) {
+        if (auto stream = take(worker)) {
+            if (process(*stream)) {
+                // more to do, but let the streams queued behind it go first
+                auto& queue = queues_[worker];
+                ready_.fetch_add(1, std::memory_order_release);
+                auto lock = std::unique_lock { queue.mutex };
+                queue.streams.push_back(std::move(stream));
+            }
+            continue;
+        }
+        if (stop_) {
+            return;
+        }
+        // a stream may be counted a moment before it can be taken, so only
+        // sleep when there is nothing at all
+        if (ready_.load(std::memory_order_acquire) == 0) {
+            details::AwaitChange(ready_, size_t { 0 });
+        } else {
+            details::CpuRelax();
+        }
+    }
+}
+
+inline auto StreamPool::process(Stream& stream) -> bool
+{
+    for (size_t turn = 0; turn < details::kBlocksPerTurn; ++turn) {
+        auto lock = std::unique_lock { stream.mutex };
+        if (stream.queue.empty()) {
+            if (!stream.closing) {
+                stream.scheduled = false;
+                return false;
+            }
+            lock.unlock();
+            auto failure = std::string {};
+            try {
+                stream.output.clear();
+                auto [output, error] = stream.push.flush_into(stream.output);
+                if (!output.has_value()) {
+                    failure = error;
+                } else if (!output->empty()) {
+                    output_frames_.fetch_add(output->size() / stream.channels,
+                        std::memory_order_relaxed);
+                    stream.callback(*output);
+                }
+            } catch (const std::exception& e) {
+                failure = e.what();
+            }
+            // stream_stats reads stats under the stream's lock
+            if (!failure.empty()) {
+                lock.lock();
+                stream.stats.error = failure;
+                lock.unlock();
+            }
+            {
+                auto streams_lock = std::unique_lock { streams_mutex_ };
+                streams_.erase(stream.id);
+            }
+            finished();
+            return false;
+        }
+        auto block = std::move(stream.queue.front());
+        stream.queue.pop_front();
+        auto frames = block.size() / stream.channels;
+        stream.queued_frames -= frames;
+        lock.unlock();
+        queued_blocks_.fetch_sub(1, std::memory_order_relaxed);
+
+        // the converter and callback are only touched by the worker that
+        // has the stream scheduled
+        auto produced = size_t { 0 };
+        auto failure = std::string {};
+        try {
+            stream.output.clear();
+            auto [output, error] = stream.push.convert_into(
+                std::span<const float> { block }, stream.output);
+            if (output.has_value()) {
+                produced = output->size() / stream.channels;
+                if (!output->empty()) {
+                    stream.callback(*output);
+                }
+            } else {
+                failure = error;
+            }
+        } catch (const std::exception& e) {
+            failure = e.what();
+        }
+
+        lock.lock();
+        stream.stats.input_frames += frames;
+        stream.stats.output_frames += produced;
+        if (!failure.empty()) {
+            stream.stats.error = failure;
+        }
+        stream.spare.push_back(std::move(block));
+        lock.unlock();
+        blocks_.fetch_add(1, std::memory_order_relaxed);
+        input_frames_.fetch_add(frames, std::memory_order_relaxed);
+        output_frames_.fetch_add(produced, std::memory_order_relaxed);
+        finished();
+    }
+    return true;
+}
+
+inline void StreamPool::finished()
+{
+    if (outstanding_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        outstanding_.notify_all();
+    }
+}
+
+} // namespace SRCpp
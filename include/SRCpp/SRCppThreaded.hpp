@@ -0,0 +1,398 @@
+#pragma once
+/*
+MIT License
+
+Copyright (c) 2025 Richard Powell
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <SRCpp/SRCpp.hpp>
+#include <SRCpp/SRCppRing.hpp>
+#include <atomic>
+#include <thread>
+
+// ThreadedConverter: runs a converter on a worker thread so that a real-time
+// thread only queues input and dequeues output.  Both queues are SpscRings,
+// so the caller's side never blocks, locks or allocates, and an expensive
+// type such as Sinc_BestQuality costs it no more than a copy.
+namespace SRCpp {
+
+// Sizing for ThreadedConverter.
+struct ThreadedOptions {
+    // Input frames the worker converts at a time.  A pulling worker asks its
+    // converter for this many input frames' worth of output at a time.
+    size_t block_frames { 256 };
+    // Input frames the caller can queue ahead of the worker.
+    size_t input_frames { 8192 };
+    // The read-ahead: converted output frames the worker keeps ready.  It
+    // stops converting while this many are waiting to be read.
+    size_t read_ahead_frames { 8192 };
+};
+
+class ThreadedConverter {
+public:
+    // Pushing: the caller writes input and reads output.  Throws
+    // std::runtime_error on bad arguments, as PushConverter does.
+    ThreadedConverter(SRCpp::Type type, int channels, double factor,
+        ThreadedOptions options = {});
+    // Pulling: the worker calls callback for input, as a PullConverter
+    // would, and the caller only reads output.  An empty span from callback
+    // ends the stream.
+    template <typename Callback>
+    ThreadedConverter(Callback&& callback, SRCpp::Type type, int channels,
+        double factor, ThreadedOptions options = {});
+    ~ThreadedConverter();
+    ThreadedConverter(const ThreadedConverter&) = delete;
+    auto operator=(const ThreadedConverter&) -> ThreadedConverter& = delete;
+
+    // Caller side.  Queues whole frames of input, converted to float, and
+    // returns how many fit.  Always 0 when pulling or after finish().
+    template <SupportedSampleType From>
+    auto write(std::span<const From> input) noexcept -> size_t;
+    // Ends the input.  The worker flushes the converter once it has
+    // converted everything queued.
+    void finish() noexcept;
+
+    // Caller side.  Dequeues up to output.size() samples of converted output,
+    // whole frames only, and returns what was written.  Returns less, or
+    // nothing, when the worker has not kept up.
+    template <SupportedSampleType To>
+    auto read(std::span<To> output) noexcept -> std::span<To>;
+
+    // From any thread.  available() is the output frames ready to read.
+    // latency_frames() is the output frames between a frame written and the
+    // same moment read, counting the converter's own delay where it reports
+    // one (see PushConverter::latency_frames).
+    auto available() const noexcept -> size_t;
+    auto latency_frames() const noexcept -> size_t;
+
+    // True once the stream has ended, by finish() or the callback, and all of
+    // its output has been read.
+    auto finished() const noexcept -> bool;
+
+    // True once the converter has failed on the worker, which then stops.
+    // error() describes the failure; it copies a string, so call it off the
+    // real-time thread.
+    auto failed() const noexcept -> bool
+    {
+        return failed_.load(std::memory_order_acquire);
+    }
+    auto error() const -> std::string;
+
+    template <typename FromContainer,
+        SupportedSampleType From = typename FromContainer::value_type>
+    auto write(FromContainer const& input) noexcept
+    {
+        return write(std::span<const From> { input });
+    }
+
+    template <typename ToContainer,
+        SupportedSampleType To = typename ToContainer::value_type>
+    auto read(ToContainer& output) noexcept
+    {
+        return read(std::span<To> { output });
+    }
+
+private:
+    ThreadedConverter(std::optional<PushConverter> push,
+        std::optional<PullConverter> pull, int channels, double factor,
+        ThreadedOptions options);
+
+    // Output frames for one block, with a frame to spare.  Checks factor
+    // here, as libsamplerate would only reject it on the worker.
+    static auto outputBlock(size_t frames, double factor) -> size_t;
+
+    void run() noexcept;
+    auto step() -> bool;
+    auto drain() noexcept -> bool;
+    auto convert() -> std::span<const float>;
+    void fail(std::string error) noexcept;
+    void wake() noexcept;
+
+    size_t channels_;
+    double factor_;
+    std::optional<PushConverter> push_;
+    std::optional<PullConverter> pull_;
+    SpscRing<float> input_;
+    SpscRing<float> output_;
+    // read_ahead_frames in samples; output_'s capacity is rounded up past it
+    size_t read_ahead_;
+
+    // worker state
+    std::vector<float> block_;
+    std::vector<float> scratch_;
+    std::vector<float> flushed_;
+    std::span<const float> pending_;
+    bool ended_ { false };
+    std::string error_;
+
+    // The caller bumps wake_ after each call; the worker waits on it when
+    // there is nothing to do, and the caller only notifies while it does.
+    std::atomic<unsigned> wake_ { 0 };
+    std::atomic<bool> sleeping_ { false };
+    std::atomic<bool> stopping_ { false };
+    std::atomic<bool> finishing_ { false };
+    std::atomic<bool> done_ { false };
+    std::atomic<bool> failed_ { false };
+    // output frames the worker holds: converted but not yet queued, plus
+    // the converter's delay
+    std::atomic<size_t> held_ { 0 };
+    std::thread worker_;
+};
+
+// Implementation details
+inline ThreadedConverter::ThreadedConverter(std::optional<PushConverter> push,
+    std::optional<PullConverter> pull, int channels, double factor,
+    ThreadedOptions options)
+    : channels_ { static_cast<size_t>(std::max(channels, 1)) }
+    , factor_ { factor }
+    , push_ { std::move(push) }
+    , pull_ { std::move(pull) }
+    , input_ { std::max(options.input_frames, options.block_frames)
+          * channels_ }
+    , output_ { std::max<size_t>(options.read_ahead_frames, 1) * channels_ }
+    , read_ahead_ { std::max<size_t>(options.read_ahead_frames, 1)
+          * channels_ }
+    , block_(std::max<size_t>(options.block_frames, 1) * channels_)
+    , scratch_(outputBlock(block_.size() / channels_, factor) * channels_)
+{
+    if (push_) {
+        push_->prepare(block_.size() / channels_, scratch_.size() / channels_);
+    }
+    worker_ = std::thread([this] { run(); });
+}
+
+inline auto ThreadedConverter::outputBlock(size_t frames, double factor)
+    -> size_t
+{
+    if (!src_is_valid_ratio(factor)) {
+        throw std::runtime_error(StrError(ErrorBadFactor));
+    }
+    return MaxOutputFrames(frames, factor);
+}
+
+inline ThreadedConverter::ThreadedConverter(SRCpp::Type type, int channels,
+    double factor, ThreadedOptions options)
+    : ThreadedConverter(PushConverter { type, channels, factor }, std::nullopt,
+          channels, factor, options)
+{
+}
+
+template <typename Callback>
+inline ThreadedConverter::ThreadedConverter(Callback&& callback,
+    SRCpp::Type type, int channels, double factor, ThreadedOptions options)
+    : ThreadedConverter(std::nullopt,
+          PullConverter { std::forward<Callback>(callback), type, channels,
+              factor },
+          channels, factor, options)
+{
+}
+
+inline ThreadedConverter::~ThreadedConverter()
+{
+    stopping_.store(true);
+    wake_.fetch_add(1);
+    wake_.notify_one();
+    worker_.join();
+}
+
+inline void ThreadedConverter::wake() noexcept
+{
+    // Pairs with run(): either the worker sees the new count before it
+    // waits, or this sees it sleeping and notifies.
+    wake_.fetch_add(1);
+    if (sleeping_.load()) {
+        wake_.notify_one();
+    }
+}
+
+template <SupportedSampleType From>
+inline auto ThreadedConverter::write(std::span<const From> input) noexcept
+    -> size_t
+{
+    if (!push_ || finishing_.load(std::memory_order_relaxed)) {
+        return 0;
+    }
+    auto frames = input.size() / channels_;
+    auto [first, second] = input_.write_regions();
+    auto fit = std::min(frames, (first.size() + second.size()) / channels_);
+    auto samples = fit * channels_;
+    auto head = std::min(samples, first.size());
+    details::ConvertSamples<float, From>(input.first(head), first.data());
+    details::ConvertSamples<float, From>(
+        input.subspan(head, samples - head), second.data());
+    input_.commit_write(samples);
+    if (fit != 0) {
+        wake();
+    }
+    return fit;
+}
+
+inline void ThreadedConverter::finish() noexcept
+{
+    finishing_.store(true);
+    wake();
+}
+
+template <SupportedSampleType To>
+inline auto ThreadedConverter::read(std::span<To> output) noexcept
+    -> std::span<To>
+{
+    auto [first, second] = output_.read_regions();
+    auto samples = std::min(output.size(), first.size() + second.size());
+    samples -= samples % channels_;
+    auto head = std::min(samples, first.size());
+    details::ConvertSamples<To, float>(first.first(head), output.data());
+    details::ConvertSamples<To, float>(
+        second.first(samples - head), output.data() + head);
+    output_.commit_read(samples);
+    if (samples != 0) {
+        wake();
+    }
+    return output.first(samples);
+}
+
+inline auto ThreadedConverter::available() const noexcept -> size_t
+{
+    return output_.size() / channels_;
+}
+
+inline auto ThreadedConverter::latency_frames() const noexcept -> size_t
+{
+    auto queued = static_cast<double>(input_.size() / channels_) * factor_;
+    return static_cast<size_t>(queued + 0.5) + available()
+        + held_.load(std::memory_order_relaxed);
+}
+
+inline auto ThreadedConverter::finished() const noexcept -> bool
+{
+    return done_.load(std::memory_order_acquire) && output_.size() == 0;
+}
+
+inline auto ThreadedConverter::error() const -> std::string
+{
+    return failed() ? error_ : std::string {};
+}
+
+inline void ThreadedConverter::fail(std::string error) noexcept
+{
+    error_ = std::move(error);
+    failed_.store(true, std::memory_order_release);
+}
+
+inline void ThreadedConverter::run() noexcept
+{
+    while (!stopping_.load()) {
+        auto seen = wake_.load();
+        auto progress = [this] {
+            try {
+                return step();
+            } catch (const std::exception& error) {
+                fail(error.what());
+            } catch (...) {
+                fail("Unknown error on the converter thread.");
+            }
+            return false;
+        }();
+        if (progress) {
+            continue;
+        }
+        sleeping_.store(true);
+        wake_.wait(seen);
+        sleeping_.store(false);
+    }
+}
+
+inline auto ThreadedConverter::drain() noexcept -> bool
+{
+    // queue as many whole frames of pending output as the read-ahead has
+    // room for
+    auto room = read_ahead_ - std::min(read_ahead_, output_.size());
+    auto samples = std::min(pending_.size(), room - room % channels_);
+    output_.write(pending_.first(samples));
+    pending_ = pending_.subspan(samples);
+    return samples != 0;
+}
+
+inline auto ThreadedConverter::step() -> bool
+{
+    if (failed_.load(std::memory_order_relaxed)
+        || done_.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    if (!pending_.empty()) {
+        auto progress = drain();
+        // once the stream has ended the converter holds nothing back
+        auto delay = ended_ ? 0
+            : push_         ? push_->latency_frames()
+                            : pull_->latency_frames();
+        held_.store(
+            pending_.size() / channels_ + delay, std::memory_order_relaxed);
+        return progress;
+    }
+    if (ended_) {
+        done_.store(true, std::memory_order_release);
+        return false;
+    }
+    pending_ = convert();
+    return !pending_.empty() || ended_;
+}
+
+inline auto ThreadedConverter::convert() -> std::span<const float>
+{
+    if (pull_) {
+        auto [result, error] = pull_->convert(std::span { scratch_ });
+        if (!result) {
+            fail(std::move(error));
+            return {};
+        }
+        // the callback ran dry, so the converter has flushed
+        ended_ = result->size() < scratch_.size();
+        return *result;
+    }
+    auto samples = input_.read(std::span { block_ });
+    if (samples != 0) {
+        auto [result, error] = push_->convert(
+            std::span<const float> { block_ }.first(samples),
+            std::span { scratch_ });
+        if (!result) {
+            fail(std::move(error));
+            return {};
+        }
+        return *result;
+    }
+    if (!finishing_.load()) {
+        return {};
+    }
+    // finish() may have raced a last write, so check again before flushing
+    if (input_.size() != 0) {
+        return convert();
+    }
+    // the worker is not real-time, so the flush may allocate as much as the
+    // converter holds back
+    auto [result, error] = push_->flush<float>();
+    if (!result) {
+        fail(std::move(error));
+        return {};
+    }
+    flushed_ = std::move(*result);
+    ended_ = true;
+    return flushed_;
+}
+}
@@ -1,5 +1,14 @@
 // NOLINTBEGIN(misc-include-cleaner)
 #include <SRCpp/SRCpp.hpp>
+#include <SRCpp/SRCppAdaptive.hpp>
+#include <SRCpp/SRCppBatch.hpp>
+#include <SRCpp/SRCppConverterPool.hpp>
+#include <SRCpp/SRCppFile.hpp>
+#include <SRCpp/SRCppParallel.hpp>
+#include <SRCpp/SRCppRanges.hpp>
+#include <SRCpp/SRCppRing.hpp>
+#include <SRCpp/SRCppStreamPool.hpp>
+#include <SRCpp/SRCppThreaded.hpp>
 // NOLINTEND(misc-include-cleaner)
 
 auto main() -> int { }
\ No newline at end of file
@@ -0,0 +1,208 @@
+#include "SRCppTestUtils.hpp"
+#include <SRCpp/SRCppAdaptive.hpp>
+#include <gtest/gtest.h>
+#include <numeric>
+#include <optional>
+#include <thread>
+
+namespace {
+struct Clocks {
+    double input_rate;
+    double output_rate;
+    size_t input_block;
+    size_t output_block;
+    size_t channels { 1 };
+};
+
+struct Run {
+    std::vector<double> ratios;
+    std::vector<double> levels;
+};
+
+// Drives resampler from two simulated device clocks for seconds, recording
+// the latency before each read and the ratio after it.  The latency is the
+// fill level, or with timestamps the input frames the producer's clock says
+// are in flight plus latency_offset, which is then reported as feedback.
+auto Simulate(SRCpp::AdaptiveResampler& resampler, Clocks clocks,
+    double seconds, std::optional<double> latency_offset = std::nullopt)
+{
+    auto run = Run {};
+    auto input = std::vector<float>(clocks.input_block * clocks.channels);
+    auto output = std::vector<float>(clocks.output_block * clocks.channels);
+    auto phase = 0.0;
+    auto written = 0.0;
+    auto next_write = 0.0;
+    auto next_read = 0.0;
+    while (next_read < seconds) {
+        if (next_write <= next_read) {
+            for (size_t i = 0; i < input.size(); ++i) {
+                input[i] = static_cast<float>(std::sin(phase));
+                if ((i + 1) % clocks.channels == 0) {
+                    phase += 2.0 * std::numbers::pi * 1000.0
+                        / clocks.input_rate;
+                }
+            }
+            resampler.write(input);
+            written += static_cast<double>(clocks.input_block);
+            next_write += clocks.input_block / clocks.input_rate;
+            continue;
+        }
+        auto latency = static_cast<double>(resampler.level());
+        if (latency_offset) {
+            // frames captured since the last block was handed over
+            latency += next_read * clocks.input_rate - written
+                + *latency_offset;
+            resampler.report_latency(latency);
+        }
+        run.levels.push_back(latency);
+        auto [result, error] = resampler.read(output);
+        EXPECT_TRUE(result.has_value()) << error;
+        run.ratios.push_back(resampler.ratio());
+        next_read += clocks.output_block / clocks.output_rate;
+    }
+    return run;
+}
+
+auto MeanOfLast(const std::vector<double>& values, size_t count)
+{
+    count = std::min(count, values.size());
+    return std::accumulate(values.end() - count, values.end(), 0.0)
+        / static_cast<double>(count);
+}
+}
+
+TEST(SRCppSpscRing, WrapsInOrder)
+{
+    auto ring = SRCpp::SpscRing<int>(5);
+    EXPECT_EQ(ring.capacity(), 8);
+    auto next = 0;
+    auto expected = 0;
+    for (auto round = 0; round < 20; ++round) {
+        auto block = std::vector<int>(3 + round % 4);
+        std::iota(block.begin(), block.end(), next);
+        auto written = ring.write(block);
+        EXPECT_EQ(written, std::min(block.size(), 8 - ring.size() + written));
+        next += static_cast<int>(written);
+        auto out = std::vector<int>(2 + round % 3);
+        out.resize(ring.read(out));
+        for (auto value : out) {
+            EXPECT_EQ(value, expected++);
+        }
+    }
+    ring.commit_read(ring.size());
+    EXPECT_EQ(ring.size(), 0);
+    EXPECT_EQ(ring.space(), 8);
+}
+
+TEST(SRCppSpscRing, AcrossThreads)
+{
+    constexpr auto kCount = 200'000;
+    auto ring = SRCpp::SpscRing<int>(1000);
+    auto producer = std::thread([&] {
+        auto next = 0;
+        auto block = std::vector<int>(37);
+        while (next < kCount) {
+            auto count = std::min<size_t>(block.size(), kCount - next);
+            std::iota(block.begin(), block.begin() + count, next);
+            auto written = ring.write(std::span { block }.first(count));
+            if (written == 0) {
+                std::this_thread::yield();
+            }
+            next += static_cast<int>(written);
+        }
+    });
+    auto expected = 0;
+    auto block = std::vector<int>(53);
+    auto ordered = true;
+    while (expected < kCount) {
+        auto [first, second] = ring.read_regions();
+        for (auto region : { first, second }) {
+            for (auto value : region) {
+                ordered = ordered && value == expected++;
+            }
+        }
+        if (first.empty()) {
+            std::this_thread::yield();
+        }
+        ring.commit_read(first.size() + second.size());
+    }
+    producer.join();
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(ring.size(), 0);
+}
+
+TEST(SRCppAdaptive, TracksDrift)
+{
+    // producer and consumer clocks tens of ppm apart, nominally 44100 to
+    // 48000, with a different block size on each side
+    for (auto drift : { 50e-6, -80e-6 }) {
+        auto factor = 48000.0 / 44100.0;
+        auto resampler = SRCpp::AdaptiveResampler(
+            SRCpp::Type::Sinc_Fastest, 1, factor);
+        auto run = Simulate(resampler,
+            { 44100.0 * (1.0 + drift), 48000.0, 441, 256 }, 120.0);
+        // over the last minute the factor averages out at the true rate
+        // ratio, which keeps the queue at its target
+        auto settled = MeanOfLast(run.ratios, 11250);
+        EXPECT_NEAR(settled / (factor / (1.0 + drift)), 1.0, 2e-6) << drift;
+        EXPECT_NEAR(MeanOfLast(run.levels, 11250), 2048.0, 16.0) << drift;
+        EXPECT_EQ(resampler.underruns(), 0);
+        EXPECT_EQ(resampler.overruns(), 0);
+    }
+}
+
+TEST(SRCppAdaptive, FollowsReportedLatency)
+{
+    // With equal block sizes on both sides, 30 ppm of drift takes minutes to
+    // show in the fill level.  Timestamps show it at once, and here also
+    // include 500 frames of device buffering beyond the queue.  Timestamps
+    // have no block jitter, so the loop can be faster.
+    auto resampler = SRCpp::AdaptiveResampler(SRCpp::Type::Linear, 2, 1.0,
+        { .target_frames = 2048, .response_frames = 96000.0 });
+    auto run = Simulate(resampler,
+        { 48000.0 * (1.0 + 30e-6), 48000.0, 480, 480, 2 }, 120.0, 500.0);
+    EXPECT_NEAR(MeanOfLast(run.levels, 6000), 2048.0, 16.0);
+    EXPECT_NEAR(MeanOfLast(run.ratios, 6000), 1.0 / (1.0 + 30e-6), 2e-6);
+}
+
+TEST(SRCppAdaptive, SilenceUntilPrimed)
+{
+    auto resampler = SRCpp::AdaptiveResampler(SRCpp::Type::Linear, 1, 2.0,
+        { .target_frames = 1000, .capacity_frames = 4096 });
+    auto output = std::vector<short>(512, 1);
+    auto [result, error] = resampler.read(output);
+    ASSERT_TRUE(result.has_value()) << error;
+    EXPECT_EQ(std::count(output.begin(), output.end(), 0), 512);
+
+    auto input = makeSin({ 1000.0f }, 48000.0, 1000);
+    EXPECT_EQ(resampler.write(input), 1000);
+    EXPECT_EQ(resampler.level(), 1000);
+    std::tie(result, error) = resampler.read(output);
+    ASSERT_TRUE(result.has_value()) << error;
+    EXPECT_GT(std::count_if(output.begin(), output.end(),
+                  [](short sample) { return sample != 0; }),
+        400);
+
+    // at twice the rate the 1000 frames last about 2000 output frames
+    for (auto i = 0; i < 4; ++i) {
+        std::tie(result, error) = resampler.read(output);
+        ASSERT_TRUE(result.has_value()) << error;
+    }
+    EXPECT_EQ(resampler.underruns(), 1);
+    std::tie(result, error) = resampler.read(output);
+    EXPECT_EQ(std::count(output.begin(), output.end(), 0), 512);
+
+    // input beyond the ring's capacity is dropped and counted
+    auto burst = std::vector<float>(5000);
+    EXPECT_EQ(resampler.write(burst), 4096);
+    EXPECT_EQ(resampler.overruns(), 904);
+}
+
+TEST(SRCppAdaptive, Errors)
+{
+    EXPECT_THROW(SRCpp::AdaptiveResampler(
+                     SRCpp::Type::Polyphase_Fastest, 1, 48000.0 / 44100.0),
+        std::runtime_error);
+    EXPECT_THROW(SRCpp::AdaptiveResampler(SRCpp::Type::Linear, 0, 1.0),
+        std::runtime_error);
+}
@@ -0,0 +1,130 @@
+#include "SRCppTestUtils.hpp"
+#include <SRCpp/SRCppBatch.hpp>
+#include <format>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <random>
+
+namespace {
+// A directory of its own in the temporary directory, removed with everything
+// in it when it goes out of scope.
+struct TempDirectory {
+    TempDirectory()
+        : path { std::filesystem::temp_directory_path()
+              / std::format("SRCppTestBatch_{}", std::random_device {}()) }
+    {
+        std::filesystem::create_directories(path);
+    }
+    ~TempDirectory() { std::filesystem::remove_all(path); }
+    std::filesystem::path path;
+};
+
+auto ReadFile(std::filesystem::path const& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<char> { std::istreambuf_iterator<char>(file), {} };
+}
+
+// Writes frames of channels interleaved float samples as raw PCM.
+auto WriteRaw(std::filesystem::path const& path, size_t frames, int channels)
+{
+    auto hz = std::vector<float>(static_cast<size_t>(channels), 1000.0f);
+    auto samples = makeSin(hz, 48000.0f, frames);
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(samples.data()),
+        static_cast<std::streamsize>(samples.size() * sizeof(float)));
+}
+
+auto RawOptions(int channels, SRCpp::Type type, double factor)
+{
+    return SRCpp::FileOptions { .type = type,
+        .factor = factor,
+        .output_format = SRCpp::FileFormat::Int16,
+        .raw_input
+        = SRCpp::RawLayout { channels, 48000.0, SRCpp::FileFormat::Float32 },
+        .block_frames = 1000 };
+}
+}
+
+TEST(SRCppBatch, MatchesConvertFile)
+{
+    // jobs of different sizes, kinds and factors, more of them than
+    // workers, so workers reuse converters across changes of factor
+    auto directory = TempDirectory {};
+    auto jobs = std::vector<SRCpp::Job> {};
+    auto types = std::array { SRCpp::Type::Sinc_Fastest,
+        SRCpp::Type::Polyphase_MediumQuality, SRCpp::Type::Linear };
+    auto factors = std::array { 0.5, 48000.0 / 44100.0, 1.5 };
+    for (size_t index = 0; index < 12; ++index) {
+        auto channels = static_cast<int>(index % 2 + 1);
+        auto input = directory.path / std::format("in{}.raw", index);
+        WriteRaw(input, 1000 + 1500 * index, channels);
+        auto output = directory.path / std::format("out{}.wav", index);
+        jobs.push_back({ input, output,
+            RawOptions(channels, types[index % 3], factors[index / 4 % 3]) });
+    }
+
+    auto stats = SRCpp::ConvertMany(jobs, 3);
+    EXPECT_EQ(stats.converted, jobs.size());
+    EXPECT_EQ(stats.failed, 0);
+    EXPECT_GT(stats.frames_per_second(), 0.0);
+    auto input_frames = size_t { 0 };
+    auto output_frames = size_t { 0 };
+    for (auto const& job : jobs) {
+        ASSERT_TRUE(job.stats.has_value()) << job.error;
+        input_frames += job.stats->input_frames;
+        output_frames += job.stats->output_frames;
+
+        auto expected = directory.path / "expected.wav";
+        auto [single, error]
+            = SRCpp::ConvertFile(job.input, expected, job.options);
+        ASSERT_TRUE(single.has_value()) << error;
+        EXPECT_EQ(job.stats->output_frames, single->output_frames);
+        EXPECT_EQ(ReadFile(job.output), ReadFile(expected)) << job.output;
+    }
+    EXPECT_EQ(stats.input_frames, input_frames);
+    EXPECT_EQ(stats.output_frames, output_frames);
+}
+
+TEST(SRCppBatch, LargestFirst)
+{
+    auto directory = TempDirectory {};
+    auto jobs = std::vector<SRCpp::Job>(4);
+    auto frames = std::array<size_t, 4> { 100, 400, 200, 300 };
+    for (size_t index = 0; index < jobs.size(); ++index) {
+        jobs[index].input = directory.path / std::format("in{}.raw", index);
+        WriteRaw(jobs[index].input, frames[index], 1);
+    }
+    jobs.push_back({ directory.path / "missing.raw" });
+    EXPECT_EQ(SRCpp::details::ScheduleJobs(jobs),
+        (std::vector<size_t> { 1, 3, 2, 0, 4 }));
+}
+
+TEST(SRCppBatch, Errors)
+{
+    // a job that fails is reported, and the rest still run
+    auto directory = TempDirectory {};
+    auto good = directory.path / "good.raw";
+    WriteRaw(good, 5000, 2);
+    auto jobs = std::vector<SRCpp::Job> {
+        { good, directory.path / "good.wav",
+            RawOptions(2, SRCpp::Type::Linear, 2.0) },
+        { directory.path / "missing.raw", directory.path / "missing.wav",
+            RawOptions(2, SRCpp::Type::Linear, 2.0) },
+        { good, directory.path / "bad.wav",
+            RawOptions(2, SRCpp::Type::Linear, -1.0) },
+    };
+    auto stats = SRCpp::ConvertMany(jobs);
+    EXPECT_EQ(stats.converted, 1);
+    EXPECT_EQ(stats.failed, 2);
+    EXPECT_EQ(stats.input_frames, 5000);
+    EXPECT_TRUE(jobs[0].stats.has_value()) << jobs[0].error;
+    EXPECT_NE(jobs[1].error.find("Could not open"), std::string::npos);
+    EXPECT_FALSE(jobs[2].stats.has_value());
+    EXPECT_EQ(jobs[2].error, SRCpp::StrError(SRCpp::ErrorBadFactor));
+    EXPECT_FALSE(std::filesystem::exists(directory.path / "bad.wav"));
+
+    // an empty batch is fine too
+    stats = SRCpp::ConvertMany({});
+    EXPECT_EQ(stats.converted + stats.failed, 0);
+}
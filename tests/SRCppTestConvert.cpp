@@ -114,6 +114,45 @@ TEST(SRCpp, ResampleFloatShort) { RunResampleTest<float, short>(); }
 TEST(SRCpp, ResampleFloatInt) { RunResampleTest<float, int>(); }
 TEST(SRCpp, ResampleFloatFloat) { RunResampleTest<float, float>(); }
 
+// Non-float conversions stream through a fixed-size block; make sure inputs
+// spanning many blocks come out the same as a single src_simple call.
+template <typename To, typename From> void RunLargeResampleTest()
+{
+    auto frames = 48000;
+    for (auto type : { SRCpp::Type::Sinc_Fastest, SRCpp::Type::ZeroOrderHold,
+             SRCpp::Type::Linear }) {
+        for (auto factor : { 0.5, 1.0, 4.5 }) {
+            for (auto&& hz : { std::vector<float> { 3000.0f },
+                     std::vector<float> { 3000.0f, 40.0f, 1004.0f } }) {
+                auto channels = hz.size();
+
+                auto input = ConvertTo<From>(makeSin(hz, 48000.0, frames));
+                auto inputFloat = std::vector<float>(input.size());
+                if constexpr (std::is_same_v<From, short>) {
+                    src_short_to_float_array(
+                        input.data(), inputFloat.data(), input.size());
+                } else if constexpr (std::is_same_v<From, int>) {
+                    src_int_to_float_array(
+                        input.data(), inputFloat.data(), input.size());
+                } else {
+                    inputFloat = input;
+                }
+                auto reference = ConvertTo<To>(
+                    CreateOneShotReference(inputFloat, channels, factor, type));
+
+                auto [output, error]
+                    = SRCpp::Convert<To, From>(input, type, channels, factor);
+                ASSERT_TRUE(output.has_value()) << error;
+                EXPECT_EQ(*output, reference);
+            }
+        }
+    }
+}
+
+TEST(SRCpp, ResampleLargeShortShort) { RunLargeResampleTest<short, short>(); }
+TEST(SRCpp, ResampleLargeFloatInt) { RunLargeResampleTest<float, int>(); }
+TEST(SRCpp, ResampleLargeIntFloat) { RunLargeResampleTest<int, float>(); }
+
 TEST(SRCpp, UnsafeConvert)
 {
     auto frames = 256;
@@ -0,0 +1,91 @@
+#include "SRCppTestUtils.hpp"
+#include <SRCpp/SRCppConverterPool.hpp>
+#include <gtest/gtest.h>
+#include <span>
+
+namespace {
+template <typename To, typename From>
+auto ConvertAll(SRCpp::PushConverter& converter, const std::vector<From>& input)
+{
+    auto [output, error] = converter.convert<To>(input);
+    EXPECT_TRUE(output.has_value()) << error;
+    auto [flush, flush_error] = converter.flush<To>();
+    EXPECT_TRUE(flush.has_value()) << flush_error;
+    output->insert(output->end(), flush->begin(), flush->end());
+    return *output;
+}
+}
+
+TEST(SRCppConverterPool, ResetStartsANewStream)
+{
+    for (auto type : { SRCpp::Type::Sinc_Fastest, SRCpp::Type::ZeroOrderHold,
+             SRCpp::Type::Linear }) {
+        auto input = makeSin({ 3000.0f, 40.0f }, 48000.0, 1000);
+        auto other = makeSin({ 500.0f, 700.0f }, 48000.0, 777);
+        auto fresh = SRCpp::PushConverter(type, 2, 1.5);
+        auto expected = ConvertAll<float>(fresh, input);
+
+        // leave input staged and history behind, then reset
+        auto reused = SRCpp::PushConverter(type, 2, 0.5);
+        reused.convert<float>(other);
+        EXPECT_EQ(reused.reset(1.5), 0);
+        EXPECT_EQ(ConvertAll<float>(reused, input), expected);
+
+        reused.convert<float>(other);
+        EXPECT_EQ(reused.reset(), 0);
+        EXPECT_EQ(ConvertAll<float>(reused, input), expected);
+
+        EXPECT_EQ(reused.reset(1000.0), SRCpp::ErrorBadFactor);
+    }
+}
+
+TEST(SRCppConverterPool, Reuses)
+{
+    auto pool = SRCpp::ConverterPool(2);
+    EXPECT_EQ(pool.reserve(SRCpp::Type::Linear, 2, 3), 0);
+    EXPECT_EQ(pool.idle(SRCpp::Type::Linear, 2), 2U);
+
+    auto input = makeSin({ 3000.0f, 40.0f }, 48000.0, 1000);
+    auto fresh = SRCpp::PushConverter(SRCpp::Type::Linear, 2, 2.0);
+    auto expected = ConvertAll<short>(fresh, input);
+    {
+        auto [lease, error] = pool.acquire(SRCpp::Type::Linear, 2, 2.0);
+        ASSERT_TRUE(lease.has_value()) << SRCpp::StrError(error);
+        EXPECT_EQ(pool.idle(SRCpp::Type::Linear, 2), 1U);
+        // half a stream, left for the next user to inherit
+        (*lease)->convert<short>(std::span { input }.first(501));
+    }
+    EXPECT_EQ(pool.idle(SRCpp::Type::Linear, 2), 2U);
+    {
+        auto [lease, error] = pool.acquire(SRCpp::Type::Linear, 2, 2.0);
+        ASSERT_TRUE(lease.has_value()) << SRCpp::StrError(error);
+        EXPECT_EQ(ConvertAll<short>(**lease, input), expected);
+        auto moved = std::move(*lease);
+        auto kept = std::move(moved).release();
+        EXPECT_EQ(pool.idle(SRCpp::Type::Linear, 2), 1U);
+    }
+    EXPECT_EQ(pool.idle(SRCpp::Type::Linear, 2), 1U);
+
+    // a different key never sees these
+    auto [mono, error] = pool.acquire(SRCpp::Type::Linear, 1, 2.0);
+    ASSERT_TRUE(mono.has_value()) << SRCpp::StrError(error);
+    EXPECT_EQ(pool.idle(SRCpp::Type::Linear, 2), 1U);
+    EXPECT_EQ(pool.idle(), 1U);
+}
+
+TEST(SRCppConverterPool, Errors)
+{
+    auto pool = SRCpp::ConverterPool();
+    {
+        auto [lease, error] = pool.acquire(SRCpp::Type::Linear, 0, 1.0);
+        EXPECT_FALSE(lease.has_value());
+        EXPECT_NE(error, 0);
+    }
+    EXPECT_EQ(pool.reserve(SRCpp::Type::Linear, 1, 1), 0);
+    {
+        auto [lease, error] = pool.acquire(SRCpp::Type::Linear, 1, 1000.0);
+        EXPECT_FALSE(lease.has_value());
+        EXPECT_EQ(error, SRCpp::ErrorBadFactor);
+    }
+    EXPECT_EQ(pool.idle(), 1U);
+}
@@ -0,0 +1,300 @@
+#include "SRCppTestUtils.hpp"
+#include <SRCpp/SRCppFile.hpp>
+#include <format>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <random>
+
+namespace {
+auto Unique()
+{
+    static auto const unique = std::random_device {}();
+    return unique;
+}
+
+// A path in the temporary directory, removed when it goes out of scope.  The
+// names are unique to the process, as the test builds for each standard may
+// run at once.
+struct TempFile {
+    explicit TempFile(std::string const& name)
+        : path { std::filesystem::temp_directory_path()
+              / std::format("SRCppTestFile_{}_{}", Unique(), name) }
+    {
+    }
+    ~TempFile() { std::filesystem::remove(path); }
+    std::filesystem::path path;
+};
+
+void PutLE(std::vector<char>& bytes, uint64_t value, size_t size)
+{
+    for (size_t i = 0; i < size; ++i) {
+        bytes.push_back(static_cast<char>(value >> (8 * i)));
+    }
+}
+
+void Put(std::vector<char>& bytes, std::string_view text)
+{
+    bytes.insert(bytes.end(), text.begin(), text.end());
+}
+
+// A canonical 16-bit WAV, or the same audio as RF64 with a ds64 chunk.
+auto MakeWav(std::span<const short> samples, int channels, int rate,
+    bool rf64 = false)
+{
+    auto data_size = samples.size() * 2;
+    std::vector<char> bytes;
+    Put(bytes, rf64 ? "RF64" : "RIFF");
+    PutLE(bytes, rf64 ? 0xFFFFFFFF : 36 + data_size, 4);
+    Put(bytes, "WAVE");
+    if (rf64) {
+        Put(bytes, "ds64");
+        PutLE(bytes, 28, 4);
+        PutLE(bytes, 72 + data_size, 8);
+        PutLE(bytes, data_size, 8);
+        PutLE(bytes, samples.size() / channels, 8);
+        PutLE(bytes, 0, 4);
+    }
+    Put(bytes, "fmt ");
+    PutLE(bytes, 16, 4);
+    PutLE(bytes, 1, 2);
+    PutLE(bytes, channels, 2);
+    PutLE(bytes, rate, 4);
+    PutLE(bytes, rate * channels * 2, 4);
+    PutLE(bytes, channels * 2, 2);
+    PutLE(bytes, 16, 2);
+    Put(bytes, "data");
+    PutLE(bytes, rf64 ? 0xFFFFFFFF : data_size, 4);
+    for (auto sample : samples) {
+        PutLE(bytes, static_cast<uint16_t>(sample), 2);
+    }
+    return bytes;
+}
+
+void WriteFile(std::filesystem::path const& path, std::span<const char> bytes)
+{
+    std::ofstream file(path, std::ios::binary);
+    file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+auto ReadFile(std::filesystem::path const& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<char> { std::istreambuf_iterator<char>(file), {} };
+}
+
+auto GetLE(std::span<const char> bytes, size_t offset, size_t size)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < size; ++i) {
+        value |= static_cast<uint64_t>(static_cast<unsigned char>(
+                     bytes[offset + i]))
+            << (8 * i);
+    }
+    return value;
+}
+
+template <typename T>
+auto Samples(std::span<const char> bytes, size_t offset = 0)
+{
+    std::vector<T> samples((bytes.size() - offset) / sizeof(T));
+    std::memcpy(samples.data(), bytes.data() + offset,
+        samples.size() * sizeof(T));
+    return samples;
+}
+}
+
+TEST(SRCppFile, Wav)
+{
+    auto input = ConvertTo<short>(makeSin({ 3000.0f, 40.0f }, 44100.0, 20000));
+    auto [expected, error] = SRCpp::Convert<short>(
+        std::span<const short> { input }, SRCpp::Type::Sinc_MediumQuality, 2,
+        48000.0 / 44100.0);
+    ASSERT_TRUE(expected.has_value()) << error;
+
+    for (auto rf64 : { false, true }) {
+        auto source = TempFile { "in.wav" };
+        auto sink = TempFile { "out.wav" };
+        WriteFile(source.path, MakeWav(input, 2, 44100, rf64));
+        // small blocks, so the stream crosses many of them
+        auto [stats, convert_error] = SRCpp::ConvertFile(source.path,
+            sink.path, { .output_rate = 48000.0, .block_frames = 1000 });
+        ASSERT_TRUE(stats.has_value()) << convert_error;
+        EXPECT_EQ(stats->input_frames, 20000);
+        EXPECT_EQ(stats->output_frames * 2, expected->size());
+        EXPECT_EQ(stats->output_rate, 48000.0);
+        EXPECT_EQ(stats->output_format, SRCpp::FileFormat::Int16);
+
+        // the output is exactly as long as its header says
+        auto bytes = ReadFile(sink.path);
+        auto data_size = expected->size() * 2;
+        ASSERT_EQ(bytes.size(), 80 + data_size);
+        EXPECT_EQ(std::string_view(bytes.data(), 4), "RIFF");
+        EXPECT_EQ(GetLE(bytes, 4, 4), 72 + data_size);
+        EXPECT_EQ(std::string_view(bytes.data() + 12, 4), "JUNK");
+        EXPECT_EQ(GetLE(bytes, 56, 2), 1);
+        EXPECT_EQ(GetLE(bytes, 58, 2), 2);
+        EXPECT_EQ(GetLE(bytes, 60, 4), 48000);
+        EXPECT_EQ(GetLE(bytes, 68, 2), 4);
+        EXPECT_EQ(GetLE(bytes, 70, 2), 16);
+        EXPECT_EQ(std::string_view(bytes.data() + 72, 4), "data");
+        EXPECT_EQ(GetLE(bytes, 76, 4), data_size);
+        EXPECT_EQ(Samples<short>(bytes, 80), *expected);
+    }
+}
+
+TEST(SRCppFile, WavFormats)
+{
+    struct Case {
+        int channels;
+        SRCpp::FileFormat format;
+        uint64_t format_size;
+        uint64_t tag;
+        uint64_t mask;
+    };
+    for (auto [channels, format, format_size, tag, mask] :
+        { Case { 2, SRCpp::FileFormat::Int16, 16, 1, 0 },
+            Case { 2, SRCpp::FileFormat::Float32, 18, 3, 0 },
+            Case { 2, SRCpp::FileFormat::Int24, 40, 1, 0x3 },
+            Case { 6, SRCpp::FileFormat::Int16, 40, 1, 0x3F },
+            Case { 3, SRCpp::FileFormat::Float32, 40, 3, 0x7 } }) {
+        auto input = std::vector<short>(1000 * channels);
+        auto source = TempFile { "in.wav" };
+        auto sink = TempFile { "out.wav" };
+        WriteFile(source.path, MakeWav(input, channels, 48000));
+        auto [stats, error] = SRCpp::ConvertFile(source.path, sink.path,
+            { .type = SRCpp::Type::Linear, .output_format = format });
+        ASSERT_TRUE(stats.has_value()) << error;
+
+        auto bytes = ReadFile(sink.path);
+        auto data = 64 + format_size;
+        auto data_size = stats->output_frames * channels
+            * SRCpp::details::BytesPerSample(format);
+        ASSERT_EQ(bytes.size(), data + data_size);
+        EXPECT_EQ(GetLE(bytes, 4, 4), data + data_size - 8);
+        EXPECT_EQ(GetLE(bytes, 52, 4), format_size);
+        EXPECT_EQ(GetLE(bytes, 56, 2), format_size == 40 ? 0xFFFE : tag);
+        EXPECT_EQ(GetLE(bytes, 58, 2), channels);
+        if (format_size > 16) {
+            EXPECT_EQ(GetLE(bytes, 72, 2), format_size - 18);
+        }
+        if (format_size == 40) {
+            EXPECT_EQ(GetLE(bytes, 74, 2), GetLE(bytes, 70, 2));
+            EXPECT_EQ(GetLE(bytes, 76, 4), mask);
+            EXPECT_EQ(GetLE(bytes, 80, 2), tag);
+            EXPECT_EQ(GetLE(bytes, 88, 8), 0x719B3800AA000080);
+        }
+        EXPECT_EQ(std::string_view(bytes.data() + data - 8, 4), "data");
+        EXPECT_EQ(GetLE(bytes, data - 4, 4), data_size);
+
+        // and it reads back as written
+        auto again = TempFile { "again.wav" };
+        std::tie(stats, error) = SRCpp::ConvertFile(
+            sink.path, again.path, { .type = SRCpp::Type::Linear });
+        ASSERT_TRUE(stats.has_value()) << error;
+        EXPECT_EQ(stats->channels, channels);
+        EXPECT_EQ(stats->output_format, format);
+    }
+}
+
+TEST(SRCppFile, RawFormats)
+{
+    // 24-bit samples decode to the top of an int, so they convert as the
+    // same values shifted up would
+    auto ints = ConvertTo<int>(makeSin({ 1000.0f }, 48000.0, 5000));
+    for (auto& sample : ints) {
+        sample &= ~0xFF;
+    }
+    std::vector<char> packed;
+    for (auto sample : ints) {
+        PutLE(packed, static_cast<uint32_t>(sample) >> 8, 3);
+    }
+    auto [expected, error] = SRCpp::Convert<float>(
+        std::span<const int> { ints }, SRCpp::Type::Linear, 1, 0.5);
+    ASSERT_TRUE(expected.has_value()) << error;
+
+    auto source = TempFile { "in.raw" };
+    auto sink = TempFile { "out.raw" };
+    WriteFile(source.path, packed);
+    auto [stats, convert_error] = SRCpp::ConvertFile(source.path, sink.path,
+        { .type = SRCpp::Type::Linear,
+            .factor = 0.5,
+            .output_format = SRCpp::FileFormat::Float32,
+            .raw_input = SRCpp::RawLayout { 1, 48000.0,
+                SRCpp::FileFormat::Int24 },
+            .raw_output = true,
+            .block_frames = 777 });
+    ASSERT_TRUE(stats.has_value()) << convert_error;
+    EXPECT_EQ(stats->output_rate, 24000.0);
+    EXPECT_EQ(Samples<float>(ReadFile(sink.path)), *expected);
+
+    // and back to 24 bits, rounded from the int conversion
+    auto round_trip = TempFile { "round.raw" };
+    std::tie(stats, convert_error) = SRCpp::ConvertFile(sink.path,
+        round_trip.path,
+        { .type = SRCpp::Type::Linear,
+            .factor = 2.0,
+            .output_format = SRCpp::FileFormat::Int24,
+            .raw_input = SRCpp::RawLayout { 1, 24000.0,
+                SRCpp::FileFormat::Float32 },
+            .raw_output = true });
+    ASSERT_TRUE(stats.has_value()) << convert_error;
+    auto [upsampled, up_error] = SRCpp::Convert<int>(
+        std::span<const float> { *expected }, SRCpp::Type::Linear, 1, 2.0);
+    ASSERT_TRUE(upsampled.has_value()) << up_error;
+    auto bytes = ReadFile(round_trip.path);
+    ASSERT_EQ(bytes.size(), upsampled->size() * 3);
+    for (size_t i = 0; i < upsampled->size(); ++i) {
+        auto rounded = std::min<int64_t>(
+            (static_cast<int64_t>((*upsampled)[i]) + 128) >> 8, 0x7FFFFF);
+        ASSERT_EQ(GetLE(bytes, 3 * i, 3),
+            static_cast<uint64_t>(rounded) & 0xFFFFFF)
+            << i;
+    }
+}
+
+TEST(SRCppFile, Errors)
+{
+    auto missing = TempFile { "missing.wav" };
+    auto sink = TempFile { "out.wav" };
+    auto [stats, error] = SRCpp::ConvertFile(missing.path, sink.path);
+    EXPECT_FALSE(stats.has_value());
+    EXPECT_NE(error.find("Could not open"), std::string::npos);
+
+    auto text = TempFile { "text.wav" };
+    WriteFile(text.path, std::string_view { "not a wave file at all" });
+    std::tie(stats, error) = SRCpp::ConvertFile(text.path, sink.path);
+    EXPECT_FALSE(stats.has_value());
+    EXPECT_EQ(error, "Input is not a WAV or RF64 file.");
+
+    // 8-bit WAV is not supported
+    auto wav = MakeWav(std::vector<short>(8), 1, 8000);
+    wav[34] = 8;
+    auto eight = TempFile { "eight.wav" };
+    WriteFile(eight.path, wav);
+    std::tie(stats, error) = SRCpp::ConvertFile(eight.path, sink.path);
+    EXPECT_FALSE(stats.has_value());
+    EXPECT_EQ(error, "Unsupported WAV encoding: format 1 with 8 bits.");
+
+    // a converter running at twice the factor the output was sized for
+    // fails part way, and takes its output file with it
+    auto source = TempFile { "source.wav" };
+    WriteFile(source.path, MakeWav(std::vector<short>(4000), 1, 8000));
+    auto [audio, audio_error]
+        = SRCpp::details::OpenAudio(source.path, SRCpp::FileOptions {});
+    ASSERT_TRUE(audio.has_value()) << audio_error;
+    auto converter = SRCpp::PushConverter(SRCpp::Type::Linear, 1, 2.0);
+    auto workspace = SRCpp::details::FileWorkspace {};
+    std::tie(stats, error) = SRCpp::details::ConvertAudio(*audio, sink.path,
+        { .type = SRCpp::Type::Linear, .block_frames = 500 }, converter,
+        workspace);
+    EXPECT_FALSE(stats.has_value());
+    EXPECT_FALSE(error.empty());
+    EXPECT_FALSE(std::filesystem::exists(sink.path));
+
+    auto good = TempFile { "good.wav" };
+    WriteFile(good.path, MakeWav(std::vector<short>(8), 1, 8000));
+    std::tie(stats, error)
+        = SRCpp::ConvertFile(good.path, sink.path, { .factor = 0.0 });
+    EXPECT_FALSE(stats.has_value());
+    EXPECT_EQ(error, SRCpp::StrError(SRCpp::ErrorBadFactor));
+}
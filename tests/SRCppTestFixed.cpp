@@ -0,0 +1,101 @@
+#include "SRCppTestUtils.hpp"
+#include <gtest/gtest.h>
+#include <span>
+
+namespace {
+using Medium44To48 = SRCpp::FixedRatioConverter<44100, 48000, 2,
+    SRCpp::Type::Polyphase_MediumQuality>;
+using Best48To16 = SRCpp::FixedRatioConverter<48000, 16000, 1>;
+
+// all of the converter's state is in the object
+static_assert(std::is_trivially_copyable_v<Medium44To48>);
+static_assert(Medium44To48::factor == 48000.0 / 44100.0);
+static_assert(Best48To16::type == SRCpp::Type::Polyphase_BestQuality);
+
+// Pushes input through converter in uneven blocks and flushes it.
+template <typename Converter>
+auto PushInBlocks(Converter& converter, std::span<const float> input)
+{
+    constexpr auto channels = Converter::channels;
+    std::vector<float> result;
+    auto frames = input.size() / channels;
+    for (size_t frame = 0, block = 1; frame < frames;
+         frame += block, block = block * 3 % 701 + 1) {
+        auto count = std::min(block, frames - frame);
+        auto [output, error] = converter.template convert<float>(
+            input.subspan(frame * channels, count * channels));
+        EXPECT_TRUE(output.has_value()) << error;
+        result.insert(result.end(), output->begin(), output->end());
+    }
+    auto [flush, error] = converter.template flush<float>();
+    EXPECT_TRUE(flush.has_value()) << error;
+    result.insert(result.end(), flush->begin(), flush->end());
+    return result;
+}
+}
+
+TEST(SRCppFixed, MatchesPolyphaseType)
+{
+    // the compile-time table is the bank the Polyphase type designs at run
+    // time, so the results are identical
+    auto stereo = makeSin({ 3000.0f, 40.0f }, 44100.0, 5000);
+    auto [expected, error] = SRCpp::Convert<float>(
+        std::span<const float> { stereo },
+        SRCpp::Type::Polyphase_MediumQuality, 2, Medium44To48::factor);
+    ASSERT_TRUE(expected.has_value()) << error;
+    auto medium = Medium44To48 {};
+    EXPECT_EQ(PushInBlocks(medium, stereo), *expected);
+
+    auto mono = makeSin({ 3000.0f }, 48000.0, 5000);
+    auto [decimated, decimated_error]
+        = SRCpp::Convert<float>(std::span<const float> { mono },
+            SRCpp::Type::Polyphase_BestQuality, 1, Best48To16::factor);
+    ASSERT_TRUE(decimated.has_value()) << decimated_error;
+    auto best = Best48To16 {};
+    EXPECT_EQ(PushInBlocks(best, mono), *decimated);
+
+    // flushing starts a new stream
+    EXPECT_EQ(PushInBlocks(best, mono), *decimated);
+}
+
+TEST(SRCppFixed, Formats)
+{
+    auto input = ConvertTo<short>(makeSin({ 3000.0f, 40.0f }, 44100.0, 3000));
+    auto [expected, error] = SRCpp::Convert<int>(
+        std::span<const short> { input },
+        SRCpp::Type::Polyphase_MediumQuality, 2, Medium44To48::factor);
+    ASSERT_TRUE(expected.has_value()) << error;
+
+    auto converter = Medium44To48 {};
+    auto [output, output_error] = converter.convert<int>(input);
+    ASSERT_TRUE(output.has_value()) << output_error;
+    auto [flush, flush_error] = converter.flush<int>();
+    ASSERT_TRUE(flush.has_value()) << flush_error;
+    output->insert(output->end(), flush->begin(), flush->end());
+    EXPECT_EQ(*output, *expected);
+}
+
+TEST(SRCppFixed, OutputFrames)
+{
+    auto input = makeSin({ 3000.0f, 40.0f }, 44100.0, 1000);
+    auto converter = Medium44To48 {};
+    auto frames = converter.output_frames(1000);
+    std::vector<float> output(frames * 2 - 1);
+    auto [result, error] = converter.convert_noalloc(input, output);
+    EXPECT_EQ(error, SRCpp::ErrorOutputTooSmall);
+    EXPECT_TRUE(result.empty());
+
+    output.resize(frames * 2);
+    std::tie(result, error) = converter.convert_noalloc(input, output);
+    EXPECT_EQ(error, SRCpp::ErrorNone);
+    EXPECT_EQ(result.size(), frames * 2);
+
+    // everything together is ceil(input_frames * up / down)
+    auto rest = converter.output_frames(0);
+    EXPECT_EQ(frames + rest, (1000 * 160 + 146) / 147);
+    output.resize(rest * 2);
+    std::tie(result, error) = converter.flush_noalloc(output);
+    EXPECT_EQ(error, SRCpp::ErrorNone);
+    EXPECT_EQ(result.size(), rest * 2);
+    EXPECT_EQ(converter.output_frames(0), 0);
+}
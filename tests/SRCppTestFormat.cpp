@@ -0,0 +1,251 @@
+#include "SRCppTestUtils.hpp"
+#include <SRCpp/SRCpp.hpp>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <limits>
+#include <random>
+#include <span>
+
+namespace {
+auto LevelsToTest()
+{
+    auto levels = std::vector<SRCpp::SimdLevel> {};
+    for (auto level :
+        { SRCpp::SimdLevel::Scalar, SRCpp::SimdLevel::SSE2,
+            SRCpp::SimdLevel::AVX2, SRCpp::SimdLevel::AVX512 }) {
+        if (level <= SRCpp::DetectSimdLevel()) {
+            levels.push_back(level);
+        }
+    }
+    return levels;
+}
+
+auto LevelName(SRCpp::SimdLevel level) -> const char*
+{
+    switch (level) {
+    case SRCpp::SimdLevel::Scalar:
+        return "Scalar";
+    case SRCpp::SimdLevel::SSE2:
+        return "SSE2";
+    case SRCpp::SimdLevel::AVX2:
+        return "AVX2";
+    case SRCpp::SimdLevel::AVX512:
+        return "AVX512";
+    }
+    return "?";
+}
+
+// floats compare by bits so -0.0f and 0.0f are told apart.
+template <typename T> auto Bits(const std::vector<T>& values)
+{
+    if constexpr (std::is_same_v<T, float>) {
+        auto bits = std::vector<uint32_t>(values.size());
+        std::memcpy(bits.data(), values.data(), values.size() * sizeof(T));
+        return bits;
+    } else {
+        return values;
+    }
+}
+
+// Awkward lengths so every kernel also runs its scalar tail.
+auto FloatInputs(float scale) -> std::vector<float>
+{
+    auto values = std::vector<float> { 0.0f, -0.0f, 1.0f, -1.0f, 2.0f, -2.0f,
+        1e30f, -1e30f, std::numeric_limits<float>::infinity(),
+        -std::numeric_limits<float>::infinity(),
+        std::numeric_limits<float>::denorm_min(),
+        -std::numeric_limits<float>::denorm_min(),
+        std::numeric_limits<float>::max(),
+        -std::numeric_limits<float>::max() };
+    // either side of the clipping points and of every rounding tie nearby
+    for (auto edge : { 32767.0f, 32768.0f, -32768.0f, -32769.0f, 2147483520.0f,
+             2147483648.0f, -2147483648.0f, -2147483904.0f }) {
+        for (auto offset : { -1.5f, -1.0f, -0.5f, 0.0f, 0.5f, 1.0f, 1.5f }) {
+            values.push_back((edge + offset) / scale);
+            values.push_back(std::nextafter(edge / scale, 0.0f));
+            values.push_back(std::nextafter(edge / scale, 10.0f * edge));
+        }
+    }
+    for (auto i = -40; i <= 40; ++i) {
+        values.push_back((i + 0.5f) / scale);
+    }
+    auto generator = std::mt19937 { 42 };
+    auto distribution = std::uniform_real_distribution<float> { -1.2f, 1.2f };
+    while (values.size() < 4099) {
+        values.push_back(distribution(generator));
+    }
+    return values;
+}
+
+auto IntInputs() -> std::vector<int>
+{
+    auto values = std::vector<int> { 0, 1, -1, std::numeric_limits<int>::max(),
+        std::numeric_limits<int>::min(), std::numeric_limits<int>::max() - 1,
+        std::numeric_limits<int>::min() + 1 };
+    // values that round to float in both directions
+    for (auto shift = 24; shift < 31; ++shift) {
+        for (auto offset : { -129, -128, -64, -1, 0, 1, 63, 64, 65, 128 }) {
+            values.push_back((1 << shift) + offset);
+            values.push_back(-(1 << shift) - offset);
+        }
+    }
+    auto generator = std::mt19937 { 42 };
+    auto distribution = std::uniform_int_distribution<int> {};
+    while (values.size() < 4099) {
+        values.push_back(distribution(generator));
+    }
+    return values;
+}
+}
+
+TEST(SRCppFormat, ShortToFloatBitExact)
+{
+    auto input = std::vector<short> {};
+    for (auto value = std::numeric_limits<short>::min();
+        value < std::numeric_limits<short>::max(); ++value) {
+        input.push_back(value);
+    }
+    input.push_back(std::numeric_limits<short>::max());
+    auto reference = std::vector<float>(input.size());
+    src_short_to_float_array(input.data(), reference.data(), input.size());
+
+    for (auto level : LevelsToTest()) {
+        auto output = std::vector<float>(input.size());
+        SRCpp::details::FormatKernelsFor(level).short_to_float(
+            input.data(), output.data(), input.size());
+        EXPECT_EQ(Bits(output), Bits(reference)) << LevelName(level);
+    }
+}
+
+TEST(SRCppFormat, IntToFloatBitExact)
+{
+    auto input = IntInputs();
+    auto reference = std::vector<float>(input.size());
+    src_int_to_float_array(input.data(), reference.data(), input.size());
+
+    for (auto level : LevelsToTest()) {
+        auto output = std::vector<float>(input.size());
+        SRCpp::details::FormatKernelsFor(level).int_to_float(
+            input.data(), output.data(), input.size());
+        EXPECT_EQ(Bits(output), Bits(reference)) << LevelName(level);
+    }
+}
+
+TEST(SRCppFormat, FloatToShortBitExact)
+{
+    auto input = FloatInputs(32768.0f);
+    auto reference = std::vector<short>(input.size());
+    src_float_to_short_array(input.data(), reference.data(), input.size());
+
+    for (auto level : LevelsToTest()) {
+        auto output = std::vector<short>(input.size());
+        SRCpp::details::FormatKernelsFor(level).float_to_short(
+            input.data(), output.data(), input.size());
+        EXPECT_EQ(output, reference) << LevelName(level);
+    }
+}
+
+TEST(SRCppFormat, FloatToIntBitExact)
+{
+    auto input = FloatInputs(2147483648.0f);
+    auto reference = std::vector<int>(input.size());
+    src_float_to_int_array(input.data(), reference.data(), input.size());
+
+    for (auto level : LevelsToTest()) {
+        auto output = std::vector<int>(input.size());
+        SRCpp::details::FormatKernelsFor(level).float_to_int(
+            input.data(), output.data(), input.size());
+        EXPECT_EQ(output, reference) << LevelName(level);
+    }
+}
+
+TEST(SRCppFormat, NaNBecomesZero)
+{
+    auto input = std::vector<float>(37, std::numeric_limits<float>::quiet_NaN());
+    for (auto level : LevelsToTest()) {
+        auto shorts = std::vector<short>(input.size(), 1);
+        auto ints = std::vector<int>(input.size(), 1);
+        const auto& kernels = SRCpp::details::FormatKernelsFor(level);
+        kernels.float_to_short(input.data(), shorts.data(), input.size());
+        kernels.float_to_int(input.data(), ints.data(), input.size());
+        EXPECT_EQ(shorts, std::vector<short>(input.size())) << LevelName(level);
+        EXPECT_EQ(ints, std::vector<int>(input.size())) << LevelName(level);
+    }
+}
+
+TEST(SRCppFormat, ConvertFormat)
+{
+    auto input = std::vector<short> { 0, 1, -1, 16384, -32768, 32767, 12 };
+    auto reference = std::vector<float>(input.size());
+    src_short_to_float_array(input.data(), reference.data(), input.size());
+    auto referenceInt = ConvertTo<int>(reference);
+
+    {
+        auto [output, error] = SRCpp::ConvertFormat<float>(input);
+        ASSERT_TRUE(output.has_value()) << error;
+        EXPECT_EQ(*output, reference);
+    }
+    {
+        auto output = std::vector<int>(input.size() + 3);
+        auto [result, error] = SRCpp::ConvertFormat(input, output);
+        ASSERT_TRUE(result.has_value()) << error;
+        EXPECT_EQ(std::vector<int>(result->begin(), result->end()),
+            referenceInt);
+    }
+    {
+        auto output = std::vector<int>(input.size() - 1);
+        auto [result, error] = SRCpp::ConvertFormat(input, output);
+        EXPECT_FALSE(result.has_value());
+        EXPECT_FALSE(error.empty());
+    }
+    {
+        auto [bytes, error] = SRCpp::ConvertFormat_unsafe(SRCpp::Format::Short,
+            input.data(), input.size() * sizeof(short), SRCpp::Format::Float);
+        ASSERT_TRUE(bytes.has_value()) << error;
+        auto output = std::vector<float>(bytes->size() / sizeof(float));
+        std::memcpy(output.data(), bytes->data(), bytes->size());
+        EXPECT_EQ(output, reference);
+    }
+#if SRCPP_USE_CPP23
+    {
+        auto output = SRCpp::ConvertFormat_expected<float>(input);
+        ASSERT_TRUE(output.has_value()) << output.error();
+        EXPECT_EQ(*output, reference);
+        auto ints = std::vector<int>(input.size());
+        auto bytes = SRCpp::ConvertFormat_unsafe_expected(SRCpp::Format::Short,
+            input.data(), input.size() * sizeof(short), SRCpp::Format::Int,
+            ints.data(), ints.size() * sizeof(int));
+        ASSERT_TRUE(bytes.has_value()) << bytes.error();
+        EXPECT_EQ(ints, referenceInt);
+    }
+#endif // SRCPP_USE_CPP23
+}
+
+TEST(SRCppFormat, StereoInterleave)
+{
+    auto left = FloatInputs(1.0f);
+    auto right = std::vector<float>(left.rbegin(), left.rend());
+    auto interleaved = std::vector<float> {};
+    for (size_t i = 0; i < left.size(); ++i) {
+        interleaved.push_back(left[i]);
+        interleaved.push_back(right[i]);
+    }
+
+    for (auto level : LevelsToTest()) {
+        const auto& kernels = SRCpp::details::FormatKernelsFor(level);
+        auto output = std::vector<float>(interleaved.size());
+        kernels.interleave2(
+            left.data(), right.data(), output.data(), left.size());
+        EXPECT_EQ(Bits(output), Bits(interleaved)) << LevelName(level);
+
+        auto out_left = std::vector<float>(left.size());
+        auto out_right = std::vector<float>(right.size());
+        kernels.deinterleave2(interleaved.data(), out_left.data(),
+            out_right.data(), left.size());
+        EXPECT_EQ(Bits(out_left), Bits(left)) << LevelName(level);
+        EXPECT_EQ(Bits(out_right), Bits(right)) << LevelName(level);
+    }
+}
@@ -0,0 +1,98 @@
+#include "SRCppTestUtils.hpp"
+#include <gtest/gtest.h>
+#include <ranges>
+#include <span>
+
+#if SRCPP_USE_GENERATOR
+namespace {
+// Splits input into chunks of frames, the last one short.
+auto Chunks(std::span<const float> input, size_t channels, size_t frames)
+{
+    std::vector<std::vector<float>> chunks;
+    for (size_t offset = 0; offset < input.size();
+         offset += frames * channels) {
+        auto count = std::min(frames * channels, input.size() - offset);
+        auto chunk = input.subspan(offset, count);
+        chunks.emplace_back(chunk.begin(), chunk.end());
+    }
+    return chunks;
+}
+}
+
+TEST(SRCppGenerator, MatchesConvert)
+{
+    auto input = makeSin({ 3000.0f, 40.0f }, 44100.0, 10000);
+    for (auto type : { SRCpp::Type::Sinc_MediumQuality,
+             SRCpp::Type::Polyphase_MediumQuality }) {
+        auto [expected, error] = SRCpp::Convert<float>(
+            std::span<const float> { input }, type, 2, 48000.0 / 44100.0);
+        ASSERT_TRUE(expected.has_value()) << error;
+
+        std::vector<float> output;
+        for (auto block : SRCpp::resample_stream(
+                 Chunks(input, 2, 777), type, 2, 48000.0 / 44100.0)) {
+            output.insert(output.end(), block.begin(), block.end());
+        }
+        EXPECT_EQ(output, *expected);
+    }
+}
+
+TEST(SRCppGenerator, LazyAndReused)
+{
+    // nothing is read until the first block is asked for, and then only as
+    // much as that block needs
+    auto input = makeSin({ 1000.0f }, 48000.0, 4800);
+    auto chunks = Chunks(input, 1, 480);
+    auto pulled = size_t { 0 };
+    auto counted = chunks | std::views::transform([&](auto const& chunk) {
+        ++pulled;
+        return std::span<const float> { chunk };
+    });
+    auto stream
+        = SRCpp::resample_stream(counted, SRCpp::Type::Linear, 1, 2.0);
+    EXPECT_EQ(pulled, 0);
+    auto block = stream.begin();
+    EXPECT_EQ(pulled, 1);
+    EXPECT_GT((*block).size(), 0);
+
+    // each block is the same buffer, overwritten
+    auto first = (*block).data();
+    ++block;
+    EXPECT_EQ((*block).data(), first);
+    EXPECT_EQ(pulled, 2);
+}
+
+TEST(SRCppGenerator, Formats)
+{
+    auto input = ConvertTo<short>(makeSin({ 1000.0f }, 48000.0, 3000));
+    auto [expected, error] = SRCpp::Convert<int>(
+        std::span<const short> { input }, SRCpp::Type::Linear, 1, 0.5);
+    ASSERT_TRUE(expected.has_value()) << error;
+    auto chunks = std::vector<std::span<const short>> {
+        std::span<const short> { input }.first(1000),
+        std::span<const short> { input }.subspan(1000),
+    };
+    std::vector<int> output;
+    for (auto block : SRCpp::resample_stream<int>(
+             chunks, SRCpp::Type::Linear, 1, 0.5)) {
+        output.insert(output.end(), block.begin(), block.end());
+    }
+    EXPECT_EQ(output, *expected);
+}
+
+TEST(SRCppGenerator, Errors)
+{
+    // bad arguments throw at the call, not at the first block
+    auto chunks = std::vector<std::vector<float>> {};
+    EXPECT_THROW(
+        SRCpp::resample_stream(chunks, SRCpp::Type::Linear, 0, 2.0),
+        std::runtime_error);
+    // an empty stream yields nothing
+    auto count = 0;
+    for ([[maybe_unused]] auto block :
+        SRCpp::resample_stream(chunks, SRCpp::Type::Linear, 1, 2.0)) {
+        ++count;
+    }
+    EXPECT_EQ(count, 0);
+}
+#endif // SRCPP_USE_GENERATOR
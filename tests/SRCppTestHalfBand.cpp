@@ -0,0 +1,165 @@
+#include "SRCppTestUtils.hpp"
+#include <gtest/gtest.h>
+#include <span>
+
+namespace {
+constexpr auto kPolyphaseTypes = { SRCpp::Type::Polyphase_BestQuality,
+    SRCpp::Type::Polyphase_MediumQuality, SRCpp::Type::Polyphase_Fastest };
+constexpr auto kPowerOfTwoFactors = { 2.0, 4.0, 8.0, 0.5, 0.25, 0.125 };
+
+auto Sine(double hz, double rate, size_t frames)
+{
+    std::vector<float> data(frames);
+    for (size_t i = 0; i < frames; ++i) {
+        auto phase = 2.0 * std::numbers::pi * hz * static_cast<double>(i);
+        data[i] = static_cast<float>(std::sin(phase / rate));
+    }
+    return data;
+}
+
+auto SineErrorDecibels(
+    const std::vector<float>& output, double hz, double rate, size_t edge)
+{
+    auto expected = Sine(hz, rate, output.size());
+    auto middle = std::span { output }.subspan(edge, output.size() - 2 * edge);
+    auto reference = std::span<const float> { expected }.subspan(
+        edge, output.size() - 2 * edge);
+    return ToDecibels(CalculateRMSError<float>(reference, middle));
+}
+
+auto Pushed(SRCpp::PushConverter& push, std::span<const float> input,
+    size_t channels, bool flush = true)
+{
+    std::vector<float> result;
+    auto frames = input.size() / channels;
+    for (size_t frame = 0, block = 1; frame < frames;
+         frame += block, block = block * 3 % 701 + 1) {
+        auto count = std::min(block, frames - frame);
+        auto [output, error] = push.convert<float>(
+            input.subspan(frame * channels, count * channels));
+        EXPECT_TRUE(output.has_value()) << error;
+        result.insert(result.end(), output->begin(), output->end());
+    }
+    if (flush) {
+        auto [rest, error] = push.flush<float>();
+        EXPECT_TRUE(rest.has_value()) << error;
+        result.insert(result.end(), rest->begin(), rest->end());
+    }
+    return result;
+}
+}
+
+TEST(SRCppHalfBand, PassesTheBand)
+{
+    for (auto type : kPolyphaseTypes) {
+        for (auto factor : kPowerOfTwoFactors) {
+            auto input_rate = 48000.0;
+            auto output_rate = input_rate * factor;
+            auto hz = 0.3 * std::min(input_rate, output_rate);
+            auto input = Sine(hz, input_rate, 40000);
+            auto [output, error] = SRCpp::Convert<float>(
+                std::span<const float> { input }, type, 1, factor);
+            ASSERT_TRUE(output.has_value()) << error;
+            EXPECT_EQ(output->size(),
+                static_cast<size_t>(std::ceil(input.size() * factor)));
+            auto edge = output->size() / 8;
+            EXPECT_LT(SineErrorDecibels(*output, hz, output_rate, edge), -95)
+                << static_cast<int>(type) << " x" << factor;
+        }
+    }
+}
+
+TEST(SRCppHalfBand, StopsAliases)
+{
+    // tones between the output's passband and its Nyquist frequency's mirror
+    // must not fold back
+    for (auto type : kPolyphaseTypes) {
+        for (auto factor : { 0.5, 0.25, 0.125 }) {
+            auto input = Sine(48000.0 * factor * 0.7, 48000.0, 40000);
+            auto [output, error] = SRCpp::Convert<float>(
+                std::span<const float> { input }, type, 1, factor);
+            ASSERT_TRUE(output.has_value()) << error;
+            auto edge = output->size() / 8;
+            auto middle = std::span<const float> { *output }.subspan(
+                edge, output->size() - 2 * edge);
+            auto silence = std::vector<float>(middle.size());
+            EXPECT_LT(ToDecibels(CalculateRMSError<float>(middle, silence)),
+                -95)
+                << static_cast<int>(type) << " x" << factor;
+        }
+    }
+}
+
+TEST(SRCppHalfBand, MatchesAcrossInterfaces)
+{
+    auto input = makeSin({ 3000.0f, 40.0f }, 44100.0, 5000);
+    for (auto type : kPolyphaseTypes) {
+        for (auto factor : { 4.0, 0.25 }) {
+            auto [expected, error] = SRCpp::Convert<float>(
+                std::span<const float> { input }, type, 2, factor);
+            ASSERT_TRUE(expected.has_value()) << error;
+
+            auto push = SRCpp::PushConverter(type, 2, factor);
+            EXPECT_EQ(Pushed(push, input, 2), *expected);
+
+            size_t offset = 0;
+            auto pull = SRCpp::PullConverter(
+                [&]() -> std::span<float> {
+                    auto count = std::min<size_t>(200, input.size() - offset);
+                    auto block = std::span { input }.subspan(offset, count);
+                    offset += count;
+                    return block;
+                },
+                type, 2, factor);
+            std::vector<float> pulled;
+            std::vector<float> buffer(2 * 333);
+            while (true) {
+                auto [output, pull_error] = pull.convert(buffer);
+                ASSERT_TRUE(output.has_value()) << pull_error;
+                if (output->empty()) {
+                    break;
+                }
+                pulled.insert(pulled.end(), output->begin(), output->end());
+            }
+            EXPECT_EQ(pulled, *expected);
+        }
+    }
+}
+
+TEST(SRCppHalfBand, ReportsLatency)
+{
+    auto input = Sine(1000.0, 48000.0, 4000);
+    for (auto type : kPolyphaseTypes) {
+        for (auto factor : kPowerOfTwoFactors) {
+            // what a stream holds back is what flush hands out
+            auto push = SRCpp::PushConverter(type, 1, factor);
+            auto latency = push.latency_frames();
+            EXPECT_GT(latency, 0);
+            auto output = Pushed(push, input, 1, false);
+            auto total = static_cast<size_t>(std::ceil(input.size() * factor));
+            EXPECT_NEAR(output.size() + latency, total, 1.0)
+                << static_cast<int>(type) << " x" << factor;
+        }
+    }
+    EXPECT_GT(
+        SRCpp::PushConverter(SRCpp::Type::Polyphase_Fastest, 1, 0.75)
+            .latency_frames(),
+        0);
+    EXPECT_GT(SRCpp::PushConverter(SRCpp::Type::Sinc_Fastest, 1, 2.0)
+                  .latency_frames(),
+        0);
+}
+
+TEST(SRCppHalfBand, ResetSwitchesEngines)
+{
+    auto input = makeSin({ 3000.0f }, 48000.0, 3000);
+    auto type = SRCpp::Type::Polyphase_MediumQuality;
+    auto push = SRCpp::PushConverter(type, 1, 0.75);
+    for (auto factor : { 2.0, 0.75, 0.125 }) {
+        auto [expected, error] = SRCpp::Convert<float>(
+            std::span<const float> { input }, type, 1, factor);
+        ASSERT_TRUE(expected.has_value()) << error;
+        EXPECT_EQ(push.reset(factor), SRCpp::ErrorNone);
+        EXPECT_EQ(Pushed(push, input, 1), *expected) << factor;
+    }
+}
@@ -0,0 +1,156 @@
+#include "SRCppTestUtils.hpp"
+#include <deque>
+#include <gtest/gtest.h>
+#include <iterator>
+#include <span>
+
+namespace {
+constexpr auto kTypes = { SRCpp::Type::Sinc_MediumQuality,
+    SRCpp::Type::Linear, SRCpp::Type::Polyphase_MediumQuality };
+constexpr auto kFactors = { 0.5, 48000.0 / 44100.0, 2.0 };
+}
+
+TEST(SRCppInto, ConvertMatchesConvert)
+{
+    auto input = makeSin({ 1000.0f, 3000.0f }, 48000.0, 3000);
+    for (auto type : kTypes) {
+        for (auto factor : kFactors) {
+            auto [expected, error] = SRCpp::Convert<short>(
+                std::span<const float> { input }, type, 2, factor);
+            ASSERT_TRUE(expected.has_value()) << error;
+
+            // appends after what is already there
+            auto output = std::vector<short> { 7, 7 };
+            auto [appended, into_error] = SRCpp::ConvertInto(
+                std::span<const float> { input }, output, type, 2, factor);
+            ASSERT_TRUE(appended.has_value()) << into_error;
+            EXPECT_EQ(appended->size(), expected->size());
+            EXPECT_EQ(appended->data(), output.data() + 2);
+            EXPECT_EQ(output[0], 7);
+            EXPECT_TRUE(std::ranges::equal(*appended, *expected));
+
+            auto deque = std::deque<short> {};
+            auto [end, iterator_error] = SRCpp::ConvertInto<short>(
+                std::span<const float> { input }, std::back_inserter(deque),
+                type, 2, factor);
+            ASSERT_TRUE(end.has_value()) << iterator_error;
+            EXPECT_TRUE(std::ranges::equal(deque, *expected));
+        }
+    }
+}
+
+TEST(SRCppInto, ConvertError)
+{
+    auto input = makeSin({ 1000.0f }, 48000.0, 1000);
+    auto output = std::vector<float> { 1.0f, 2.0f };
+    auto [appended, error] = SRCpp::ConvertInto(std::span<const float> { input },
+        output, SRCpp::Type::Sinc_Fastest, 1, 1000.0);
+    EXPECT_FALSE(appended.has_value());
+    EXPECT_FALSE(error.empty());
+    EXPECT_EQ(output, (std::vector<float> { 1.0f, 2.0f }));
+}
+
+TEST(SRCppInto, PushMatchesConvert)
+{
+    auto input = makeSin({ 1000.0f, 3000.0f }, 48000.0, 6000);
+    for (auto type : kTypes) {
+        for (auto factor : kFactors) {
+            auto push = SRCpp::PushConverter(type, 2, factor);
+            auto expected = std::vector<int> {};
+            for (size_t sample = 0; sample < input.size(); sample += 1000) {
+                auto block = std::span<const float> { input }.subspan(
+                    sample, std::min<size_t>(1000, input.size() - sample));
+                auto [result, error] = push.convert<int>(block);
+                ASSERT_TRUE(result.has_value()) << error;
+                expected.insert(expected.end(), result->begin(), result->end());
+            }
+            auto [flushed, flush_error] = push.flush<int>();
+            ASSERT_TRUE(flushed.has_value()) << flush_error;
+            expected.insert(expected.end(), flushed->begin(), flushed->end());
+
+            auto into = SRCpp::PushConverter(type, 2, factor);
+            auto output = std::vector<int> {};
+            auto iterated = std::vector<int> {};
+            auto into_iterator = SRCpp::PushConverter(type, 2, factor);
+            for (size_t sample = 0; sample < input.size(); sample += 1000) {
+                auto block = std::span<const float> { input }.subspan(
+                    sample, std::min<size_t>(1000, input.size() - sample));
+                auto before = output.size();
+                auto [appended, error] = into.convert_into(block, output);
+                ASSERT_TRUE(appended.has_value()) << error;
+                EXPECT_EQ(appended->size(), output.size() - before);
+                auto [end, iterator_error] = into_iterator.convert_into<int>(
+                    block, std::back_inserter(iterated));
+                ASSERT_TRUE(end.has_value()) << iterator_error;
+            }
+            auto [appended, flush_into_error] = into.flush_into(output);
+            ASSERT_TRUE(appended.has_value()) << flush_into_error;
+            auto [end, iterator_error]
+                = into_iterator.flush_into<int>(std::back_inserter(iterated));
+            ASSERT_TRUE(end.has_value()) << iterator_error;
+            EXPECT_EQ(output, expected);
+            EXPECT_EQ(iterated, expected);
+        }
+    }
+}
+
+TEST(SRCppInto, PushReusesCapacity)
+{
+    // once the caller's vector has grown, clearing it between blocks means
+    // no more allocations
+    auto input = makeSin({ 1000.0f }, 48000.0, 1024);
+    auto push = SRCpp::PushConverter(SRCpp::Type::Polyphase_Fastest, 1, 1.5);
+    auto output = std::vector<float> {};
+    ASSERT_TRUE(push.convert_into(input, output).first.has_value());
+    output.clear();
+    ASSERT_TRUE(push.convert_into(input, output).first.has_value());
+    auto* data = output.data();
+    for (int block = 0; block < 8; ++block) {
+        output.clear();
+        auto [appended, error] = push.convert_into(input, output);
+        ASSERT_TRUE(appended.has_value()) << error;
+        EXPECT_EQ(output.data(), data);
+        EXPECT_EQ(appended->size(), 1536U);
+    }
+}
+
+TEST(SRCppInto, Pull)
+{
+    auto input = makeSin({ 1000.0f }, 48000.0, 4000);
+    for (auto factor : kFactors) {
+        auto type = SRCpp::Type::Polyphase_MediumQuality;
+        auto expected = std::vector<short>(
+            SRCpp::MaxOutputFrames(input.size(), factor) + 1000);
+        {
+            auto remaining = std::span<float> { input };
+            auto pull = SRCpp::PullConverter(
+                [&] { return std::exchange(remaining, {}); }, type, 1, factor);
+            auto [result, error] = pull.convert(expected);
+            ASSERT_TRUE(result.has_value()) << error;
+            expected.resize(result->size());
+        }
+        auto remaining = std::span<float> { input };
+        auto pull = SRCpp::PullConverter(
+            [&] { return std::exchange(remaining, {}); }, type, 1, factor);
+        auto output = std::vector<short> {};
+        auto deque = std::deque<short> {};
+        while (true) {
+            auto [appended, error] = pull.convert_into(300, output);
+            ASSERT_TRUE(appended.has_value()) << error;
+            EXPECT_LE(appended->size(), 300U);
+            if (appended->empty()) {
+                break;
+            }
+        }
+        EXPECT_EQ(output, expected);
+
+        remaining = std::span<float> { input };
+        auto iterated = SRCpp::PullConverter(
+            [&] { return std::exchange(remaining, {}); }, type, 1, factor);
+        auto [end, error]
+            = iterated.convert_into<short>(expected.size() + 100,
+                std::back_inserter(deque));
+        ASSERT_TRUE(end.has_value()) << error;
+        EXPECT_TRUE(std::ranges::equal(deque, expected));
+    }
+}
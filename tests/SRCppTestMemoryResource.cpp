@@ -0,0 +1,158 @@
+#include "SRCppTestUtils.hpp"
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <memory_resource>
+#include <span>
+
+namespace {
+// Counts what is allocated through it and checks every block is 64-byte
+// aligned.  Output vectors use the default alignment, so they allocate from
+// new_delete_resource() instead.
+class CountingResource : public std::pmr::memory_resource {
+public:
+    size_t allocations { 0 };
+    size_t outstanding { 0 };
+    bool aligned { true };
+
+private:
+    auto do_allocate(size_t bytes, size_t alignment) -> void* override
+    {
+        auto* data
+            = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        aligned = aligned && alignment >= 64
+            && reinterpret_cast<std::uintptr_t>(data) % 64 == 0;
+        ++allocations;
+        ++outstanding;
+        return data;
+    }
+
+    void do_deallocate(void* data, size_t bytes, size_t alignment) override
+    {
+        --outstanding;
+        std::pmr::new_delete_resource()->deallocate(data, bytes, alignment);
+    }
+
+    auto do_is_equal(const memory_resource& other) const noexcept
+        -> bool override
+    {
+        return this == &other;
+    }
+};
+
+// Fails any allocation from the default resource while in scope.
+struct NoDefaultResource {
+    std::pmr::memory_resource* previous {
+        std::pmr::set_default_resource(std::pmr::null_memory_resource())
+    };
+    ~NoDefaultResource() { std::pmr::set_default_resource(previous); }
+};
+
+constexpr auto kTypes = { SRCpp::Type::Sinc_Fastest, SRCpp::Type::Linear,
+    SRCpp::Type::Polyphase_Fastest };
+}
+
+TEST(SRCppMemoryResource, Push)
+{
+    auto input = makeSin({ 1000.0f, 3000.0f }, 48000.0, 4000);
+    for (auto type : kTypes) {
+        auto resource = CountingResource {};
+        {
+            auto expected = SRCpp::PushConverter(type, 2, 1.5);
+            auto reference = std::vector<short> {};
+            auto output
+                = std::pmr::vector<short> { std::pmr::new_delete_resource() };
+            {
+                auto guard = NoDefaultResource {};
+                auto push = SRCpp::PushConverter(type, 2, 1.5, &resource);
+                for (size_t sample = 0; sample < input.size();
+                    sample += 998) {
+                    auto block = std::span<const float> { input }.subspan(
+                        sample, std::min<size_t>(998, input.size() - sample));
+                    ASSERT_TRUE(push.convert_into(block, output).first);
+                    ASSERT_TRUE(
+                        expected.convert_into(block, reference).first);
+                }
+                ASSERT_TRUE(push.flush_into(output).first);
+                ASSERT_TRUE(expected.flush_into(reference).first);
+            }
+            EXPECT_GT(resource.allocations, 0U);
+            EXPECT_TRUE(std::ranges::equal(output, reference));
+        }
+        EXPECT_TRUE(resource.aligned);
+        EXPECT_EQ(resource.outstanding, 0U);
+    }
+}
+
+TEST(SRCppMemoryResource, PushCreateCopyAndMove)
+{
+    auto input = makeSin({ 1000.0f }, 48000.0, 1000);
+    auto resource = CountingResource {};
+    {
+        auto guard = NoDefaultResource {};
+        auto [created, error] = SRCpp::PushConverter::create(
+            SRCpp::Type::Polyphase_Fastest, 1, 0.5, &resource);
+        ASSERT_EQ(error, 0);
+        created->prepare(1000, 1000);
+        auto prepared = resource.allocations;
+        EXPECT_GT(prepared, 0U);
+
+        // a copy allocates from the same resource, and a move takes the
+        // buffers with it
+        auto copy = *created;
+        EXPECT_GT(resource.allocations, prepared);
+        auto moved = std::move(*created);
+        auto output = std::vector<float>(1000);
+        auto [result, convert_error] = moved.convert_noalloc(
+            std::span<const float> { input }, std::span { output });
+        EXPECT_EQ(convert_error, 0);
+        EXPECT_FALSE(result.empty());
+    }
+    EXPECT_TRUE(resource.aligned);
+    EXPECT_EQ(resource.outstanding, 0U);
+}
+
+TEST(SRCppMemoryResource, Pull)
+{
+    auto input = ConvertTo<int>(makeSin({ 1000.0f, 3000.0f }, 48000.0, 2000));
+    for (auto type : kTypes) {
+        auto resource = CountingResource {};
+        {
+            auto guard = NoDefaultResource {};
+            auto remaining = std::span<int> { input };
+            auto pull = SRCpp::PullConverter(
+                [&] { return std::exchange(remaining, {}); }, type, 2, 2.0,
+                &resource);
+            auto output
+                = std::pmr::vector<float> { std::pmr::new_delete_resource() };
+            ASSERT_TRUE(pull.convert_into(2000, output).first);
+            EXPECT_FALSE(output.empty());
+            EXPECT_GT(resource.allocations, 1U);
+        }
+        EXPECT_TRUE(resource.aligned);
+        EXPECT_EQ(resource.outstanding, 0U);
+    }
+}
+
+TEST(SRCppMemoryResource, ConvertInto)
+{
+    auto input = makeSin({ 1000.0f, 3000.0f }, 48000.0, 3000);
+    for (auto type : kTypes) {
+        auto [expected, error] = SRCpp::Convert<float>(
+            std::span<const float> { input }, type, 2, 0.75);
+        ASSERT_TRUE(expected.has_value()) << error;
+
+        auto resource = CountingResource {};
+        {
+            auto guard = NoDefaultResource {};
+            auto output
+                = std::pmr::vector<float> { std::pmr::new_delete_resource() };
+            auto [appended, into_error]
+                = SRCpp::ConvertInto(std::span<const float> { input }, output,
+                    type, 2, 0.75, &resource);
+            ASSERT_TRUE(appended.has_value()) << into_error;
+            EXPECT_TRUE(std::ranges::equal(output, *expected));
+        }
+        EXPECT_TRUE(resource.aligned);
+        EXPECT_EQ(resource.outstanding, 0U);
+    }
+}
@@ -0,0 +1,141 @@
+#include "SRCppTestUtils.hpp"
+#include <gtest/gtest.h>
+#include <span>
+
+namespace {
+constexpr auto kPolyphaseTypes = { SRCpp::Type::Polyphase_BestQuality,
+    SRCpp::Type::Polyphase_MediumQuality, SRCpp::Type::Polyphase_Fastest };
+constexpr auto kSincTypes = { SRCpp::Type::Sinc_BestQuality,
+    SRCpp::Type::Sinc_MediumQuality, SRCpp::Type::Sinc_Fastest };
+constexpr auto kFactors = { 0.5, 0.75, 48000.0 / 44100.0, 2.0 };
+
+// libsamplerate's counts are worked out, not reported, so allow them a
+// frame either way at the input rate
+auto Slack(double factor) { return std::ceil(factor) + 1.0; }
+}
+
+TEST(SRCppOutputFrames, Convert)
+{
+    auto input = makeSin({ 1000.0f, 3000.0f }, 48000.0, 5000);
+    auto frames = input.size() / 2;
+    for (auto factor : kFactors) {
+        auto expected = SRCpp::ExpectedOutputFrames(frames, factor);
+        EXPECT_EQ(expected,
+            static_cast<size_t>(
+                std::ceil(static_cast<double>(frames) * factor)));
+        EXPECT_EQ(SRCpp::MaxOutputFrames(frames, factor), expected + 1);
+        for (auto type : kPolyphaseTypes) {
+            auto [output, error] = SRCpp::Convert<float>(
+                std::span<const float> { input }, type, 2, factor);
+            ASSERT_TRUE(output.has_value()) << error;
+            EXPECT_EQ(output->size() / 2, expected);
+        }
+        for (auto type : kSincTypes) {
+            auto [output, error] = SRCpp::Convert<float>(
+                std::span<const float> { input }, type, 2, factor);
+            ASSERT_TRUE(output.has_value()) << error;
+            EXPECT_LE(
+                output->size() / 2, SRCpp::MaxOutputFrames(frames, factor));
+            EXPECT_NEAR(static_cast<double>(output->size() / 2),
+                static_cast<double>(expected), Slack(factor));
+        }
+    }
+}
+
+TEST(SRCppOutputFrames, PushSizedExactly)
+{
+    // each block gets exactly max_output_frames, so nothing is left staged
+    // and only the filter's latency is owed between blocks
+    auto input = makeSin({ 1000.0f }, 48000.0, 6000);
+    auto types = std::vector<SRCpp::Type>(kPolyphaseTypes);
+    types.insert(types.end(), kSincTypes);
+    types.push_back(SRCpp::Type::Linear);
+    for (auto type : types) {
+        for (auto factor : kFactors) {
+            auto push = SRCpp::PushConverter(type, 1, factor);
+            EXPECT_EQ(push.expected_output_frames(input.size()),
+                SRCpp::ExpectedOutputFrames(input.size(), factor));
+            auto total = size_t { 0 };
+            for (size_t frame = 0; frame < input.size(); frame += 500) {
+                auto block = std::span<const float> { input }.subspan(
+                    frame, std::min<size_t>(500, input.size() - frame));
+                auto output = std::vector<float>(
+                    push.max_output_frames(block.size()));
+                auto [result, error]
+                    = push.convert(block, std::span { output });
+                ASSERT_TRUE(result.has_value()) << error;
+                total += result->size();
+                EXPECT_LE(static_cast<double>(push.max_output_frames(0)),
+                    static_cast<double>(push.latency_frames()) + Slack(factor)
+                        + 1.0)
+                    << static_cast<int>(type) << " x" << factor;
+            }
+            auto output = std::vector<float>(push.max_output_frames(0));
+            auto [flushed, error] = push.flush_noalloc(std::span { output });
+            ASSERT_EQ(error, 0);
+            total += flushed.size();
+            if (SRCpp::details::IsPolyphase(type)) {
+                EXPECT_EQ(total, push.expected_output_frames(input.size()));
+            } else if (type != SRCpp::Type::Linear) {
+                EXPECT_NEAR(static_cast<double>(total),
+                    static_cast<double>(
+                        push.expected_output_frames(input.size())),
+                    Slack(factor));
+            }
+        }
+    }
+}
+
+TEST(SRCppOutputFrames, Latency)
+{
+    // what a stream holds back is what flush hands out
+    auto input = makeSin({ 1000.0f }, 48000.0, 8000);
+    auto types = std::vector<SRCpp::Type>(kPolyphaseTypes);
+    types.insert(types.end(), kSincTypes);
+    for (auto type : types) {
+        for (auto factor : kFactors) {
+            auto push = SRCpp::PushConverter(type, 1, factor);
+            auto latency = push.latency_frames();
+            EXPECT_GT(latency, 0);
+            EXPECT_EQ(SRCpp::LatencyFrames(type, factor), latency);
+            auto [output, error] = push.convert<float>(input);
+            ASSERT_TRUE(output.has_value()) << error;
+            auto total = push.expected_output_frames(input.size());
+            EXPECT_NEAR(static_cast<double>(output->size() + latency),
+                static_cast<double>(total), Slack(factor))
+                << static_cast<int>(type) << " x" << factor;
+        }
+    }
+    // decimating widens libsamplerate's filters at the input rate, not at
+    // the output rate
+    auto fastest = [](double factor) {
+        return static_cast<double>(
+            SRCpp::LatencyFrames(SRCpp::Type::Sinc_Fastest, factor));
+    };
+    EXPECT_NEAR(fastest(0.5), fastest(1.0), 1.0);
+    EXPECT_EQ(SRCpp::LatencyFrames(SRCpp::Type::Linear, 2.0), 2);
+    EXPECT_EQ(SRCpp::LatencyFrames(SRCpp::Type::Sinc_Fastest, 0.0), 0);
+}
+
+TEST(SRCppOutputFrames, Pull)
+{
+    auto input = makeSin({ 1000.0f }, 48000.0, 4000);
+    for (auto type : kPolyphaseTypes) {
+        for (auto factor : kFactors) {
+            auto remaining = std::span<float> { input };
+            auto pull = SRCpp::PullConverter(
+                [&] { return std::exchange(remaining, {}); }, type, 1, factor);
+            EXPECT_EQ(
+                pull.latency_frames(), SRCpp::LatencyFrames(type, factor));
+            auto room = pull.max_output_frames(input.size());
+            EXPECT_EQ(room,
+                SRCpp::MaxOutputFrames(input.size(), factor)
+                    + pull.latency_frames());
+            auto output = std::vector<float>(room);
+            auto [result, error] = pull.convert(output);
+            ASSERT_TRUE(result.has_value()) << error;
+            EXPECT_EQ(
+                result->size(), pull.expected_output_frames(input.size()));
+        }
+    }
+}
@@ -0,0 +1,186 @@
+#include "SRCppTestUtils.hpp"
+#include <SRCpp/SRCppParallel.hpp>
+#include <gtest/gtest.h>
+#include <numbers>
+#include <span>
+
+namespace {
+auto Tones(size_t channels)
+{
+    auto hz = std::vector<float> {};
+    for (size_t channel = 0; channel < channels; ++channel) {
+        hz.push_back(100.0f + 700.0f * channel);
+    }
+    return hz;
+}
+
+template <typename To, typename From>
+void RunParallelTest(SRCpp::Type type, double factor, size_t channels,
+    size_t threads)
+{
+    auto block_frames = size_t { 256 };
+    auto input = ConvertTo<From>(makeSin(Tones(channels), 48000.0, 2000));
+    auto output_frames
+        = static_cast<size_t>(std::ceil(block_frames * factor)) + 2;
+
+    auto serial = SRCpp::PushConverter(type, channels, factor);
+    auto parallel
+        = SRCpp::ParallelPushConverter(type, channels, factor, threads);
+    EXPECT_EQ(parallel.groups(), std::min(channels, threads));
+
+    auto reference = std::vector<To> {};
+    auto output = std::vector<To> {};
+    auto buffer = std::vector<To>(output_frames * channels);
+    for (auto input_span = std::span<const From> { input };
+        !input_span.empty();) {
+        auto block = input_span.first(
+            std::min(block_frames * channels, input_span.size()));
+        auto [expected, expected_error] = serial.convert(block, buffer);
+        ASSERT_TRUE(expected.has_value()) << expected_error;
+        reference.insert(reference.end(), expected->begin(), expected->end());
+
+        auto [data, error] = parallel.convert(block, std::span { buffer });
+        ASSERT_TRUE(data.has_value()) << error;
+        output.insert(output.end(), data->begin(), data->end());
+        input_span = input_span.subspan(block.size());
+    }
+    {
+        auto [expected, expected_error] = serial.flush<To>();
+        ASSERT_TRUE(expected.has_value()) << expected_error;
+        reference.insert(reference.end(), expected->begin(), expected->end());
+        auto [data, error] = parallel.flush<To>();
+        ASSERT_TRUE(data.has_value()) << error;
+        output.insert(output.end(), data->begin(), data->end());
+    }
+    EXPECT_EQ(output, reference);
+}
+
+// Compares Convert(..., threads) with the serial Convert.  Exact where the
+// phase steps of Linear and ZeroOrderHold are exact in binary, otherwise
+// within tolerance of full scale.
+template <typename To, typename From>
+void RunParallelConvertTest(
+    SRCpp::Type type, double factor, size_t channels, double tolerance)
+{
+    auto input = ConvertTo<From>(makeSin(Tones(channels), 48000.0, 100000));
+    auto [reference, reference_error]
+        = SRCpp::Convert<To>(input, type, channels, factor);
+    ASSERT_TRUE(reference.has_value()) << reference_error;
+    for (auto threads : { 2, 3, 4 }) {
+        auto [output, error]
+            = SRCpp::Convert<To>(input, type, channels, factor, threads);
+        ASSERT_TRUE(output.has_value()) << error;
+        ASSERT_EQ(output->size(), reference->size()) << threads;
+        if (tolerance == 0.0) {
+            EXPECT_EQ(*output, *reference) << threads;
+            continue;
+        }
+        auto scale = std::is_same_v<To, float> ? 1.0 : 32768.0;
+        for (size_t i = 0; i < output->size(); ++i) {
+            ASSERT_NEAR((*output)[i], (*reference)[i], tolerance * scale)
+                << threads << " " << i;
+        }
+    }
+}
+
+template <typename To, typename From> void RunParallelTests()
+{
+    for (auto type : { SRCpp::Type::Sinc_Fastest, SRCpp::Type::ZeroOrderHold,
+             SRCpp::Type::Linear }) {
+        for (auto factor : { 0.5, 1.5 }) {
+            for (auto [channels, threads] :
+                { std::pair<size_t, size_t> { 1, 4 }, { 3, 2 }, { 8, 3 },
+                    { 16, 4 } }) {
+                RunParallelTest<To, From>(type, factor, channels, threads);
+            }
+        }
+    }
+}
+}
+
+TEST(SRCppParallel, ShortShort) { RunParallelTests<short, short>(); }
+TEST(SRCppParallel, ShortFloat) { RunParallelTests<short, float>(); }
+TEST(SRCppParallel, IntFloat) { RunParallelTests<int, float>(); }
+TEST(SRCppParallel, FloatInt) { RunParallelTests<float, int>(); }
+TEST(SRCppParallel, FloatFloat) { RunParallelTests<float, float>(); }
+
+TEST(SRCppParallel, Allocating)
+{
+    auto channels = size_t { 6 };
+    auto input = makeSin(Tones(channels), 48000.0, 1000);
+    auto serial = SRCpp::PushConverter(SRCpp::Type::Linear, channels, 1.5);
+    auto parallel
+        = SRCpp::ParallelPushConverter(SRCpp::Type::Linear, channels, 1.5, 4);
+    auto [expected, expected_error] = serial.convert<short>(input);
+    ASSERT_TRUE(expected.has_value()) << expected_error;
+    auto [data, error] = parallel.convert<short>(input);
+    ASSERT_TRUE(data.has_value()) << error;
+    EXPECT_EQ(*data, *expected);
+#if SRCPP_USE_CPP23
+    auto more = parallel.convert_expected<short>(input);
+    ASSERT_TRUE(more.has_value()) << more.error();
+    auto flushed = parallel.flush_expected<short>();
+    ASSERT_TRUE(flushed.has_value()) << flushed.error();
+#endif // SRCPP_USE_CPP23
+}
+
+TEST(SRCppParallel, ConvertExact)
+{
+    for (auto type : { SRCpp::Type::ZeroOrderHold, SRCpp::Type::Linear,
+             SRCpp::Type::Polyphase_Fastest }) {
+        for (auto factor : { 0.25, 0.5, 2.0 }) {
+            for (auto channels : { 1, 2, 3 }) {
+                RunParallelConvertTest<float, float>(
+                    type, factor, channels, 0.0);
+                RunParallelConvertTest<short, short>(
+                    type, factor, channels, 0.0);
+            }
+        }
+    }
+}
+
+TEST(SRCppParallel, ConvertNear)
+{
+    for (auto type : { SRCpp::Type::Sinc_BestQuality,
+             SRCpp::Type::Sinc_Fastest, SRCpp::Type::Linear }) {
+        for (auto factor : { 44100.0 / 48000.0, 48000.0 / 44100.0, 1.5 }) {
+            RunParallelConvertTest<float, float>(type, factor, 2, 1e-5);
+            RunParallelConvertTest<short, float>(type, factor, 2, 1e-4);
+        }
+    }
+}
+
+TEST(SRCppParallel, ConvertShortInput)
+{
+    // too short to split, and a factor with no whole-number ratio nearby
+    auto input = makeSin({ 3000.0f, 40.0f }, 48000.0, 1000);
+    for (auto factor : { 1.5, std::numbers::pi / 3 }) {
+        auto [reference, reference_error]
+            = SRCpp::Convert<float>(input, SRCpp::Type::Linear, 2, factor);
+        ASSERT_TRUE(reference.has_value()) << reference_error;
+        auto [output, error]
+            = SRCpp::Convert<float>(input, SRCpp::Type::Linear, 2, factor, 4);
+        ASSERT_TRUE(output.has_value()) << error;
+        EXPECT_EQ(*output, *reference);
+    }
+}
+
+TEST(SRCppParallel, ConvertOutputTooSmall)
+{
+    auto input = makeSin({ 3000.0f, 40.0f }, 48000.0, 100000);
+    auto reference = std::vector<float>(70000 * 2);
+    auto [expected, expected_error]
+        = SRCpp::Convert(input, reference, SRCpp::Type::Linear, 2, 2.0);
+    ASSERT_TRUE(expected.has_value()) << expected_error;
+    auto output = std::vector<float>(70000 * 2);
+    auto [result, error]
+        = SRCpp::Convert(input, output, SRCpp::Type::Linear, 2, 2.0, 4);
+    ASSERT_TRUE(result.has_value()) << error;
+    EXPECT_EQ(std::vector<float>(result->begin(), result->end()),
+        std::vector<float>(expected->begin(), expected->end()));
+#if SRCPP_USE_CPP23
+    auto more = SRCpp::Convert_expected<float>(
+        input, SRCpp::Type::Linear, 2, 2.0, 4);
+    ASSERT_TRUE(more.has_value()) << more.error();
+#endif // SRCPP_USE_CPP23
+}
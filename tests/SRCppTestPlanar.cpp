@@ -0,0 +1,262 @@
+#include "SRCppTestUtils.hpp"
+#include <SRCpp/SRCpp.hpp>
+#include <gtest/gtest.h>
+#include <span>
+
+namespace {
+// One buffer per channel, plus the pointers a PlanarSpan refers to.
+template <typename T> struct Planar {
+    Planar(size_t channels, size_t frames)
+        : buffers(channels, std::vector<T>(frames))
+    {
+        for (auto& buffer : buffers) {
+            pointers.push_back(buffer.data());
+        }
+    }
+
+    static auto FromInterleaved(const std::vector<T>& input, size_t channels)
+    {
+        auto planar = Planar(channels, input.size() / channels);
+        for (size_t i = 0; i < input.size(); ++i) {
+            planar.buffers[i % channels][i / channels] = input[i];
+        }
+        return planar;
+    }
+
+    auto span() -> SRCpp::PlanarSpan<T>
+    {
+        return { pointers, buffers.front().size() };
+    }
+
+    std::vector<std::vector<T>> buffers;
+    std::vector<T*> pointers;
+};
+
+template <typename T>
+auto Interleave(SRCpp::PlanarSpan<T> planar) -> std::vector<std::remove_cv_t<T>>
+{
+    auto output = std::vector<std::remove_cv_t<T>> {};
+    for (size_t frame = 0; frame < planar.frames(); ++frame) {
+        for (size_t channel = 0; channel < planar.channels(); ++channel) {
+            output.push_back(planar.channel(channel)[frame]);
+        }
+    }
+    return output;
+}
+
+constexpr auto kTypes = { SRCpp::Type::Sinc_BestQuality,
+    SRCpp::Type::Sinc_Fastest, SRCpp::Type::ZeroOrderHold,
+    SRCpp::Type::Linear };
+
+auto Tones()
+{
+    return std::vector<std::vector<float>> { { 3000.0f }, { 3000.0f, 40.0f },
+        { 3000.0f, 40.0f, 1004.0f } };
+}
+
+template <typename To, typename From> void RunPlanarConvertTest()
+{
+    for (auto type : kTypes) {
+        for (auto factor : { 0.5, 1.0, 1.5 }) {
+            for (const auto& hz : Tones()) {
+                auto channels = hz.size();
+                auto input = ConvertTo<From>(makeSin(hz, 48000.0, 20000));
+                auto [reference, reference_error]
+                    = SRCpp::Convert<To>(input, type, channels, factor);
+                ASSERT_TRUE(reference.has_value()) << reference_error;
+
+                auto planar = Planar<From>::FromInterleaved(input, channels);
+                auto [output, error]
+                    = SRCpp::Convert<To>(planar.span(), type, factor);
+                ASSERT_TRUE(output.has_value()) << error;
+                auto interleaved = std::vector<To> {};
+                for (size_t frame = 0; frame < output->front().size();
+                    ++frame) {
+                    for (const auto& channel : *output) {
+                        interleaved.push_back(channel[frame]);
+                    }
+                }
+                EXPECT_EQ(interleaved, *reference);
+            }
+        }
+    }
+}
+
+template <typename To, typename From> void RunPlanarPushTest()
+{
+    auto block_frames = size_t { 100 };
+    for (auto type : kTypes) {
+        for (auto factor : { 0.5, 1.5 }) {
+            for (const auto& hz : Tones()) {
+                auto channels = hz.size();
+                auto input = ConvertTo<From>(makeSin(hz, 48000.0, 1000));
+                auto planar = Planar<From>::FromInterleaved(input, channels);
+                auto output_frames = block_frames * 2;
+                auto reference = std::vector<To> {};
+                auto output = std::vector<To> {};
+
+                auto pusher = SRCpp::PushConverter(type, channels, factor);
+                auto buffer = std::vector<To>(output_frames * channels);
+                auto planar_pusher
+                    = SRCpp::PushConverter(type, channels, factor);
+                auto planar_buffer = Planar<To>(channels, output_frames);
+                for (size_t frame = 0; frame < planar.span().frames();
+                    frame += block_frames) {
+                    auto count = std::min(
+                        block_frames, planar.span().frames() - frame);
+                    auto [data, error] = pusher.convert(
+                        std::span<const From> { input }.subspan(
+                            frame * channels, count * channels),
+                        std::span { buffer });
+                    ASSERT_TRUE(data.has_value()) << error;
+                    reference.insert(reference.end(), data->begin(), data->end());
+
+                    auto [planar_data, planar_error] = planar_pusher.convert(
+                        planar.span().subspan(frame, count),
+                        planar_buffer.span());
+                    ASSERT_TRUE(planar_data.has_value()) << planar_error;
+                    auto chunk = Interleave(*planar_data);
+                    output.insert(output.end(), chunk.begin(), chunk.end());
+                }
+                auto [flush, error] = pusher.flush<To>();
+                ASSERT_TRUE(flush.has_value()) << error;
+                reference.insert(reference.end(), flush->begin(), flush->end());
+
+                auto flush_buffer = Planar<To>(channels, 4096);
+                auto [planar_flush, planar_error]
+                    = planar_pusher.flush(flush_buffer.span());
+                ASSERT_TRUE(planar_flush.has_value()) << planar_error;
+                auto chunk = Interleave(*planar_flush);
+                output.insert(output.end(), chunk.begin(), chunk.end());
+
+                EXPECT_EQ(output, reference);
+            }
+        }
+    }
+}
+
+template <typename To, typename From> void RunPlanarPullTest()
+{
+    auto block_frames = size_t { 33 };
+    for (auto type : kTypes) {
+        for (auto factor : { 0.5, 1.5 }) {
+            for (const auto& hz : Tones()) {
+                auto channels = hz.size();
+                auto input = ConvertTo<From>(makeSin(hz, 48000.0, 1000));
+                auto planar = Planar<From>::FromInterleaved(input, channels);
+                auto output_frames = size_t { 64 };
+                auto pulls = static_cast<size_t>(1000 * factor) / output_frames;
+
+                auto input_span = std::span<From> { input };
+                auto puller = SRCpp::PullConverter(
+                    [&] {
+                        auto result = input_span.first(std::min(
+                            block_frames * channels, input_span.size()));
+                        input_span = input_span.subspan(result.size());
+                        return result;
+                    },
+                    type, channels, factor);
+                auto planar_input = planar.span();
+                auto planar_puller = SRCpp::PullConverter(
+                    [&] {
+                        auto result = planar_input.first(
+                            std::min(block_frames, planar_input.frames()));
+                        planar_input = planar_input.subspan(result.frames());
+                        return result;
+                    },
+                    type, channels, factor);
+
+                auto reference = std::vector<To> {};
+                auto output = std::vector<To> {};
+                auto buffer = std::vector<To>(output_frames * channels);
+                auto planar_buffer = Planar<To>(channels, output_frames);
+                for (size_t pull = 0; pull < pulls; ++pull) {
+                    auto [data, error] = puller.convert(buffer);
+                    ASSERT_TRUE(data.has_value()) << error;
+                    reference.insert(reference.end(), data->begin(), data->end());
+
+                    auto [planar_data, planar_error]
+                        = planar_puller.convert(planar_buffer.span());
+                    ASSERT_TRUE(planar_data.has_value()) << planar_error;
+                    auto chunk = Interleave(*planar_data);
+                    output.insert(output.end(), chunk.begin(), chunk.end());
+                }
+                EXPECT_EQ(output, reference);
+            }
+        }
+    }
+}
+}
+
+TEST(SRCppPlanar, ConvertShortShort) { RunPlanarConvertTest<short, short>(); }
+TEST(SRCppPlanar, ConvertShortFloat) { RunPlanarConvertTest<short, float>(); }
+TEST(SRCppPlanar, ConvertIntFloat) { RunPlanarConvertTest<int, float>(); }
+TEST(SRCppPlanar, ConvertFloatShort) { RunPlanarConvertTest<float, short>(); }
+TEST(SRCppPlanar, ConvertFloatFloat) { RunPlanarConvertTest<float, float>(); }
+
+TEST(SRCppPlanar, PushShortShort) { RunPlanarPushTest<short, short>(); }
+TEST(SRCppPlanar, PushShortFloat) { RunPlanarPushTest<short, float>(); }
+TEST(SRCppPlanar, PushIntFloat) { RunPlanarPushTest<int, float>(); }
+TEST(SRCppPlanar, PushFloatInt) { RunPlanarPushTest<float, int>(); }
+TEST(SRCppPlanar, PushFloatFloat) { RunPlanarPushTest<float, float>(); }
+
+TEST(SRCppPlanar, PullShortFloat) { RunPlanarPullTest<short, float>(); }
+TEST(SRCppPlanar, PullFloatShort) { RunPlanarPullTest<float, short>(); }
+TEST(SRCppPlanar, PullFloatFloat) { RunPlanarPullTest<float, float>(); }
+
+TEST(SRCppPlanar, NoAlloc)
+{
+    auto channels = size_t { 2 };
+    auto input = makeSin({ 3000.0f, 40.0f }, 48000.0, 256);
+    auto planar = Planar<float>::FromInterleaved(input, channels);
+    auto [pusher, create_error]
+        = SRCpp::PushConverter::create(SRCpp::Type::Linear, channels, 1.5);
+    ASSERT_TRUE(pusher.has_value()) << SRCpp::StrError(create_error);
+    pusher->prepare(64, 128);
+    auto reference = SRCpp::PushConverter(SRCpp::Type::Linear, channels, 1.5);
+
+    auto buffer = Planar<short>(channels, 128);
+    auto reference_buffer = std::vector<short>(128 * channels);
+    for (size_t frame = 0; frame < 256; frame += 64) {
+        auto [data, error]
+            = pusher->convert_noalloc(planar.span().subspan(frame, 64),
+                buffer.span());
+        ASSERT_EQ(error, 0) << SRCpp::StrError(error);
+        auto [expected, expected_error] = reference.convert(
+            std::span<const float> { input }.subspan(
+                frame * channels, 64 * channels),
+            std::span { reference_buffer });
+        ASSERT_TRUE(expected.has_value()) << expected_error;
+        EXPECT_EQ(Interleave(data),
+            std::vector<short>(expected->begin(), expected->end()));
+    }
+}
+
+TEST(SRCppPlanar, ChannelMismatch)
+{
+    auto input = Planar<float>(2, 16);
+    auto output = Planar<float>(3, 64);
+    {
+        auto [result, error] = SRCpp::Convert(
+            input.span(), output.span(), SRCpp::Type::Linear, 2.0);
+        EXPECT_FALSE(result.has_value());
+        EXPECT_FALSE(error.empty());
+    }
+    {
+        auto pusher = SRCpp::PushConverter(SRCpp::Type::Linear, 2, 2.0);
+        auto [result, error] = pusher.convert(input.span(), output.span());
+        EXPECT_FALSE(result.has_value());
+        EXPECT_FALSE(error.empty());
+        auto [noalloc, code] = pusher.convert_noalloc(
+            input.span(), SRCpp::PlanarSpan<float> {});
+        EXPECT_EQ(code, SRCpp::ErrorChannelMismatch);
+    }
+#if SRCPP_USE_CPP23
+    {
+        auto result = SRCpp::Convert_expected(SRCpp::PlanarSpan<const float> {
+                                                  input.span() },
+            output.span(), SRCpp::Type::Linear, 2.0);
+        EXPECT_FALSE(result.has_value());
+    }
+#endif // SRCPP_USE_CPP23
+}
@@ -0,0 +1,196 @@
+#include "SRCppTestUtils.hpp"
+#include <gtest/gtest.h>
+#include <span>
+
+namespace {
+constexpr auto kPolyphaseTypes = { SRCpp::Type::Polyphase_BestQuality,
+    SRCpp::Type::Polyphase_MediumQuality, SRCpp::Type::Polyphase_Fastest };
+
+// makeSin accumulates phase in float, which is only good to about -60 dB
+// over these lengths.
+auto Sine(double hz, double rate, size_t frames)
+{
+    std::vector<float> data(frames);
+    for (size_t i = 0; i < frames; ++i) {
+        auto phase = 2.0 * std::numbers::pi * hz * static_cast<double>(i);
+        data[i] = static_cast<float>(std::sin(phase / rate));
+    }
+    return data;
+}
+
+// RMS of output against a unit sine of hz, skipping edge frames at each end
+// where the stream starts and stops.
+auto SineErrorDecibels(
+    const std::vector<float>& output, double hz, double rate, size_t edge)
+{
+    auto expected = Sine(hz, rate, output.size());
+    auto middle = std::span { output }.subspan(edge, output.size() - 2 * edge);
+    auto reference = std::span<const float> { expected }.subspan(
+        edge, output.size() - 2 * edge);
+    return ToDecibels(CalculateRMSError<float>(reference, middle));
+}
+
+auto RMSDecibels(std::span<const float> samples)
+{
+    auto silence = std::vector<float>(samples.size());
+    return ToDecibels(CalculateRMSError<float>(samples, silence));
+}
+}
+
+TEST(SRCppPolyphase, PassesTheBand)
+{
+    struct Case {
+        SRCpp::Type type;
+        double input_rate;
+        double output_rate;
+        double hz;
+        double floor;
+    };
+    for (auto c : {
+             Case { SRCpp::Type::Polyphase_BestQuality, 44100, 48000, 18000,
+                 -100 },
+             Case { SRCpp::Type::Polyphase_BestQuality, 48000, 16000, 7000,
+                 -100 },
+             Case { SRCpp::Type::Polyphase_BestQuality, 8000, 48000, 3000,
+                 -100 },
+             Case { SRCpp::Type::Polyphase_MediumQuality, 44100, 48000,
+                 16000, -100 },
+             Case { SRCpp::Type::Polyphase_Fastest, 48000, 16000, 5000, -100 },
+         }) {
+        auto factor = c.output_rate / c.input_rate;
+        auto input = Sine(c.hz, c.input_rate, 20000);
+        auto [output, error]
+            = SRCpp::Convert<float>(std::span<const float> { input }, c.type,
+                1, factor);
+        ASSERT_TRUE(output.has_value()) << error;
+        EXPECT_NEAR(output->size(), input.size() * factor, 2.0);
+        EXPECT_LT(SineErrorDecibels(*output, c.hz, c.output_rate, 2000),
+            c.floor)
+            << c.input_rate << " -> " << c.output_rate;
+    }
+}
+
+TEST(SRCppPolyphase, StopsAliases)
+{
+    // tones above the output's Nyquist frequency must not fold back
+    for (auto type : kPolyphaseTypes) {
+        auto input = Sine(10000.0, 44100.0, 20000);
+        auto [output, error] = SRCpp::Convert<float>(
+            std::span<const float> { input }, type, 1, 16000.0 / 44100.0);
+        ASSERT_TRUE(output.has_value()) << error;
+        auto middle
+            = std::span<const float> { *output }.subspan(1000, 5000);
+        EXPECT_LT(RMSDecibels(middle), -100) << static_cast<int>(type);
+    }
+}
+
+TEST(SRCppPolyphase, MatchesAcrossInterfaces)
+{
+    auto input = makeSin({ 3000.0f, 40.0f }, 44100.0, 5000);
+    auto factor = 48000.0 / 44100.0;
+    for (auto type : kPolyphaseTypes) {
+        auto [expected, error]
+            = SRCpp::Convert<float>(std::span<const float> { input }, type, 2,
+                factor);
+        ASSERT_TRUE(expected.has_value()) << error;
+
+        // short output goes through the block converter
+        auto [shorts, shorts_error] = SRCpp::Convert<short>(
+            std::span<const float> { input }, type, 2, factor);
+        ASSERT_TRUE(shorts.has_value()) << shorts_error;
+        EXPECT_EQ(*shorts, ConvertTo<short>(*expected));
+
+        // pushed in uneven blocks
+        auto push = SRCpp::PushConverter(type, 2, factor);
+        std::vector<float> pushed;
+        for (size_t frame = 0, block = 1; frame < 5000;
+             frame += block, block = block * 3 % 701 + 1) {
+            auto count = std::min(block, 5000 - frame);
+            auto [output, push_error] = push.convert<float>(
+                std::span<const float> { input }.subspan(
+                    frame * 2, count * 2));
+            ASSERT_TRUE(output.has_value()) << push_error;
+            pushed.insert(pushed.end(), output->begin(), output->end());
+        }
+        auto [flush, flush_error] = push.flush<float>();
+        ASSERT_TRUE(flush.has_value()) << flush_error;
+        pushed.insert(pushed.end(), flush->begin(), flush->end());
+        EXPECT_EQ(pushed, *expected);
+
+        // pulled through a callback handing out 100 frames at a time
+        size_t offset = 0;
+        auto pull = SRCpp::PullConverter(
+            [&]() -> std::span<float> {
+                auto count = std::min<size_t>(200, input.size() - offset);
+                auto block = std::span { input }.subspan(offset, count);
+                offset += count;
+                return block;
+            },
+            type, 2, factor);
+        std::vector<float> pulled;
+        std::vector<float> buffer(2 * 333);
+        while (true) {
+            auto [output, pull_error] = pull.convert(buffer);
+            ASSERT_TRUE(output.has_value()) << pull_error;
+            if (output->empty()) {
+                break;
+            }
+            pulled.insert(pulled.end(), output->begin(), output->end());
+        }
+        EXPECT_EQ(pulled, *expected);
+    }
+}
+
+TEST(SRCppPolyphase, Errors)
+{
+    auto input = makeSin({ 3000.0f }, 44100.0, 1000);
+    // pi / 3 has no small numerator
+    auto irrational = std::numbers::pi / 3.0;
+    auto [created, error] = SRCpp::PushConverter::create(
+        SRCpp::Type::Polyphase_Fastest, 1, irrational);
+    EXPECT_FALSE(created.has_value());
+    EXPECT_EQ(error, SRCpp::ErrorNotRational);
+
+    auto [output, message] = SRCpp::Convert<float>(
+        std::span<const float> { input }, SRCpp::Type::Polyphase_Fastest, 1,
+        irrational);
+    EXPECT_FALSE(output.has_value());
+    EXPECT_EQ(message, SRCpp::StrError(SRCpp::ErrorNotRational));
+
+    auto push = SRCpp::PushConverter(SRCpp::Type::Polyphase_Fastest, 1, 0.5);
+    EXPECT_EQ(push.reset(irrational), SRCpp::ErrorNotRational);
+    EXPECT_EQ(push.reset(1000.0), SRCpp::ErrorBadFactor);
+    EXPECT_EQ(push.reset(2.0), 0);
+    EXPECT_THROW(SRCpp::PushConverter(SRCpp::Type::Polyphase_Fastest, 0, 2.0),
+        std::runtime_error);
+}
+
+TEST(SRCppPolyphase, CacheDropsUnusedDesigns)
+{
+    // a cache of its own, so the banks other tests made do not count
+    auto cache = SRCpp::details::DesignCache<int, int, 2> {};
+    auto designs = 0;
+    auto design = [&] {
+        ++designs;
+        return std::make_shared<const int>(designs);
+    };
+    auto held = cache.get(1, design);
+    EXPECT_EQ(cache.get(1, design), held);
+    EXPECT_EQ(designs, 1);
+
+    // one an engine holds outlives the most recently used
+    for (int key = 2; key < 10; ++key) {
+        cache.get(key, design);
+    }
+    EXPECT_EQ(cache.get(1, design), held);
+    EXPECT_EQ(designs, 9);
+
+    // and once nothing holds it, it goes
+    held.reset();
+    for (int key = 10; key < 20; ++key) {
+        cache.get(key, design);
+    }
+    EXPECT_LE(cache.size(), 3U);
+    cache.get(1, design);
+    EXPECT_EQ(designs, 20);
+}
@@ -0,0 +1,79 @@
+#include "SRCppTestUtils.hpp"
+#include <SRCpp/SRCppRanges.hpp>
+#include <gtest/gtest.h>
+#include <ranges>
+
+namespace {
+template <typename Range> auto Collect(Range&& range)
+{
+    using To = std::ranges::range_value_t<Range>;
+    std::vector<To> result;
+    for (auto sample : range) {
+        result.push_back(sample);
+    }
+    return result;
+}
+}
+
+TEST(SRCppRanges, MatchesConvert)
+{
+    auto input = makeSin({ 3000.0f, 40.0f }, 44100.0, 10000);
+    for (auto type : { SRCpp::Type::Sinc_MediumQuality,
+             SRCpp::Type::Polyphase_MediumQuality }) {
+        auto [expected, error] = SRCpp::Convert<float>(
+            std::span<const float> { input }, type, 2, 48000.0 / 44100.0);
+        ASSERT_TRUE(expected.has_value()) << error;
+        EXPECT_EQ(Collect(input
+                      | SRCpp::views::resample(type, 2, 48000.0 / 44100.0)),
+            *expected);
+        EXPECT_EQ(Collect(SRCpp::views::resample(
+                      input, type, 2, 48000.0 / 44100.0)),
+            *expected);
+    }
+}
+
+TEST(SRCppRanges, OnlyWhatIsTaken)
+{
+    // an endless input: taking 1000 samples at twice the rate reads about
+    // 500, give or take a chunk
+    auto reads = size_t { 0 };
+    auto endless = std::views::iota(0) | std::views::transform([&](int i) {
+        ++reads;
+        return static_cast<float>(std::sin(i * 0.01));
+    });
+    auto taken = Collect(endless
+        | SRCpp::views::resample(SRCpp::Type::Linear, 1, 2.0)
+        | std::views::take(1000));
+    EXPECT_EQ(taken.size(), 1000);
+    EXPECT_GE(reads, 500);
+    EXPECT_LE(reads, 500 + 2 * 256);
+}
+
+TEST(SRCppRanges, Formats)
+{
+    auto input = ConvertTo<short>(makeSin({ 1000.0f }, 48000.0, 3000));
+    auto [expected, error] = SRCpp::Convert<int>(
+        std::span<const short> { input }, SRCpp::Type::Linear, 1, 0.5);
+    ASSERT_TRUE(expected.has_value()) << error;
+    auto view
+        = input | SRCpp::views::resample<int>(SRCpp::Type::Linear, 1, 0.5);
+    static_assert(std::ranges::input_range<decltype(view)>);
+    static_assert(std::ranges::view<decltype(view)>);
+    EXPECT_EQ(Collect(view), *expected);
+}
+
+TEST(SRCppRanges, Errors)
+{
+    // bad arguments throw when the view is made, not when it is read
+    auto input = std::vector<float>(100);
+    EXPECT_THROW(input | SRCpp::views::resample(SRCpp::Type::Linear, 0, 2.0),
+        std::runtime_error);
+    // a partial frame at the end is dropped
+    auto odd = std::vector<float>(3, 1.0f);
+    auto output = Collect(
+        odd | SRCpp::views::resample(SRCpp::Type::Linear, 2, 1.0));
+    EXPECT_EQ(output.size() % 2, 0);
+    EXPECT_TRUE(Collect(std::vector<float> {}
+                    | SRCpp::views::resample(SRCpp::Type::Linear, 1, 2.0))
+            .empty());
+}
@@ -0,0 +1,199 @@
+#include "SRCppTestUtils.hpp"
+#include <gtest/gtest.h>
+#include <span>
+
+namespace {
+// Sinc_Fastest keeps these quick; every libsamplerate type ramps the same way.
+constexpr auto kType = SRCpp::Type::Sinc_Fastest;
+
+auto Frames(const std::vector<float>& samples, size_t channels)
+{
+    return static_cast<double>(samples.size() / channels);
+}
+
+auto Append(std::vector<float>& to, const std::vector<float>& from)
+{
+    to.insert(to.end(), from.begin(), from.end());
+}
+}
+
+TEST(SRCppRatio, StepChangesFrameCount)
+{
+    auto input = makeSin({ 1000.0f, 40.0f }, 48000.0, 4000);
+    auto block = std::span<const float> { input }.first(2 * 2000);
+    auto rest = std::span<const float> { input }.subspan(2 * 2000);
+    auto push = SRCpp::PushConverter(kType, 2, 1.0);
+    EXPECT_EQ(push.ratio(), 1.0);
+
+    auto [first, error] = push.convert<float>(block);
+    ASSERT_TRUE(first.has_value()) << error;
+    EXPECT_EQ(push.set_ratio(2.0), SRCpp::ErrorNone);
+    EXPECT_EQ(push.ratio(), 2.0);
+    auto [second, second_error] = push.convert<float>(rest);
+    ASSERT_TRUE(second.has_value()) << second_error;
+    auto [flush, flush_error] = push.flush<float>();
+    ASSERT_TRUE(flush.has_value()) << flush_error;
+
+    // the step applies from the next frame, and flush hands out the rest at
+    // the new factor
+    EXPECT_NEAR(Frames(*first, 2), 2000.0, 16.0);
+    EXPECT_NEAR(Frames(*second, 2) + Frames(*flush, 2), 4000.0, 16.0);
+}
+
+TEST(SRCppRatio, SameFactorKeepsStream)
+{
+    auto input = makeSin({ 1000.0f }, 48000.0, 3000);
+    auto whole = SRCpp::PushConverter(kType, 1, 1.5);
+    auto [expected, error] = whole.convert<float>(input);
+    ASSERT_TRUE(expected.has_value()) << error;
+
+    auto split = SRCpp::PushConverter(kType, 1, 1.5);
+    std::vector<float> output;
+    for (auto mode : { SRCpp::RatioMode::Step, SRCpp::RatioMode::Ramp }) {
+        auto half = std::span<const float> { input }.subspan(
+            mode == SRCpp::RatioMode::Step ? 0 : 1500, 1500);
+        auto [block, block_error] = split.convert<float>(half, 1.5, mode);
+        ASSERT_TRUE(block.has_value()) << block_error;
+        Append(output, *block);
+    }
+    EXPECT_EQ(output, *expected);
+}
+
+TEST(SRCppRatio, RampIsSmooth)
+{
+    // a tone swept by ramping the factor in small blocks has no jumps beyond
+    // what its highest pitch allows
+    auto input = makeSin({ 1000.0f }, 48000.0, 48000);
+    auto push = SRCpp::PushConverter(kType, 1, 1.0);
+    std::vector<float> output;
+    auto factor = 1.0;
+    for (size_t frame = 0; frame < input.size(); frame += 480) {
+        factor = frame < input.size() / 2 ? factor * 1.002 : factor / 1.002;
+        auto [block, error] = push.convert<float>(
+            std::span<const float> { input }.subspan(frame, 480), factor);
+        ASSERT_TRUE(block.has_value()) << error;
+        EXPECT_EQ(push.ratio(), factor);
+        Append(output, *block);
+    }
+    auto [flush, error] = push.flush<float>();
+    ASSERT_TRUE(flush.has_value()) << error;
+    Append(output, *flush);
+
+    auto largest = 0.0f;
+    for (size_t i = 1; i < output.size(); ++i) {
+        largest = std::max(largest, std::abs(output[i] - output[i - 1]));
+    }
+    EXPECT_LT(largest, 2.0 * std::numbers::pi * 1000.0 / 48000.0 * 1.01);
+    // the factor peaks near 1.105 and comes back down
+    EXPECT_GT(Frames(output, 1), 48000.0 * 1.04);
+    EXPECT_LT(Frames(output, 1), 48000.0 * 1.105);
+}
+
+TEST(SRCppRatio, RampSpansTheOutputBuffer)
+{
+    auto input = makeSin({ 1000.0f }, 48000.0, 1000);
+    auto push = SRCpp::PushConverter(kType, 1, 1.0);
+    auto [warm, warm_error] = push.convert<float>(input);
+    ASSERT_TRUE(warm.has_value()) << warm_error;
+
+    // from 1 to 2 across a 2000 frame buffer runs out of these 1000 frames
+    // after 2000 * (e^0.5 - 1) frames
+    std::vector<float> output(2000);
+    auto [ramped, error] = push.convert(std::span<const float> { input },
+        std::span<float> { output }, 2.0);
+    ASSERT_TRUE(ramped.has_value()) << error;
+    EXPECT_NEAR(Frames(std::vector<float>(ramped->begin(), ramped->end()), 1),
+        2000.0 * (std::exp(0.5) - 1.0), 16.0);
+
+    // a step goes straight to the new factor
+    auto stepped = SRCpp::PushConverter(kType, 1, 1.0);
+    std::tie(warm, warm_error) = stepped.convert<float>(input);
+    ASSERT_TRUE(warm.has_value()) << warm_error;
+    auto [block, block_error] = stepped.convert(std::span<const float> { input },
+        std::span<float> { output }, 2.0, SRCpp::RatioMode::Step);
+    ASSERT_TRUE(block.has_value()) << block_error;
+    EXPECT_NEAR(static_cast<double>(block->size()), 2000.0, 16.0);
+}
+
+TEST(SRCppRatio, FlushAfterRampDown)
+{
+    auto input = makeSin({ 1000.0f }, 48000.0, 2000);
+    auto push = SRCpp::PushConverter(kType, 1, 4.0);
+    std::vector<float> output(100);
+    auto [ramped, error] = push.convert(
+        std::span<const float> { input }, std::span<float> { output }, 0.5);
+    ASSERT_TRUE(ramped.has_value()) << error;
+    EXPECT_EQ(ramped->size(), output.size());
+
+    // 100 frames of ramp from 4 use about 60 input frames, and the rest
+    // drains at close to 0.5
+    auto [flush, flush_error] = push.flush<float>();
+    ASSERT_TRUE(flush.has_value()) << flush_error;
+    EXPECT_GT(flush->size(), 970);
+    EXPECT_LT(flush->size(), 1070);
+}
+
+TEST(SRCppRatio, Pull)
+{
+    auto input = makeSin({ 1000.0f, 40.0f }, 48000.0, 8000);
+    size_t offset = 0;
+    auto pull = SRCpp::PullConverter(
+        [&]() -> std::span<float> {
+            auto count = std::min<size_t>(256, input.size() - offset);
+            auto block = std::span { input }.subspan(offset, count);
+            offset += count;
+            return block;
+        },
+        kType, 2, 1.0);
+    std::vector<float> buffer(2 * 2000);
+    auto [first, error] = pull.convert(buffer);
+    ASSERT_TRUE(first.has_value()) << error;
+    EXPECT_EQ(first->size(), buffer.size());
+
+    EXPECT_EQ(pull.set_ratio(0.5), SRCpp::ErrorNone);
+    EXPECT_EQ(pull.ratio(), 0.5);
+    std::vector<float> rest;
+    while (true) {
+        auto [output, pull_error] = pull.convert(buffer, 0.5);
+        ASSERT_TRUE(output.has_value()) << pull_error;
+        if (output->empty()) {
+            break;
+        }
+        rest.insert(rest.end(), output->begin(), output->end());
+    }
+    // the 6000 frames still to come, at half rate
+    EXPECT_NEAR(Frames(rest, 2), 3000.0, 16.0);
+}
+
+TEST(SRCppRatio, Polyphase)
+{
+    // Polyphase types step, keeping the stream, and need rational factors
+    auto input = makeSin({ 1000.0f }, 48000.0, 4410);
+    auto push = SRCpp::PushConverter(
+        SRCpp::Type::Polyphase_Fastest, 1, 48000.0 / 44100.0);
+    auto [first, error] = push.convert<float>(input);
+    ASSERT_TRUE(first.has_value()) << error;
+    EXPECT_EQ(push.set_ratio(std::numbers::pi), SRCpp::ErrorNotRational);
+    EXPECT_EQ(push.ratio(), 48000.0 / 44100.0);
+    auto [second, second_error] = push.convert<float>(
+        input, 44100.0 / 48000.0, SRCpp::RatioMode::Ramp);
+    ASSERT_TRUE(second.has_value()) << second_error;
+    auto [flush, flush_error] = push.flush<float>();
+    ASSERT_TRUE(flush.has_value()) << flush_error;
+    EXPECT_NEAR(static_cast<double>(first->size() + second->size()
+                    + flush->size()),
+        4800.0 + 4410.0 * 44100.0 / 48000.0, 16.0);
+}
+
+TEST(SRCppRatio, Errors)
+{
+    auto push = SRCpp::PushConverter(kType, 1, 1.0);
+    EXPECT_EQ(push.set_ratio(1000.0), SRCpp::ErrorBadFactor);
+    EXPECT_EQ(push.set_ratio(0.0, SRCpp::RatioMode::Ramp),
+        SRCpp::ErrorBadFactor);
+    EXPECT_EQ(push.ratio(), 1.0);
+    auto input = std::vector<float>(100);
+    auto [output, error] = push.convert<float>(input, 1000.0);
+    EXPECT_FALSE(output.has_value());
+    EXPECT_EQ(error, SRCpp::StrError(SRCpp::ErrorBadFactor));
+}
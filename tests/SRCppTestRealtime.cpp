@@ -0,0 +1,281 @@
+#include "SRCppTestUtils.hpp"
+#include <SRCpp/SRCpp.hpp>
+#include <atomic>
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <new>
+#include <span>
+
+// Every allocation in this test binary goes through here, so a test can
+// count what happens between two points.
+namespace {
+std::atomic<size_t> allocations { 0 };
+}
+
+auto operator new(std::size_t size) -> void*
+{
+    ++allocations;
+    if (auto* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc {};
+}
+
+// gcc cannot see that operator new above is the one handing out these
+// pointers, and warns about pairing it with free.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+namespace {
+// Counts the allocations made by func.
+template <typename Func> auto AllocationsIn(Func&& func) -> size_t
+{
+    auto before = allocations.load();
+    func();
+    return allocations.load() - before;
+}
+
+template <typename To, typename From>
+void RunNoAllocTest(SRCpp::Type type, double factor)
+{
+    auto frames = 2048;
+    auto block_frames = size_t { 64 };
+    auto hz = std::vector<float> { 3000.0f, 40.0f };
+    auto channels = hz.size();
+    auto input = ConvertTo<From>(makeSin(hz, 48000.0, frames));
+    auto output_frames
+        = static_cast<size_t>(std::ceil(block_frames * factor)) + 2;
+
+    // the same pattern of calls through the allocating interface.
+    auto reference = std::vector<To> {};
+    {
+        auto pusher = SRCpp::PushConverter(type, channels, factor);
+        auto buffer = std::vector<To>(output_frames * channels);
+        for (auto input_span = std::span<const From> { input };
+            !input_span.empty();) {
+            auto block = input_span.first(
+                std::min(block_frames * channels, input_span.size()));
+            auto [data, error] = pusher.convert(block, std::span { buffer });
+            ASSERT_TRUE(data.has_value()) << error;
+            reference.insert(reference.end(), data->begin(), data->end());
+            input_span = input_span.subspan(block.size());
+        }
+        auto [flush, error] = pusher.flush<To>();
+        ASSERT_TRUE(flush.has_value()) << error;
+        reference.insert(reference.end(), flush->begin(), flush->end());
+    }
+
+    auto [pusher, create_error]
+        = SRCpp::PushConverter::create(type, channels, factor);
+    ASSERT_TRUE(pusher.has_value()) << SRCpp::StrError(create_error);
+    pusher->prepare(block_frames, output_frames);
+    auto buffer = std::vector<To>(output_frames * channels);
+    auto flush_buffer = std::vector<To>(4096 * channels);
+
+    auto output = std::vector<To> {};
+    auto allocated = size_t { 0 };
+    for (auto input_span = std::span<const From> { input };
+        !input_span.empty();) {
+        auto block = input_span.first(
+            std::min(block_frames * channels, input_span.size()));
+        auto result = std::pair<std::span<To>, int> {};
+        allocated += AllocationsIn([&] {
+            result = pusher->convert_noalloc(block, std::span { buffer });
+        });
+        ASSERT_EQ(result.second, 0) << SRCpp::StrError(result.second);
+        output.insert(output.end(), result.first.begin(), result.first.end());
+        input_span = input_span.subspan(block.size());
+    }
+    auto result = std::pair<std::span<To>, int> {};
+    allocated += AllocationsIn(
+        [&] { result = pusher->flush_noalloc(std::span { flush_buffer }); });
+    ASSERT_EQ(result.second, 0) << SRCpp::StrError(result.second);
+    output.insert(output.end(), result.first.begin(), result.first.end());
+
+    EXPECT_EQ(allocated, 0U);
+    EXPECT_EQ(output, reference);
+}
+
+template <typename To, typename From> void RunNoAllocTests()
+{
+    for (auto type : { SRCpp::Type::Sinc_BestQuality,
+             SRCpp::Type::Sinc_MediumQuality, SRCpp::Type::Sinc_Fastest,
+             SRCpp::Type::ZeroOrderHold, SRCpp::Type::Linear,
+             SRCpp::Type::Polyphase_BestQuality,
+             SRCpp::Type::Polyphase_MediumQuality,
+             SRCpp::Type::Polyphase_Fastest }) {
+        for (auto factor : { 0.5, 1.5 }) {
+            RunNoAllocTest<To, From>(type, factor);
+        }
+    }
+}
+}
+
+TEST(SRCppRealtime, NoAllocShortShort) { RunNoAllocTests<short, short>(); }
+TEST(SRCppRealtime, NoAllocShortInt) { RunNoAllocTests<short, int>(); }
+TEST(SRCppRealtime, NoAllocShortFloat) { RunNoAllocTests<short, float>(); }
+
+TEST(SRCppRealtime, NoAllocIntShort) { RunNoAllocTests<int, short>(); }
+TEST(SRCppRealtime, NoAllocIntInt) { RunNoAllocTests<int, int>(); }
+TEST(SRCppRealtime, NoAllocIntFloat) { RunNoAllocTests<int, float>(); }
+
+TEST(SRCppRealtime, NoAllocFloatShort) { RunNoAllocTests<float, short>(); }
+TEST(SRCppRealtime, NoAllocFloatInt) { RunNoAllocTests<float, int>(); }
+TEST(SRCppRealtime, NoAllocFloatFloat) { RunNoAllocTests<float, float>(); }
+
+TEST(SRCppRealtime, ExceedsPrepared)
+{
+    auto channels = 2;
+    auto [pusher, create_error]
+        = SRCpp::PushConverter::create(SRCpp::Type::Linear, channels, 0.5);
+    ASSERT_TRUE(pusher.has_value()) << SRCpp::StrError(create_error);
+    pusher->prepare(16, 16);
+
+    // no room for the output, so everything would have to be staged.
+    auto input = std::vector<float>(1024 * channels);
+    auto output = std::vector<float> {};
+    auto result = std::pair<std::span<float>, int> {};
+    auto allocated = AllocationsIn(
+        [&] { result = pusher->convert_noalloc(input, output); });
+    EXPECT_EQ(allocated, 0U);
+    EXPECT_EQ(result.second, SRCpp::ErrorExceedsPrepared);
+    EXPECT_TRUE(result.first.empty());
+}
+
+namespace {
+// Each block carries its own factor, cycling through factors.
+void RunNoAllocRatioTest(SRCpp::Type type)
+{
+    auto frames = 2048;
+    auto block_frames = size_t { 64 };
+    auto factors = std::vector<double> { 1.5, 0.75, 1.25 };
+    auto hz = std::vector<float> { 3000.0f, 40.0f };
+    auto channels = hz.size();
+    auto input = ConvertTo<float>(makeSin(hz, 48000.0, frames));
+    auto output_frames = block_frames * 2;
+
+    auto reference = std::vector<float> {};
+    {
+        auto pusher = SRCpp::PushConverter(type, channels, factors.front());
+        auto buffer = std::vector<float>(output_frames * channels);
+        auto block = size_t { 0 };
+        for (auto input_span = std::span<const float> { input };
+            !input_span.empty(); ++block) {
+            auto chunk = input_span.first(
+                std::min(block_frames * channels, input_span.size()));
+            auto [data, error] = pusher.convert(chunk, std::span { buffer },
+                factors[block % factors.size()]);
+            ASSERT_TRUE(data.has_value()) << error;
+            reference.insert(reference.end(), data->begin(), data->end());
+            input_span = input_span.subspan(chunk.size());
+        }
+    }
+
+    auto [pusher, create_error]
+        = SRCpp::PushConverter::create(type, channels, factors.front());
+    ASSERT_TRUE(pusher.has_value()) << SRCpp::StrError(create_error);
+    pusher->prepare(block_frames, output_frames, factors);
+    auto buffer = std::vector<float>(output_frames * channels);
+
+    auto output = std::vector<float> {};
+    auto allocated = size_t { 0 };
+    auto block = size_t { 0 };
+    for (auto input_span = std::span<const float> { input };
+        !input_span.empty(); ++block) {
+        auto chunk = input_span.first(
+            std::min(block_frames * channels, input_span.size()));
+        auto result = std::pair<std::span<float>, int> {};
+        allocated += AllocationsIn([&] {
+            result = pusher->convert_noalloc(chunk, std::span { buffer },
+                factors[block % factors.size()]);
+        });
+        ASSERT_EQ(result.second, 0) << SRCpp::StrError(result.second);
+        output.insert(output.end(), result.first.begin(), result.first.end());
+        input_span = input_span.subspan(chunk.size());
+    }
+
+    // a factor prepare() was not told about
+    auto result = std::pair<std::span<float>, int> {};
+    allocated += AllocationsIn([&] {
+        result = pusher->convert_noalloc(
+            std::span<const float> { input }.first(block_frames * channels),
+            std::span { buffer }, 0.625);
+    });
+    if (SRCpp::details::IsPolyphase(type)) {
+        EXPECT_EQ(result.second, SRCpp::ErrorExceedsPrepared);
+    } else {
+        EXPECT_EQ(result.second, 0) << SRCpp::StrError(result.second);
+    }
+
+    EXPECT_EQ(allocated, 0U);
+    EXPECT_EQ(output, reference);
+}
+}
+
+TEST(SRCppRealtime, NoAllocRatio)
+{
+    for (auto type : { SRCpp::Type::Sinc_MediumQuality,
+             SRCpp::Type::Sinc_Fastest, SRCpp::Type::Linear,
+             SRCpp::Type::Polyphase_BestQuality,
+             SRCpp::Type::Polyphase_MediumQuality,
+             SRCpp::Type::Polyphase_Fastest }) {
+        RunNoAllocRatioTest(type);
+    }
+}
+
+TEST(SRCppRealtime, FlushInPieces)
+{
+    auto channels = size_t { 2 };
+    auto factor = 1.5;
+    auto input = ConvertTo<short>(makeSin({ 3000.0f, 40.0f }, 48000.0, 512));
+
+    auto reference = std::vector<short> {};
+    {
+        auto pusher = SRCpp::PushConverter(
+            SRCpp::Type::Sinc_MediumQuality, channels, factor);
+        auto [data, error]
+            = pusher.convert<short>(std::span<const short> { input });
+        ASSERT_TRUE(data.has_value()) << error;
+        reference = *data;
+        auto [flush, flush_error] = pusher.flush<short>();
+        ASSERT_TRUE(flush.has_value()) << flush_error;
+        reference.insert(reference.end(), flush->begin(), flush->end());
+    }
+
+    // a flush buffer far smaller than the tail takes it a piece at a time.
+    auto pusher = SRCpp::PushConverter(
+        SRCpp::Type::Sinc_MediumQuality, channels, factor);
+    pusher.prepare(512, 1024);
+    auto output = std::vector<short>(1024 * channels);
+    auto [data, error] = pusher.convert_noalloc(
+        std::span<const short> { input }, std::span { output });
+    ASSERT_EQ(error, 0) << SRCpp::StrError(error);
+    auto result = std::vector<short>(data.begin(), data.end());
+    auto piece = std::vector<short>(16 * channels);
+    for (;;) {
+        auto [flushed, flush_error]
+            = pusher.flush_noalloc(std::span { piece });
+        ASSERT_EQ(flush_error, 0) << SRCpp::StrError(flush_error);
+        result.insert(result.end(), flushed.begin(), flushed.end());
+        if (flushed.size() < piece.size()) {
+            break;
+        }
+    }
+    EXPECT_EQ(result, reference);
+}
+
+TEST(SRCppRealtime, CreateReportsErrors)
+{
+    auto [pusher, error]
+        = SRCpp::PushConverter::create(SRCpp::Type::Linear, 0, 1.0);
+    EXPECT_FALSE(pusher.has_value());
+    EXPECT_NE(error, 0);
+    EXPECT_STRNE(SRCpp::StrError(error), "");
+}
@@ -0,0 +1,135 @@
+#include "SRCppTestUtils.hpp"
+#include <SRCpp/SRCppStreamPool.hpp>
+#include <gtest/gtest.h>
+#include <mutex>
+#include <span>
+#include <thread>
+
+namespace {
+// What one PushConverter makes of input pushed in block_frames blocks.
+auto SerialOutput(SRCpp::Type type, size_t channels, double factor,
+    const std::vector<short>& input, size_t block_frames)
+{
+    auto pusher = SRCpp::PushConverter(type, channels, factor);
+    auto output = std::vector<float> {};
+    for (auto input_span = std::span<const short> { input };
+        !input_span.empty();) {
+        auto block = input_span.first(
+            std::min(block_frames * channels, input_span.size()));
+        auto [data, error] = pusher.convert<float>(block);
+        EXPECT_TRUE(data.has_value()) << error;
+        output.insert(output.end(), data->begin(), data->end());
+        input_span = input_span.subspan(block.size());
+    }
+    auto [flush, error] = pusher.flush<float>();
+    EXPECT_TRUE(flush.has_value()) << error;
+    output.insert(output.end(), flush->begin(), flush->end());
+    return output;
+}
+}
+
+TEST(SRCppStreamPool, MatchesSerial)
+{
+    auto streams = size_t { 64 };
+    auto block_frames = size_t { 160 };
+    auto pool = SRCpp::StreamPool(4);
+    EXPECT_EQ(pool.threads(), 4U);
+
+    auto inputs = std::vector<std::vector<short>> {};
+    auto outputs = std::vector<std::vector<float>>(streams);
+    for (size_t id = 0; id < streams; ++id) {
+        auto channels = 1 + id % 2;
+        auto hz = std::vector<float>(channels, 300.0f + 10.0f * id);
+        inputs.push_back(ConvertTo<short>(makeSin(hz, 8000.0, 4000)));
+        auto type = id % 3 ? SRCpp::Type::Linear : SRCpp::Type::Sinc_Fastest;
+        auto [opened, error] = pool.open(id, type, channels, 2.0,
+            [&output = outputs[id]](std::span<const float> data) {
+                output.insert(output.end(), data.begin(), data.end());
+            });
+        ASSERT_TRUE(opened.has_value()) << error;
+    }
+
+    // several producers, each feeding its own share of the streams
+    auto producers = std::vector<std::thread> {};
+    for (size_t producer = 0; producer < 4; ++producer) {
+        producers.emplace_back([&, producer] {
+            for (size_t block = 0; block * block_frames < 4000; ++block) {
+                for (auto id = producer; id < streams; id += 4) {
+                    auto channels = 1 + id % 2;
+                    auto input = std::span<const short> { inputs[id] };
+                    auto first = block * block_frames * channels;
+                    auto [depth, error] = pool.push(id,
+                        input.subspan(first,
+                            std::min(block_frames * channels,
+                                input.size() - first)));
+                    EXPECT_TRUE(depth.has_value()) << error;
+                }
+            }
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    pool.wait();
+    auto stats = pool.stream_stats(0);
+    ASSERT_TRUE(stats.has_value());
+    EXPECT_EQ(stats->queued_blocks, 0U);
+    EXPECT_EQ(stats->input_frames, 4000U);
+    EXPECT_TRUE(stats->error.empty()) << stats->error;
+
+    for (size_t id = 0; id < streams; ++id) {
+        auto [closed, error] = pool.close(id);
+        ASSERT_TRUE(closed.has_value()) << error;
+    }
+    pool.wait();
+    EXPECT_EQ(pool.stats().streams, 0U);
+    EXPECT_EQ(pool.stats().blocks, streams * 25);
+    EXPECT_EQ(pool.stats().input_frames, streams * 4000);
+
+    for (size_t id = 0; id < streams; ++id) {
+        auto channels = 1 + id % 2;
+        auto type = id % 3 ? SRCpp::Type::Linear : SRCpp::Type::Sinc_Fastest;
+        EXPECT_EQ(outputs[id],
+            SerialOutput(type, channels, 2.0, inputs[id], block_frames))
+            << id;
+    }
+}
+
+TEST(SRCppStreamPool, Errors)
+{
+    auto pool = SRCpp::StreamPool(2);
+    auto input = std::vector<float>(64);
+    {
+        auto [opened, error] = pool.open(1, SRCpp::Type::Linear, 0, 1.0, {});
+        EXPECT_FALSE(opened.has_value());
+        EXPECT_FALSE(error.empty());
+    }
+    {
+        auto [depth, error] = pool.push(7, input);
+        EXPECT_FALSE(depth.has_value());
+        EXPECT_FALSE(error.empty());
+    }
+    auto [opened, error] = pool.open(
+        1, SRCpp::Type::Linear, 1, 1.0, [](std::span<const float>) { });
+    ASSERT_TRUE(opened.has_value()) << error;
+    EXPECT_FALSE(pool.open(1, SRCpp::Type::Linear, 1, 1.0, {}).first);
+    EXPECT_TRUE(pool.close(1).first.has_value());
+    EXPECT_FALSE(pool.push(1, input).first.has_value());
+    pool.wait();
+    EXPECT_FALSE(pool.stream_stats(1).has_value());
+}
+
+TEST(SRCppStreamPool, CallbackErrors)
+{
+    auto pool = SRCpp::StreamPool(1);
+    auto [opened, error]
+        = pool.open(3, SRCpp::Type::Linear, 1, 1.0, [](std::span<const float>) {
+              throw std::runtime_error("callback failed");
+          });
+    ASSERT_TRUE(opened.has_value()) << error;
+    pool.push(3, std::vector<float>(256, 0.5f));
+    pool.wait();
+    auto stats = pool.stream_stats(3);
+    ASSERT_TRUE(stats.has_value());
+    EXPECT_EQ(stats->error, "callback failed");
+}
@@ -0,0 +1,159 @@
+#include "SRCppTestUtils.hpp"
+#include <SRCpp/SRCppThreaded.hpp>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <thread>
+
+namespace {
+// Yields until done() holds, giving up after a few seconds.
+template <typename Done> auto WaitFor(Done done)
+{
+    auto deadline
+        = std::chrono::steady_clock::now() + std::chrono::seconds { 10 };
+    while (!done()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+// Reads converter until it finishes, as a real-time consumer would.
+auto ReadAll(SRCpp::ThreadedConverter& converter, size_t channels)
+{
+    std::vector<float> result;
+    auto block = std::vector<float>(97 * channels);
+    auto finished = WaitFor([&] {
+        auto output = converter.read(block);
+        result.insert(result.end(), output.begin(), output.end());
+        return converter.finished();
+    });
+    EXPECT_TRUE(finished);
+    return result;
+}
+
+auto Reference(std::span<const float> input, SRCpp::Type type, int channels,
+    double factor)
+{
+    auto [expected, error]
+        = SRCpp::Convert<float>(input, type, channels, factor);
+    EXPECT_TRUE(expected.has_value()) << error;
+    return expected.value_or(std::vector<float> {});
+}
+}
+
+TEST(SRCppThreaded, MatchesPushConverter)
+{
+    for (auto type : { SRCpp::Type::Sinc_MediumQuality,
+             SRCpp::Type::Polyphase_MediumQuality }) {
+        auto input = makeSin({ 3000.0f, 40.0f }, 44100.0, 20000);
+        auto factor = 48000.0 / 44100.0;
+        auto converter = SRCpp::ThreadedConverter(
+            type, 2, factor, { .block_frames = 128, .input_frames = 1024 });
+        // the writer backs off when the input queue is full
+        auto writer = std::thread([&] {
+            auto frame = size_t { 0 };
+            while (frame < 20000) {
+                auto count = std::min<size_t>(300, 20000 - frame);
+                auto written = converter.write(
+                    std::span<const float> { input }.subspan(
+                        frame * 2, count * 2));
+                if (written == 0) {
+                    std::this_thread::yield();
+                }
+                frame += written;
+            }
+            converter.finish();
+        });
+        auto output = ReadAll(converter, 2);
+        writer.join();
+        EXPECT_EQ(output, Reference(input, type, 2, factor));
+        EXPECT_FALSE(converter.failed()) << converter.error();
+    }
+}
+
+TEST(SRCppThreaded, Pull)
+{
+    // the callback runs on the worker thread, not the reader's
+    auto input = makeSin({ 3000.0f }, 48000.0, 10000);
+    auto offset = size_t { 0 };
+    auto reader = std::this_thread::get_id();
+    auto elsewhere = true;
+    auto converter = SRCpp::ThreadedConverter(
+        [&] {
+            elsewhere = elsewhere && std::this_thread::get_id() != reader;
+            auto count = std::min<size_t>(333, input.size() - offset);
+            auto chunk = std::span { input }.subspan(offset, count);
+            offset += count;
+            return chunk;
+        },
+        SRCpp::Type::Sinc_BestQuality, 1, 0.5);
+    auto output = ReadAll(converter, 1);
+    EXPECT_TRUE(elsewhere);
+    EXPECT_EQ(output, Reference(input, SRCpp::Type::Sinc_BestQuality, 1, 0.5));
+    // a finished converter stays finished
+    auto more = std::vector<short>(64);
+    EXPECT_TRUE(converter.read(more).empty());
+    EXPECT_TRUE(converter.finished());
+}
+
+TEST(SRCppThreaded, ReadAhead)
+{
+    // a pulling worker converts until the read-ahead is full, then waits
+    auto input = std::vector<float>(256, 0.25f);
+    auto converter = SRCpp::ThreadedConverter([&] { return std::span { input }; },
+        SRCpp::Type::Linear, 2, 3.0, { .read_ahead_frames = 1024 });
+    EXPECT_TRUE(WaitFor([&] { return converter.available() == 1024; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds { 20 });
+    EXPECT_EQ(converter.available(), 1024);
+    EXPECT_GE(converter.latency_frames(), 1024);
+
+    // reading makes room, and the worker fills it again
+    auto output = std::vector<int>(500 * 2);
+    EXPECT_EQ(converter.read(output).size(), 1000);
+    EXPECT_TRUE(WaitFor([&] { return converter.available() == 1024; }));
+    EXPECT_FALSE(converter.finished());
+}
+
+TEST(SRCppThreaded, ReadAheadIsExact)
+{
+    // the ring rounds up to a power of two, but the worker stops at the
+    // read-ahead it was given
+    auto input = std::vector<float>(256, 0.25f);
+    auto converter = SRCpp::ThreadedConverter([&] { return std::span { input }; },
+        SRCpp::Type::Linear, 2, 3.0, { .read_ahead_frames = 1000 });
+    EXPECT_TRUE(WaitFor([&] { return converter.available() == 1000; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds { 20 });
+    EXPECT_EQ(converter.available(), 1000);
+}
+
+TEST(SRCppThreaded, ReportsLatency)
+{
+    // nothing is read, so everything written is still in flight: queued,
+    // converted, or held back by the filter
+    auto converter = SRCpp::ThreadedConverter(
+        SRCpp::Type::Polyphase_BestQuality, 1, 2.0);
+    auto input = makeSin({ 1000.0f }, 48000.0, 1000);
+    EXPECT_EQ(converter.write(input), 1000);
+    EXPECT_TRUE(WaitFor([&] { return converter.available() > 1500; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds { 20 });
+    EXPECT_NEAR(static_cast<double>(converter.latency_frames()), 2000.0, 2.0);
+
+    // after the flush it is all converted
+    converter.finish();
+    EXPECT_TRUE(WaitFor([&] { return converter.available() >= 2000; }));
+    EXPECT_EQ(converter.latency_frames(), converter.available());
+    EXPECT_EQ(converter.write(input), 0);
+}
+
+TEST(SRCppThreaded, Errors)
+{
+    EXPECT_THROW(SRCpp::ThreadedConverter(SRCpp::Type::Linear, 0, 2.0),
+        std::runtime_error);
+    EXPECT_THROW(SRCpp::ThreadedConverter(SRCpp::Type::Linear, 1, -1.0),
+        std::runtime_error);
+    auto converter = SRCpp::ThreadedConverter(SRCpp::Type::Linear, 1, 2.0);
+    EXPECT_FALSE(converter.failed());
+    EXPECT_TRUE(converter.error().empty());
+}
@@ -0,0 +1,183 @@
+// Shared by the command-line tools: argument parsing helpers and the
+// blocking queue their pipeline stages hand buffers through.
+#pragma once
+#include <SRCpp/SRCpp.hpp>
+#include <SRCpp/SRCppFile.hpp>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+namespace SRCppTools {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr auto kTypes = std::array {
+    std::pair { "Sinc_BestQuality", SRCpp::Type::Sinc_BestQuality },
+    std::pair { "Sinc_MediumQuality", SRCpp::Type::Sinc_MediumQuality },
+    std::pair { "Sinc_Fastest", SRCpp::Type::Sinc_Fastest },
+    std::pair { "ZeroOrderHold", SRCpp::Type::ZeroOrderHold },
+    std::pair { "Linear", SRCpp::Type::Linear },
+    std::pair { "Polyphase_BestQuality", SRCpp::Type::Polyphase_BestQuality },
+    std::pair {
+        "Polyphase_MediumQuality", SRCpp::Type::Polyphase_MediumQuality },
+    std::pair { "Polyphase_Fastest", SRCpp::Type::Polyphase_Fastest },
+};
+
+constexpr auto kFormats = std::array {
+    std::pair { "int16", SRCpp::FileFormat::Int16 },
+    std::pair { "int24", SRCpp::FileFormat::Int24 },
+    std::pair { "int32", SRCpp::FileFormat::Int32 },
+    std::pair { "float", SRCpp::FileFormat::Float32 },
+};
+
+template <typename Table>
+auto Lookup(Table const& table, std::string_view name)
+    -> std::optional<typename Table::value_type::second_type>
+{
+    for (auto [key, value] : table) {
+        if (name == key) {
+            return value;
+        }
+    }
+    return std::nullopt;
+}
+
+template <typename Table, typename Value>
+auto NameOf(Table const& table, Value value) -> std::string_view
+{
+    for (auto [key, entry] : table) {
+        if (entry == value) {
+            return key;
+        }
+    }
+    return "?";
+}
+
+template <typename T>
+auto ParseNumber(std::string_view text) -> std::optional<T>
+{
+    T value {};
+    auto [end, error]
+        = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc {} || end != text.data() + text.size()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+// "channels:rate:format", as for --raw-input.
+inline auto ParseRawLayout(std::string_view text)
+    -> std::optional<SRCpp::RawLayout>
+{
+    auto first = text.find(':');
+    auto second = text.find(':', first + 1);
+    if (first == text.npos || second == text.npos) {
+        return std::nullopt;
+    }
+    auto channels = ParseNumber<int>(text.substr(0, first));
+    auto rate = ParseNumber<double>(text.substr(first + 1, second - first - 1));
+    auto format = Lookup(kFormats, text.substr(second + 1));
+    if (!channels || *channels <= 0 || !rate || !format) {
+        return std::nullopt;
+    }
+    return SRCpp::RawLayout { *channels, *rate, *format };
+}
+
+enum class Parsed {
+    Unknown,
+    Ok,
+    Bad,
+};
+
+// The conversion options every tool takes, parsed into options.  value()
+// returns the flag's argument, or std::nullopt if there is none.
+template <typename Value>
+auto ParseFileOption(std::string_view flag, Value&& value,
+    SRCpp::FileOptions& options) -> Parsed
+{
+    auto check = [](bool good) { return good ? Parsed::Ok : Parsed::Bad; };
+    if (flag == "--type") {
+        auto type = value().and_then(
+            [](auto name) { return Lookup(kTypes, name); });
+        options.type = type.value_or(options.type);
+        return check(type.has_value());
+    } else if (flag == "--ratio") {
+        auto factor = value().and_then(ParseNumber<double>);
+        options.factor = factor.value_or(options.factor);
+        return check(factor.has_value());
+    } else if (flag == "--rate") {
+        options.output_rate = value().and_then(ParseNumber<double>);
+        return check(options.output_rate.has_value());
+    } else if (flag == "--format") {
+        options.output_format = value().and_then(
+            [](auto name) { return Lookup(kFormats, name); });
+        return check(options.output_format.has_value());
+    } else if (flag == "--block") {
+        auto block = value().and_then(ParseNumber<size_t>);
+        options.block_frames = block.value_or(options.block_frames);
+        return check(block.value_or(0) != 0);
+    } else if (flag == "--raw-input") {
+        options.raw_input = value().and_then(ParseRawLayout);
+        return check(options.raw_input.has_value());
+    } else if (flag == "--raw-output") {
+        options.raw_output = true;
+        return Parsed::Ok;
+    }
+    return Parsed::Unknown;
+}
+
+// Their usage text.
+constexpr auto kFileOptionsUsage
+    = R"(  --type TYPE        converter type (default Sinc_MediumQuality):
+                     Sinc_BestQuality, Sinc_MediumQuality, Sinc_Fastest,
+                     ZeroOrderHold, Linear, Polyphase_BestQuality,
+                     Polyphase_MediumQuality, Polyphase_Fastest
+  --ratio FACTOR     output rate / input rate
+  --rate HZ          output rate, instead of --ratio
+  --format FORMAT    output samples: int16, int24, int32 or float
+                     (default: the input's)
+  --block FRAMES     input frames per block (default 65536)
+  --raw-input CHANNELS:RATE:FORMAT
+                     read headerless little-endian PCM
+  --raw-output       write headerless PCM instead of WAV
+)";
+
+// An unbounded blocking queue.  The pipelines bound what is in flight by
+// how many buffers they create, not by the queue.
+template <typename T> class Queue {
+public:
+    void push(T value)
+    {
+        {
+            auto lock = std::lock_guard { mutex_ };
+            items_.push_back(std::move(value));
+        }
+        ready_.notify_one();
+    }
+
+    auto pop() -> T
+    {
+        auto lock = std::unique_lock { mutex_ };
+        ready_.wait(lock, [this] { return !items_.empty(); });
+        auto value = std::move(items_.front());
+        items_.pop_front();
+        return value;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<T> items_;
+};
+
+inline auto Seconds(Clock::duration duration) -> double
+{
+    return std::chrono::duration<double>(duration).count();
+}
+}
@@ -0,0 +1,168 @@
+// srcpp-batch: converts every file under a directory across all cores.
+//
+// The files become jobs for ConvertMany, which starts the largest first and
+// reuses each worker's converters from one file to the next.  The output
+// tree mirrors the input tree.
+#include "SRCppTools.hpp"
+#include <SRCpp/SRCppBatch.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <format>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace SRCppTools;
+
+auto Usage() -> std::string
+{
+    return std::string { R"(usage: srcpp-batch [options] INPUT_DIR OUTPUT_DIR
+
+Converts every WAV/RF64 file under INPUT_DIR, or every file with
+--raw-input, to the same path under OUTPUT_DIR.
+
+)" } + kFileOptionsUsage
+        + R"(  --threads N        files converted at once
+                     (default: one per hardware thread)
+)";
+}
+
+struct Arguments {
+    std::filesystem::path input;
+    std::filesystem::path output;
+    SRCpp::FileOptions options {};
+    size_t threads { 0 };
+};
+
+auto ParseArguments(int argc, char** argv)
+    -> std::pair<std::optional<Arguments>, std::string>
+{
+    auto arguments = Arguments {};
+    std::vector<std::string_view> paths;
+    for (int i = 1; i < argc; ++i) {
+        auto flag = std::string_view { argv[i] };
+        auto value = [&]() -> std::optional<std::string_view> {
+            if (i + 1 >= argc) {
+                return std::nullopt;
+            }
+            return std::string_view { argv[++i] };
+        };
+        auto bad = [&] {
+            return std::pair<std::optional<Arguments>, std::string> {
+                std::nullopt, std::format("Bad or missing value for {}", flag)
+            };
+        };
+        if (flag == "--help" || flag == "-h") {
+            return { std::nullopt, {} };
+        }
+        if (auto parsed = ParseFileOption(flag, value, arguments.options);
+            parsed == Parsed::Bad) {
+            return bad();
+        } else if (parsed == Parsed::Ok) {
+            continue;
+        }
+        if (flag == "--threads") {
+            auto threads = value().and_then(ParseNumber<size_t>);
+            if (!threads) {
+                return bad();
+            }
+            arguments.threads = *threads;
+        } else if (flag.starts_with("--")) {
+            return { std::nullopt, std::format("Unknown option {}", flag) };
+        } else {
+            paths.push_back(flag);
+        }
+    }
+    if (paths.size() != 2) {
+        return { std::nullopt, "Expected an INPUT_DIR and an OUTPUT_DIR" };
+    }
+    arguments.input = paths[0];
+    arguments.output = paths[1];
+    return { arguments, {} };
+}
+
+auto IsWav(std::filesystem::path const& path)
+{
+    auto extension = path.extension().string();
+    std::ranges::transform(extension, extension.begin(),
+        [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension == ".wav" || extension == ".rf64";
+}
+
+// A job for every file to convert, with its output directory created.
+auto FindJobs(Arguments const& arguments)
+    -> std::pair<std::optional<std::vector<SRCpp::Job>>, std::string>
+{
+    auto error = std::error_code {};
+    auto jobs = std::vector<SRCpp::Job> {};
+    auto walk = std::filesystem::recursive_directory_iterator(
+        arguments.input, error);
+    for (; !error && walk != std::filesystem::recursive_directory_iterator {};
+        walk.increment(error)) {
+        auto const& path = walk->path();
+        if (!walk->is_regular_file()
+            || (!arguments.options.raw_input && !IsWav(path))) {
+            continue;
+        }
+        auto output = arguments.output
+            / std::filesystem::relative(path, arguments.input);
+        if (!arguments.options.raw_output) {
+            output.replace_extension(".wav");
+        }
+        std::filesystem::create_directories(output.parent_path(), error);
+        if (error) {
+            return { std::nullopt,
+                std::format("Could not create {}: {}",
+                    output.parent_path().string(), error.message()) };
+        }
+        jobs.push_back({ path, output, arguments.options });
+    }
+    if (error) {
+        return { std::nullopt,
+            std::format("Could not read {}: {}", arguments.input.string(),
+                error.message()) };
+    }
+    return { std::move(jobs), std::string {} };
+}
+}
+
+auto main(int argc, char** argv) -> int
+{
+    auto [arguments, error] = ParseArguments(argc, argv);
+    if (!arguments) {
+        if (error.empty()) {
+            std::fputs(Usage().c_str(), stdout);
+            return 0;
+        }
+        std::fputs(
+            std::format("srcpp-batch: {}\n\n{}", error, Usage()).c_str(),
+            stderr);
+        return 2;
+    }
+    auto [jobs, jobs_error] = FindJobs(*arguments);
+    if (!jobs) {
+        std::fputs(
+            std::format("srcpp-batch: {}\n", jobs_error).c_str(), stderr);
+        return 1;
+    }
+
+    auto stats = SRCpp::ConvertMany(*jobs, arguments->threads);
+    for (auto const& job : *jobs) {
+        if (!job.stats) {
+            std::fputs(std::format("srcpp-batch: {}: {}\n",
+                           job.input.string(), job.error)
+                           .c_str(),
+                stderr);
+        }
+    }
+    std::fputs(std::format("{} files converted, {} failed\n"
+                           "{} -> {} frames in {:.3f} s: {:.1f} Mframes/s\n",
+                   stats.converted, stats.failed, stats.input_frames,
+                   stats.output_frames, stats.seconds,
+                   stats.frames_per_second() / 1e6)
+                   .c_str(),
+        stdout);
+    return stats.failed == 0 ? 0 : 1;
+}
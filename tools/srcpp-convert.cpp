@@ -0,0 +1,321 @@
+// srcpp-convert: converts one WAV/RF64 or raw PCM file at I/O speed.
+//
+// Three stages run on their own threads and overlap: the reader decodes
+// blocks from the memory-mapped input, the converter runs them through a
+// PushConverter, and the writer encodes and writes the output.  Blocks cycle
+// between the stages through queues, so --buffers of them per side bound the
+// memory in flight: 2 double-buffers, 3 triple-buffers.
+#include "SRCppTools.hpp"
+#include <cstdio>
+#include <format>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace SRCppTools;
+
+auto Usage() -> std::string
+{
+    return std::string { R"(usage: srcpp-convert [options] INPUT OUTPUT
+
+Converts INPUT, a WAV/RF64 file or raw PCM, to OUTPUT.
+
+)" } + kFileOptionsUsage
+        + R"(  --buffers N        blocks in flight per stage boundary, 2 or more
+                     (default 3)
+  --stats            print throughput and time spent per stage
+)";
+}
+
+struct Arguments {
+    std::string input;
+    std::string output;
+    SRCpp::FileOptions options {};
+    size_t buffers { 3 };
+    bool stats { false };
+};
+
+auto ParseArguments(int argc, char** argv)
+    -> std::pair<std::optional<Arguments>, std::string>
+{
+    auto arguments = Arguments {};
+    std::vector<std::string_view> paths;
+    for (int i = 1; i < argc; ++i) {
+        auto flag = std::string_view { argv[i] };
+        auto value = [&]() -> std::optional<std::string_view> {
+            if (i + 1 >= argc) {
+                return std::nullopt;
+            }
+            return std::string_view { argv[++i] };
+        };
+        auto bad = [&] {
+            return std::pair<std::optional<Arguments>, std::string> {
+                std::nullopt, std::format("Bad or missing value for {}", flag)
+            };
+        };
+        if (flag == "--help" || flag == "-h") {
+            return { std::nullopt, {} };
+        }
+        if (auto parsed = ParseFileOption(flag, value, arguments.options);
+            parsed == Parsed::Bad) {
+            return bad();
+        } else if (parsed == Parsed::Ok) {
+            continue;
+        }
+        if (flag == "--buffers") {
+            auto buffers = value().and_then(ParseNumber<size_t>);
+            if (!buffers || *buffers < 2) {
+                return bad();
+            }
+            arguments.buffers = *buffers;
+        } else if (flag == "--stats") {
+            arguments.stats = true;
+        } else if (flag.starts_with("--")) {
+            return { std::nullopt, std::format("Unknown option {}", flag) };
+        } else {
+            paths.push_back(flag);
+        }
+    }
+    if (paths.size() != 2) {
+        return { std::nullopt, "Expected an INPUT and an OUTPUT" };
+    }
+    arguments.input = paths[0];
+    arguments.output = paths[1];
+    return { arguments, {} };
+}
+
+// A block of interleaved float samples passed between stages.  The last
+// block of the stream is marked, and may be empty.
+struct Block {
+    std::vector<float> samples;
+    size_t frames { 0 };
+    bool last { false };
+};
+
+// Time each stage spent working, not waiting on the others.
+struct StageTimes {
+    Clock::duration read {};
+    Clock::duration convert {};
+    Clock::duration write {};
+};
+
+auto Run(Arguments const& arguments) -> std::string
+{
+    auto const& options = arguments.options;
+    auto [source, source_error]
+        = SRCpp::details::OpenAudio(arguments.input, options);
+    if (!source) {
+        return source_error;
+    }
+    auto bytes = source->file.bytes();
+    auto const& layout = source->layout;
+
+    auto channels = static_cast<size_t>(layout.channels);
+    auto factor = SRCpp::details::FileFactor(options, layout);
+    auto output_rate
+        = options.output_rate.value_or(layout.sample_rate * factor);
+    auto format = options.output_format.value_or(layout.format);
+    if (!src_is_valid_ratio(factor)) {
+        return SRCpp::StrError(SRCpp::ErrorBadFactor);
+    }
+    auto [converter, converter_error]
+        = SRCpp::PushConverter::create(options.type, layout.channels, factor);
+    if (!converter) {
+        return SRCpp::StrError(converter_error);
+    }
+
+    auto file = std::ofstream(arguments.output, std::ios::binary);
+    if (!file) {
+        return std::format("Could not create {}", arguments.output);
+    }
+    // the fmt chunk, and so the header, depends on the channels and format
+    auto header = std::vector<std::byte>(
+        SRCpp::details::WavHeaderSize(layout.channels, format));
+    auto write_header = [&](size_t frames) {
+        SRCpp::details::WriteWavHeader(
+            header, layout.channels, output_rate, format, frames);
+        file.write(reinterpret_cast<const char*>(header.data()),
+            static_cast<std::streamsize>(header.size()));
+    };
+    if (!options.raw_output) {
+        // rewritten with the real length at the end
+        write_header(0);
+    }
+
+    auto block = options.block_frames;
+    auto out_block
+        = static_cast<size_t>(std::ceil(static_cast<double>(block) * factor))
+        + 1;
+    converter->prepare(block, out_block);
+
+    // the blocks on each side of the converter, and where they wait
+    auto inputs = std::vector<Block>(arguments.buffers);
+    auto outputs = std::vector<Block>(arguments.buffers);
+    Queue<Block*> free_inputs, read, free_outputs, converted;
+    for (auto& input : inputs) {
+        input.samples.resize(block * channels);
+        free_inputs.push(&input);
+    }
+    for (auto& output : outputs) {
+        output.samples.resize(out_block * channels);
+        free_outputs.push(&output);
+    }
+
+    auto times = StageTimes {};
+    auto in_frame_bytes
+        = SRCpp::details::BytesPerSample(layout.format) * channels;
+    auto reader = std::thread([&] {
+        auto scratch = SRCpp::details::SampleScratch {
+            std::vector<short>(block * channels),
+            std::vector<int>(block * channels),
+        };
+        for (size_t frame = 0;;) {
+            auto* input = free_inputs.pop();
+            auto start = Clock::now();
+            input->frames = std::min(block, layout.frames - frame);
+            input->last = frame + input->frames == layout.frames;
+            SRCpp::details::DecodeSamples(
+                bytes.subspan(layout.offset + frame * in_frame_bytes,
+                    input->frames * in_frame_bytes),
+                layout.format,
+                std::span { input->samples }.first(input->frames * channels),
+                scratch);
+            frame += input->frames;
+            source->file.release(layout.offset + frame * in_frame_bytes);
+            times.read += Clock::now() - start;
+            auto last = input->last;
+            read.push(input);
+            if (last) {
+                return;
+            }
+        }
+    });
+
+    std::string error;
+    auto written = size_t { 0 };
+    auto writer = std::thread([&] {
+        auto out_frame_bytes
+            = SRCpp::details::BytesPerSample(format) * channels;
+        auto scratch = SRCpp::details::SampleScratch {};
+        auto encoded = std::vector<std::byte>();
+        for (;;) {
+            auto* output = converted.pop();
+            auto start = Clock::now();
+            auto samples = output->frames * channels;
+            if (scratch.ints.size() < samples) {
+                scratch.shorts.resize(samples);
+                scratch.ints.resize(samples);
+            }
+            encoded.resize(output->frames * out_frame_bytes);
+            SRCpp::details::EncodeSamples(
+                std::span { output->samples }.first(samples), format, encoded,
+                scratch);
+            file.write(reinterpret_cast<const char*>(encoded.data()),
+                static_cast<std::streamsize>(encoded.size()));
+            written += output->frames;
+            times.write += Clock::now() - start;
+            auto last = output->last;
+            free_outputs.push(output);
+            if (last) {
+                return;
+            }
+        }
+    });
+
+    // the converter stage runs here; after an error it keeps draining the
+    // reader so that every stage still reaches the last block
+    auto start = Clock::now();
+    for (auto last = false; !last;) {
+        auto* input = read.pop();
+        auto* output = free_outputs.pop();
+        auto began = Clock::now();
+        last = input->last;
+        output->frames = 0;
+        if (error.empty()) {
+            auto [result, result_error] = converter->convert_noalloc(
+                std::span<const float> { input->samples }.first(
+                    input->frames * channels),
+                std::span { output->samples });
+            if (result_error != 0) {
+                error = SRCpp::StrError(result_error);
+            }
+            output->frames = result.size() / channels;
+        }
+        free_inputs.push(input);
+        times.convert += Clock::now() - began;
+        output->last = false;
+        converted.push(output);
+    }
+    // the flush gets its own block, grown to whatever the filter held back
+    auto* flush = free_outputs.pop();
+    auto began = Clock::now();
+    flush->frames = 0;
+    if (error.empty()) {
+        auto [result, result_error] = converter->flush<float>();
+        if (!result) {
+            error = result_error;
+        } else {
+            flush->samples = std::move(*result);
+            flush->frames = flush->samples.size() / channels;
+        }
+    }
+    times.convert += Clock::now() - began;
+    flush->last = true;
+    converted.push(flush);
+    reader.join();
+    writer.join();
+    auto elapsed = Clock::now() - start;
+
+    if (!options.raw_output) {
+        file.seekp(0);
+        write_header(written);
+    }
+    file.close();
+    if (!file && error.empty()) {
+        error = std::format("Could not write {}", arguments.output);
+    }
+    if (!error.empty()) {
+        return error;
+    }
+
+    if (arguments.stats) {
+        auto seconds = Seconds(elapsed);
+        auto megabytes = static_cast<double>(bytes.size()) / 1e6;
+        std::fputs(std::format("{} -> {} frames, {} at {:.6f}\n"
+                               "{:.3f} s: {:.1f} Mframes/s, {:.1f} MB/s in\n"
+                               "read {:.3f} s, convert {:.3f} s, "
+                               "write {:.3f} s\n",
+                       layout.frames, written, NameOf(kTypes, options.type),
+                       factor, seconds,
+                       static_cast<double>(layout.frames) / seconds / 1e6,
+                       megabytes / seconds, Seconds(times.read),
+                       Seconds(times.convert), Seconds(times.write))
+                       .c_str(),
+            stdout);
+    }
+    return {};
+}
+}
+
+auto main(int argc, char** argv) -> int
+{
+    auto [arguments, error] = ParseArguments(argc, argv);
+    if (!arguments) {
+        if (error.empty()) {
+            std::fputs(Usage().c_str(), stdout);
+            return 0;
+        }
+        std::fputs(
+            std::format("srcpp-convert: {}\n\n{}", error, Usage()).c_str(),
+            stderr);
+        return 2;
+    }
+    if (auto failure = Run(*arguments); !failure.empty()) {
+        std::fputs(std::format("srcpp-convert: {}\n", failure).c_str(), stderr);
+        return 1;
+    }
+    return 0;
+}